@@ -0,0 +1,286 @@
+
+#include "include/AssetCache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace synthesizerBase {
+
+    namespace {
+        constexpr char cacheMagic[8] = {'S', 'B', 'C', 'A', 'C', 'H', 'E', '\0'};
+
+        /**
+         * Start of the file
+         */
+        struct CacheHeader {
+            char magic[8];
+            uint32_t formatVersion;
+            uint32_t assetCount;
+            uint64_t contentVersion;
+            uint64_t fileBytes;
+            uint64_t directoryChecksum; // of the entries following the header
+            uint8_t reserved[24];
+        };
+
+        /**
+         * Directory entry of an asset
+         */
+        struct CacheEntry {
+            char name[AssetCache::maxNameLength + 1]; // zero-terminated
+            uint32_t type;
+            uint32_t count;
+            uint64_t offset; // from the start of the file, multiple of payloadAlignment
+            uint64_t bytes;
+            uint64_t checksum; // of the payload
+        };
+
+        static_assert(sizeof(CacheHeader) == 64, "The header fills one cache line");
+        static_assert(sizeof(CacheEntry) == 64, "Directory entries fill one cache line");
+
+        /**
+         * FNV-1a over 64-bit words, then the remaining bytes; about one cycle per word, as the payloads are
+         * checked at startup
+         */
+        uint64_t checksum(const uint8_t* data, size_t bytes) {
+            constexpr uint64_t prime = 0x100000001b3ull;
+            uint64_t hash = 0xcbf29ce484222325ull;
+            size_t index = 0;
+            for (; index + 8 <= bytes; index += 8) {
+                uint64_t word;
+                memcpy(&word, data + index, sizeof(word));
+                hash = (hash ^ word) * prime;
+            }
+            for (; index < bytes; index++) {
+                hash = (hash ^ data[index]) * prime;
+            }
+            return hash;
+        }
+
+        size_t alignUp(size_t bytes) {
+            return (bytes + AssetCache::payloadAlignment - 1) & ~(AssetCache::payloadAlignment - 1);
+        }
+
+        bool writeAll(FILE* file, const void* data, size_t bytes) {
+            return bytes == 0 || fwrite(data, 1, bytes, file) == bytes;
+        }
+    }
+
+    AssetCache::~AssetCache() {
+        close();
+    }
+
+    int32_t AssetCache::open(const char* path, uint64_t contentVersion) {
+        close();
+        const int file = ::open(path, O_RDONLY);
+        if (file < 0) {
+            return ResultErrorIO;
+        }
+        struct stat status{};
+        void* map = MAP_FAILED;
+        if (fstat(file, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(CacheHeader))) {
+            map = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        ::close(file); // the mapping keeps the file
+        if (map == MAP_FAILED) {
+            return ResultErrorIO;
+        }
+        const size_t size = static_cast<size_t>(status.st_size);
+        const auto* bytes = static_cast<const uint8_t*>(map);
+
+        // Header and directory only; the payloads are checked on first use
+        CacheHeader header{};
+        memcpy(&header, bytes, sizeof(header));
+        const size_t directoryBytes = static_cast<size_t>(header.assetCount) * sizeof(CacheEntry);
+        bool valid = memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 &&
+                     header.formatVersion == formatVersion && header.fileBytes == size &&
+                     (contentVersion == 0 || header.contentVersion == contentVersion) &&
+                     header.assetCount <= (size - sizeof(CacheHeader)) / sizeof(CacheEntry) &&
+                     checksum(bytes + sizeof(CacheHeader), directoryBytes) == header.directoryChecksum;
+        for (uint32_t index = 0; valid && index < header.assetCount; index++) {
+            CacheEntry entry{};
+            memcpy(&entry, bytes + sizeof(CacheHeader) + index * sizeof(CacheEntry), sizeof(entry));
+            valid = entry.name[maxNameLength] == '\0' && entry.offset % payloadAlignment == 0 &&
+                    entry.offset >= sizeof(CacheHeader) + directoryBytes && entry.offset <= size &&
+                    entry.bytes <= size - entry.offset;
+        }
+        if (!valid) {
+            munmap(map, size);
+            return ResultErrorInvalidState;
+        }
+        _map = bytes;
+        _mapBytes = size;
+        _assetCount = static_cast<int32_t>(header.assetCount);
+        _contentVersion = header.contentVersion;
+        _validation.reset(new std::atomic<int32_t>[header.assetCount]);
+        for (int32_t index = 0; index < _assetCount; index++) {
+            _validation[index].store(0, std::memory_order_relaxed);
+        }
+        return ResultOk;
+    }
+
+    void AssetCache::close() {
+        if (_map != nullptr) {
+            munmap(const_cast<uint8_t*>(_map), _mapBytes);
+        }
+        _map = nullptr;
+        _mapBytes = 0;
+        _assetCount = 0;
+        _contentVersion = 0;
+        _validation.reset();
+    }
+
+    bool AssetCache::isOpen() const {
+        return _map != nullptr;
+    }
+
+    int32_t AssetCache::getAssetCount() const {
+        return _assetCount;
+    }
+
+    uint64_t AssetCache::getContentVersion() const {
+        return _contentVersion;
+    }
+
+    const void* AssetCache::find(const char* name, AssetType type, size_t* bytes, uint32_t* count) {
+        for (int32_t index = 0; index < _assetCount; index++) {
+            const auto* entry = reinterpret_cast<const CacheEntry*>(_map + sizeof(CacheHeader)) + index;
+            if (strncmp(entry->name, name, sizeof(entry->name)) != 0) {
+                continue;
+            }
+            if (entry->type != static_cast<uint32_t>(type) || !validate(index)) {
+                return nullptr;
+            }
+            if (bytes != nullptr) {
+                *bytes = static_cast<size_t>(entry->bytes);
+            }
+            if (count != nullptr) {
+                *count = entry->count;
+            }
+            return _map + entry->offset;
+        }
+        return nullptr;
+    }
+
+    const float* AssetCache::findWavetable(const char* name) {
+        size_t bytes = 0;
+        const void* tables = find(name, AssetType::Wavetable, &bytes);
+        const size_t expectedBytes =
+                sizeof(float) * WavetableMipmaps::levelCount * WavetableMipmaps::levelStride;
+        return bytes == expectedBytes ? static_cast<const float*>(tables) : nullptr;
+    }
+
+    const float* AssetCache::findParameters(const char* name, int32_t* count) {
+        size_t bytes = 0;
+        uint32_t values = 0;
+        const void* parameters = find(name, AssetType::Parameters, &bytes, &values);
+        if (parameters == nullptr || bytes != sizeof(float) * values) {
+            return nullptr;
+        }
+        *count = static_cast<int32_t>(values);
+        return static_cast<const float*>(parameters);
+    }
+
+    int32_t AssetCache::validateAll() {
+        int32_t result = ResultOk;
+        for (int32_t index = 0; index < _assetCount; index++) {
+            if (!validate(index)) {
+                result = ResultErrorInvalidState;
+            }
+        }
+        return result;
+    }
+
+    bool AssetCache::validate(int32_t index) {
+        const int32_t state = _validation[index].load(std::memory_order_acquire);
+        if (state != 0) {
+            return state > 0;
+        }
+        // Threads checking the same asset at once both compute the same result
+        const auto* entry = reinterpret_cast<const CacheEntry*>(_map + sizeof(CacheHeader)) + index;
+        const bool valid = checksum(_map + entry->offset, static_cast<size_t>(entry->bytes)) == entry->checksum;
+        _validation[index].store(valid ? 1 : -1, std::memory_order_release);
+        return valid;
+    }
+
+    int32_t AssetCacheBuilder::addData(const char* name, AssetType type, const void* data, size_t bytes,
+                                       uint32_t count) {
+        const size_t length = name != nullptr ? strlen(name) : 0;
+        if (length == 0 || length > static_cast<size_t>(AssetCache::maxNameLength) ||
+            (data == nullptr && bytes > 0)) {
+            return ResultErrorInvalidArgument;
+        }
+        for (const Asset& asset : _assets) {
+            if (asset.name == name) {
+                return ResultErrorInvalidArgument;
+            }
+        }
+        const auto* begin = static_cast<const uint8_t*>(data);
+        _assets.push_back(Asset{name, type, count, std::vector<uint8_t>(begin, begin + bytes)});
+        return ResultOk;
+    }
+
+    int32_t AssetCacheBuilder::addWavetable(const char* name, const WavetableMipmaps& mipmaps) {
+        constexpr uint32_t floats = WavetableMipmaps::levelCount * WavetableMipmaps::levelStride;
+        return addData(name, AssetType::Wavetable, mipmaps.getTables(), sizeof(float) * floats, floats);
+    }
+
+    int32_t AssetCacheBuilder::addParameters(const char* name, const float* values, int32_t count) {
+        if (count < 0) {
+            return ResultErrorInvalidArgument;
+        }
+        return addData(name, AssetType::Parameters, values, sizeof(float) * count, static_cast<uint32_t>(count));
+    }
+
+    int32_t AssetCacheBuilder::write(const char* path, uint64_t contentVersion) const {
+        // Directory, with the payloads laid out after it
+        std::vector<CacheEntry> directory(_assets.size());
+        size_t offset = alignUp(sizeof(CacheHeader) + sizeof(CacheEntry) * _assets.size());
+        for (size_t index = 0; index < _assets.size(); index++) {
+            CacheEntry& entry = directory[index];
+            memset(&entry, 0, sizeof(entry));
+            strncpy(entry.name, _assets[index].name.c_str(), AssetCache::maxNameLength);
+            entry.type = static_cast<uint32_t>(_assets[index].type);
+            entry.count = _assets[index].count;
+            entry.offset = offset;
+            entry.bytes = _assets[index].data.size();
+            entry.checksum = checksum(_assets[index].data.data(), _assets[index].data.size());
+            offset = alignUp(offset + _assets[index].data.size());
+        }
+        CacheHeader header{};
+        memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.formatVersion = AssetCache::formatVersion;
+        header.assetCount = static_cast<uint32_t>(_assets.size());
+        header.contentVersion = contentVersion;
+        header.fileBytes = offset;
+        header.directoryChecksum = checksum(reinterpret_cast<const uint8_t*>(directory.data()),
+                                            sizeof(CacheEntry) * directory.size());
+
+        const std::string temporaryPath = std::string(path) + ".tmp";
+        FILE* file = fopen(temporaryPath.c_str(), "wb");
+        if (file == nullptr) {
+            return ResultErrorIO;
+        }
+        static const uint8_t padding[AssetCache::payloadAlignment] = {};
+        size_t written = sizeof(CacheHeader) + sizeof(CacheEntry) * directory.size();
+        bool success = writeAll(file, &header, sizeof(header)) &&
+                       writeAll(file, directory.data(), sizeof(CacheEntry) * directory.size());
+        for (size_t index = 0; success && index < _assets.size(); index++) {
+            success = writeAll(file, padding, directory[index].offset - written) &&
+                      writeAll(file, _assets[index].data.data(), _assets[index].data.size());
+            written = directory[index].offset + _assets[index].data.size();
+        }
+        success = success && writeAll(file, padding, offset - written);
+        success = fclose(file) == 0 && success;
+        if (!success || rename(temporaryPath.c_str(), path) != 0) {
+            remove(temporaryPath.c_str());
+            return ResultErrorIO;
+        }
+        return ResultOk;
+    }
+
+}  // namespace synthesizerBase
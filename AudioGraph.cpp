@@ -0,0 +1,341 @@
+
+#include "include/AudioGraph.h"
+
+#include <algorithm>
+#include <string.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    void AudioSourceNode::process(const float* const* inputs, int32_t inputCount, float* output, int32_t framesCount,
+                                  ChannelCount channelCount) {
+        if (_source->isIdle()) {
+            memset(output, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            return;
+        }
+        _source->onAudioReady(output, framesCount, channelCount);
+    }
+
+    void AudioSourceNode::onPlaybackStopped() {
+        _source->onPlaybackStopped();
+    }
+
+    void AudioSourceNode::onAudioEvent(const AudioEvent& event) {
+        _source->onAudioEvent(event);
+    }
+
+    void MixNode::process(const float* const* inputs, int32_t inputCount, float* output, int32_t framesCount,
+                          ChannelCount channelCount) {
+        const int32_t samples = framesCount * static_cast<int32_t>(channelCount);
+        if (inputCount == 0) {
+            memset(output, 0, sizeof(float) * samples);
+            return;
+        }
+        memcpy(output, inputs[0], sizeof(float) * samples);
+        for (int32_t input = 1; input < inputCount; input++) {
+            simd::mixAccumulate(output, inputs[input], 1.0f, samples);
+        }
+    }
+
+    AudioGraph::AudioGraph(int32_t maxNodes, int32_t channelCount, int32_t blockFrames)
+            : _channelCount(std::max(1, channelCount)),
+              _blockFrames(std::max(1, blockFrames)),
+              _nodes(static_cast<size_t>(std::max(1, maxNodes))) {
+    }
+
+    AudioGraph::~AudioGraph() {
+        releaseRetiredSchedules();
+        delete _pending.exchange(nullptr);
+        delete _current;
+    }
+
+    int32_t AudioGraph::addNode(AudioGraphNode* node) {
+        if (node == nullptr) {
+            return ResultErrorInvalidArgument;
+        }
+        for (size_t index = 0; index < _nodes.size(); index++) {
+            if (_nodes[index].node == nullptr) {
+                _nodes[index].node = node;
+                _nodes[index].inputs.clear();
+                return static_cast<int32_t>(index);
+            }
+        }
+        return ResultErrorInvalidState;
+    }
+
+    int32_t AudioGraph::removeNode(int32_t node) {
+        if (node < 0 || node >= static_cast<int32_t>(_nodes.size()) || _nodes[node].node == nullptr) {
+            return ResultErrorInvalidArgument;
+        }
+        _nodes[node].node = nullptr;
+        _nodes[node].inputs.clear();
+        for (NodeEntry& entry : _nodes) {
+            entry.inputs.erase(std::remove(entry.inputs.begin(), entry.inputs.end(), node), entry.inputs.end());
+        }
+        if (_outputNode == node) {
+            _outputNode = -1;
+        }
+        return ResultOk;
+    }
+
+    int32_t AudioGraph::connect(int32_t source, int32_t destination) {
+        const auto count = static_cast<int32_t>(_nodes.size());
+        if (source < 0 || source >= count || destination < 0 || destination >= count ||
+            _nodes[source].node == nullptr || _nodes[destination].node == nullptr) {
+            return ResultErrorInvalidArgument;
+        }
+        _nodes[destination].inputs.push_back(source);
+        return ResultOk;
+    }
+
+    int32_t AudioGraph::disconnect(int32_t source, int32_t destination) {
+        if (destination < 0 || destination >= static_cast<int32_t>(_nodes.size())) {
+            return ResultErrorInvalidArgument;
+        }
+        std::vector<int32_t>& inputs = _nodes[destination].inputs;
+        auto position = std::find(inputs.begin(), inputs.end(), source);
+        if (position == inputs.end()) {
+            return ResultErrorInvalidArgument;
+        }
+        inputs.erase(position);
+        return ResultOk;
+    }
+
+    int32_t AudioGraph::setOutputNode(int32_t node) {
+        if (node < 0 || node >= static_cast<int32_t>(_nodes.size()) || _nodes[node].node == nullptr) {
+            return ResultErrorInvalidArgument;
+        }
+        _outputNode = node;
+        return ResultOk;
+    }
+
+    int32_t AudioGraph::commit() {
+        releaseRetiredSchedules();
+        const auto count = static_cast<int32_t>(_nodes.size());
+        std::unique_ptr<Schedule> schedule(new Schedule());
+
+        // Nodes the output depends on
+        std::vector<char> needed(static_cast<size_t>(count), 0);
+        std::vector<int32_t> stack;
+        if (_outputNode >= 0) {
+            stack.push_back(_outputNode);
+            needed[_outputNode] = 1;
+        }
+        while (!stack.empty()) {
+            const int32_t node = stack.back();
+            stack.pop_back();
+            for (int32_t input : _nodes[node].inputs) {
+                if (!needed[input]) {
+                    needed[input] = 1;
+                    stack.push_back(input);
+                }
+            }
+        }
+
+        // Topological order (Kahn's algorithm); each connection counts, even if repeated
+        std::vector<int32_t> pendingInputs(static_cast<size_t>(count), 0);
+        std::vector<std::vector<int32_t>> consumers(static_cast<size_t>(count));
+        int32_t neededCount = 0;
+        for (int32_t node = 0; node < count; node++) {
+            if (!needed[node]) {
+                continue;
+            }
+            neededCount++;
+            for (int32_t input : _nodes[node].inputs) {
+                consumers[input].push_back(node);
+                pendingInputs[node]++;
+            }
+        }
+        std::vector<int32_t> order;
+        order.reserve(static_cast<size_t>(neededCount));
+        for (int32_t node = 0; node < count; node++) {
+            if (needed[node] && pendingInputs[node] == 0) {
+                order.push_back(node);
+            }
+        }
+        for (size_t next = 0; next < order.size(); next++) {
+            for (int32_t consumer : consumers[order[next]]) {
+                if (--pendingInputs[consumer] == 0) {
+                    order.push_back(consumer);
+                }
+            }
+        }
+        if (static_cast<int32_t>(order.size()) != neededCount) {
+            return ResultErrorInvalidArgument;
+        }
+
+        // Waves: a node runs one wave after the latest of its inputs
+        std::vector<int32_t> waveOf(static_cast<size_t>(count), 0);
+        int32_t waveCount = 0;
+        for (int32_t node : order) {
+            for (int32_t input : _nodes[node].inputs) {
+                waveOf[node] = std::max(waveOf[node], waveOf[input] + 1);
+            }
+            waveCount = std::max(waveCount, waveOf[node] + 1);
+        }
+        std::stable_sort(order.begin(), order.end(), [&waveOf](int32_t a, int32_t b) {
+            return waveOf[a] < waveOf[b];
+        });
+
+        // Liveness: a buffer returns to the free list after the wave of the last consumer of its node. Not after
+        // the step: nodes of one wave may run concurrently.
+        const auto steps = static_cast<int32_t>(order.size());
+        std::vector<int32_t> lastUse(static_cast<size_t>(count), -1);
+        for (int32_t node : order) {
+            for (int32_t input : _nodes[node].inputs) {
+                lastUse[input] = std::max(lastUse[input], waveOf[node]);
+            }
+        }
+        if (_outputNode >= 0) {
+            lastUse[_outputNode] = waveCount; // read after the last wave
+        }
+        std::vector<int32_t> bufferOf(static_cast<size_t>(count), -1);
+        std::vector<int32_t> freeBuffers;
+        int32_t bufferCount = 0;
+        size_t inputTotal = 0;
+        for (int32_t waveStart = 0; waveStart < steps;) {
+            const int32_t wave = waveOf[order[waveStart]];
+            int32_t waveEnd = waveStart;
+            for (; waveEnd < steps && waveOf[order[waveEnd]] == wave; waveEnd++) {
+                const int32_t node = order[waveEnd];
+                if (freeBuffers.empty()) {
+                    bufferOf[node] = bufferCount++;
+                } else {
+                    bufferOf[node] = freeBuffers.back();
+                    freeBuffers.pop_back();
+                }
+                inputTotal += _nodes[node].inputs.size();
+            }
+            schedule->waveEnds.push_back(waveEnd);
+            for (int32_t step = waveStart; step < waveEnd; step++) {
+                for (int32_t input : _nodes[order[step]].inputs) {
+                    if (lastUse[input] == wave) {
+                        lastUse[input] = -1; // once, even if used several times
+                        freeBuffers.push_back(bufferOf[input]);
+                    }
+                }
+            }
+            waveStart = waveEnd;
+        }
+
+        const size_t bufferSize = static_cast<size_t>(_blockFrames) * _channelCount;
+        schedule->bufferCount = bufferCount;
+        schedule->arena.resize(bufferSize * std::max(1, bufferCount));
+        schedule->inputPointers.reserve(inputTotal); // no reallocation: the steps point into it
+        schedule->steps.reserve(static_cast<size_t>(steps));
+        for (int32_t node : order) {
+            Step step{};
+            step.node = _nodes[node].node;
+            step.inputs = schedule->inputPointers.data() + schedule->inputPointers.size();
+            step.inputCount = static_cast<int32_t>(_nodes[node].inputs.size());
+            step.output = schedule->arena.data() + bufferSize * bufferOf[node];
+            for (int32_t input : _nodes[node].inputs) {
+                schedule->inputPointers.push_back(schedule->arena.data() + bufferSize * bufferOf[input]);
+            }
+            schedule->steps.push_back(step);
+        }
+        if (_outputNode >= 0) {
+            schedule->output = schedule->arena.data() + bufferSize * bufferOf[_outputNode];
+        }
+
+        _scheduledNodeCount = steps;
+        _bufferCount = bufferCount;
+        // A schedule committed before and never adopted can be deleted right away
+        delete _pending.exchange(schedule.release(), std::memory_order_acq_rel);
+        return ResultOk;
+    }
+
+    bool AudioGraph::isCommitPending() const {
+        return _pending.load(std::memory_order_acquire) != nullptr;
+    }
+
+    int32_t AudioGraph::getScheduledNodeCount() const {
+        return _scheduledNodeCount;
+    }
+
+    int32_t AudioGraph::getBufferCount() const {
+        return _bufferCount;
+    }
+
+    void AudioGraph::setThreadPool(RealtimeThreadPool* pool) {
+        _threadPool = pool;
+    }
+
+    void AudioGraph::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        adoptPendingSchedule();
+        const auto channels = static_cast<int32_t>(channelCount);
+        if (_current == nullptr || _current->output == nullptr || channels != _channelCount) {
+            memset(audioData, 0, sizeof(float) * framesCount * channels);
+            return;
+        }
+
+        for (int32_t offset = 0; offset < framesCount; offset += _blockFrames) {
+            const int32_t frames = std::min(_blockFrames, framesCount - offset);
+            int32_t waveStart = 0;
+            for (int32_t waveEnd : _current->waveEnds) {
+                if (_threadPool != nullptr && waveEnd - waveStart > 1) {
+                    _waveSteps = _current->steps.data() + waveStart;
+                    _waveFrames = frames;
+                    _waveChannelCount = channelCount;
+                    _threadPool->parallelFor(&AudioGraph::processStepTask, this, waveEnd - waveStart);
+                } else {
+                    for (int32_t index = waveStart; index < waveEnd; index++) {
+                        const Step& step = _current->steps[index];
+                        step.node->process(step.inputs, step.inputCount, step.output, frames, channelCount);
+                    }
+                }
+                waveStart = waveEnd;
+            }
+            for (int32_t channel = 0; channel < channels; channel++) {
+                memcpy(audioData + static_cast<int64_t>(channel) * framesCount + offset,
+                       _current->output + static_cast<int64_t>(channel) * frames, sizeof(float) * frames);
+            }
+        }
+    }
+
+    void AudioGraph::onPlaybackStopped() {
+        if (_current == nullptr) {
+            return;
+        }
+        for (const Step& step : _current->steps) {
+            step.node->onPlaybackStopped();
+        }
+    }
+
+    void AudioGraph::onAudioEvent(const AudioEvent& event) {
+        adoptPendingSchedule();
+        if (_current == nullptr) {
+            return;
+        }
+        for (const Step& step : _current->steps) {
+            step.node->onAudioEvent(event);
+        }
+    }
+
+    void AudioGraph::adoptPendingSchedule() {
+        if (_pending.load(std::memory_order_relaxed) == nullptr || _retired.availableToWrite() == 0) {
+            // Nothing new, or the control thread has not released enough old schedules yet
+            return;
+        }
+        Schedule* schedule = _pending.exchange(nullptr, std::memory_order_acq_rel);
+        if (_current != nullptr) {
+            _retired.push(_current);
+        }
+        _current = schedule;
+    }
+
+    void AudioGraph::processStepTask(void* context, int32_t index) {
+        auto* graph = static_cast<AudioGraph*>(context);
+        const Step& step = graph->_waveSteps[index];
+        step.node->process(step.inputs, step.inputCount, step.output, graph->_waveFrames, graph->_waveChannelCount);
+    }
+
+    void AudioGraph::releaseRetiredSchedules() {
+        Schedule* schedule = nullptr;
+        while (_retired.pop(schedule)) {
+            delete schedule;
+        }
+    }
+
+}  // namespace synthesizerBase
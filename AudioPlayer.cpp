@@ -4,15 +4,194 @@
 
 #include "include/AudioPlayer.h"
 
+#include <algorithm>
+#include <string.h>
+#include "include/RealtimeSafety.h"
+#include "include/SimdKernels.h"
+
 namespace synthesizerBase {
 
-    void AudioPlayer::setAudioSource(AudioSource *source) {
-        _source = source;
+    AudioPlayer::AudioPlayer()
+            : _stagedEvents(eventQueueCapacity),
+              _subBlockScratch(defaultAudioFrameSize * AudioSourceExchange::crossfadeChannels) {
+    }
+
+    AudioPlayer::~AudioPlayer() {
+        if (_threadPool != nullptr) {
+            _threadPool->setThreadSetup(nullptr);
+        }
+    }
+
+    int32_t AudioPlayer::setAudioSource(AudioSource *source) {
+        return _sourceExchange.setSource(source);
+    }
+
+    int32_t AudioPlayer::setAudioSource(AudioSource *source, int32_t crossfadeFrames) {
+        return _sourceExchange.setSource(source, crossfadeFrames);
     }
 
     AudioSource* AudioPlayer::getAudioSource()
     {
-        return(_source);
+        return(_sourceExchange.getSource());
+    }
+
+    AudioSource* AudioPlayer::collectRetiredAudioSource()
+    {
+        return(_sourceExchange.collectRetired());
+    }
+
+    void AudioPlayer::adoptAudioSource() {
+        _sourceExchange.adoptWhileStopped();
+    }
+
+    void AudioPlayer::renderAudio(float* audioData, int32_t framesCount, ChannelCount channelCount,
+                                  SampleLayout layout) {
+        _threadSetup.applyToCurrentThread();
+        RealtimeScope realtimeScope;
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        _telemetry.beginCallback();
+#endif
+        if (_threadPool != nullptr) {
+            _threadPool->beginBlock(framesCount);
+        }
+        stageEvents();
+        const int64_t blockStart = _frameTime.load(std::memory_order_relaxed);
+        const int64_t blockEnd = blockStart + framesCount;
+        if (static_cast<int32_t>(channelCount) <= 1) {
+            layout = SampleLayout::Planar; // the same for one channel
+        }
+        if (_stagedCount == 0 || _stagedEvents[0].frame >= blockEnd) {
+            // No event in this block
+            if (layout == SampleLayout::Planar) {
+                _sourceExchange.render(audioData, framesCount, channelCount);
+            } else {
+                renderSubBlock(audioData, framesCount, channelCount, 0, framesCount, layout);
+            }
+        } else {
+            int32_t rendered = 0;
+            int32_t applied = 0;
+            while (applied < _stagedCount && _stagedEvents[applied].frame < blockEnd) {
+                const AudioEvent& event = _stagedEvents[applied];
+                const auto offset = static_cast<int32_t>(std::max<int64_t>(event.frame - blockStart, 0));
+                if (offset > rendered) {
+                    renderSubBlock(audioData, framesCount, channelCount, rendered, offset - rendered, layout);
+                    rendered = offset;
+                }
+                _sourceExchange.dispatchEvent(event);
+                applied++;
+            }
+            if (rendered < framesCount) {
+                renderSubBlock(audioData, framesCount, channelCount, rendered, framesCount - rendered, layout);
+            }
+            // Keep the events of later blocks
+            std::copy(_stagedEvents.begin() + applied, _stagedEvents.begin() + _stagedCount, _stagedEvents.begin());
+            _stagedCount -= applied;
+        }
+        _frameTime.store(blockEnd, std::memory_order_relaxed);
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        _telemetry.endCallback(framesCount);
+#endif
+    }
+
+    void AudioPlayer::stageEvents() {
+        AudioEvent event;
+        // Events left in the queue when the staging array is full are taken at the next block
+        while (_stagedCount < static_cast<int32_t>(_stagedEvents.size()) && _eventQueue.pop(event)) {
+            // Events mostly arrive in order: insertion from the end is then constant time. Equal frames keep
+            // their arrival order.
+            int32_t position = _stagedCount;
+            while (position > 0 && _stagedEvents[position - 1].frame > event.frame) {
+                _stagedEvents[position] = _stagedEvents[position - 1];
+                position--;
+            }
+            _stagedEvents[position] = event;
+            _stagedCount++;
+        }
+    }
+
+    void AudioPlayer::renderSubBlock(float* audioData, int32_t framesCount, ChannelCount channelCount,
+                                     int32_t offset, int32_t length, SampleLayout layout) {
+        const auto channels = static_cast<int32_t>(channelCount);
+        if (channels <= 1) {
+            _sourceExchange.render(audioData + offset, length, channelCount);
+            return;
+        }
+        const int32_t chunkFrames = std::max<int32_t>(1, static_cast<int32_t>(_subBlockScratch.size()) / channels);
+        if (layout == SampleLayout::Interleaved) {
+            // Frames of a part are contiguous: the source fills them directly if it renders interleaved frames
+            float* part = audioData + static_cast<int64_t>(offset) * channels;
+            if (_sourceExchange.renderInterleaved(part, length, channelCount)) {
+                return;
+            }
+            for (int32_t done = 0; done < length; done += chunkFrames) {
+                const int32_t chunk = std::min(chunkFrames, length - done);
+                _sourceExchange.render(_subBlockScratch.data(), chunk, channelCount);
+                simd::interleave(part + static_cast<int64_t>(done) * channels, _subBlockScratch.data(), chunk, chunk,
+                                 channels);
+            }
+            return;
+        }
+        // The source fills float[channelCount][length]: render into the scratch buffer, then copy each channel
+        for (int32_t done = 0; done < length; done += chunkFrames) {
+            const int32_t chunk = std::min(chunkFrames, length - done);
+            _sourceExchange.render(_subBlockScratch.data(), chunk, channelCount);
+            for (int32_t channel = 0; channel < channels; channel++) {
+                memcpy(audioData + channel * framesCount + offset + done, _subBlockScratch.data() + channel * chunk,
+                       sizeof(float) * chunk);
+            }
+        }
+    }
+
+    int32_t AudioPlayer::postEvent(const AudioEvent& event) {
+        return _eventQueue.push(event) ? ResultOk : ResultErrorInvalidState;
+    }
+
+    void AudioPlayer::discardEvents() {
+        AudioEvent event;
+        while (_eventQueue.pop(event)) {
+        }
+        _stagedCount = 0;
+    }
+
+    int64_t AudioPlayer::getFrameTime() const {
+        return _frameTime.load(std::memory_order_relaxed);
+    }
+
+    void AudioPlayer::setThreadPool(RealtimeThreadPool* pool) {
+        if (_threadPool != nullptr) {
+            _threadPool->setThreadSetup(nullptr);
+        }
+        _threadPool = pool;
+        if (pool != nullptr) {
+            pool->setThreadSetup(&_threadSetup);
+        }
+    }
+
+    RealtimeThreadPool* AudioPlayer::getThreadPool() {
+        return _threadPool;
+    }
+
+    void AudioPlayer::setAudioThreadFeatures(int32_t features, int32_t priority) {
+        _threadSetup.configure(features, priority);
+    }
+
+    AudioThreadSetup& AudioPlayer::getAudioThreadSetup() {
+        return _threadSetup;
+    }
+
+    CallbackTelemetry* AudioPlayer::getTelemetry() {
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        return &_telemetry;
+#else
+        return nullptr;
+#endif
+    }
+
+    void AudioPlayer::notifyPlaybackStopped() {
+        _sourceExchange.notifyPlaybackStopped();
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        _telemetry.endPlayback();
+#endif
     }
 
 
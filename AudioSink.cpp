@@ -0,0 +1,170 @@
+
+#include "include/AudioSink.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+namespace synthesizerBase {
+
+    BufferAudioSink::BufferAudioSink(float* buffer, int64_t capacityFrames)
+            : _buffer(buffer), _capacityFrames(capacityFrames) {
+    }
+
+    int32_t BufferAudioSink::open(int samplingRate, int32_t channelCount) {
+        if (_buffer == nullptr || channelCount <= 0) {
+            return ResultErrorInvalidArgument;
+        }
+        _channelCount = channelCount;
+        _framesWritten = 0;
+        return ResultOk;
+    }
+
+    int32_t BufferAudioSink::write(const float* audioData, int32_t framesCount, int32_t channelCount) {
+        if (channelCount != _channelCount) {
+            return ResultErrorInvalidArgument;
+        }
+        const int64_t framesLeft = _capacityFrames - _framesWritten;
+        if (framesLeft <= 0) {
+            return ResultErrorInvalidState;
+        }
+        const auto framesToStore = static_cast<int32_t>(std::min<int64_t>(framesCount, framesLeft));
+        memcpy(_buffer + _framesWritten * channelCount, audioData, sizeof(float) * framesToStore * channelCount);
+        _framesWritten += framesToStore;
+        // Once full, the leading part of the block that still fits is stored
+        return framesToStore == framesCount ? ResultOk : ResultErrorInvalidState;
+    }
+
+    void BufferAudioSink::close() {
+    }
+
+    SampleLayout BufferAudioSink::getLayout() const {
+        return SampleLayout::Interleaved;
+    }
+
+    int64_t BufferAudioSink::getFramesWritten() const {
+        return _framesWritten;
+    }
+
+    namespace {
+        // Frames converted at once when writing integer samples
+        constexpr int32_t conversionChunkFrames = 1024;
+    }
+
+    FileAudioSink::FileAudioSink(const char* path, FileFormat format, SampleFormat sampleFormat, DitherMode dither)
+            : _path(path, path + strlen(path) + 1), _format(format), _sampleFormat(sampleFormat), _dither(dither) {
+    }
+
+    FileAudioSink::~FileAudioSink() {
+        FileAudioSink::close();
+    }
+
+    int32_t FileAudioSink::open(int samplingRate, int32_t channelCount) {
+        if (channelCount <= 0 || samplingRate <= 0) {
+            return ResultErrorInvalidArgument;
+        }
+        close();
+        _file = fopen(_path.data(), "wb");
+        if (_file == nullptr) {
+            return ResultErrorIO;
+        }
+        _samplingRate = samplingRate;
+        _channelCount = channelCount;
+        _framesWritten = 0;
+        _converter.reset();
+        if (_sampleFormat != SampleFormat::Float) {
+            _converter.reset(new SampleFormatConverter(_sampleFormat, channelCount, _dither, conversionChunkFrames));
+            _converted.resize(static_cast<size_t>(conversionChunkFrames) * channelCount *
+                              SampleFormatConverter::bytesPerSample(_sampleFormat));
+        }
+        if (_format == FileFormat::Wav) {
+            // Placeholder header, rewritten with the final sizes on close
+            return writeWavHeader();
+        }
+        return ResultOk;
+    }
+
+    int32_t FileAudioSink::write(const float* audioData, int32_t framesCount, int32_t channelCount) {
+        if (_file == nullptr) {
+            return ResultErrorInvalidState;
+        }
+        if (channelCount != _channelCount) {
+            return ResultErrorInvalidArgument;
+        }
+        if (!_converter) {
+            const size_t samplesCount = static_cast<size_t>(framesCount) * channelCount;
+            if (fwrite(audioData, sizeof(float), samplesCount, _file) != samplesCount) {
+                return ResultErrorIO;
+            }
+            _framesWritten += framesCount;
+            return ResultOk;
+        }
+        const size_t frameBytes = static_cast<size_t>(channelCount) *
+                                  SampleFormatConverter::bytesPerSample(_sampleFormat);
+        for (int32_t offset = 0; offset < framesCount; offset += conversionChunkFrames) {
+            const int32_t frames = std::min(conversionChunkFrames, framesCount - offset);
+            _converter->convert(_converted.data(), audioData + static_cast<int64_t>(offset) * channelCount, frames);
+            if (fwrite(_converted.data(), frameBytes, frames, _file) != static_cast<size_t>(frames)) {
+                return ResultErrorIO;
+            }
+            _framesWritten += frames;
+        }
+        return ResultOk;
+    }
+
+    SampleLayout FileAudioSink::getLayout() const {
+        return SampleLayout::Interleaved;
+    }
+
+    void FileAudioSink::close() {
+        if (_file == nullptr) {
+            return;
+        }
+        if (_format == FileFormat::Wav) {
+            const int64_t dataBytes = _framesWritten * _channelCount *
+                                      SampleFormatConverter::bytesPerSample(_sampleFormat);
+            if ((dataBytes & 1) != 0) {
+                // RIFF chunks are padded to an even size; the pad byte does not count in the data chunk size
+                fputc(0, _file);
+            }
+            fseek(_file, 0, SEEK_SET);
+            writeWavHeader();
+        }
+        fclose(_file);
+        _file = nullptr;
+    }
+
+    // Write a little endian integer of the given number of bytes
+    static bool writeLittleEndian(FILE* file, uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            if (fputc(static_cast<int>((value >> (8 * i)) & 0xFF), file) == EOF) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int32_t FileAudioSink::writeWavHeader() {
+        const auto bytesPerSample = static_cast<uint32_t>(SampleFormatConverter::bytesPerSample(_sampleFormat));
+        const uint32_t bytesPerFrame = static_cast<uint32_t>(_channelCount) * bytesPerSample;
+        const auto dataBytes = static_cast<uint32_t>(_framesWritten * bytesPerFrame);
+        const uint32_t padBytes = dataBytes & 1; // written by close
+        const uint16_t formatPcm = 1;
+        const uint16_t formatIeeeFloat = 3;
+
+        bool ok = fwrite("RIFF", 1, 4, _file) == 4;
+        ok = ok && writeLittleEndian(_file, 36 + dataBytes + padBytes, 4);
+        ok = ok && fwrite("WAVEfmt ", 1, 8, _file) == 8;
+        ok = ok && writeLittleEndian(_file, 16, 4); // size of the fmt chunk
+        ok = ok && writeLittleEndian(_file, _sampleFormat == SampleFormat::Float ? formatIeeeFloat : formatPcm, 2);
+        ok = ok && writeLittleEndian(_file, static_cast<uint32_t>(_channelCount), 2);
+        ok = ok && writeLittleEndian(_file, static_cast<uint32_t>(_samplingRate), 4);
+        ok = ok && writeLittleEndian(_file, static_cast<uint32_t>(_samplingRate) * bytesPerFrame, 4);
+        ok = ok && writeLittleEndian(_file, bytesPerFrame, 2);
+        ok = ok && writeLittleEndian(_file, 8 * bytesPerSample, 2);
+        ok = ok && fwrite("data", 1, 4, _file) == 4;
+        ok = ok && writeLittleEndian(_file, dataBytes, 4);
+        return ok ? ResultOk : ResultErrorIO;
+    }
+
+}  // namespace synthesizerBase
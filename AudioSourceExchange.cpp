@@ -0,0 +1,214 @@
+
+#include "include/AudioSourceExchange.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+namespace synthesizerBase {
+
+    static constexpr uintptr_t pendingTag = 1;
+
+    AudioSourceExchange::AudioSourceExchange()
+            : _scratch(static_cast<size_t>(defaultAudioFrameSize) * crossfadeChannels) {
+    }
+
+    int32_t AudioSourceExchange::setSource(AudioSource* source, int32_t crossfadeFrames) {
+        if (source != nullptr && !addReference(source)) {
+            return ResultErrorInvalidState;
+        }
+        _published.store(source, std::memory_order_relaxed);
+        _pendingCrossfadeFrames.store(std::max(0, crossfadeFrames), std::memory_order_relaxed);
+        const uintptr_t previous = _pending.exchange(reinterpret_cast<uintptr_t>(source) | pendingTag,
+                                                     std::memory_order_acq_rel);
+        if (previous != 0) {
+            // The audio thread never took the previous publication: it ends here. The source itself may still be
+            // in use through an earlier publication, which the reference count accounts for.
+            releaseReference(reinterpret_cast<AudioSource*>(previous & ~pendingTag));
+        }
+        return ResultOk;
+    }
+
+    AudioSource* AudioSourceExchange::getSource() const {
+        return _published.load(std::memory_order_relaxed);
+    }
+
+    AudioSource* AudioSourceExchange::collectRetired() {
+        AudioSource* retired = nullptr;
+        while (_retired.pop(retired)) {
+            releaseReference(retired);
+        }
+        for (Reference& reference : _references) {
+            if (reference.source != nullptr && reference.count == 0) {
+                AudioSource* source = reference.source;
+                reference.source = nullptr;
+                return source;
+            }
+        }
+        return nullptr;
+    }
+
+    bool AudioSourceExchange::addReference(AudioSource* source) {
+        Reference* unused = nullptr;
+        for (Reference& reference : _references) {
+            if (reference.source == source) {
+                // Also if it waits for collectRetired: published again, it is in use again
+                reference.count++;
+                return true;
+            }
+            if (reference.source == nullptr && unused == nullptr) {
+                unused = &reference;
+            }
+        }
+        if (unused == nullptr) {
+            return false;
+        }
+        unused->source = source;
+        unused->count = 1;
+        return true;
+    }
+
+    void AudioSourceExchange::releaseReference(AudioSource* source) {
+        if (source == nullptr) {
+            return;
+        }
+        for (Reference& reference : _references) {
+            if (reference.source == source && reference.count > 0) {
+                reference.count--;
+                return;
+            }
+        }
+    }
+
+    void AudioSourceExchange::render(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        adoptPendingSource();
+
+        AudioSource* current = _current.load(std::memory_order_relaxed);
+        if (current != nullptr && !current->isIdle()) {
+            current->onAudioReady(audioData, framesCount, channelCount);
+        } else {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+        }
+
+        if (_fadingOut != nullptr) {
+            renderCrossfade(audioData, framesCount, channelCount);
+        }
+    }
+
+    bool AudioSourceExchange::renderInterleaved(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        adoptPendingSource();
+        if (_fadingOut != nullptr) {
+            return false;
+        }
+        AudioSource* current = _current.load(std::memory_order_relaxed);
+        if (current == nullptr || current->isIdle()) {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            return true;
+        }
+        if (current->getNativeLayout() != SampleLayout::Interleaved) {
+            return false;
+        }
+        current->renderInterleaved(audioData, framesCount, channelCount);
+        return true;
+    }
+
+    void AudioSourceExchange::notifyPlaybackStopped() {
+        AudioSource* current = _current.load(std::memory_order_relaxed);
+        if (current != nullptr) {
+            current->onPlaybackStopped();
+        }
+        if (_fadingOut != nullptr) {
+            _fadingOut->onPlaybackStopped();
+            retire(_fadingOut);
+            _fadingOut = nullptr;
+        }
+    }
+
+    void AudioSourceExchange::dispatchEvent(const AudioEvent& event) {
+        adoptPendingSource();
+        AudioSource* current = _current.load(std::memory_order_relaxed);
+        if (current != nullptr) {
+            current->onAudioEvent(event);
+        }
+    }
+
+    AudioSource* AudioSourceExchange::getCurrentSource() const {
+        return _current.load(std::memory_order_relaxed);
+    }
+
+    void AudioSourceExchange::adoptWhileStopped() {
+        if (_fadingOut != nullptr) {
+            retire(_fadingOut);
+            _fadingOut = nullptr;
+        }
+        adoptPendingSource(false);
+    }
+
+    void AudioSourceExchange::adoptPendingSource(bool crossfade) {
+        if (_fadingOut != nullptr) {
+            // One crossfade at a time; the new source is adopted at the first block boundary after it
+            return;
+        }
+        if (_pending.load(std::memory_order_relaxed) == 0 || _retired.availableToWrite() == 0) {
+            return;
+        }
+        const uintptr_t pending = _pending.exchange(0, std::memory_order_acq_rel);
+        if (pending == 0) {
+            return;
+        }
+        auto* source = reinterpret_cast<AudioSource*>(pending & ~pendingTag);
+        AudioSource* previous = _current.load(std::memory_order_relaxed);
+        if (source == previous) {
+            // Published again while in use: this publication ends at once, the current one goes on
+            if (source != nullptr) {
+                retire(source);
+            }
+            return;
+        }
+        _current.store(source, std::memory_order_release);
+
+        const int32_t crossfadeFrames = crossfade ? _pendingCrossfadeFrames.load(std::memory_order_relaxed) : 0;
+        if (previous != nullptr && crossfadeFrames > 0) {
+            _fadingOut = previous;
+            _fadeLength = crossfadeFrames;
+            _fadePosition = 0;
+        } else if (previous != nullptr) {
+            retire(previous);
+        }
+    }
+
+    void AudioSourceExchange::renderCrossfade(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        const auto channels = static_cast<int32_t>(channelCount);
+        const int32_t chunkFrames = static_cast<int32_t>(_scratch.size()) / channels;
+        const int32_t fadeFrames = std::min(framesCount, _fadeLength - _fadePosition);
+        const float gainStep = 1.0f / static_cast<float>(_fadeLength);
+
+        // The outgoing source renders only the frames still part of the crossfade, in chunks that fit the scratch
+        // buffer; each chunk is weighted down and added to the incoming source weighted up.
+        for (int32_t offset = 0; offset < fadeFrames; offset += chunkFrames) {
+            const int32_t chunk = std::min(chunkFrames, fadeFrames - offset);
+            _fadingOut->onAudioReady(_scratch.data(), chunk, channelCount);
+            const float startGain = static_cast<float>(_fadePosition + offset) * gainStep;
+            for (int32_t channel = 0; channel < channels; channel++) {
+                float* output = audioData + static_cast<int64_t>(channel) * framesCount + offset;
+                const float* outgoing = _scratch.data() + static_cast<int64_t>(channel) * chunk;
+                for (int32_t i = 0; i < chunk; i++) {
+                    const float gain = startGain + static_cast<float>(i) * gainStep;
+                    output[i] = gain * output[i] + (1.0f - gain) * outgoing[i];
+                }
+            }
+        }
+
+        _fadePosition += fadeFrames;
+        if (_fadePosition >= _fadeLength) {
+            retire(_fadingOut);
+            _fadingOut = nullptr;
+        }
+    }
+
+    void AudioSourceExchange::retire(AudioSource* source) {
+        // Space was checked before adopting the source that replaced this one
+        _retired.push(source);
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,190 @@
+
+#include "include/AudioThreadSetup.h"
+
+#include <algorithm>
+#include <stdio.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "include/AudioDefinitions.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        // Configuration applied last on this thread, 0 for none
+        thread_local uint64_t appliedConfiguration = 0;
+
+        std::atomic<uint64_t> lastConfiguration{0};
+
+#if defined(__x86_64__) || defined(__i386__)
+        constexpr unsigned int flushToZero = 0x8000; // MXCSR FTZ
+        constexpr unsigned int denormalsAreZero = 0x0040; // MXCSR DAZ
+#elif defined(__aarch64__) || defined(__arm__)
+        constexpr uint64_t flushToZero = 1u << 24; // FPCR/FPSCR FZ
+#endif
+
+        // Maximum frequency of a core in kHz, or 0 if unknown
+        long maximumFrequency(int32_t core) {
+            char path[96];
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", core);
+            FILE* file = fopen(path, "r");
+            if (file == nullptr) {
+                return 0;
+            }
+            long frequency = 0;
+            if (fscanf(file, "%ld", &frequency) != 1) {
+                frequency = 0;
+            }
+            fclose(file);
+            return frequency;
+        }
+    }
+
+    AudioThreadSetup::AudioThreadSetup(int32_t features, int32_t priority) {
+        configure(features, priority);
+    }
+
+    void AudioThreadSetup::configure(int32_t features, int32_t priority) {
+        _features = features;
+        _priority = priority;
+        _performanceCores.clear();
+        if ((features & AudioThreadPerformanceCores) != 0) {
+            _performanceCores = findPerformanceCores();
+        }
+        _appliedFeatures.store(0, std::memory_order_relaxed);
+        _configuration = lastConfiguration.fetch_add(1) + 1;
+    }
+
+    void AudioThreadSetup::applyToCurrentThread() {
+        if (appliedConfiguration == _configuration) {
+            return;
+        }
+        appliedConfiguration = _configuration;
+        int32_t applied = 0;
+        if ((_features & AudioThreadFlushDenormals) != 0 && flushDenormals()) {
+            applied |= AudioThreadFlushDenormals;
+        }
+        if ((_features & AudioThreadRealtimePriority) != 0 && setRealtimePriority(_priority) == ResultOk) {
+            applied |= AudioThreadRealtimePriority;
+        }
+        if ((_features & AudioThreadPerformanceCores) != 0 && setAffinity()) {
+            applied |= AudioThreadPerformanceCores;
+        }
+        _appliedFeatures.store(applied, std::memory_order_relaxed);
+    }
+
+    int32_t AudioThreadSetup::getFeatures() const {
+        return _features;
+    }
+
+    int32_t AudioThreadSetup::getAppliedFeatures() const {
+        return _appliedFeatures.load(std::memory_order_relaxed);
+    }
+
+    const std::vector<int32_t>& AudioThreadSetup::getPerformanceCores() const {
+        return _performanceCores;
+    }
+
+    bool AudioThreadSetup::flushDenormals() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_setcsr(_mm_getcsr() | flushToZero | denormalsAreZero);
+        return true;
+#elif defined(__aarch64__)
+        uint64_t fpcr;
+        asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+        asm volatile("msr fpcr, %0" : : "r"(fpcr | flushToZero));
+        return true;
+#elif defined(__arm__) && defined(__ARM_FP)
+        uint32_t fpscr;
+        asm volatile("vmrs %0, fpscr" : "=r"(fpscr));
+        asm volatile("vmsr fpscr, %0" : : "r"(fpscr | static_cast<uint32_t>(flushToZero)));
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool AudioThreadSetup::areDenormalsFlushed() {
+#if defined(__x86_64__) || defined(__i386__)
+        return (_mm_getcsr() & (flushToZero | denormalsAreZero)) == (flushToZero | denormalsAreZero);
+#elif defined(__aarch64__)
+        uint64_t fpcr;
+        asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+        return (fpcr & flushToZero) != 0;
+#elif defined(__arm__) && defined(__ARM_FP)
+        uint32_t fpscr;
+        asm volatile("vmrs %0, fpscr" : "=r"(fpscr));
+        return (fpscr & static_cast<uint32_t>(flushToZero)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    int32_t AudioThreadSetup::setRealtimePriority(int32_t priority) {
+#if defined(__linux__)
+        sched_param parameters{};
+        parameters.sched_priority = priority;
+        // Usually not permitted without CAP_SYS_NICE or an RLIMIT_RTPRIO; AAudio may have done it already
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0) {
+            return ResultOk;
+        }
+        int policy = 0;
+        if (pthread_getschedparam(pthread_self(), &policy, &parameters) == 0 && policy == SCHED_FIFO) {
+            return ResultOk;
+        }
+#endif
+        return ResultErrorInvalidState;
+    }
+
+    std::vector<int32_t> AudioThreadSetup::findPerformanceCores() {
+        std::vector<int32_t> cores;
+#if defined(__linux__)
+        const auto coreCount = static_cast<int32_t>(sysconf(_SC_NPROCESSORS_CONF));
+        std::vector<long> frequencies(static_cast<size_t>(std::max(coreCount, 0)));
+        long highest = 0;
+        long lowest = 0;
+        for (int32_t core = 0; core < coreCount; core++) {
+            frequencies[core] = maximumFrequency(core);
+            if (frequencies[core] <= 0) {
+                return cores;
+            }
+            highest = core == 0 ? frequencies[core] : std::max(highest, frequencies[core]);
+            lowest = core == 0 ? frequencies[core] : std::min(lowest, frequencies[core]);
+        }
+        if (highest == lowest) {
+            return cores;
+        }
+        // Leave out the efficiency cores, the slowest cluster; on devices with several fast clusters, a single
+        // fastest core would be too few
+        for (int32_t core = 0; core < coreCount; core++) {
+            if (frequencies[core] > lowest) {
+                cores.push_back(core);
+            }
+        }
+#endif
+        return cores;
+    }
+
+    bool AudioThreadSetup::setAffinity() const {
+#if defined(__linux__)
+        if (_performanceCores.empty()) {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int32_t core : _performanceCores) {
+            CPU_SET(core, &set);
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+}  // namespace synthesizerBase
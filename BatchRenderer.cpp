@@ -0,0 +1,177 @@
+
+#include "include/BatchRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include "include/AudioThreadSetup.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        int64_t steadyNanos() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    BatchRenderer::BatchRenderer(int32_t workerCount, int32_t framesPerDataCallback) {
+        if (workerCount <= 0) {
+            workerCount = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+        }
+        for (int32_t index = 0; index < workerCount; index++) {
+            _players.emplace_back(new OfflineAudioPlayer(nullptr, 48000, defaultAudioChannelNumber,
+                                                         std::max(1, framesPerDataCallback)));
+            _players.back()->setAudioThreadFeatures(AudioThreadFlushDenormals);
+        }
+        for (int32_t index = 0; index < workerCount; index++) {
+            _workers.emplace_back(&BatchRenderer::work, this, _players[index].get());
+        }
+    }
+
+    BatchRenderer::~BatchRenderer() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _jobAvailable.notify_all();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    int64_t BatchRenderer::submit(RenderJob job) {
+        int64_t identifier;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            identifier = static_cast<int64_t>(_results.size());
+            _results.emplace_back();
+            if (_queue.empty() && _running == 0) {
+                _busySince = steadyNanos();
+            }
+            _queue.emplace_back(identifier, std::move(job));
+        }
+        _jobAvailable.notify_one();
+        return identifier;
+    }
+
+    void BatchRenderer::wait() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _jobsFinished.wait(lock, [this] { return _queue.empty() && _running == 0; });
+    }
+
+    RenderResult BatchRenderer::takeResult(int64_t job) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        RenderResult result;
+        if (job >= 0 && job < static_cast<int64_t>(_results.size())) {
+            std::swap(result, _results[job]);
+        }
+        return result;
+    }
+
+    BatchStatistics BatchRenderer::getStatistics() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        BatchStatistics statistics = _statistics;
+        if (!_queue.empty() || _running > 0) {
+            statistics.busySeconds += static_cast<double>(steadyNanos() - _busySince) * 1e-9;
+        }
+        statistics.realtimeFactor = statistics.busySeconds > 0.0 ?
+                                    statistics.audioSeconds / statistics.busySeconds : 0.0;
+        return statistics;
+    }
+
+    int32_t BatchRenderer::getWorkerCount() const {
+        return static_cast<int32_t>(_workers.size());
+    }
+
+    void BatchRenderer::work(OfflineAudioPlayer* player) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _jobAvailable.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) {
+                return; // stopping
+            }
+            const int64_t identifier = _queue.front().first;
+            RenderJob job = std::move(_queue.front().second);
+            _queue.pop_front();
+            _running++;
+            lock.unlock();
+
+            RenderResult result = render(player, job);
+
+            lock.lock();
+            _running--;
+            _statistics.jobsCompleted++;
+            if (result.result != ResultOk) {
+                _statistics.jobsFailed++;
+            }
+            if (job.samplingRate > 0) {
+                _statistics.audioSeconds += static_cast<double>(result.framesRendered) / job.samplingRate;
+            }
+            _results[identifier] = std::move(result);
+            if (_queue.empty() && _running == 0) {
+                _statistics.busySeconds += static_cast<double>(steadyNanos() - _busySince) * 1e-9;
+                _jobsFinished.notify_all();
+            }
+        }
+    }
+
+    RenderResult BatchRenderer::render(OfflineAudioPlayer* player, RenderJob& job) {
+        RenderResult result;
+        const int64_t start = steadyNanos();
+        if (!job.createSource || job.frames <= 0 || job.samplingRate <= 0 || job.channelCount <= 0 ||
+            job.events.size() > static_cast<size_t>(AudioPlayer::eventQueueCapacity)) {
+            result.result = ResultErrorInvalidArgument;
+            return result;
+        }
+        std::unique_ptr<AudioSource> source = job.createSource();
+        std::unique_ptr<AudioSink> sink;
+        if (job.createSink) {
+            sink = job.createSink();
+            if (sink == nullptr) {
+                result.result = ResultErrorInvalidArgument;
+                return result;
+            }
+        } else if (!job.outputPath.empty()) {
+            sink.reset(new FileAudioSink(job.outputPath.c_str(), FileAudioSink::FileFormat::Wav, job.sampleFormat));
+        } else {
+            result.audio.resize(static_cast<size_t>(job.frames) * job.channelCount);
+            sink.reset(new BufferAudioSink(result.audio.data(), job.frames));
+        }
+        if (source == nullptr) {
+            result.result = ResultErrorInvalidArgument;
+            return result;
+        }
+
+        player->setFormat(job.samplingRate, job.channelCount);
+        player->setRenderLength(job.frames);
+        player->setSink(sink.get());
+        player->setAudioSource(source.get());
+        // The player counts frames over all its jobs; events are relative to the start of this one
+        player->discardEvents();
+        const int64_t origin = player->getFrameTime();
+        result.result = ResultOk;
+        for (AudioEvent event : job.events) {
+            event.frame += origin;
+            if (player->postEvent(event) != ResultOk) {
+                result.result = ResultErrorInvalidArgument;
+            }
+        }
+        if (result.result == ResultOk) {
+            result.result = player->play();
+            result.framesRendered = player->getFramesRendered();
+        }
+        player->setSink(nullptr);
+        // Adopted right away, such that the player does not keep the source deleted on return
+        while (player->collectRetiredAudioSource() != nullptr) {
+        }
+        player->setAudioSource(nullptr);
+        player->adoptAudioSource();
+        while (player->collectRetiredAudioSource() != nullptr) {
+        }
+        result.renderSeconds = static_cast<double>(steadyNanos() - start) * 1e-9;
+        return result;
+    }
+
+}  // namespace synthesizerBase
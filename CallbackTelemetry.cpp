@@ -0,0 +1,200 @@
+
+#include "include/CallbackTelemetry.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+namespace synthesizerBase {
+
+    static int64_t monotonicNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int32_t DurationHistogram::bucketIndex(int64_t nanos) {
+        int64_t micros = nanos / 1000;
+        int32_t bucket = 0;
+        while (micros > 0 && bucket < bucketCount - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    int64_t DurationHistogram::bucketUpperMicros(int32_t bucket) {
+        return static_cast<int64_t>(1) << bucket;
+    }
+
+    int64_t DurationHistogram::total() const {
+        int64_t sum = 0;
+        for (int64_t count : counts) {
+            sum += count;
+        }
+        return sum;
+    }
+
+    int64_t DurationHistogram::percentileMicros(double fraction) const {
+        const auto threshold = static_cast<int64_t>(fraction * static_cast<double>(total()));
+        int64_t sum = 0;
+        for (int32_t bucket = 0; bucket < bucketCount; bucket++) {
+            sum += counts[bucket];
+            if (sum > threshold) {
+                return bucketUpperMicros(bucket);
+            }
+        }
+        return bucketUpperMicros(bucketCount - 1);
+    }
+
+    CallbackTelemetry::CallbackTelemetry(int32_t capacity, int32_t windowCallbacks)
+            : _records(capacity), _windowCallbacks(windowCallbacks > 0 ? windowCallbacks : 1) {
+    }
+
+    void CallbackTelemetry::setSamplingRate(int samplingRate) {
+        _samplingRate = samplingRate;
+    }
+
+    void CallbackTelemetry::beginCallback() {
+        _callbackStartNanos = monotonicNanos();
+    }
+
+    void CallbackTelemetry::endCallback(int32_t framesCount) {
+        const int64_t endNanos = monotonicNanos();
+        CallbackRecord record{};
+        record.startNanos = _callbackStartNanos;
+        // Clamped: a stalled audio thread must not wrap around to a negative duration or interval
+        record.durationNanos = static_cast<int32_t>(std::min<int64_t>(endNanos - _callbackStartNanos, INT32_MAX));
+        record.intervalNanos = _previousStartNanos != 0
+                               ? static_cast<int32_t>(std::min<int64_t>(_callbackStartNanos - _previousStartNanos,
+                                                                        INT32_MAX)) : 0;
+        record.framesCount = framesCount;
+        record.xRunCount = _xRunCount;
+        _previousStartNanos = _callbackStartNanos;
+        if (!_records.push(record)) {
+            _droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void CallbackTelemetry::endPlayback() {
+        _previousStartNanos = 0;
+    }
+
+    void CallbackTelemetry::reportXRunCount(int32_t xRunCount) {
+        _xRunCount = xRunCount;
+    }
+
+    int32_t CallbackTelemetry::poll(CallbackRecord* records, int32_t maxRecords) {
+        int32_t drained = 0;
+        CallbackRecord record{};
+        while (_records.pop(record)) {
+            if (drained < maxRecords && records != nullptr) {
+                records[drained] = record;
+            }
+            accumulate(record);
+            drained++;
+        }
+        return drained;
+    }
+
+    void CallbackTelemetry::accumulate(const CallbackRecord& record) {
+        if (_windowFill >= _windowCallbacks) {
+            // Start a new window; the histograms then cover the previous and the new one
+            _currentWindow = 1 - _currentWindow;
+            _durations[_currentWindow] = DurationHistogram();
+            _intervals[_currentWindow] = DurationHistogram();
+            _windowFill = 0;
+        }
+        _windowFill++;
+
+        _durations[_currentWindow].counts[DurationHistogram::bucketIndex(record.durationNanos)]++;
+        if (record.intervalNanos > 0) {
+            _intervals[_currentWindow].counts[DurationHistogram::bucketIndex(record.intervalNanos)]++;
+        }
+
+        if (_callbackCount == 0 || record.framesCount < _minFramesCount) {
+            _minFramesCount = record.framesCount;
+        }
+        if (_callbackCount == 0 || record.framesCount > _maxFramesCount) {
+            _maxFramesCount = record.framesCount;
+        }
+        _callbackCount++;
+
+        if (record.durationNanos > _worstDurationNanos) {
+            _worstDurationNanos = record.durationNanos;
+        }
+        if (record.intervalNanos > _worstIntervalNanos) {
+            _worstIntervalNanos = record.intervalNanos;
+        }
+        if (_samplingRate > 0 && record.intervalNanos > 0) {
+            // The interval follows the previous block; its nominal length is approximated by this block's
+            const double periodNanos = 1e9 * record.framesCount / _samplingRate;
+            if (record.intervalNanos > 1.5 * periodNanos) {
+                _lateCallbackCount++;
+            }
+        }
+        _latestXRunCount = record.xRunCount;
+    }
+
+    DurationHistogram CallbackTelemetry::getDurationHistogram() const {
+        DurationHistogram histogram;
+        for (int32_t bucket = 0; bucket < DurationHistogram::bucketCount; bucket++) {
+            histogram.counts[bucket] = _durations[0].counts[bucket] + _durations[1].counts[bucket];
+        }
+        return histogram;
+    }
+
+    DurationHistogram CallbackTelemetry::getIntervalHistogram() const {
+        DurationHistogram histogram;
+        for (int32_t bucket = 0; bucket < DurationHistogram::bucketCount; bucket++) {
+            histogram.counts[bucket] = _intervals[0].counts[bucket] + _intervals[1].counts[bucket];
+        }
+        return histogram;
+    }
+
+    int64_t CallbackTelemetry::getCallbackCount() const {
+        return _callbackCount;
+    }
+
+    int64_t CallbackTelemetry::getWorstDurationNanos() const {
+        return _worstDurationNanos;
+    }
+
+    int64_t CallbackTelemetry::getWorstIntervalNanos() const {
+        return _worstIntervalNanos;
+    }
+
+    int32_t CallbackTelemetry::getXRunCount() const {
+        return _latestXRunCount;
+    }
+
+    int64_t CallbackTelemetry::getLateCallbackCount() const {
+        return _lateCallbackCount;
+    }
+
+    int32_t CallbackTelemetry::getMinFramesCount() const {
+        return _minFramesCount;
+    }
+
+    int32_t CallbackTelemetry::getMaxFramesCount() const {
+        return _maxFramesCount;
+    }
+
+    int64_t CallbackTelemetry::getDroppedRecordCount() const {
+        return _droppedRecords.load(std::memory_order_relaxed);
+    }
+
+    void CallbackTelemetry::reset() {
+        _durations[0] = DurationHistogram();
+        _durations[1] = DurationHistogram();
+        _intervals[0] = DurationHistogram();
+        _intervals[1] = DurationHistogram();
+        _windowFill = 0;
+        _callbackCount = 0;
+        _worstDurationNanos = 0;
+        _worstIntervalNanos = 0;
+        _lateCallbackCount = 0;
+        _minFramesCount = 0;
+        _maxFramesCount = 0;
+    }
+
+}  // namespace synthesizerBase
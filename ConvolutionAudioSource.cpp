@@ -0,0 +1,204 @@
+
+#include "include/ConvolutionAudioSource.h"
+
+#include <algorithm>
+#include <string.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        constexpr int32_t minimumPartitionFrames = 16;
+        constexpr int32_t maximumPartitionFrames = 8192;
+
+        int32_t partitionLength(int32_t partitionFrames) {
+            int32_t length = minimumPartitionFrames;
+            while (length < partitionFrames && length < maximumPartitionFrames) {
+                length *= 2;
+            }
+            return length;
+        }
+    }
+
+    ConvolutionAudioSource::ConvolutionAudioSource(AudioSource* source, const float* impulseResponse,
+                                                   int32_t impulseFrames, int32_t impulseChannels,
+                                                   int32_t channelCount, int32_t partitionFrames)
+            : _source(source),
+              _channelCount(std::max(1, channelCount)),
+              _impulseChannels(std::max(1, impulseChannels)),
+              _impulseFrames(std::max(1, impulseFrames)),
+              _partitionFrames(partitionLength(partitionFrames)),
+              _fft(2 * _partitionFrames) {
+        const int32_t partition = _partitionFrames;
+        _partitionCount = (_impulseFrames - 1) / partition;
+        _binCount = partition + 1;
+        _binStride = (_binCount + 15) / 16 * 16;
+        _macCount = (_binCount + 7) / 8 * 8;
+
+        _head.resize(static_cast<size_t>(_impulseChannels) * partition);
+        _filterSpectra.resize(static_cast<size_t>(_impulseChannels) * _partitionCount * 2 * _binStride);
+        _inputSpectra.resize(static_cast<size_t>(_channelCount) * _partitionCount * 2 * _binStride);
+        _input.resize(static_cast<size_t>(_channelCount) * 2 * partition);
+        _pending.resize(static_cast<size_t>(_channelCount) * partition);
+        _accumulator.resize(static_cast<size_t>(2 * _binStride));
+        _transformed.resize(static_cast<size_t>(2 * partition));
+
+        if (impulseResponse != nullptr && impulseFrames > 0) {
+            // The inverse transform is not scaled, so scale the responses by the inverse of the transform length
+            const float scale = 1.0f / static_cast<float>(2 * partition);
+            for (int32_t channel = 0; channel < _impulseChannels; channel++) {
+                const float* response = impulseResponse + static_cast<int64_t>(channel) * impulseFrames;
+                float* head = _head.data() + static_cast<int64_t>(channel) * partition;
+                for (int32_t tap = 0; tap < std::min(partition, impulseFrames); tap++) {
+                    head[partition - 1 - tap] = response[tap];
+                }
+                for (int32_t index = 0; index < _partitionCount; index++) {
+                    const int32_t first = (index + 1) * partition;
+                    const int32_t taps = std::min(partition, impulseFrames - first);
+                    memset(_transformed.data(), 0, sizeof(float) * 2 * partition);
+                    for (int32_t tap = 0; tap < taps; tap++) {
+                        _transformed[tap] = scale * response[first + tap];
+                    }
+                    float* spectrum = _filterSpectra.data() +
+                                      (static_cast<int64_t>(channel) * _partitionCount + index) * 2 * _binStride;
+                    _fft.forward(_transformed.data(), spectrum, spectrum + _binStride);
+                }
+            }
+        }
+        clear();
+    }
+
+    void ConvolutionAudioSource::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        if (static_cast<int32_t>(channelCount) != _channelCount || _source == nullptr || isIdle()) {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            // All kept input and pending output is zero; only the position in the partition matters
+            _position = (_position + framesCount) % _partitionFrames;
+            _silentFrames += framesCount;
+            _blockState = BlockState::Silent;
+            return;
+        }
+        bool silent = _source->isIdle();
+        if (silent) {
+            memset(audioData, 0, sizeof(float) * framesCount * _channelCount);
+        } else {
+            _source->onAudioReady(audioData, framesCount, channelCount);
+            silent = _source->getBlockState() == BlockState::Silent;
+        }
+
+        const int32_t partition = _partitionFrames;
+        for (int32_t offset = 0; offset < framesCount;) {
+            const int32_t frames = std::min(framesCount - offset, partition - _position);
+            for (int32_t channel = 0; channel < _channelCount; channel++) {
+                float* samples = audioData + static_cast<int64_t>(channel) * framesCount + offset;
+                float* input = _input.data() + static_cast<int64_t>(channel) * 2 * partition;
+                const float* head = _head.data() + static_cast<int64_t>(channel % _impulseChannels) * partition;
+                const float* pending = _pending.data() + static_cast<int64_t>(channel) * partition + _position;
+                memcpy(input + partition + _position, samples, sizeof(float) * frames);
+                for (int32_t frame = 0; frame < frames; frame++) {
+                    // The reversed head under the last partition frames of input, up to this one
+                    samples[frame] = simd::dotProduct(head, input + _position + frame + 1, partition) +
+                                     pending[frame];
+                }
+            }
+            _silentFrames = silent ? _silentFrames + frames : 0;
+            _position += frames;
+            offset += frames;
+            if (_position == partition) {
+                processPartition();
+                _position = 0;
+            }
+        }
+        _blockState = BlockState::Active;
+    }
+
+    void ConvolutionAudioSource::processPartition() {
+        const int32_t partition = _partitionFrames;
+        // Once the delay line only holds silence, its output is zero, as is the pending output
+        const bool flushed = _silentFrames >= static_cast<int64_t>(_partitionCount + 2) * partition;
+        if (_partitionCount > 0 && !flushed) {
+            _newestSpectrum = (_newestSpectrum + 1) % _partitionCount;
+            for (int32_t channel = 0; channel < _channelCount; channel++) {
+                const float* input = _input.data() + static_cast<int64_t>(channel) * 2 * partition;
+                float* spectra = _inputSpectra.data() +
+                                 static_cast<int64_t>(channel) * _partitionCount * 2 * _binStride;
+                const float* filters = _filterSpectra.data() +
+                                       static_cast<int64_t>(channel % _impulseChannels) * _partitionCount * 2 *
+                                       _binStride;
+                float* newest = spectra + static_cast<int64_t>(_newestSpectrum) * 2 * _binStride;
+                _fft.forward(input, newest, newest + _binStride);
+
+                // Filter partition i applies to the input spectrum of i partitions ago
+                float* real = _accumulator.data();
+                float* imaginary = real + _binStride;
+                memset(real, 0, sizeof(float) * 2 * _binStride);
+                for (int32_t index = 0; index < _partitionCount; index++) {
+                    const int32_t slot = (_newestSpectrum - index + _partitionCount) % _partitionCount;
+                    const float* filter = filters + static_cast<int64_t>(index) * 2 * _binStride;
+                    const float* spectrum = spectra + static_cast<int64_t>(slot) * 2 * _binStride;
+                    simd::complexMultiplyAccumulate(real, imaginary, filter, filter + _binStride, spectrum,
+                                                    spectrum + _binStride, _macCount);
+                }
+                _fft.inverse(real, imaginary, _transformed.data());
+                // Overlap-save: the second half holds the linear convolution
+                memcpy(_pending.data() + static_cast<int64_t>(channel) * partition, _transformed.data() + partition,
+                       sizeof(float) * partition);
+            }
+        } else {
+            memset(_pending.data(), 0, sizeof(float) * _pending.size());
+        }
+        for (int32_t channel = 0; channel < _channelCount; channel++) {
+            float* input = _input.data() + static_cast<int64_t>(channel) * 2 * partition;
+            memcpy(input, input + partition, sizeof(float) * partition);
+        }
+    }
+
+    void ConvolutionAudioSource::clear() {
+        if (_inputSpectra.size() > 0) {
+            memset(_inputSpectra.data(), 0, sizeof(float) * _inputSpectra.size());
+        }
+        memset(_input.data(), 0, sizeof(float) * _input.size());
+        memset(_pending.data(), 0, sizeof(float) * _pending.size());
+        _position = 0;
+        _newestSpectrum = 0;
+        _silentFrames = static_cast<int64_t>(_partitionCount + 2) * _partitionFrames;
+        _blockState = BlockState::Silent;
+    }
+
+    void ConvolutionAudioSource::onPlaybackStopped() {
+        if (_source != nullptr) {
+            _source->onPlaybackStopped();
+        }
+        clear();
+    }
+
+    bool ConvolutionAudioSource::isIdle() const {
+        if (_source == nullptr) {
+            return true;
+        }
+        return _source->isIdle() && _silentFrames >= static_cast<int64_t>(_partitionCount + 2) * _partitionFrames;
+    }
+
+    BlockState ConvolutionAudioSource::getBlockState() const {
+        return _blockState;
+    }
+
+    void ConvolutionAudioSource::onAudioEvent(const AudioEvent& event) {
+        if (_source != nullptr) {
+            _source->onAudioEvent(event);
+        }
+    }
+
+    int32_t ConvolutionAudioSource::getTailFrames() const {
+        return (_source != nullptr ? _source->getTailFrames() : 0) + _impulseFrames;
+    }
+
+    int32_t ConvolutionAudioSource::getPartitionFrames() const {
+        return _partitionFrames;
+    }
+
+    int32_t ConvolutionAudioSource::getPartitionCount() const {
+        return _partitionCount;
+    }
+
+}  // namespace synthesizerBase
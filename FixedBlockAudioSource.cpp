@@ -0,0 +1,85 @@
+
+#include "include/FixedBlockAudioSource.h"
+
+#include <algorithm>
+#include <string.h>
+
+
+namespace synthesizerBase {
+
+    static int32_t roundUpToPowerOfTwo(int32_t value, int32_t minimum) {
+        int32_t result = minimum;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    FixedBlockAudioSource::FixedBlockAudioSource(AudioSource* source, int32_t blockFrames, int32_t channelCount)
+            : _source(source),
+              _blockFrames(roundUpToPowerOfTwo(blockFrames, 16)),
+              _channelCount(std::max(1, channelCount)),
+              _block(static_cast<size_t>(_blockFrames) * _channelCount),
+              _readPosition(_blockFrames) {
+    }
+
+    void FixedBlockAudioSource::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        const auto channels = static_cast<int32_t>(channelCount);
+        _silentOutput = true;
+        if (channels != _channelCount) {
+            memset(audioData, 0, sizeof(float) * framesCount * channels);
+            return;
+        }
+
+        int32_t framesDone = 0;
+        while (framesDone < framesCount) {
+            if (_readPosition == _blockFrames) {
+                if (_source->isIdle()) {
+                    if (!_silentBlock) {
+                        memset(_block.data(), 0, sizeof(float) * _blockFrames * _channelCount);
+                        _silentBlock = true;
+                    }
+                } else {
+                    _source->onAudioReady(_block.data(), _blockFrames, channelCount);
+                    _silentBlock = _source->getBlockState() == BlockState::Silent;
+                }
+                _readPosition = 0;
+            }
+            _silentOutput = _silentOutput && _silentBlock;
+            const int32_t frames = std::min(_blockFrames - _readPosition, framesCount - framesDone);
+            for (int32_t channel = 0; channel < channels; channel++) {
+                memcpy(audioData + static_cast<int64_t>(channel) * framesCount + framesDone,
+                       _block.data() + static_cast<int64_t>(channel) * _blockFrames + _readPosition,
+                       sizeof(float) * frames);
+            }
+            _readPosition += frames;
+            framesDone += frames;
+        }
+    }
+
+    void FixedBlockAudioSource::onPlaybackStopped() {
+        _readPosition = _blockFrames;
+        _source->onPlaybackStopped();
+    }
+
+    int32_t FixedBlockAudioSource::getBlockFrames() const {
+        return _blockFrames;
+    }
+
+    bool FixedBlockAudioSource::isIdle() const {
+        return (_readPosition == _blockFrames || _silentBlock) && _source->isIdle();
+    }
+
+    BlockState FixedBlockAudioSource::getBlockState() const {
+        return _silentOutput ? BlockState::Silent : BlockState::Active;
+    }
+
+    void FixedBlockAudioSource::onAudioEvent(const AudioEvent& event) {
+        _source->onAudioEvent(event);
+    }
+
+    int32_t FixedBlockAudioSource::getTailFrames() const {
+        return _source->getTailFrames();
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,230 @@
+
+#include "include/MixerAudioSource.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    MixerAudioSource::MixerAudioSource(int32_t maxInputs, int32_t channelCount, int32_t chunkFrames)
+            : _maxInputs(std::max(1, maxInputs)),
+              _channelCount(std::max(1, channelCount)),
+              _chunkFrames(std::max(1, chunkFrames)),
+              _slots(new InputSlot[_maxInputs]),
+              _scratch(static_cast<size_t>(_chunkFrames) * _channelCount),
+              _renderedSlots(new int32_t[_maxInputs]) {
+    }
+
+    int32_t MixerAudioSource::attachInput(AudioSource* source, float gain, float pan) {
+        for (int32_t index = 0; index < _maxInputs; index++) {
+            InputSlot& slot = _slots[index];
+            int32_t expected = SlotFree;
+            if (slot.state.compare_exchange_strong(expected, SlotAttaching, std::memory_order_acquire)) {
+                slot.source = source;
+                slot.gain = gain;
+                slot.pan = pan;
+                updateChannelGains(slot);
+                for (float& applied : slot.appliedGains) {
+                    applied = 0.0f; // fade in
+                }
+                slot.state.store(SlotActive, std::memory_order_release);
+                return index;
+            }
+        }
+        return ResultErrorInvalidState;
+    }
+
+    void MixerAudioSource::detachInput(int32_t slot) {
+        if (slot < 0 || slot >= _maxInputs) {
+            return;
+        }
+        int32_t expected = SlotActive;
+        _slots[slot].state.compare_exchange_strong(expected, SlotDetaching, std::memory_order_acq_rel);
+    }
+
+    bool MixerAudioSource::isInputReleased(int32_t slot) {
+        if (slot < 0 || slot >= _maxInputs) {
+            return false;
+        }
+        int32_t expected = SlotReleased;
+        if (_slots[slot].state.compare_exchange_strong(expected, SlotFree, std::memory_order_acq_rel)) {
+            _slots[slot].source = nullptr;
+            return true;
+        }
+        return expected == SlotFree;
+    }
+
+    void MixerAudioSource::setInputGain(int32_t slot, float gain) {
+        if (slot >= 0 && slot < _maxInputs) {
+            _slots[slot].gain = gain;
+            updateChannelGains(_slots[slot]);
+        }
+    }
+
+    void MixerAudioSource::setInputPan(int32_t slot, float pan) {
+        if (slot >= 0 && slot < _maxInputs) {
+            _slots[slot].pan = pan;
+            updateChannelGains(_slots[slot]);
+        }
+    }
+
+    int32_t MixerAudioSource::getMaxInputs() const {
+        return _maxInputs;
+    }
+
+    void MixerAudioSource::setThreadPool(RealtimeThreadPool* pool) {
+        _threadPool = pool;
+        if (pool != nullptr && _inputScratch.size() == 0) {
+            _inputScratch.resize(static_cast<size_t>(_maxInputs) * _chunkFrames * _channelCount);
+        }
+    }
+
+    void MixerAudioSource::updateChannelGains(InputSlot& slot) {
+        if (_channelCount == 1) {
+            slot.channelGains[0].store(slot.gain, std::memory_order_relaxed);
+            return;
+        }
+        const float pan = std::min(1.0f, std::max(-1.0f, slot.pan));
+        const float angle = (pan + 1.0f) * static_cast<float>(M_PI) / 4.0f;
+        slot.channelGains[0].store(slot.gain * cosf(angle), std::memory_order_relaxed);
+        slot.channelGains[1].store(slot.gain * sinf(angle), std::memory_order_relaxed);
+        slot.channelGains[2].store(slot.gain, std::memory_order_relaxed);
+    }
+
+    void MixerAudioSource::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        const auto channels = static_cast<int32_t>(channelCount);
+        memset(audioData, 0, sizeof(float) * framesCount * channels);
+        if (channels != _channelCount) {
+            return;
+        }
+
+        _renderedCount = 0;
+        for (int32_t index = 0; index < _maxInputs; index++) {
+            InputSlot& slot = _slots[index];
+            const int32_t state = slot.state.load(std::memory_order_acquire);
+            if (state != SlotActive && state != SlotDetaching) {
+                continue;
+            }
+            beginInput(slot, state == SlotDetaching, framesCount);
+            if (!slot.source->isIdle()) {
+                _renderedSlots[_renderedCount++] = index;
+            } else if (slot.fadingOut) {
+                // Nothing to fade out
+                slot.state.store(SlotReleased, std::memory_order_release);
+            }
+        }
+        _silentBlock = true;
+
+        const bool parallel = _threadPool != nullptr && _renderedCount > 1;
+        const int64_t inputStride = static_cast<int64_t>(_chunkFrames) * _channelCount;
+        for (int32_t offset = 0; offset < framesCount; offset += _chunkFrames) {
+            const int32_t frames = std::min(_chunkFrames, framesCount - offset);
+            if (parallel) {
+                _chunkRenderFrames = frames;
+                _chunkChannelCount = channelCount;
+                _threadPool->parallelFor(&MixerAudioSource::renderInputTask, this, _renderedCount);
+                // Accumulated in slot order, as without the pool
+                for (int32_t i = 0; i < _renderedCount; i++) {
+                    const InputSlot& slot = _slots[_renderedSlots[i]];
+                    if (slot.source->getBlockState() != BlockState::Silent) {
+                        accumulateInput(slot, _inputScratch.data() + i * inputStride, audioData, framesCount, offset,
+                                        frames);
+                    }
+                }
+            } else {
+                for (int32_t i = 0; i < _renderedCount; i++) {
+                    InputSlot& slot = _slots[_renderedSlots[i]];
+                    slot.source->onAudioReady(_scratch.data(), frames, channelCount);
+                    if (slot.source->getBlockState() != BlockState::Silent) {
+                        accumulateInput(slot, _scratch.data(), audioData, framesCount, offset, frames);
+                    }
+                }
+            }
+        }
+
+        for (int32_t i = 0; i < _renderedCount; i++) {
+            InputSlot& slot = _slots[_renderedSlots[i]];
+            if (slot.fadingOut) {
+                slot.state.store(SlotReleased, std::memory_order_release);
+            }
+        }
+    }
+
+    void MixerAudioSource::onAudioEvent(const AudioEvent& event) {
+        for (int32_t index = 0; index < _maxInputs; index++) {
+            InputSlot& slot = _slots[index];
+            // Attaching slots are not published yet: their source is still being written by attachInput
+            const int32_t state = slot.state.load(std::memory_order_acquire);
+            if (state == SlotActive || state == SlotDetaching) {
+                slot.source->onAudioEvent(event);
+            }
+        }
+    }
+
+    void MixerAudioSource::beginInput(InputSlot& slot, bool fadeOut, int32_t framesCount) {
+        slot.fadingOut = fadeOut;
+        for (int32_t i = 0; i < 3; i++) {
+            const float target = fadeOut ? 0.0f : slot.channelGains[i].load(std::memory_order_relaxed);
+            slot.startGains[i] = slot.appliedGains[i];
+            slot.gainSteps[i] = (target - slot.startGains[i]) / static_cast<float>(framesCount);
+            slot.appliedGains[i] = target;
+        }
+    }
+
+    void MixerAudioSource::accumulateInput(const InputSlot& slot, const float* input, float* audioData,
+                                           int32_t framesCount, int32_t offset, int32_t frames) {
+        _silentBlock = false;
+        for (int32_t channel = 0; channel < _channelCount; channel++) {
+            const int32_t gainIndex = std::min(channel, 2);
+            float* output = audioData + static_cast<int64_t>(channel) * framesCount + offset;
+            const float* channelInput = input + static_cast<int64_t>(channel) * frames;
+            if (slot.gainSteps[gainIndex] == 0.0f) {
+                simd::mixAccumulate(output, channelInput, slot.startGains[gainIndex], frames);
+            } else {
+                const float chunkStartGain = slot.startGains[gainIndex] +
+                                             static_cast<float>(offset) * slot.gainSteps[gainIndex];
+                simd::mixAccumulateRamp(output, channelInput, chunkStartGain, slot.gainSteps[gainIndex], frames);
+            }
+        }
+    }
+
+    void MixerAudioSource::renderInputTask(void* context, int32_t index) {
+        auto* mixer = static_cast<MixerAudioSource*>(context);
+        float* scratch = mixer->_inputScratch.data() + static_cast<int64_t>(index) * mixer->_chunkFrames *
+                                                       mixer->_channelCount;
+        mixer->_slots[mixer->_renderedSlots[index]].source->onAudioReady(scratch, mixer->_chunkRenderFrames,
+                                                                          mixer->_chunkChannelCount);
+    }
+
+    bool MixerAudioSource::isIdle() const {
+        for (int32_t index = 0; index < _maxInputs; index++) {
+            const InputSlot& slot = _slots[index];
+            const int32_t state = slot.state.load(std::memory_order_acquire);
+            if (state == SlotAttaching || state == SlotDetaching || (state == SlotActive && !slot.source->isIdle())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    BlockState MixerAudioSource::getBlockState() const {
+        return _silentBlock ? BlockState::Silent : BlockState::Active;
+    }
+
+    void MixerAudioSource::onPlaybackStopped() {
+        for (int32_t index = 0; index < _maxInputs; index++) {
+            InputSlot& slot = _slots[index];
+            const int32_t state = slot.state.load(std::memory_order_acquire);
+            if (state == SlotActive || state == SlotDetaching) {
+                slot.source->onPlaybackStopped();
+            }
+            if (state == SlotDetaching) {
+                slot.state.store(SlotReleased, std::memory_order_release);
+            }
+        }
+    }
+
+}  // namespace synthesizerBase
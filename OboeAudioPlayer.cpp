@@ -1,5 +1,6 @@
 #include "include/OboeAudioPlayer.h"
 
+#include <algorithm>
 #include <utility>
 #include "include/AudioSource.h"
 #include <stdio.h>
@@ -14,9 +15,10 @@ namespace synthesizerBase {
 #endif
 
     OboeAudioPlayer::OboeAudioPlayer(synthesizerBase::AudioSource* source,
-                                     int samplingRate)
-            :  _samplingRate(samplingRate) { _source = source;
-
+                                     int samplingRate,
+                                     int32_t channelCount)
+            :  _samplingRate(samplingRate), _channelCount(channelCount) { setAudioSource(source);
+        setAudioThreadFeatures(AudioThreadFlushDenormals);
     }
 
     OboeAudioPlayer::~OboeAudioPlayer() {
@@ -30,20 +32,50 @@ namespace synthesizerBase {
         const auto result =
                 builder.setPerformanceMode(PerformanceMode::LowLatency)
                         ->setDirection(Direction::Output)
-                        ->setSampleRate(_samplingRate)
+                        ->setSampleRate(_nativeRateEnabled ? kUnspecified : _samplingRate)
                         ->setDataCallback(this)
                         ->setSharingMode(SharingMode::Exclusive)
-                        ->setFormat(AudioFormat::Float)
-                        ->setChannelCount(channelCount)
-                        ->setSampleRateConversionQuality(SampleRateConversionQuality::Best)
+                        ->setFormat(_nativeFormatEnabled ? AudioFormat::Unspecified : AudioFormat::Float)
+                        ->setChannelCount(_channelCount)
+                        ->setSampleRateConversionQuality(_nativeRateEnabled ? SampleRateConversionQuality::None :
+                                                         SampleRateConversionQuality::Best)
                         ->openStream(_stream);
                builder.setFramesPerCallback(defaultAudioFrameSize);
-               builder.setChannelCount(defaultAudioChannelNumber);
 
         if (result != Result::OK) {
             return static_cast<int32_t>(result);
         }
 
+        _converter.reset();
+        SampleFormat format = SampleFormat::Float;
+        switch (_stream->getFormat()) {
+            case AudioFormat::I16:
+                format = SampleFormat::Int16;
+                break;
+            case AudioFormat::I24:
+                format = SampleFormat::Int24Packed;
+                break;
+            case AudioFormat::I32:
+                format = SampleFormat::Int32;
+                break;
+            default:
+                break;
+        }
+        if (format != SampleFormat::Float) {
+            _converter.reset(new SampleFormatConverter(format, _stream->getChannelCount(), _dither));
+            const int32_t capacityFrames = std::max(_stream->getBufferCapacityInFrames(), defaultAudioFrameSize);
+            _floatData.resize(static_cast<size_t>(capacityFrames) * _stream->getChannelCount());
+        }
+
+        _resampler.reset();
+        if (_nativeRateEnabled && _stream->getSampleRate() != _samplingRate) {
+            _resampler.reset(new ResamplingAudioSource(&_playerSource, _samplingRate, _stream->getSampleRate(),
+                                                       _stream->getChannelCount(), _resamplerQuality));
+        }
+
+        // The player renders at the source's rate
+        configureTelemetry(_resampler ? _samplingRate : _stream->getSampleRate());
+
         const auto playResult = _stream->requestStart();
 
         return static_cast<int32_t>(playResult);
@@ -57,21 +89,66 @@ namespace synthesizerBase {
             _stream->close();
             _stream.reset();
         }
-        _source->onPlaybackStopped();
+        notifyPlaybackStopped();
     }
 
     DataCallbackResult OboeAudioPlayer::onAudioReady(oboe::AudioStream* audioStream,
                                                      void* audioData,
                                                      int32_t framesCount) {
-        auto* floatData = reinterpret_cast<float*>(audioData);
+
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        const auto xRunCount = audioStream->getXRunCount();
+        if (xRunCount) {
+            reportXRunCount(xRunCount.value());
+        }
+#endif
 
 
+        // Oboe's buffers are interleaved; the stream may have granted another channel count than requested
+        const int32_t channels = audioStream->getChannelCount();
+        if (!_converter) {
+            renderStream(reinterpret_cast<float*>(audioData), framesCount, channels);
+            return oboe::DataCallbackResult::Continue;
+        }
 
-        _source->onAudioReady(floatData,framesCount,channelCount);
+        // Integer stream: render floats, then convert into the stream's buffer
+        const auto capacityFrames = static_cast<int32_t>(_floatData.size() / channels);
+        const int32_t frameBytes = SampleFormatConverter::bytesPerSample(_converter->getFormat()) * channels;
+        for (int32_t offset = 0; offset < framesCount; offset += capacityFrames) {
+            const int32_t frames = std::min(capacityFrames, framesCount - offset);
+            renderStream(_floatData.data(), frames, channels);
+            _converter->convert(static_cast<uint8_t*>(audioData) + static_cast<int64_t>(offset) * frameBytes,
+                                _floatData.data(), frames);
+        }
 
         return oboe::DataCallbackResult::Continue;
     }
 
+    void OboeAudioPlayer::renderStream(float* audioData, int32_t framesCount, int32_t channelCount) {
+        if (_resampler) {
+            _resampler->renderInterleaved(audioData, framesCount, static_cast<ChannelCount>(channelCount));
+        } else {
+            renderAudio(audioData, framesCount, static_cast<ChannelCount>(channelCount), SampleLayout::Interleaved);
+        }
+    }
+
+    void OboeAudioPlayer::setNativeRateEnabled(bool enabled, ResamplerQuality quality) {
+        _nativeRateEnabled = enabled;
+        _resamplerQuality = quality;
+    }
+
+    void OboeAudioPlayer::setNativeFormatEnabled(bool enabled) {
+        _nativeFormatEnabled = enabled;
+    }
+
+    void OboeAudioPlayer::setDitherMode(DitherMode dither) {
+        _dither = dither;
+    }
+
+    SampleFormat OboeAudioPlayer::getSampleFormat() const {
+        return _converter ? _converter->getFormat() : SampleFormat::Float;
+    }
+
     int32_t OboeAudioPlayer::getChannelCount() {
         if (_stream)
         {
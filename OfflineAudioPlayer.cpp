@@ -0,0 +1,106 @@
+#include "include/OfflineAudioPlayer.h"
+
+#include <algorithm>
+
+
+namespace synthesizerBase {
+
+    OfflineAudioPlayer::OfflineAudioPlayer(AudioSource* source, int samplingRate,
+                                           int32_t channelCount, int32_t framesPerDataCallback)
+            : _samplingRate(samplingRate),
+              _channelCount(channelCount),
+              _framesPerDataCallback(framesPerDataCallback) {
+        setAudioSource(source);
+    }
+
+    OfflineAudioPlayer::~OfflineAudioPlayer() {
+        OfflineAudioPlayer::stop();
+    }
+
+    void OfflineAudioPlayer::setSink(AudioSink* sink) {
+        _sink = sink;
+    }
+
+    void OfflineAudioPlayer::setRenderLength(int64_t framesToRender) {
+        _framesToRender = framesToRender;
+    }
+
+    void OfflineAudioPlayer::setFormat(int samplingRate, int32_t channelCount) {
+        _samplingRate = samplingRate;
+        _channelCount = channelCount;
+    }
+
+    int32_t OfflineAudioPlayer::play() {
+        if (getAudioSource() == nullptr || _channelCount <= 0 || _framesPerDataCallback <= 0 || _samplingRate <= 0) {
+            return ResultErrorInvalidArgument;
+        }
+
+        _buffer.assign(static_cast<size_t>(_framesPerDataCallback) * _channelCount, 0.0f);
+        _framesRendered = 0;
+        configureTelemetry(0); // no real-time deadline
+
+        if (_sink != nullptr) {
+            const int32_t openResult = _sink->open(_samplingRate, _channelCount);
+            if (openResult != ResultOk) {
+                return openResult;
+            }
+        }
+
+        const auto channelCount = static_cast<ChannelCount>(_channelCount);
+        // Blocks go to the sink in the layout it stores, without a conversion in between
+        const SampleLayout layout = _sink != nullptr ? _sink->getLayout() : SampleLayout::Planar;
+        int32_t result = ResultOk;
+        int64_t framesRendered = 0;
+
+        while (!_stopRequested.load(std::memory_order_relaxed)) {
+            int32_t framesCount = _framesPerDataCallback;
+            if (_framesToRender > 0) {
+                if (framesRendered >= _framesToRender) {
+                    break;
+                }
+                framesCount = static_cast<int32_t>(
+                        std::min<int64_t>(framesCount, _framesToRender - framesRendered));
+            }
+
+            renderAudio(_buffer.data(), framesCount, channelCount, layout);
+
+            if (_sink != nullptr) {
+                result = _sink->write(_buffer.data(), framesCount, _channelCount);
+            }
+            framesRendered += framesCount;
+            _framesRendered.store(framesRendered, std::memory_order_relaxed);
+            if (result != ResultOk) {
+                break;
+            }
+        }
+
+        // Cleared only once the render is over, such that a stop() issued before or during play() is not lost
+        _stopRequested = false;
+        if (_sink != nullptr) {
+            _sink->close();
+        }
+        notifyPlaybackStopped();
+        return result;
+    }
+
+    void OfflineAudioPlayer::stop() {
+        _stopRequested = true;
+    }
+
+    int32_t OfflineAudioPlayer::getChannelCount() {
+        return _channelCount;
+    }
+
+    int32_t OfflineAudioPlayer::getFramesPerDataCallback() {
+        return _framesPerDataCallback;
+    }
+
+    int64_t OfflineAudioPlayer::getFramesRendered() const {
+        return _framesRendered.load(std::memory_order_relaxed);
+    }
+
+    int OfflineAudioPlayer::getSamplingRate() const {
+        return _samplingRate;
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,194 @@
+
+#include "include/ParameterBank.h"
+
+#include <algorithm>
+#include <math.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        // A one-pole ramp ends when it is this close to its target, relative to the change that started it
+        constexpr float onePoleSettledFraction = 1e-4f;
+    }
+
+    ParameterBank::ParameterBank(int32_t parameterCount, int samplingRate, int32_t maxBlockFrames)
+            : _parameterCount(std::max(1, parameterCount)),
+              _samplingRate(samplingRate),
+              _maxBlockFrames(std::max(1, maxBlockFrames)),
+              _rowStride((_maxBlockFrames + 15) / 16 * 16),
+              _values(static_cast<size_t>(_parameterCount)),
+              _targets(static_cast<size_t>(_parameterCount)),
+              _steps(static_cast<size_t>(_parameterCount)),
+              _remainingFrames(static_cast<size_t>(_parameterCount)),
+              _shapes(static_cast<size_t>(_parameterCount)),
+              _rampShapes(static_cast<size_t>(_parameterCount)),
+              _rampFrames(static_cast<size_t>(_parameterCount)),
+              _settledDistances(static_cast<size_t>(_parameterCount)),
+              _rampBlocks(static_cast<size_t>(_parameterCount)),
+              _rampingPositions(static_cast<size_t>(_parameterCount)),
+              _ramping(static_cast<size_t>(_parameterCount)),
+              _rampingCount(0),
+              _ramps(static_cast<size_t>(_parameterCount) * _rowStride),
+              _blockCount(0),
+              _blockFrames(0) {
+        for (int32_t parameter = 0; parameter < _parameterCount; parameter++) {
+            _shapes[parameter] = static_cast<uint8_t>(RampShape::Linear);
+            _rampFrames[parameter] = 0.01f * static_cast<float>(_samplingRate);
+            _rampBlocks[parameter] = -1;
+            _rampingPositions[parameter] = -1;
+        }
+    }
+
+    void ParameterBank::setRamp(int32_t parameter, RampShape shape, float rampMillis) {
+        if (parameter < 0 || parameter >= _parameterCount) {
+            return;
+        }
+        _shapes[parameter] = static_cast<uint8_t>(shape);
+        _rampFrames[parameter] = std::max(0.0f, rampMillis) * 0.001f * static_cast<float>(_samplingRate);
+    }
+
+    void ParameterBank::setTarget(int32_t parameter, float target) {
+        if (parameter < 0 || parameter >= _parameterCount) {
+            return;
+        }
+        _targets[parameter] = target;
+        const float current = _values[parameter];
+        const float rampFrames = _rampFrames[parameter];
+        if (target == current || rampFrames < 1.0f) {
+            setValue(parameter, target);
+            return;
+        }
+
+        auto shape = static_cast<RampShape>(_shapes[parameter]);
+        if (shape == RampShape::Exponential && !(current * target > 0.0f)) {
+            shape = RampShape::Linear;
+        }
+        const auto frames = std::max(1, static_cast<int32_t>(lroundf(rampFrames)));
+        switch (shape) {
+            case RampShape::Linear:
+                _steps[parameter] = (target - current) / static_cast<float>(frames);
+                break;
+            case RampShape::Exponential:
+                _steps[parameter] = static_cast<float>(pow(static_cast<double>(target) / current, 1.0 / frames));
+                break;
+            case RampShape::OnePole:
+                _steps[parameter] = static_cast<float>(exp(-1.0 / rampFrames));
+                break;
+        }
+        _remainingFrames[parameter] = frames;
+        _settledDistances[parameter] = onePoleSettledFraction * fabsf(target - current);
+        _rampShapes[parameter] = static_cast<uint8_t>(shape);
+        startRamping(parameter);
+    }
+
+    void ParameterBank::setValue(int32_t parameter, float value) {
+        if (parameter < 0 || parameter >= _parameterCount) {
+            return;
+        }
+        _values[parameter] = value;
+        _targets[parameter] = value;
+        stopRamping(parameter);
+    }
+
+    bool ParameterBank::handleEvent(const AudioEvent& event) {
+        if (event.type != AudioEventParameter || event.index < 0 || event.index >= _parameterCount) {
+            return false;
+        }
+        setTarget(event.index, event.value);
+        return true;
+    }
+
+    int32_t ParameterBank::advance(int32_t framesCount) {
+        if (framesCount > _maxBlockFrames) {
+            return ResultErrorInvalidArgument;
+        }
+        _blockCount++;
+        _blockFrames = std::max(0, framesCount);
+        if (framesCount <= 0) {
+            return ResultOk;
+        }
+        // From the end, as stopRamping moves the last ramping parameter into the freed position
+        for (int32_t i = _rampingCount - 1; i >= 0; i--) {
+            const int32_t parameter = _ramping[i];
+            float* ramp = _ramps.data() + static_cast<int64_t>(parameter) * _rowStride;
+            const float current = _values[parameter];
+            const float target = _targets[parameter];
+            const float step = _steps[parameter];
+            const auto shape = static_cast<RampShape>(_rampShapes[parameter]);
+            _rampBlocks[parameter] = _blockCount;
+
+            if (shape == RampShape::OnePole) {
+                // target + (current - target) * step^(i+1)
+                simd::exponentialRamp(ramp, target, (current - target) * step, step, framesCount);
+                const float last = ramp[framesCount - 1];
+                if (fabsf(last - target) <= _settledDistances[parameter]) {
+                    _values[parameter] = target;
+                    stopRamping(parameter);
+                } else {
+                    _values[parameter] = last;
+                }
+                continue;
+            }
+
+            const int32_t frames = std::min(framesCount, _remainingFrames[parameter]);
+            if (shape == RampShape::Linear) {
+                simd::linearRamp(ramp, current + step, step, frames);
+            } else {
+                simd::exponentialRamp(ramp, 0.0f, current * step, step, frames);
+            }
+            _remainingFrames[parameter] -= frames;
+            if (_remainingFrames[parameter] == 0) {
+                // Exactly on target at the end of the ramp, then constant
+                ramp[frames - 1] = target;
+                simd::linearRamp(ramp + frames, target, 0.0f, framesCount - frames);
+                _values[parameter] = target;
+                stopRamping(parameter);
+            } else {
+                _values[parameter] = ramp[frames - 1];
+            }
+        }
+        return ResultOk;
+    }
+
+    const float* ParameterBank::getRamp(int32_t parameter) const {
+        if (isSteady(parameter)) {
+            return nullptr;
+        }
+        return _ramps.data() + static_cast<int64_t>(parameter) * _rowStride;
+    }
+
+    int32_t ParameterBank::apply(int32_t parameter, float* samples, int32_t count) const {
+        const float* ramp = getRamp(parameter);
+        if (ramp != nullptr) {
+            if (count > _blockFrames) {
+                return ResultErrorInvalidArgument;
+            }
+            simd::multiply(samples, ramp, count);
+        } else if (_values[parameter] != 1.0f) {
+            simd::scale(samples, _values[parameter], count);
+        }
+        return ResultOk;
+    }
+
+    void ParameterBank::startRamping(int32_t parameter) {
+        if (_rampingPositions[parameter] >= 0) {
+            return;
+        }
+        _rampingPositions[parameter] = _rampingCount;
+        _ramping[_rampingCount++] = parameter;
+    }
+
+    void ParameterBank::stopRamping(int32_t parameter) {
+        const int32_t position = _rampingPositions[parameter];
+        if (position < 0) {
+            return;
+        }
+        const int32_t last = _ramping[--_rampingCount];
+        _ramping[position] = last;
+        _rampingPositions[last] = position;
+        _rampingPositions[parameter] = -1;
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,141 @@
+
+#include "include/RealFft.h"
+
+#include <math.h>
+
+
+namespace synthesizerBase {
+
+    RealFft::RealFft(int32_t size) {
+        _size = 4;
+        while (_size < size) {
+            _size *= 2;
+        }
+        _half = _size / 2;
+        _bitReversal.resize(static_cast<size_t>(_half));
+        int32_t bits = 0;
+        while ((1 << bits) < _half) {
+            bits++;
+        }
+        for (int32_t index = 0; index < _half; index++) {
+            int32_t reversed = 0;
+            for (int32_t bit = 0; bit < bits; bit++) {
+                reversed |= ((index >> bit) & 1) << (bits - 1 - bit);
+            }
+            _bitReversal[index] = reversed;
+        }
+        // Stage with butterflies of span h: exp(-i*pi*k/h) for k < h
+        _stageTwiddles.resize(static_cast<size_t>(2 * (_half - 1)));
+        int32_t offset = 0;
+        for (int32_t span = 1; span < _half; span *= 2) {
+            for (int32_t k = 0; k < span; k++) {
+                const double angle = -M_PI * k / span;
+                _stageTwiddles[offset + k] = static_cast<float>(cos(angle));
+                _stageTwiddles[_half - 1 + offset + k] = static_cast<float>(sin(angle));
+            }
+            offset += span;
+        }
+        _splitTwiddles.resize(static_cast<size_t>(2 * (_half / 2 + 1)));
+        for (int32_t k = 0; k <= _half / 2; k++) {
+            const double angle = 2.0 * M_PI * k / _size;
+            _splitTwiddles[k] = static_cast<float>(cos(angle));
+            _splitTwiddles[_half / 2 + 1 + k] = static_cast<float>(sin(angle));
+        }
+        _work.resize(static_cast<size_t>(_size));
+    }
+
+    int32_t RealFft::getSize() const {
+        return _size;
+    }
+
+    int32_t RealFft::getBinCount() const {
+        return _half + 1;
+    }
+
+    void RealFft::forward(const float* input, float* real, float* imaginary) {
+        float* workReal = _work.data();
+        float* workImaginary = workReal + _half;
+        // Even samples as real parts, odd samples as imaginary parts
+        for (int32_t index = 0; index < _half; index++) {
+            workReal[_bitReversal[index]] = input[2 * index];
+            workImaginary[_bitReversal[index]] = input[2 * index + 1];
+        }
+        transform(workReal, workImaginary);
+
+        // Spectra of the even (e) and odd (o) samples from bins k and half - k, combined as e + W^k o
+        const float* cosines = _splitTwiddles.data();
+        const float* sines = cosines + _half / 2 + 1;
+        for (int32_t k = 0; k <= _half / 2; k++) {
+            const int32_t mirror = k == 0 ? 0 : _half - k;
+            const float evenReal = 0.5f * (workReal[k] + workReal[mirror]);
+            const float evenImaginary = 0.5f * (workImaginary[k] - workImaginary[mirror]);
+            const float oddReal = 0.5f * (workImaginary[k] + workImaginary[mirror]);
+            const float oddImaginary = -0.5f * (workReal[k] - workReal[mirror]);
+            const float twiddledReal = cosines[k] * oddReal + sines[k] * oddImaginary;
+            const float twiddledImaginary = cosines[k] * oddImaginary - sines[k] * oddReal;
+            real[k] = evenReal + twiddledReal;
+            imaginary[k] = evenImaginary + twiddledImaginary;
+            real[_half - k] = evenReal - twiddledReal;
+            imaginary[_half - k] = twiddledImaginary - evenImaginary;
+        }
+        imaginary[0] = 0.0f;
+        imaginary[_half] = 0.0f;
+    }
+
+    void RealFft::inverse(const float* real, const float* imaginary, float* output) {
+        float* workReal = _work.data();
+        float* workImaginary = workReal + _half;
+        const float* cosines = _splitTwiddles.data();
+        const float* sines = cosines + _half / 2 + 1;
+        // Complex spectrum of the half length, conjugated by swapping real and imaginary parts, such that the
+        // forward transform computes the inverse one
+        for (int32_t k = 0; k <= _half / 2; k++) {
+            const int32_t mirror = _half - k;
+            const float imaginaryAt = k == 0 ? 0.0f : imaginary[k];
+            const float imaginaryMirror = k == 0 ? 0.0f : imaginary[mirror];
+            const float evenReal = real[k] + real[mirror];
+            const float evenImaginary = imaginaryAt - imaginaryMirror;
+            const float differenceReal = real[k] - real[mirror];
+            const float differenceImaginary = imaginaryAt + imaginaryMirror;
+            const float oddReal = differenceReal * cosines[k] - differenceImaginary * sines[k];
+            const float oddImaginary = differenceReal * sines[k] + differenceImaginary * cosines[k];
+            workImaginary[_bitReversal[k]] = evenReal - oddImaginary;
+            workReal[_bitReversal[k]] = evenImaginary + oddReal;
+            if (k > 0 && k < mirror) {
+                workImaginary[_bitReversal[mirror]] = evenReal + oddImaginary;
+                workReal[_bitReversal[mirror]] = oddReal - evenImaginary;
+            }
+        }
+        transform(workReal, workImaginary);
+        for (int32_t index = 0; index < _half; index++) {
+            output[2 * index] = workImaginary[index];
+            output[2 * index + 1] = workReal[index];
+        }
+    }
+
+    void RealFft::transform(float* real, float* imaginary) const {
+        const float* twiddles = _stageTwiddles.data();
+        int32_t offset = 0;
+        for (int32_t span = 1; span < _half; span *= 2) {
+            const float* twiddleReal = twiddles + offset;
+            const float* twiddleImaginary = twiddles + _half - 1 + offset;
+            for (int32_t start = 0; start < _half; start += 2 * span) {
+                float* lowReal = real + start;
+                float* lowImaginary = imaginary + start;
+                float* highReal = lowReal + span;
+                float* highImaginary = lowImaginary + span;
+                for (int32_t k = 0; k < span; k++) {
+                    const float productReal = highReal[k] * twiddleReal[k] - highImaginary[k] * twiddleImaginary[k];
+                    const float productImaginary = highReal[k] * twiddleImaginary[k] +
+                                                   highImaginary[k] * twiddleReal[k];
+                    highReal[k] = lowReal[k] - productReal;
+                    highImaginary[k] = lowImaginary[k] - productImaginary;
+                    lowReal[k] += productReal;
+                    lowImaginary[k] += productImaginary;
+                }
+            }
+            offset += span;
+        }
+    }
+
+}  // namespace synthesizerBase
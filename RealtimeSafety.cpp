@@ -0,0 +1,330 @@
+
+// The interposed functions are defined here; fortified headers would declare some of them as inline wrappers
+#undef _FORTIFY_SOURCE
+#include "include/RealtimeSafety.h"
+
+#include <atomic>
+#include <stdlib.h>
+#if defined(SYNTHESIZERBASE_REALTIME_CHECKS) && defined(__GLIBC__)
+#define SYNTHESIZERBASE_INTERPOSE
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+
+namespace synthesizerBase {
+
+    namespace {
+        constexpr int32_t backtraceDepth = 32;
+
+        std::atomic<int32_t> checkMode{static_cast<int32_t>(RealtimeCheckMode::Report)};
+        std::atomic<int32_t> reportLimit{RealtimeSafety::defaultReportLimit};
+        std::atomic<int32_t> reportCount{0};
+        std::atomic<int64_t> violationCount{0};
+        std::atomic<RealtimeViolationHandler> violationHandler{nullptr};
+        std::atomic<void*> violationContext{nullptr};
+
+        // Read by the allocation functions: initial-exec, such that no access calls into the dynamic linker
+        thread_local int32_t realtimeDepth __attribute__((tls_model("initial-exec"))) = 0;
+        thread_local int32_t suspendDepth __attribute__((tls_model("initial-exec"))) = 0;
+
+#ifdef SYNTHESIZERBASE_INTERPOSE
+        const char* typeName(RealtimeViolationType type) {
+            switch (type) {
+                case RealtimeViolationType::Allocation:
+                    return "allocation";
+                case RealtimeViolationType::Deallocation:
+                    return "deallocation";
+                case RealtimeViolationType::Lock:
+                    return "lock";
+                case RealtimeViolationType::BlockingCall:
+                default:
+                    return "blocking call";
+            }
+        }
+
+        void writeMessage(const char* message) {
+            const ssize_t written = write(STDERR_FILENO, message, strlen(message));
+            (void) written;
+        }
+
+        void reportViolation(RealtimeViolationType type, const char* function) {
+            // Reporting allocates and writes: not checked
+            suspendDepth++;
+            violationCount.fetch_add(1, std::memory_order_relaxed);
+            const RealtimeViolationHandler handler = violationHandler.load(std::memory_order_acquire);
+            if (handler != nullptr) {
+                handler(RealtimeViolation{type, function}, violationContext.load(std::memory_order_relaxed));
+            }
+            const auto mode = static_cast<RealtimeCheckMode>(checkMode.load(std::memory_order_relaxed));
+            const int32_t report = reportCount.fetch_add(1, std::memory_order_relaxed);
+            const int32_t limit = reportLimit.load(std::memory_order_relaxed);
+            if (mode == RealtimeCheckMode::Abort || report < limit) {
+                char message[128];
+                snprintf(message, sizeof(message), "SynthesizerBase: %s %s() in a real-time scope\n",
+                         typeName(type), function);
+                writeMessage(message);
+                void* frames[backtraceDepth];
+                backtrace_symbols_fd(frames, backtrace(frames, backtraceDepth), STDERR_FILENO);
+            } else if (report == limit) {
+                writeMessage("SynthesizerBase: report limit reached, further real-time violations are only counted\n");
+            }
+            if (mode == RealtimeCheckMode::Abort) {
+                abort();
+            }
+            suspendDepth--;
+        }
+
+        inline void checkCall(RealtimeViolationType type, const char* function) {
+            if (realtimeDepth > 0 && suspendDepth == 0 &&
+                checkMode.load(std::memory_order_relaxed) != static_cast<int32_t>(RealtimeCheckMode::Off)) {
+                reportViolation(type, function);
+            }
+        }
+
+        /**
+         * The function an interposed function stands in front of, looked up on first use
+         */
+        void* resolveNext(std::atomic<void*>& next, const char* name) {
+            void* function = next.load(std::memory_order_relaxed);
+            if (function == nullptr) {
+                function = dlsym(RTLD_NEXT, name);
+                next.store(function, std::memory_order_relaxed);
+            }
+            return function;
+        }
+
+        __attribute__((constructor)) void initializeChecks() {
+            const char* mode = getenv("SYNTHESIZERBASE_REALTIME_CHECKS");
+            if (mode != nullptr && strcmp(mode, "off") == 0) {
+                checkMode = static_cast<int32_t>(RealtimeCheckMode::Off);
+            } else if (mode != nullptr && strcmp(mode, "abort") == 0) {
+                checkMode = static_cast<int32_t>(RealtimeCheckMode::Abort);
+            }
+            // The first backtrace loads the unwinder; rather now than at the first report
+            void* frames[1];
+            backtrace(frames, 1);
+        }
+#endif
+    }
+
+    bool RealtimeSafety::isAvailable() {
+#ifdef SYNTHESIZERBASE_INTERPOSE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void RealtimeSafety::setMode(RealtimeCheckMode mode) {
+        checkMode.store(static_cast<int32_t>(mode), std::memory_order_relaxed);
+    }
+
+    RealtimeCheckMode RealtimeSafety::getMode() {
+        return static_cast<RealtimeCheckMode>(checkMode.load(std::memory_order_relaxed));
+    }
+
+    void RealtimeSafety::setReportLimit(int32_t reports) {
+        reportLimit.store(reports, std::memory_order_relaxed);
+        reportCount.store(0, std::memory_order_relaxed);
+    }
+
+    void RealtimeSafety::setViolationHandler(RealtimeViolationHandler handler, void* context) {
+        violationContext.store(context, std::memory_order_relaxed);
+        violationHandler.store(handler, std::memory_order_release);
+    }
+
+    int64_t RealtimeSafety::getViolationCount() {
+        return violationCount.load(std::memory_order_relaxed);
+    }
+
+    void RealtimeSafety::resetViolationCount() {
+        violationCount.store(0, std::memory_order_relaxed);
+    }
+
+    bool RealtimeSafety::isChecking() {
+        return isAvailable() && realtimeDepth > 0 && suspendDepth == 0;
+    }
+
+    void RealtimeSafety::enterRealtimeScope() {
+        realtimeDepth++;
+    }
+
+    void RealtimeSafety::leaveRealtimeScope() {
+        realtimeDepth--;
+    }
+
+    void RealtimeSafety::suspendChecks() {
+        suspendDepth++;
+    }
+
+    void RealtimeSafety::resumeChecks() {
+        suspendDepth--;
+    }
+
+}  // namespace synthesizerBase
+
+#ifdef SYNTHESIZERBASE_INTERPOSE
+
+// ---------------------------------------------------------------- interposed functions
+
+// glibc's own allocator entry points: looking up the next malloc with dlsym would allocate
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+using synthesizerBase::RealtimeViolationType;
+
+/**
+ * Interposed function with fixed arguments, forwarding to the next definition (normally glibc's)
+ */
+#define SYNTHESIZERBASE_CHECKED(type, returnType, name, parameters, arguments, specifier) \
+    extern "C" returnType name parameters specifier { \
+        synthesizerBase::checkCall(RealtimeViolationType::type, #name); \
+        static std::atomic<void*> next{nullptr}; \
+        return reinterpret_cast<returnType (*) parameters>(synthesizerBase::resolveNext(next, #name)) arguments; \
+    }
+
+extern "C" void* malloc(size_t size) noexcept {
+    synthesizerBase::checkCall(RealtimeViolationType::Allocation, "malloc");
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) noexcept {
+    synthesizerBase::checkCall(RealtimeViolationType::Allocation, "calloc");
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) noexcept {
+    synthesizerBase::checkCall(RealtimeViolationType::Allocation, "realloc");
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void free(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        synthesizerBase::checkCall(RealtimeViolationType::Deallocation, "free");
+    }
+    __libc_free(pointer);
+}
+
+extern "C" int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    synthesizerBase::checkCall(RealtimeViolationType::Allocation, "posix_memalign");
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* memory = __libc_memalign(alignment, size);
+    if (memory == nullptr) {
+        return ENOMEM;
+    }
+    *pointer = memory;
+    return 0;
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    synthesizerBase::checkCall(RealtimeViolationType::Allocation, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) noexcept {
+    synthesizerBase::checkCall(RealtimeViolationType::Allocation, "memalign");
+    return __libc_memalign(alignment, size);
+}
+
+SYNTHESIZERBASE_CHECKED(Lock, int, pthread_mutex_lock, (pthread_mutex_t* mutex), (mutex), noexcept)
+SYNTHESIZERBASE_CHECKED(Lock, int, pthread_rwlock_rdlock, (pthread_rwlock_t* lock), (lock), noexcept)
+SYNTHESIZERBASE_CHECKED(Lock, int, pthread_rwlock_wrlock, (pthread_rwlock_t* lock), (lock), noexcept)
+SYNTHESIZERBASE_CHECKED(Lock, int, pthread_cond_wait, (pthread_cond_t* condition, pthread_mutex_t* mutex),
+                        (condition, mutex), )
+SYNTHESIZERBASE_CHECKED(Lock, int, pthread_cond_timedwait,
+                        (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time),
+                        (condition, mutex, time), )
+SYNTHESIZERBASE_CHECKED(Lock, int, sem_wait, (sem_t* semaphore), (semaphore), )
+SYNTHESIZERBASE_CHECKED(Lock, int, sem_timedwait, (sem_t* semaphore, const struct timespec* time),
+                        (semaphore, time), )
+SYNTHESIZERBASE_CHECKED(Lock, int, pthread_join, (pthread_t thread, void** value), (thread, value), )
+
+SYNTHESIZERBASE_CHECKED(BlockingCall, ssize_t, read, (int file, void* buffer, size_t bytes), (file, buffer, bytes), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, ssize_t, write, (int file, const void* buffer, size_t bytes),
+                        (file, buffer, bytes), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, ssize_t, pread, (int file, void* buffer, size_t bytes, off_t offset),
+                        (file, buffer, bytes, offset), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, ssize_t, pwrite, (int file, const void* buffer, size_t bytes, off_t offset),
+                        (file, buffer, bytes, offset), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, close, (int file), (file), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, fsync, (int file), (file), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, fdatasync, (int file), (file), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, nanosleep, (const struct timespec* duration, struct timespec* remaining),
+                        (duration, remaining), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, clock_nanosleep,
+                        (clockid_t clock, int flags, const struct timespec* time, struct timespec* remaining),
+                        (clock, flags, time, remaining), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, usleep, (useconds_t microseconds), (microseconds), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, unsigned int, sleep, (unsigned int seconds), (seconds), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, poll, (struct pollfd* files, nfds_t count, int timeout),
+                        (files, count, timeout), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, select,
+                        (int count, fd_set* reading, fd_set* writing, fd_set* exceptions, struct timeval* timeout),
+                        (count, reading, writing, exceptions, timeout), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, void*, mmap,
+                        (void* address, size_t bytes, int protection, int flags, int file, off_t offset),
+                        (address, bytes, protection, flags, file, offset), noexcept)
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, munmap, (void* address, size_t bytes), (address, bytes), noexcept)
+SYNTHESIZERBASE_CHECKED(BlockingCall, FILE*, fopen, (const char* path, const char* mode), (path, mode), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, fclose, (FILE* stream), (stream), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, size_t, fread, (void* buffer, size_t size, size_t count, FILE* stream),
+                        (buffer, size, count, stream), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, size_t, fwrite, (const void* buffer, size_t size, size_t count, FILE* stream),
+                        (buffer, size, count, stream), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, fflush, (FILE* stream), (stream), )
+SYNTHESIZERBASE_CHECKED(BlockingCall, int, puts, (const char* text), (text), )
+
+extern "C" int open(const char* path, int flags, ...) {
+    synthesizerBase::checkCall(RealtimeViolationType::BlockingCall, "open");
+    mode_t mode = 0;
+    if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE) {
+        va_list arguments;
+        va_start(arguments, flags);
+        mode = static_cast<mode_t>(va_arg(arguments, int));
+        va_end(arguments);
+    }
+    static std::atomic<void*> next{nullptr};
+    return reinterpret_cast<int (*)(const char*, int, ...)>(synthesizerBase::resolveNext(next, "open"))(path, flags,
+                                                                                                     mode);
+}
+
+extern "C" int printf(const char* format, ...) {
+    synthesizerBase::checkCall(RealtimeViolationType::BlockingCall, "printf");
+    va_list arguments;
+    va_start(arguments, format);
+    const int result = vprintf(format, arguments);
+    va_end(arguments);
+    return result;
+}
+
+extern "C" int fprintf(FILE* stream, const char* format, ...) {
+    synthesizerBase::checkCall(RealtimeViolationType::BlockingCall, "fprintf");
+    va_list arguments;
+    va_start(arguments, format);
+    const int result = vfprintf(stream, format, arguments);
+    va_end(arguments);
+    return result;
+}
+
+#endif
@@ -0,0 +1,257 @@
+
+#include "include/RealtimeThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "include/RealtimeSafety.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        int64_t monotonicNanos() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Tell the core it is in a spin loop: saves power and frees resources for a hyperthread sibling
+        inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+        // Sleep while the word still has the given value; may return early
+        void waitWhileEqual(std::atomic<uint32_t>& word, uint32_t value) {
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+            if (word.load(std::memory_order_acquire) == value) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+#endif
+        }
+
+        void wakeAll(std::atomic<uint32_t>& word) {
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+            (void) word; // sleeping workers poll the word
+#endif
+        }
+    }
+
+    RealtimeThreadPool::RealtimeThreadPool(int32_t workerCount, int samplingRate, float deadlineFraction,
+                                           int32_t spinMicros)
+            : _workerCount(std::max(0, workerCount)),
+              _samplingRate(samplingRate),
+              _deadlineFraction(deadlineFraction),
+              _spinNanos(static_cast<int64_t>(std::max(0, spinMicros)) * 1000),
+              _ranges(new TaskRange[_workerCount + 1]) {
+        _workers.reserve(static_cast<size_t>(_workerCount));
+        for (int32_t participant = 1; participant <= _workerCount; participant++) {
+            _workers.emplace_back(&RealtimeThreadPool::runWorker, this, participant);
+        }
+    }
+
+    RealtimeThreadPool::~RealtimeThreadPool() {
+        _running.store(false, std::memory_order_release);
+        wakeWorkers();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    void RealtimeThreadPool::beginBlock(int32_t framesCount) {
+        const int64_t now = monotonicNanos();
+        // During the fallback, let the workers fall asleep
+        if (now >= _fallbackEndNanos.load(std::memory_order_relaxed)) {
+            wakeWorkers();
+        }
+        _deadlineNanos = 0;
+        if (_samplingRate > 0) {
+            _blockNanos = static_cast<int64_t>(1e9 * framesCount / _samplingRate);
+            _deadlineNanos = now + static_cast<int64_t>(_deadlineFraction * _blockNanos);
+        }
+    }
+
+    bool RealtimeThreadPool::parallelFor(Task task, void* context, int32_t count) {
+        bool idle = false;
+        if (_workerCount == 0 || count <= 1 || isFallbackActive() ||
+            !_busy.compare_exchange_strong(idle, true, std::memory_order_acquire)) {
+            for (int32_t index = 0; index < count; index++) {
+                task(context, index);
+            }
+            return false;
+        }
+
+        const int32_t participants = _workerCount + 1;
+        for (int32_t participant = 0; participant < participants; participant++) {
+            _ranges[participant].next.store(static_cast<int32_t>(static_cast<int64_t>(count) * participant /
+                                                                 participants), std::memory_order_relaxed);
+            _ranges[participant].end = static_cast<int32_t>(static_cast<int64_t>(count) * (participant + 1) /
+                                                            participants);
+        }
+        _task = task;
+        _context = context;
+        _remaining.store(count, std::memory_order_relaxed);
+        _generation++;
+        _batch.store((_generation << 1) | 1u); // publishes the batch
+        wakeWorkers();
+
+        const int32_t executed = runBatch(0);
+        bool late = false;
+        // Join: the remaining tasks were all claimed by workers, which are running them
+        waitForZero(_remaining, late);
+        // Close the batch, and wait for workers still looking for tasks before the ranges can be reused
+        _batch.store(_generation << 1);
+        waitForZero(_activeWorkers, late);
+        _busy.store(false, std::memory_order_release);
+
+        if (!late && _deadlineNanos > 0) {
+            const int64_t now = monotonicNanos();
+            if (now > _deadlineNanos) {
+                missDeadline(now);
+            }
+        }
+        const bool parallel = executed < count;
+        if (parallel) {
+            _parallelBatchCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return parallel;
+    }
+
+    void RealtimeThreadPool::setThreadSetup(AudioThreadSetup* setup) {
+        _threadSetup.store(setup, std::memory_order_release);
+    }
+
+    int32_t RealtimeThreadPool::getWorkerCount() const {
+        return _workerCount;
+    }
+
+    bool RealtimeThreadPool::isFallbackActive() const {
+        return monotonicNanos() < _fallbackEndNanos.load(std::memory_order_relaxed);
+    }
+
+    int64_t RealtimeThreadPool::getMissedDeadlineCount() const {
+        return _missedDeadlineCount.load(std::memory_order_relaxed);
+    }
+
+    int64_t RealtimeThreadPool::getParallelBatchCount() const {
+        return _parallelBatchCount.load(std::memory_order_relaxed);
+    }
+
+    void RealtimeThreadPool::waitForZero(const std::atomic<int32_t>& counter, bool& late) {
+        while (counter.load(std::memory_order_acquire) > 0) {
+            if (late) {
+                // The tasks claimed by workers can only be completed by them: let a preempted worker run
+                std::this_thread::yield();
+                continue;
+            }
+            cpuRelax();
+            if (_deadlineNanos > 0) {
+                const int64_t now = monotonicNanos();
+                if (now > _deadlineNanos) {
+                    // Fall back at once, such that the next batches of this block already run inline
+                    late = true;
+                    missDeadline(now);
+                }
+            }
+        }
+    }
+
+    void RealtimeThreadPool::missDeadline(int64_t now) {
+        _missedDeadlineCount.fetch_add(1, std::memory_order_relaxed);
+        _fallbackEndNanos.store(now + fallbackBlocks * _blockNanos, std::memory_order_relaxed);
+    }
+
+    int32_t RealtimeThreadPool::runBatch(int32_t participant) {
+        const int32_t participants = _workerCount + 1;
+        int32_t executed = 0;
+        for (int32_t i = 0; i < participants; i++) {
+            // Own range first, then steal from the following ones
+            TaskRange& range = _ranges[(participant + i) % participants];
+            const int32_t end = range.end;
+            for (int32_t index = range.next.fetch_add(1, std::memory_order_relaxed); index < end;
+                 index = range.next.fetch_add(1, std::memory_order_relaxed)) {
+                _task(_context, index);
+                executed++;
+            }
+        }
+        if (executed > 0) {
+            _remaining.fetch_sub(executed, std::memory_order_acq_rel);
+        }
+        return executed;
+    }
+
+    void RealtimeThreadPool::runWorker(int32_t participant) {
+        uint32_t seenBatch = 0;
+        uint32_t seenWake = _wakeSequence.load(std::memory_order_acquire);
+        int64_t idleSince = monotonicNanos();
+        while (_running.load(std::memory_order_acquire)) {
+            const uint32_t batch = _batch.load(std::memory_order_acquire);
+            if ((batch & 1u) != 0 && batch != seenBatch) {
+                seenBatch = batch;
+                setUpWorker();
+                // Registered before checking the batch is still open: the audio thread closes it before waiting
+                // for active workers to leave, so either it waits for this one or this one sees it closed
+                _activeWorkers.fetch_add(1);
+                if (_batch.load() == batch) {
+                    RealtimeScope realtimeScope;
+                    runBatch(participant);
+                }
+                _activeWorkers.fetch_sub(1, std::memory_order_release);
+                idleSince = monotonicNanos();
+                continue;
+            }
+
+            const uint32_t wake = _wakeSequence.load(std::memory_order_acquire);
+            if (wake != seenWake) {
+                // Woken for a new block: spin again
+                seenWake = wake;
+                setUpWorker();
+                idleSince = monotonicNanos();
+                continue;
+            }
+            if (monotonicNanos() - idleSince < _spinNanos) {
+                cpuRelax();
+                continue;
+            }
+
+            // Sleep; a wake after seenWake was read returns at once, as the futex word no longer matches
+            _sleepingWorkers.fetch_add(1);
+            if (_batch.load() == batch && _running.load()) {
+                waitWhileEqual(_wakeSequence, seenWake);
+            }
+            _sleepingWorkers.fetch_sub(1);
+        }
+    }
+
+    void RealtimeThreadPool::wakeWorkers() {
+        _wakeSequence.fetch_add(1);
+        if (_sleepingWorkers.load() > 0) {
+            wakeAll(_wakeSequence);
+        }
+    }
+
+    void RealtimeThreadPool::setUpWorker() {
+        AudioThreadSetup* setup = _threadSetup.load(std::memory_order_acquire);
+        if (setup != nullptr) {
+            setup->applyToCurrentThread();
+        }
+    }
+
+}  // namespace synthesizerBase
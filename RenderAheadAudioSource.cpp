@@ -0,0 +1,204 @@
+
+#include "include/RenderAheadAudioSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include "include/RealtimeSafety.h"
+
+
+namespace synthesizerBase {
+
+    RenderAheadAudioSource::RenderAheadAudioSource(AudioSource* source, int samplingRate, int32_t channelCount,
+                                                   int32_t blockFrames, int32_t blocksAhead)
+            : _source(source),
+              _samplingRate(samplingRate),
+              _channelCount(std::max(1, channelCount)),
+              _blockFrames(std::max(1, blockFrames)),
+              _blocksAhead(std::max(1, blocksAhead)),
+              _ring(_blockFrames * _blocksAhead * _channelCount),
+              _blockBuffer(static_cast<size_t>(_blockFrames) * _channelCount),
+              _interleavedBuffer(static_cast<size_t>(_blockFrames) * _channelCount),
+              // The audio thread copies at most the whole ring per callback; larger requests are served in parts
+              _readBuffer(static_cast<size_t>(_ring.capacity())) {
+    }
+
+    RenderAheadAudioSource::~RenderAheadAudioSource() {
+        stop();
+    }
+
+    void RenderAheadAudioSource::start() {
+        stop();
+        // Prefill, such that playback starts with the full latency budget
+        while (_ring.availableToWrite() >= _blockFrames * _channelCount &&
+               getFillLevelFrames() < _blockFrames * _blocksAhead) {
+            renderBlock();
+        }
+        resetStatistics();
+        _running = true;
+        _worker = std::thread(&RenderAheadAudioSource::runWorker, this);
+    }
+
+    void RenderAheadAudioSource::stop() {
+        _running = false;
+        if (_worker.joinable()) {
+            _worker.join();
+        }
+    }
+
+    void RenderAheadAudioSource::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        const auto channels = static_cast<int32_t>(channelCount);
+        if (channels != _channelCount) {
+            memset(audioData, 0, sizeof(float) * framesCount * channels);
+            _underrunCount.fetch_add(1, std::memory_order_relaxed);
+            _underrunFrames.fetch_add(framesCount, std::memory_order_relaxed);
+            return;
+        }
+
+        const int32_t fillLevel = getFillLevelFrames();
+        if (fillLevel < _minimumFillLevel.load(std::memory_order_relaxed)) {
+            _minimumFillLevel.store(fillLevel, std::memory_order_relaxed);
+        }
+
+        const int32_t maxFramesPerRead = static_cast<int32_t>(_readBuffer.size()) / channels;
+        int32_t framesDone = 0;
+        while (framesDone < framesCount) {
+            const int32_t framesWanted = std::min(maxFramesPerRead, framesCount - framesDone);
+            const int32_t framesRead = _ring.read(_readBuffer.data(), framesWanted * channels) / channels;
+            // Deinterleave into the blockwise layout float[channelCount][framesCount]
+            for (int32_t channel = 0; channel < channels; channel++) {
+                float* output = audioData + static_cast<int64_t>(channel) * framesCount + framesDone;
+                for (int32_t frame = 0; frame < framesRead; frame++) {
+                    output[frame] = _readBuffer[frame * channels + channel];
+                }
+            }
+            framesDone += framesRead;
+            _readFrames += framesRead;
+            if (framesRead < framesWanted) {
+                break;
+            }
+        }
+
+        if (framesDone < framesCount) {
+            const int32_t missing = framesCount - framesDone;
+            for (int32_t channel = 0; channel < channels; channel++) {
+                memset(audioData + static_cast<int64_t>(channel) * framesCount + framesDone, 0,
+                       sizeof(float) * missing);
+            }
+            _underrunCount.fetch_add(1, std::memory_order_relaxed);
+            _underrunFrames.fetch_add(missing, std::memory_order_relaxed);
+        }
+    }
+
+    void RenderAheadAudioSource::onAudioEvent(const AudioEvent& event) {
+        // The worker renders at most one block beyond the latency ahead of playback: delaying all events by as much
+        // keeps them in the future of the worker, and their timing relative to each other sample-accurate
+        ScheduledEvent scheduled;
+        scheduled.event = event;
+        scheduled.renderFrame = _readFrames + getLatencyFrames() + _blockFrames;
+        if (!_events.push(scheduled)) {
+            _droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void RenderAheadAudioSource::onPlaybackStopped() {
+        stop();
+        _source->onPlaybackStopped();
+    }
+
+    int32_t RenderAheadAudioSource::getFillLevelFrames() const {
+        return _ring.availableToRead() / _channelCount;
+    }
+
+    int32_t RenderAheadAudioSource::getMinimumFillLevelFrames() const {
+        return _minimumFillLevel.load(std::memory_order_relaxed);
+    }
+
+    int64_t RenderAheadAudioSource::getUnderrunCount() const {
+        return _underrunCount.load(std::memory_order_relaxed);
+    }
+
+    int64_t RenderAheadAudioSource::getUnderrunFrames() const {
+        return _underrunFrames.load(std::memory_order_relaxed);
+    }
+
+    int64_t RenderAheadAudioSource::getDroppedEventCount() const {
+        return _droppedEventCount.load(std::memory_order_relaxed);
+    }
+
+    int32_t RenderAheadAudioSource::getLatencyFrames() const {
+        return _blockFrames * _blocksAhead;
+    }
+
+    void RenderAheadAudioSource::resetStatistics() {
+        _minimumFillLevel = getFillLevelFrames();
+        _underrunCount = 0;
+        _underrunFrames = 0;
+    }
+
+    void RenderAheadAudioSource::renderBlock() {
+        int32_t rendered = 0;
+        while (rendered < _blockFrames) {
+            // Apply the events due at this frame, then render up to the next event in the block
+            int32_t partEnd = _blockFrames;
+            while (peekEvent()) {
+                const int64_t offset = _nextEvent.renderFrame - _renderedFrames;
+                if (offset > rendered) {
+                    partEnd = static_cast<int32_t>(std::min<int64_t>(offset, _blockFrames));
+                    break;
+                }
+                _source->onAudioEvent(_nextEvent.event);
+                _hasNextEvent = false;
+            }
+            renderPart(rendered, partEnd - rendered);
+            rendered = partEnd;
+        }
+        _ring.write(_interleavedBuffer.data(), _blockFrames * _channelCount);
+        _renderedFrames += _blockFrames;
+    }
+
+    void RenderAheadAudioSource::renderPart(int32_t offset, int32_t framesCount) {
+        float* output = _interleavedBuffer.data() + static_cast<int64_t>(offset) * _channelCount;
+        if (_source->isIdle()) {
+            std::fill(output, output + static_cast<int64_t>(framesCount) * _channelCount, 0.0f);
+            return;
+        }
+        _source->onAudioReady(_blockBuffer.data(), framesCount, static_cast<ChannelCount>(_channelCount));
+        for (int32_t channel = 0; channel < _channelCount; channel++) {
+            const float* input = _blockBuffer.data() + static_cast<int64_t>(channel) * framesCount;
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                output[frame * _channelCount + channel] = input[frame];
+            }
+        }
+    }
+
+    bool RenderAheadAudioSource::peekEvent() {
+        if (!_hasNextEvent) {
+            _hasNextEvent = _events.pop(_nextEvent);
+        }
+        return _hasNextEvent;
+    }
+
+    void RenderAheadAudioSource::setThreadSetup(AudioThreadSetup* setup) {
+        _threadSetup = setup;
+    }
+
+    void RenderAheadAudioSource::runWorker() {
+        // Poll at a quarter of a block period: often enough to refill in time, without waking the audio thread
+        const auto pollInterval = std::chrono::microseconds(
+                std::max<int64_t>(50, static_cast<int64_t>(250000.0 * _blockFrames / std::max(1, _samplingRate))));
+        if (_threadSetup != nullptr) {
+            _threadSetup->applyToCurrentThread();
+        }
+        while (_running.load(std::memory_order_relaxed)) {
+            if (_ring.availableToWrite() >= _blockFrames * _channelCount &&
+                getFillLevelFrames() < _blockFrames * _blocksAhead) {
+                RealtimeScope realtimeScope;
+                renderBlock();
+            } else {
+                std::this_thread::sleep_for(pollInterval);
+            }
+        }
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,242 @@
+
+#include "include/ResamplingAudioSource.h"
+
+#include <algorithm>
+#include <math.h>
+#include <numeric>
+#include <string.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        struct QualityPreset {
+            int32_t taps;
+            int32_t phases;
+            double kaiserBeta;
+            float cutoff; // relative to the Nyquist frequency of the lower rate
+        };
+
+        QualityPreset qualityPreset(ResamplerQuality quality) {
+            switch (quality) {
+                case ResamplerQuality::Fast:
+                    return {8, 64, 4.5, 0.80f};
+                case ResamplerQuality::Medium:
+                    return {16, 128, 6.5, 0.86f};
+                case ResamplerQuality::Best:
+                    return {64, 512, 10.5, 0.945f};
+                case ResamplerQuality::High:
+                default:
+                    return {32, 256, 8.5, 0.91f};
+            }
+        }
+
+        // Modified Bessel function of the first kind, order 0, by its power series
+        double besselI0(double x) {
+            double sum = 1.0;
+            double term = 1.0;
+            for (int k = 1; k < 64; k++) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+                if (term < 1e-12 * sum) {
+                    break;
+                }
+            }
+            return sum;
+        }
+    }
+
+    ResamplingAudioSource::ResamplingAudioSource(AudioSource* source, int sourceRate, int outputRate,
+                                                 int32_t channelCount, ResamplerQuality quality,
+                                                 int32_t sourceBlockFrames)
+            : _source(source),
+              _sourceRate(std::max(1, sourceRate)),
+              _outputRate(std::max(1, outputRate)),
+              _channelCount(std::max(1, channelCount)),
+              _sourceBlockFrames(std::max(1, sourceBlockFrames)) {
+        const QualityPreset preset = qualityPreset(quality);
+        _taps = preset.taps;
+        _phases = preset.phases;
+        _tapStride = (_taps + 15) / 16 * 16;
+        _historyStride = (_taps + _sourceBlockFrames + 15) / 16 * 16;
+
+        const int64_t divisor = std::gcd(static_cast<int64_t>(_sourceRate), static_cast<int64_t>(_outputRate));
+        _denominator = _outputRate / divisor;
+        const int64_t numerator = _sourceRate / divisor;
+        _step = static_cast<int32_t>(numerator / _denominator);
+        _stepRemainder = numerator % _denominator;
+
+        if (_sourceRate != _outputRate) {
+            _filters.resize(static_cast<size_t>(_phases + 1) * _tapStride);
+            _history.resize(static_cast<size_t>(_channelCount) * _historyStride);
+            // Below the Nyquist frequency of the lower rate, in units of the source Nyquist frequency
+            designFilters(preset.cutoff * std::min(1.0f, static_cast<float>(_outputRate) / _sourceRate),
+                          preset.kaiserBeta);
+        }
+        _sourceBlock.resize(static_cast<size_t>(_channelCount) * _sourceBlockFrames);
+        // Zeros before the first input frame, such that output frame 0 is centered on input frame 0
+        _available = _taps / 2 - 1;
+        _silentFrames = _available;
+    }
+
+    void ResamplingAudioSource::designFilters(float cutoff, double kaiserBeta) {
+        const double half = _taps / 2.0;
+        const double normalization = besselI0(kaiserBeta);
+        for (int32_t phase = 0; phase <= _phases; phase++) {
+            // The filter is centered between taps half - 1 and half, at the position of the output frame
+            const double fraction = static_cast<double>(phase) / _phases;
+            float* filter = _filters.data() + static_cast<int64_t>(phase) * _tapStride;
+            double sum = 0.0;
+            for (int32_t tap = 0; tap < _taps; tap++) {
+                const double x = tap - (half - 1.0) - fraction;
+                const double r = x / half;
+                const double window = r <= -1.0 || r >= 1.0 ? 0.0 :
+                                      besselI0(kaiserBeta * sqrt(1.0 - r * r)) / normalization;
+                const double argument = M_PI * cutoff * x;
+                const double sinc = x == 0.0 ? 1.0 : sin(argument) / argument;
+                const double coefficient = cutoff * sinc * window;
+                filter[tap] = static_cast<float>(coefficient);
+                sum += coefficient;
+            }
+            // Unity gain at 0 Hz for every phase
+            for (int32_t tap = 0; tap < _taps; tap++) {
+                filter[tap] = static_cast<float>(filter[tap] / sum);
+            }
+        }
+    }
+
+    void ResamplingAudioSource::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        if (static_cast<int32_t>(channelCount) != _channelCount || _source == nullptr) {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            return;
+        }
+        if (_sourceRate == _outputRate) {
+            _source->onAudioReady(audioData, framesCount, channelCount);
+            return;
+        }
+        render(audioData, framesCount, framesCount, 1);
+    }
+
+    SampleLayout ResamplingAudioSource::getNativeLayout() const {
+        return SampleLayout::Interleaved;
+    }
+
+    void ResamplingAudioSource::renderInterleaved(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        if (static_cast<int32_t>(channelCount) != _channelCount || _source == nullptr) {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            return;
+        }
+        if (_sourceRate != _outputRate) {
+            render(audioData, framesCount, 1, _channelCount);
+        } else if (_source->getNativeLayout() == SampleLayout::Interleaved) {
+            _source->renderInterleaved(audioData, framesCount, channelCount);
+        } else {
+            for (int32_t offset = 0; offset < framesCount; offset += _sourceBlockFrames) {
+                const int32_t frames = std::min(_sourceBlockFrames, framesCount - offset);
+                _source->onAudioReady(_sourceBlock.data(), frames, channelCount);
+                simd::interleave(audioData + static_cast<int64_t>(offset) * _channelCount, _sourceBlock.data(),
+                                 frames, frames, _channelCount);
+            }
+        }
+    }
+
+    void ResamplingAudioSource::render(float* audioData, int32_t framesCount, int32_t channelStride,
+                                       int32_t frameStride) {
+        for (int32_t frame = 0; frame < framesCount; frame++) {
+            while (_index + _taps > _available) {
+                refill();
+            }
+            // Phase below the position, and weight of the phase above
+            const int64_t scaledPosition = _remainder * _phases;
+            const auto phase = static_cast<int32_t>(scaledPosition / _denominator);
+            const float weight = static_cast<float>(scaledPosition - phase * _denominator) /
+                                 static_cast<float>(_denominator);
+            const float* below = _filters.data() + static_cast<int64_t>(phase) * _tapStride;
+            const float* above = below + _tapStride;
+            float* output = audioData + static_cast<int64_t>(frame) * frameStride;
+            for (int32_t channel = 0; channel < _channelCount; channel++) {
+                const float* input = _history.data() + static_cast<int64_t>(channel) * _historyStride + _index;
+                const float sample = simd::interpolatedDotProduct(input, below, above, weight, _taps);
+                output[static_cast<int64_t>(channel) * channelStride] = sample;
+            }
+            _index += _step;
+            _remainder += _stepRemainder;
+            if (_remainder >= _denominator) {
+                _remainder -= _denominator;
+                _index++;
+            }
+        }
+    }
+
+    void ResamplingAudioSource::refill() {
+        // When downsampling by a large ratio, the next output frame may lie beyond the frames kept
+        const int32_t dropped = std::min(_index, _available);
+        if (dropped > 0) {
+            const int32_t kept = _available - dropped;
+            for (int32_t channel = 0; channel < _channelCount; channel++) {
+                float* history = _history.data() + static_cast<int64_t>(channel) * _historyStride;
+                memmove(history, history + dropped, sizeof(float) * kept);
+            }
+            _available = kept;
+            _index -= dropped;
+        }
+
+        const bool silent = _source->isIdle();
+        if (!silent) {
+            _source->onAudioReady(_sourceBlock.data(), _sourceBlockFrames, static_cast<ChannelCount>(_channelCount));
+        }
+        for (int32_t channel = 0; channel < _channelCount; channel++) {
+            float* destination = _history.data() + static_cast<int64_t>(channel) * _historyStride + _available;
+            if (silent) {
+                memset(destination, 0, sizeof(float) * _sourceBlockFrames);
+            } else {
+                memcpy(destination, _sourceBlock.data() + static_cast<int64_t>(channel) * _sourceBlockFrames,
+                       sizeof(float) * _sourceBlockFrames);
+            }
+        }
+        _available += _sourceBlockFrames;
+        if (silent || _source->getBlockState() == BlockState::Silent) {
+            _silentFrames += _sourceBlockFrames;
+        } else {
+            _silentFrames = 0;
+        }
+    }
+
+    void ResamplingAudioSource::onPlaybackStopped() {
+        if (_source != nullptr) {
+            _source->onPlaybackStopped();
+        }
+        if (_history.size() > 0) {
+            memset(_history.data(), 0, sizeof(float) * _history.size());
+        }
+        _available = _taps / 2 - 1;
+        _silentFrames = _available;
+        _index = 0;
+        _remainder = 0;
+    }
+
+    bool ResamplingAudioSource::isIdle() const {
+        if (_source == nullptr) {
+            return true;
+        }
+        return _source->isIdle() && (_sourceRate == _outputRate || _silentFrames >= _available);
+    }
+
+    void ResamplingAudioSource::onAudioEvent(const AudioEvent& event) {
+        if (_source != nullptr) {
+            _source->onAudioEvent(event);
+        }
+    }
+
+    int32_t ResamplingAudioSource::getTailFrames() const {
+        const int64_t sourceTail = (_source != nullptr ? _source->getTailFrames() : 0) +
+                                   (_sourceRate != _outputRate ? _taps : 0);
+        return static_cast<int32_t>((sourceTail * _outputRate + _sourceRate - 1) / _sourceRate);
+    }
+
+    int32_t ResamplingAudioSource::getFilterTaps() const {
+        return _taps;
+    }
+
+}  // namespace synthesizerBase
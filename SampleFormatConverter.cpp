@@ -0,0 +1,150 @@
+
+#include "include/SampleFormatConverter.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        // Full scale of the integer formats, in least significant bits
+        float fullScale(SampleFormat format) {
+            switch (format) {
+                case SampleFormat::Int16:
+                    return 32768.0f;
+                case SampleFormat::Int24Packed:
+                    return 8388608.0f;
+                case SampleFormat::Int32:
+                    return 2147483648.0f;
+                case SampleFormat::Float:
+                default:
+                    return 1.0f;
+            }
+        }
+
+        // Largest value of the integer formats, as the kernels clamp to it
+        float largestValue(SampleFormat format) {
+            return format == SampleFormat::Int32 ? 2147483520.0f : fullScale(format) - 1.0f;
+        }
+
+        // Seeds of the dither generators, odd and distinct
+        constexpr uint32_t randomSeed = 0x9E3779B9u;
+
+        // Shaping errors are bounded, such that clipped samples do not feed back a large error
+        constexpr float maxShapingError = 2.0f;
+    }
+
+    int32_t SampleFormatConverter::bytesPerSample(SampleFormat format) {
+        switch (format) {
+            case SampleFormat::Int16:
+                return 2;
+            case SampleFormat::Int24Packed:
+                return 3;
+            case SampleFormat::Int32:
+            case SampleFormat::Float:
+            default:
+                return 4;
+        }
+    }
+
+    SampleFormatConverter::SampleFormatConverter(SampleFormat format, int32_t channelCount, DitherMode dither,
+                                                 int32_t chunkFrames)
+            : _format(format),
+              _channelCount(std::max(1, channelCount)),
+              _dither(format == SampleFormat::Float ? DitherMode::None : dither),
+              _chunkFrames(std::max(1, chunkFrames)) {
+        for (int32_t generator = 0; generator < simd::ditherGenerators; generator++) {
+            _randomStates[generator] = randomSeed * static_cast<uint32_t>(2 * generator + 1);
+        }
+        if (_dither != DitherMode::None) {
+            _ditherValues.resize(static_cast<size_t>(_chunkFrames) * _channelCount);
+            _errors.resize(static_cast<size_t>(_channelCount) * 2);
+        }
+    }
+
+    void SampleFormatConverter::convert(void* destination, const float* source, int32_t framesCount) {
+        if (_format == SampleFormat::Float) {
+            memcpy(destination, source, sizeof(float) * framesCount * _channelCount);
+            return;
+        }
+        auto* bytes = static_cast<uint8_t*>(destination);
+        const int32_t frameBytes = bytesPerSample(_format) * _channelCount;
+        for (int32_t offset = 0; offset < framesCount; offset += _chunkFrames) {
+            const int32_t frames = std::min(_chunkFrames, framesCount - offset);
+            const float* input = source + static_cast<int64_t>(offset) * _channelCount;
+            uint8_t* output = bytes + static_cast<int64_t>(offset) * frameBytes;
+            const float* dither = nullptr;
+            if (_dither != DitherMode::None) {
+                generateDither(input, frames);
+                dither = _ditherValues.data();
+            }
+            const int32_t samples = frames * _channelCount;
+            switch (_format) {
+                case SampleFormat::Int16:
+                    simd::floatToInt16(reinterpret_cast<int16_t*>(output), input, dither, samples);
+                    break;
+                case SampleFormat::Int24Packed:
+                    simd::floatToInt24(output, input, dither, samples);
+                    break;
+                case SampleFormat::Int32:
+                    simd::floatToInt32(reinterpret_cast<int32_t*>(output), input, dither, samples);
+                    break;
+                case SampleFormat::Float:
+                default:
+                    break;
+            }
+        }
+    }
+
+    void SampleFormatConverter::reset() {
+        for (size_t i = 0; i < _errors.size(); i++) {
+            _errors[i] = 0.0f;
+        }
+    }
+
+    SampleFormat SampleFormatConverter::getFormat() const {
+        return _format;
+    }
+
+    DitherMode SampleFormatConverter::getDitherMode() const {
+        return _dither;
+    }
+
+    int32_t SampleFormatConverter::getChannelCount() const {
+        return _channelCount;
+    }
+
+    void SampleFormatConverter::generateDither(const float* source, int32_t framesCount) {
+        const int32_t samples = framesCount * _channelCount;
+        float* dither = _ditherValues.data();
+        simd::triangularDither(dither, _randomStates, samples);
+        if (_dither != DitherMode::NoiseShaped) {
+            return;
+        }
+
+        // Error feedback: the value quantized is v[n] = x[n] - 2e[n-1] + e[n-2], with e[n] = q[n] - v[n] the error of
+        // rounding v[n] plus dither. The total error q - x = e[n] - 2e[n-1] + e[n-2] is shaped by (1 - z^-1)^2, a
+        // second order high-pass. The feedback is handed to the kernel as part of the dither; the rounding done
+        // here uses the same operations as the kernel, so that the errors fed back are those of the output.
+        // Frame by frame, such that the feedback loops of the channels overlap.
+        const float scale = fullScale(_format);
+        const float maximum = largestValue(_format);
+        float* errors = _errors.data();
+        for (int32_t frame = 0; frame < framesCount; frame++) {
+            for (int32_t channel = 0; channel < _channelCount; channel++) {
+                const int32_t i = frame * _channelCount + channel;
+                const float previous = errors[2 * channel];
+                const float feedback = errors[2 * channel + 1] - 2.0f * previous;
+                dither[i] += feedback;
+                const float quantized = std::min(maximum, std::max(-scale, rintf(source[i] * scale + dither[i])));
+                errors[2 * channel + 1] = previous;
+                errors[2 * channel] = std::min(maxShapingError,
+                                               std::max(-maxShapingError, quantized - (source[i] * scale + feedback)));
+            }
+        }
+    }
+
+}  // namespace synthesizerBase
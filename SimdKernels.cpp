@@ -0,0 +1,1284 @@
+
+#include "include/SimdKernels.h"
+
+#include <atomic>
+#include <initializer_list>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SYNTHESIZERBASE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SYNTHESIZERBASE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifdef SYNTHESIZERBASE_X86
+// x86 kernels are compiled for their instruction set independently of the compiler flags, and only called
+// if the CPU supports it
+#define SYNTHESIZERBASE_TARGET_SSE2 __attribute__((target("sse2")))
+#define SYNTHESIZERBASE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+
+namespace synthesizerBase {
+namespace simd {
+
+    namespace {
+
+        // ---------------------------------------------------------------- scalar
+
+        void mixAccumulateScalar(float* destination, const float* source, float gain, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] += gain * source[i];
+            }
+        }
+
+        void mixAccumulateRampScalar(float* destination, const float* source, float startGain, float gainStep,
+                                     int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] += (startGain + static_cast<float>(i) * gainStep) * source[i];
+            }
+        }
+
+        void linearRampScalar(float* destination, float start, float step, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] = start + static_cast<float>(i) * step;
+            }
+        }
+
+        void exponentialRampScalar(float* destination, float offset, float scale, float factor, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] = offset + scale;
+                scale *= factor;
+            }
+        }
+
+        void multiplyScalar(float* destination, const float* gains, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] *= gains[i];
+            }
+        }
+
+        void scaleScalar(float* destination, float gain, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] *= gain;
+            }
+        }
+
+        void interleaveScalar(float* interleaved, const float* planar, int32_t planarStride, int32_t framesCount,
+                              int32_t channelCount) {
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                const float* source = planar + static_cast<int64_t>(channel) * planarStride;
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    interleaved[static_cast<int64_t>(frame) * channelCount + channel] = source[frame];
+                }
+            }
+        }
+
+        void deinterleaveScalar(float* planar, int32_t planarStride, const float* interleaved, int32_t framesCount,
+                                int32_t channelCount) {
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                float* destination = planar + static_cast<int64_t>(channel) * planarStride;
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    destination[frame] = interleaved[static_cast<int64_t>(frame) * channelCount + channel];
+                }
+            }
+        }
+
+        // Full scale and largest value of the integer formats, as floats: the largest int32_t is not a float
+        constexpr float int16FullScale = 32768.0f;
+        constexpr float int16Maximum = 32767.0f;
+        constexpr float int24FullScale = 8388608.0f;
+        constexpr float int24Maximum = 8388607.0f;
+        constexpr float int32FullScale = 2147483648.0f;
+        constexpr float int32Maximum = 2147483520.0f;
+
+        // Scale, add the dither, clamp and round to nearest. NaN gives the minimum, as in the vectorized versions.
+        inline int32_t quantizeScalar(float sample, const float* dither, float fullScale, float maximum) {
+            float value = sample * fullScale;
+            if (dither != nullptr) {
+                value += *dither;
+            }
+            value = value >= -fullScale ? value : -fullScale;
+            value = value <= maximum ? value : maximum;
+            return static_cast<int32_t>(lrintf(value));
+        }
+
+        inline void storeInt24(uint8_t* destination, int32_t value) {
+            destination[0] = static_cast<uint8_t>(value);
+            destination[1] = static_cast<uint8_t>(value >> 8);
+            destination[2] = static_cast<uint8_t>(value >> 16);
+        }
+
+        void floatToInt16Scalar(int16_t* destination, const float* source, const float* dither, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                const int32_t value = quantizeScalar(source[i], dither != nullptr ? dither + i : nullptr,
+                                                     int16FullScale, int16Maximum);
+                destination[i] = static_cast<int16_t>(value);
+            }
+        }
+
+        void floatToInt24Scalar(uint8_t* destination, const float* source, const float* dither, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                storeInt24(destination + 3 * i, quantizeScalar(source[i], dither != nullptr ? dither + i : nullptr,
+                                                               int24FullScale, int24Maximum));
+            }
+        }
+
+        void floatToInt32Scalar(int32_t* destination, const float* source, const float* dither, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] = quantizeScalar(source[i], dither != nullptr ? dither + i : nullptr, int32FullScale,
+                                                int32Maximum);
+            }
+        }
+
+        float dotProductScalar(const float* a, const float* b, int32_t count) {
+            float sum = 0.0f;
+            for (int32_t i = 0; i < count; i++) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        float interpolatedDotProductScalar(const float* input, const float* below, const float* above, float weight,
+                                           int32_t count) {
+            float sum = 0.0f;
+            for (int32_t i = 0; i < count; i++) {
+                sum += input[i] * (below[i] + weight * (above[i] - below[i]));
+            }
+            return sum;
+        }
+
+        void complexMultiplyAccumulateScalar(float* accumulatorReal, float* accumulatorImaginary, const float* aReal,
+                                             const float* aImaginary, const float* bReal, const float* bImaginary,
+                                             int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                accumulatorReal[i] += aReal[i] * bReal[i] - aImaginary[i] * bImaginary[i];
+                accumulatorImaginary[i] += aReal[i] * bImaginary[i] + aImaginary[i] * bReal[i];
+            }
+        }
+
+        inline float nextTriangularScalar(uint32_t& state) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return static_cast<float>(static_cast<int32_t>(state & 0xFFFFu) - static_cast<int32_t>(state >> 16)) *
+                   (1.0f / 65536.0f);
+        }
+
+        void triangularDitherScalar(float* destination, uint32_t* states, int32_t count) {
+            for (int32_t i = 0; i < count; i++) {
+                destination[i] = nextTriangularScalar(states[i % ditherGenerators]);
+            }
+        }
+
+        void wavetableVoicesScalar(const float* tables, float* phases, const float* increments,
+                                   const float* amplitudes, const int32_t* tableOffsets, int32_t voiceCount,
+                                   float tableLength, float* accumulator, int32_t framesCount) {
+            for (int32_t voice = 0; voice < voiceCount; voice++) {
+                const float* table = tables + tableOffsets[voice];
+                const float increment = increments[voice];
+                const float amplitude = amplitudes[voice];
+                float phase = phases[voice];
+                float* lane = accumulator + voice % wavetableVoiceGroup;
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    const int32_t index = static_cast<int32_t>(phase);
+                    const float fraction = phase - static_cast<float>(index);
+                    const float sample = table[index] + fraction * (table[index + 1] - table[index]);
+                    lane[frame * wavetableVoiceGroup] += amplitude * sample;
+                    phase += increment;
+                    if (phase >= tableLength) {
+                        phase -= tableLength;
+                    }
+                }
+                phases[voice] = phase;
+            }
+        }
+
+#ifdef SYNTHESIZERBASE_X86
+        // ---------------------------------------------------------------- SSE2
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void mixAccumulateSse2(float* destination, const float* source, float gain, int32_t count) {
+            const __m128 gains = _mm_set1_ps(gain);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 sum = _mm_add_ps(_mm_loadu_ps(destination + i),
+                                              _mm_mul_ps(gains, _mm_loadu_ps(source + i)));
+                _mm_storeu_ps(destination + i, sum);
+            }
+            mixAccumulateScalar(destination + i, source + i, gain, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void mixAccumulateRampSse2(float* destination, const float* source, float startGain, float gainStep,
+                                   int32_t count) {
+            __m128 gains = _mm_add_ps(_mm_set1_ps(startGain),
+                                      _mm_mul_ps(_mm_set1_ps(gainStep), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+            const __m128 increment = _mm_set1_ps(4.0f * gainStep);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 sum = _mm_add_ps(_mm_loadu_ps(destination + i),
+                                              _mm_mul_ps(gains, _mm_loadu_ps(source + i)));
+                _mm_storeu_ps(destination + i, sum);
+                gains = _mm_add_ps(gains, increment);
+            }
+            mixAccumulateRampScalar(destination + i, source + i, startGain + static_cast<float>(i) * gainStep,
+                                    gainStep, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void linearRampSse2(float* destination, float start, float step, int32_t count) {
+            __m128 values = _mm_add_ps(_mm_set1_ps(start),
+                                       _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+            const __m128 increment = _mm_set1_ps(4.0f * step);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(destination + i, values);
+                values = _mm_add_ps(values, increment);
+            }
+            linearRampScalar(destination + i, start + static_cast<float>(i) * step, step, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void exponentialRampSse2(float* destination, float offset, float scale, float factor, int32_t count) {
+            const float factor2 = factor * factor;
+            __m128 scales = _mm_mul_ps(_mm_set1_ps(scale), _mm_setr_ps(1.0f, factor, factor2, factor2 * factor));
+            const __m128 offsets = _mm_set1_ps(offset);
+            const __m128 factors = _mm_set1_ps(factor2 * factor2);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(destination + i, _mm_add_ps(offsets, scales));
+                scales = _mm_mul_ps(scales, factors);
+            }
+            alignas(16) float remaining[4];
+            _mm_store_ps(remaining, scales);
+            exponentialRampScalar(destination + i, offset, remaining[0], factor, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void multiplySse2(float* destination, const float* gains, int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_loadu_ps(destination + i), _mm_loadu_ps(gains + i)));
+            }
+            multiplyScalar(destination + i, gains + i, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void scaleSse2(float* destination, float gain, int32_t count) {
+            const __m128 gains = _mm_set1_ps(gain);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_loadu_ps(destination + i), gains));
+            }
+            scaleScalar(destination + i, gain, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void interleaveSse2(float* interleaved, const float* planar, int32_t planarStride, int32_t framesCount,
+                            int32_t channelCount) {
+            if (channelCount != 2) {
+                interleaveScalar(interleaved, planar, planarStride, framesCount, channelCount);
+                return;
+            }
+            const float* left = planar;
+            const float* right = planar + planarStride;
+            int32_t i = 0;
+            for (; i + 4 <= framesCount; i += 4) {
+                const __m128 l = _mm_loadu_ps(left + i);
+                const __m128 r = _mm_loadu_ps(right + i);
+                _mm_storeu_ps(interleaved + 2 * i, _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(interleaved + 2 * i + 4, _mm_unpackhi_ps(l, r));
+            }
+            for (; i < framesCount; i++) {
+                interleaved[2 * i] = left[i];
+                interleaved[2 * i + 1] = right[i];
+            }
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void deinterleaveSse2(float* planar, int32_t planarStride, const float* interleaved, int32_t framesCount,
+                              int32_t channelCount) {
+            if (channelCount != 2) {
+                deinterleaveScalar(planar, planarStride, interleaved, framesCount, channelCount);
+                return;
+            }
+            float* left = planar;
+            float* right = planar + planarStride;
+            int32_t i = 0;
+            for (; i + 4 <= framesCount; i += 4) {
+                const __m128 a = _mm_loadu_ps(interleaved + 2 * i);
+                const __m128 b = _mm_loadu_ps(interleaved + 2 * i + 4);
+                _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            for (; i < framesCount; i++) {
+                left[i] = interleaved[2 * i];
+                right[i] = interleaved[2 * i + 1];
+            }
+        }
+
+        // Four samples scaled, dithered, clamped and rounded (rounding mode of the thread: nearest by default)
+        SYNTHESIZERBASE_TARGET_SSE2
+        inline __m128i quantizeSse2(const float* source, const float* dither, float fullScale, float maximum) {
+            __m128 value = _mm_mul_ps(_mm_loadu_ps(source), _mm_set1_ps(fullScale));
+            if (dither != nullptr) {
+                value = _mm_add_ps(value, _mm_loadu_ps(dither));
+            }
+            value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-fullScale)), _mm_set1_ps(maximum));
+            return _mm_cvtps_epi32(value);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void floatToInt16Sse2(int16_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m128i low = quantizeSse2(source + i, dither != nullptr ? dither + i : nullptr,
+                                                 int16FullScale, int16Maximum);
+                const __m128i high = quantizeSse2(source + i + 4, dither != nullptr ? dither + i + 4 : nullptr,
+                                                  int16FullScale, int16Maximum);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(low, high));
+            }
+            floatToInt16Scalar(destination + i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void floatToInt24Sse2(uint8_t* destination, const float* source, const float* dither, int32_t count) {
+            alignas(16) int32_t values[4];
+            int32_t i = 0;
+            // SSE2 has no byte shuffle: the conversion is vectorized, the packing is not
+            for (; i + 4 <= count; i += 4) {
+                _mm_store_si128(reinterpret_cast<__m128i*>(values),
+                                quantizeSse2(source + i, dither != nullptr ? dither + i : nullptr, int24FullScale,
+                                             int24Maximum));
+                for (int32_t j = 0; j < 4; j++) {
+                    storeInt24(destination + 3 * (i + j), values[j]);
+                }
+            }
+            floatToInt24Scalar(destination + 3 * i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void floatToInt32Sse2(int32_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i),
+                                 quantizeSse2(source + i, dither != nullptr ? dither + i : nullptr, int32FullScale,
+                                              int32Maximum));
+            }
+            floatToInt32Scalar(destination + i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        inline float horizontalSumSse2(__m128 values) {
+            const __m128 pairs = _mm_add_ps(values, _mm_movehl_ps(values, values));
+            return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        float dotProductSse2(const float* a, const float* b, int32_t count) {
+            // Two accumulators, to hide the latency of the additions
+            __m128 first = _mm_setzero_ps();
+            __m128 second = _mm_setzero_ps();
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                first = _mm_add_ps(first, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+                second = _mm_add_ps(second, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+            }
+            return horizontalSumSse2(_mm_add_ps(first, second)) + dotProductScalar(a + i, b + i, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        float interpolatedDotProductSse2(const float* input, const float* below, const float* above, float weight,
+                                         int32_t count) {
+            const __m128 weights = _mm_set1_ps(weight);
+            __m128 sum = _mm_setzero_ps();
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 low = _mm_loadu_ps(below + i);
+                const __m128 filter = _mm_add_ps(low, _mm_mul_ps(weights, _mm_sub_ps(_mm_loadu_ps(above + i), low)));
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(input + i), filter));
+            }
+            return horizontalSumSse2(sum) +
+                   interpolatedDotProductScalar(input + i, below + i, above + i, weight, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void complexMultiplyAccumulateSse2(float* accumulatorReal, float* accumulatorImaginary, const float* aReal,
+                                           const float* aImaginary, const float* bReal, const float* bImaginary,
+                                           int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 ar = _mm_loadu_ps(aReal + i);
+                const __m128 ai = _mm_loadu_ps(aImaginary + i);
+                const __m128 br = _mm_loadu_ps(bReal + i);
+                const __m128 bi = _mm_loadu_ps(bImaginary + i);
+                _mm_storeu_ps(accumulatorReal + i, _mm_add_ps(_mm_loadu_ps(accumulatorReal + i),
+                                                              _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi))));
+                _mm_storeu_ps(accumulatorImaginary + i, _mm_add_ps(_mm_loadu_ps(accumulatorImaginary + i),
+                                                                   _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br))));
+            }
+            complexMultiplyAccumulateScalar(accumulatorReal + i, accumulatorImaginary + i, aReal + i, aImaginary + i,
+                                            bReal + i, bImaginary + i, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        inline __m128 nextTriangularSse2(__m128i& state) {
+            state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+            state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+            state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+            const __m128i difference = _mm_sub_epi32(_mm_and_si128(state, _mm_set1_epi32(0xFFFF)),
+                                                     _mm_srli_epi32(state, 16));
+            return _mm_mul_ps(_mm_cvtepi32_ps(difference), _mm_set1_ps(1.0f / 65536.0f));
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void triangularDitherSse2(float* destination, uint32_t* states, int32_t count) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(states));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(states + 4));
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm_storeu_ps(destination + i, nextTriangularSse2(low));
+                _mm_storeu_ps(destination + i + 4, nextTriangularSse2(high));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(states), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(states + 4), high);
+            triangularDitherScalar(destination + i, states, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_SSE2
+        void wavetableVoicesSse2(const float* tables, float* phases, const float* increments,
+                                 const float* amplitudes, const int32_t* tableOffsets, int32_t voiceCount,
+                                 float tableLength, float* accumulator, int32_t framesCount) {
+            const __m128 lengths = _mm_set1_ps(tableLength);
+            alignas(16) int32_t indices[4];
+            // SSE2 has no gather: four voices at a time, the table reads are scalar
+            for (int32_t voice = 0; voice < voiceCount; voice += 4) {
+                __m128 phase = _mm_loadu_ps(phases + voice);
+                const __m128 increment = _mm_loadu_ps(increments + voice);
+                const __m128 amplitude = _mm_loadu_ps(amplitudes + voice);
+                const __m128i offsets = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tableOffsets + voice));
+                float* lane = accumulator + voice % wavetableVoiceGroup;
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    const __m128i whole = _mm_cvttps_epi32(phase);
+                    const __m128 fraction = _mm_sub_ps(phase, _mm_cvtepi32_ps(whole));
+                    _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_add_epi32(offsets, whole));
+                    const __m128 a = _mm_setr_ps(tables[indices[0]], tables[indices[1]],
+                                                 tables[indices[2]], tables[indices[3]]);
+                    const __m128 b = _mm_setr_ps(tables[indices[0] + 1], tables[indices[1] + 1],
+                                                 tables[indices[2] + 1], tables[indices[3] + 1]);
+                    const __m128 sample = _mm_add_ps(a, _mm_mul_ps(fraction, _mm_sub_ps(b, a)));
+                    float* destination = lane + frame * wavetableVoiceGroup;
+                    _mm_storeu_ps(destination, _mm_add_ps(_mm_loadu_ps(destination), _mm_mul_ps(amplitude, sample)));
+                    phase = _mm_add_ps(phase, increment);
+                    phase = _mm_sub_ps(phase, _mm_and_ps(_mm_cmpge_ps(phase, lengths), lengths));
+                }
+                _mm_storeu_ps(phases + voice, phase);
+            }
+        }
+
+        // ---------------------------------------------------------------- AVX2
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void mixAccumulateAvx2(float* destination, const float* source, float gain, int32_t count) {
+            const __m256 gains = _mm256_set1_ps(gain);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 sum = _mm256_fmadd_ps(gains, _mm256_loadu_ps(source + i),
+                                                   _mm256_loadu_ps(destination + i));
+                _mm256_storeu_ps(destination + i, sum);
+            }
+            mixAccumulateScalar(destination + i, source + i, gain, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void mixAccumulateRampAvx2(float* destination, const float* source, float startGain, float gainStep,
+                                   int32_t count) {
+            __m256 gains = _mm256_fmadd_ps(_mm256_set1_ps(gainStep),
+                                           _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f),
+                                           _mm256_set1_ps(startGain));
+            const __m256 increment = _mm256_set1_ps(8.0f * gainStep);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 sum = _mm256_fmadd_ps(gains, _mm256_loadu_ps(source + i),
+                                                   _mm256_loadu_ps(destination + i));
+                _mm256_storeu_ps(destination + i, sum);
+                gains = _mm256_add_ps(gains, increment);
+            }
+            mixAccumulateRampScalar(destination + i, source + i, startGain + static_cast<float>(i) * gainStep,
+                                    gainStep, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void linearRampAvx2(float* destination, float start, float step, int32_t count) {
+            __m256 values = _mm256_fmadd_ps(_mm256_set1_ps(step),
+                                            _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f),
+                                            _mm256_set1_ps(start));
+            const __m256 increment = _mm256_set1_ps(8.0f * step);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(destination + i, values);
+                values = _mm256_add_ps(values, increment);
+            }
+            linearRampScalar(destination + i, start + static_cast<float>(i) * step, step, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void exponentialRampAvx2(float* destination, float offset, float scale, float factor, int32_t count) {
+            alignas(32) float powers[8];
+            float power = 1.0f;
+            for (float& value : powers) {
+                value = power;
+                power *= factor;
+            }
+            __m256 scales = _mm256_mul_ps(_mm256_set1_ps(scale), _mm256_load_ps(powers));
+            const __m256 offsets = _mm256_set1_ps(offset);
+            const __m256 factors = _mm256_set1_ps(power);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(destination + i, _mm256_add_ps(offsets, scales));
+                scales = _mm256_mul_ps(scales, factors);
+            }
+            _mm256_store_ps(powers, scales);
+            exponentialRampScalar(destination + i, offset, powers[0], factor, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void multiplyAvx2(float* destination, const float* gains, int32_t count) {
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(destination + i,
+                                 _mm256_mul_ps(_mm256_loadu_ps(destination + i), _mm256_loadu_ps(gains + i)));
+            }
+            multiplyScalar(destination + i, gains + i, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void scaleAvx2(float* destination, float gain, int32_t count) {
+            const __m256 gains = _mm256_set1_ps(gain);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_loadu_ps(destination + i), gains));
+            }
+            scaleScalar(destination + i, gain, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void interleaveAvx2(float* interleaved, const float* planar, int32_t planarStride, int32_t framesCount,
+                            int32_t channelCount) {
+            if (channelCount != 2) {
+                interleaveScalar(interleaved, planar, planarStride, framesCount, channelCount);
+                return;
+            }
+            const float* left = planar;
+            const float* right = planar + planarStride;
+            int32_t i = 0;
+            for (; i + 8 <= framesCount; i += 8) {
+                const __m256 l = _mm256_loadu_ps(left + i);
+                const __m256 r = _mm256_loadu_ps(right + i);
+                // Unpacking works within 128-bit lanes: frames 0, 1, 4, 5 and 2, 3, 6, 7
+                const __m256 low = _mm256_unpacklo_ps(l, r);
+                const __m256 high = _mm256_unpackhi_ps(l, r);
+                _mm256_storeu_ps(interleaved + 2 * i, _mm256_permute2f128_ps(low, high, 0x20));
+                _mm256_storeu_ps(interleaved + 2 * i + 8, _mm256_permute2f128_ps(low, high, 0x31));
+            }
+            interleaveScalar(interleaved + 2 * i, planar + i, planarStride, framesCount - i, 2);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void deinterleaveAvx2(float* planar, int32_t planarStride, const float* interleaved, int32_t framesCount,
+                              int32_t channelCount) {
+            if (channelCount != 2) {
+                deinterleaveScalar(planar, planarStride, interleaved, framesCount, channelCount);
+                return;
+            }
+            float* left = planar;
+            float* right = planar + planarStride;
+            int32_t i = 0;
+            for (; i + 8 <= framesCount; i += 8) {
+                const __m256 a = _mm256_loadu_ps(interleaved + 2 * i);
+                const __m256 b = _mm256_loadu_ps(interleaved + 2 * i + 8);
+                // Frames 0, 1, 4, 5 and 2, 3, 6, 7, such that the in-lane shuffles give frames 0 to 7 in order
+                const __m256 first = _mm256_permute2f128_ps(a, b, 0x20);
+                const __m256 second = _mm256_permute2f128_ps(a, b, 0x31);
+                _mm256_storeu_ps(left + i, _mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm256_storeu_ps(right + i, _mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            deinterleaveScalar(planar + i, planarStride, interleaved + 2 * i, framesCount - i, 2);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        inline __m256i quantizeAvx2(const float* source, const float* dither, float fullScale, float maximum) {
+            __m256 value = _mm256_mul_ps(_mm256_loadu_ps(source), _mm256_set1_ps(fullScale));
+            if (dither != nullptr) {
+                value = _mm256_add_ps(value, _mm256_loadu_ps(dither));
+            }
+            value = _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(-fullScale)), _mm256_set1_ps(maximum));
+            return _mm256_cvtps_epi32(value);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void floatToInt16Avx2(int16_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const __m256i low = quantizeAvx2(source + i, dither != nullptr ? dither + i : nullptr,
+                                                 int16FullScale, int16Maximum);
+                const __m256i high = quantizeAvx2(source + i + 8, dither != nullptr ? dither + i + 8 : nullptr,
+                                                  int16FullScale, int16Maximum);
+                // Packing works within 128-bit lanes: samples 0-3, 8-11, 4-7, 12-15, put back in order
+                const __m256i packed = _mm256_packs_epi32(low, high);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i),
+                                    _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+            floatToInt16Scalar(destination + i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void floatToInt24Avx2(uint8_t* destination, const float* source, const float* dither, int32_t count) {
+            // Within each 128-bit lane, the three low bytes of the four samples, followed by four unused bytes
+            const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                  0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            int32_t i = 0;
+            // Each lane is stored with 16 bytes, the 4 unused ones overwritten by the next store: two more samples
+            // must follow
+            for (; i + 10 <= count; i += 8) {
+                const __m256i packed = _mm256_shuffle_epi8(
+                        quantizeAvx2(source + i, dither != nullptr ? dither + i : nullptr, int24FullScale,
+                                     int24Maximum), pack);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 3 * i), _mm256_castsi256_si128(packed));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 3 * i + 12),
+                                 _mm256_extracti128_si256(packed, 1));
+            }
+            floatToInt24Scalar(destination + 3 * i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void floatToInt32Avx2(int32_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i),
+                                    quantizeAvx2(source + i, dither != nullptr ? dither + i : nullptr,
+                                                 int32FullScale, int32Maximum));
+            }
+            floatToInt32Scalar(destination + i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        float dotProductAvx2(const float* a, const float* b, int32_t count) {
+            __m256 first = _mm256_setzero_ps();
+            __m256 second = _mm256_setzero_ps();
+            int32_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                first = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), first);
+                second = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), second);
+            }
+            if (i + 8 <= count) {
+                first = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), first);
+                i += 8;
+            }
+            const __m256 sum = _mm256_add_ps(first, second);
+            return horizontalSumSse2(_mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1))) +
+                   dotProductScalar(a + i, b + i, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        float interpolatedDotProductAvx2(const float* input, const float* below, const float* above, float weight,
+                                         int32_t count) {
+            const __m256 weights = _mm256_set1_ps(weight);
+            __m256 sum = _mm256_setzero_ps();
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 low = _mm256_loadu_ps(below + i);
+                const __m256 filter = _mm256_fmadd_ps(weights, _mm256_sub_ps(_mm256_loadu_ps(above + i), low), low);
+                sum = _mm256_fmadd_ps(_mm256_loadu_ps(input + i), filter, sum);
+            }
+            return horizontalSumSse2(_mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1))) +
+                   interpolatedDotProductScalar(input + i, below + i, above + i, weight, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void complexMultiplyAccumulateAvx2(float* accumulatorReal, float* accumulatorImaginary, const float* aReal,
+                                           const float* aImaginary, const float* bReal, const float* bImaginary,
+                                           int32_t count) {
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 ar = _mm256_loadu_ps(aReal + i);
+                const __m256 ai = _mm256_loadu_ps(aImaginary + i);
+                const __m256 br = _mm256_loadu_ps(bReal + i);
+                const __m256 bi = _mm256_loadu_ps(bImaginary + i);
+                const __m256 real = _mm256_fmadd_ps(ar, br, _mm256_loadu_ps(accumulatorReal + i));
+                const __m256 imaginary = _mm256_fmadd_ps(ar, bi, _mm256_loadu_ps(accumulatorImaginary + i));
+                _mm256_storeu_ps(accumulatorReal + i, _mm256_fnmadd_ps(ai, bi, real));
+                _mm256_storeu_ps(accumulatorImaginary + i, _mm256_fmadd_ps(ai, br, imaginary));
+            }
+            complexMultiplyAccumulateScalar(accumulatorReal + i, accumulatorImaginary + i, aReal + i, aImaginary + i,
+                                            bReal + i, bImaginary + i, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void triangularDitherAvx2(float* destination, uint32_t* states, int32_t count) {
+            __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states));
+            const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+            const __m256 scale = _mm256_set1_ps(1.0f / 65536.0f);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+                state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+                state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+                const __m256i difference = _mm256_sub_epi32(_mm256_and_si256(state, lowHalf),
+                                                            _mm256_srli_epi32(state, 16));
+                _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_cvtepi32_ps(difference), scale));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(states), state);
+            triangularDitherScalar(destination + i, states, count - i);
+        }
+
+        SYNTHESIZERBASE_TARGET_AVX2
+        void wavetableVoicesAvx2(const float* tables, float* phases, const float* increments,
+                                 const float* amplitudes, const int32_t* tableOffsets, int32_t voiceCount,
+                                 float tableLength, float* accumulator, int32_t framesCount) {
+            const __m256 lengths = _mm256_set1_ps(tableLength);
+            for (int32_t voice = 0; voice < voiceCount; voice += 8) {
+                __m256 phase = _mm256_loadu_ps(phases + voice);
+                const __m256 increment = _mm256_loadu_ps(increments + voice);
+                const __m256 amplitude = _mm256_loadu_ps(amplitudes + voice);
+                const __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tableOffsets + voice));
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    const __m256i whole = _mm256_cvttps_epi32(phase);
+                    const __m256 fraction = _mm256_sub_ps(phase, _mm256_cvtepi32_ps(whole));
+                    const __m256i indices = _mm256_add_epi32(offsets, whole);
+                    const __m256 a = _mm256_i32gather_ps(tables, indices, 4);
+                    const __m256 b = _mm256_i32gather_ps(tables + 1, indices, 4);
+                    const __m256 sample = _mm256_fmadd_ps(fraction, _mm256_sub_ps(b, a), a);
+                    float* destination = accumulator + frame * wavetableVoiceGroup;
+                    _mm256_storeu_ps(destination, _mm256_fmadd_ps(amplitude, sample, _mm256_loadu_ps(destination)));
+                    phase = _mm256_add_ps(phase, increment);
+                    phase = _mm256_sub_ps(phase,
+                                          _mm256_and_ps(_mm256_cmp_ps(phase, lengths, _CMP_GE_OQ), lengths));
+                }
+                _mm256_storeu_ps(phases + voice, phase);
+            }
+        }
+#endif
+
+#ifdef SYNTHESIZERBASE_NEON
+        // ---------------------------------------------------------------- NEON
+
+        void mixAccumulateNeon(float* destination, const float* source, float gain, int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(destination + i, vmlaq_n_f32(vld1q_f32(destination + i), vld1q_f32(source + i), gain));
+            }
+            mixAccumulateScalar(destination + i, source + i, gain, count - i);
+        }
+
+        void mixAccumulateRampNeon(float* destination, const float* source, float startGain, float gainStep,
+                                   int32_t count) {
+            const float offsets[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+            float32x4_t gains = vmlaq_n_f32(vdupq_n_f32(startGain), vld1q_f32(offsets), gainStep);
+            const float32x4_t increment = vdupq_n_f32(4.0f * gainStep);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(destination + i, vmlaq_f32(vld1q_f32(destination + i), gains, vld1q_f32(source + i)));
+                gains = vaddq_f32(gains, increment);
+            }
+            mixAccumulateRampScalar(destination + i, source + i, startGain + static_cast<float>(i) * gainStep,
+                                    gainStep, count - i);
+        }
+
+        void linearRampNeon(float* destination, float start, float step, int32_t count) {
+            const float offsets[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+            float32x4_t values = vmlaq_n_f32(vdupq_n_f32(start), vld1q_f32(offsets), step);
+            const float32x4_t increment = vdupq_n_f32(4.0f * step);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(destination + i, values);
+                values = vaddq_f32(values, increment);
+            }
+            linearRampScalar(destination + i, start + static_cast<float>(i) * step, step, count - i);
+        }
+
+        void exponentialRampNeon(float* destination, float offset, float scale, float factor, int32_t count) {
+            const float factor2 = factor * factor;
+            const float powers[4] = {1.0f, factor, factor2, factor2 * factor};
+            float32x4_t scales = vmulq_n_f32(vld1q_f32(powers), scale);
+            const float32x4_t offsets = vdupq_n_f32(offset);
+            const float factor4 = factor2 * factor2;
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(destination + i, vaddq_f32(offsets, scales));
+                scales = vmulq_n_f32(scales, factor4);
+            }
+            exponentialRampScalar(destination + i, offset, vgetq_lane_f32(scales, 0), factor, count - i);
+        }
+
+        void multiplyNeon(float* destination, const float* gains, int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(destination + i, vmulq_f32(vld1q_f32(destination + i), vld1q_f32(gains + i)));
+            }
+            multiplyScalar(destination + i, gains + i, count - i);
+        }
+
+        void scaleNeon(float* destination, float gain, int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(destination + i, vmulq_n_f32(vld1q_f32(destination + i), gain));
+            }
+            scaleScalar(destination + i, gain, count - i);
+        }
+
+        void interleaveNeon(float* interleaved, const float* planar, int32_t planarStride, int32_t framesCount,
+                            int32_t channelCount) {
+            if (channelCount != 2) {
+                interleaveScalar(interleaved, planar, planarStride, framesCount, channelCount);
+                return;
+            }
+            const float* left = planar;
+            const float* right = planar + planarStride;
+            int32_t i = 0;
+            for (; i + 4 <= framesCount; i += 4) {
+                float32x4x2_t frames;
+                frames.val[0] = vld1q_f32(left + i);
+                frames.val[1] = vld1q_f32(right + i);
+                vst2q_f32(interleaved + 2 * i, frames);
+            }
+            for (; i < framesCount; i++) {
+                interleaved[2 * i] = left[i];
+                interleaved[2 * i + 1] = right[i];
+            }
+        }
+
+        void deinterleaveNeon(float* planar, int32_t planarStride, const float* interleaved, int32_t framesCount,
+                              int32_t channelCount) {
+            if (channelCount != 2) {
+                deinterleaveScalar(planar, planarStride, interleaved, framesCount, channelCount);
+                return;
+            }
+            float* left = planar;
+            float* right = planar + planarStride;
+            int32_t i = 0;
+            for (; i + 4 <= framesCount; i += 4) {
+                const float32x4x2_t frames = vld2q_f32(interleaved + 2 * i);
+                vst1q_f32(left + i, frames.val[0]);
+                vst1q_f32(right + i, frames.val[1]);
+            }
+            for (; i < framesCount; i++) {
+                left[i] = interleaved[2 * i];
+                right[i] = interleaved[2 * i + 1];
+            }
+        }
+
+        inline int32x4_t quantizeNeon(const float* source, const float* dither, float fullScale, float maximum) {
+            float32x4_t value = vmulq_n_f32(vld1q_f32(source), fullScale);
+            if (dither != nullptr) {
+                value = vaddq_f32(value, vld1q_f32(dither));
+            }
+            value = vminq_f32(vmaxq_f32(value, vdupq_n_f32(-fullScale)), vdupq_n_f32(maximum));
+#if defined(__aarch64__)
+            return vcvtnq_s32_f32(value);
+#else
+            // No rounding conversion on 32-bit ARM: add 0.5 with the sign of the value and truncate
+            const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(value), vdupq_n_u32(0x80000000u));
+            const float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+            return vcvtq_s32_f32(vaddq_f32(value, half));
+#endif
+        }
+
+        void floatToInt16Neon(int16_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const int32x4_t low = quantizeNeon(source + i, dither != nullptr ? dither + i : nullptr,
+                                                   int16FullScale, int16Maximum);
+                const int32x4_t high = quantizeNeon(source + i + 4, dither != nullptr ? dither + i + 4 : nullptr,
+                                                    int16FullScale, int16Maximum);
+                vst1q_s16(destination + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+            }
+            floatToInt16Scalar(destination + i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        void floatToInt24Neon(uint8_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t values[4];
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_s32(values, quantizeNeon(source + i, dither != nullptr ? dither + i : nullptr, int24FullScale,
+                                               int24Maximum));
+                for (int32_t j = 0; j < 4; j++) {
+                    storeInt24(destination + 3 * (i + j), values[j]);
+                }
+            }
+            floatToInt24Scalar(destination + 3 * i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        void floatToInt32Neon(int32_t* destination, const float* source, const float* dither, int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                vst1q_s32(destination + i, quantizeNeon(source + i, dither != nullptr ? dither + i : nullptr,
+                                                        int32FullScale, int32Maximum));
+            }
+            floatToInt32Scalar(destination + i, source + i, dither != nullptr ? dither + i : nullptr, count - i);
+        }
+
+        float dotProductNeon(const float* a, const float* b, int32_t count) {
+            float32x4_t first = vdupq_n_f32(0.0f);
+            float32x4_t second = vdupq_n_f32(0.0f);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                first = vmlaq_f32(first, vld1q_f32(a + i), vld1q_f32(b + i));
+                second = vmlaq_f32(second, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            }
+            const float32x4_t sum = vaddq_f32(first, second);
+            const float32x2_t pairs = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+            return vget_lane_f32(vpadd_f32(pairs, pairs), 0) + dotProductScalar(a + i, b + i, count - i);
+        }
+
+        float interpolatedDotProductNeon(const float* input, const float* below, const float* above, float weight,
+                                         int32_t count) {
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t low = vld1q_f32(below + i);
+                const float32x4_t filter = vmlaq_n_f32(low, vsubq_f32(vld1q_f32(above + i), low), weight);
+                sum = vmlaq_f32(sum, vld1q_f32(input + i), filter);
+            }
+            const float32x2_t pairs = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+            return vget_lane_f32(vpadd_f32(pairs, pairs), 0) +
+                   interpolatedDotProductScalar(input + i, below + i, above + i, weight, count - i);
+        }
+
+        void complexMultiplyAccumulateNeon(float* accumulatorReal, float* accumulatorImaginary, const float* aReal,
+                                           const float* aImaginary, const float* bReal, const float* bImaginary,
+                                           int32_t count) {
+            int32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t ar = vld1q_f32(aReal + i);
+                const float32x4_t ai = vld1q_f32(aImaginary + i);
+                const float32x4_t br = vld1q_f32(bReal + i);
+                const float32x4_t bi = vld1q_f32(bImaginary + i);
+                vst1q_f32(accumulatorReal + i, vmlsq_f32(vmlaq_f32(vld1q_f32(accumulatorReal + i), ar, br), ai, bi));
+                vst1q_f32(accumulatorImaginary + i,
+                          vmlaq_f32(vmlaq_f32(vld1q_f32(accumulatorImaginary + i), ar, bi), ai, br));
+            }
+            complexMultiplyAccumulateScalar(accumulatorReal + i, accumulatorImaginary + i, aReal + i, aImaginary + i,
+                                            bReal + i, bImaginary + i, count - i);
+        }
+
+        inline float32x4_t nextTriangularNeon(uint32x4_t& state) {
+            state = veorq_u32(state, vshlq_n_u32(state, 13));
+            state = veorq_u32(state, vshrq_n_u32(state, 17));
+            state = veorq_u32(state, vshlq_n_u32(state, 5));
+            const int32x4_t difference = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(state, vdupq_n_u32(0xFFFFu))),
+                                                   vreinterpretq_s32_u32(vshrq_n_u32(state, 16)));
+            return vmulq_n_f32(vcvtq_f32_s32(difference), 1.0f / 65536.0f);
+        }
+
+        void triangularDitherNeon(float* destination, uint32_t* states, int32_t count) {
+            uint32x4_t low = vld1q_u32(states);
+            uint32x4_t high = vld1q_u32(states + 4);
+            int32_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                vst1q_f32(destination + i, nextTriangularNeon(low));
+                vst1q_f32(destination + i + 4, nextTriangularNeon(high));
+            }
+            vst1q_u32(states, low);
+            vst1q_u32(states + 4, high);
+            triangularDitherScalar(destination + i, states, count - i);
+        }
+
+        void wavetableVoicesNeon(const float* tables, float* phases, const float* increments,
+                                 const float* amplitudes, const int32_t* tableOffsets, int32_t voiceCount,
+                                 float tableLength, float* accumulator, int32_t framesCount) {
+            const float32x4_t lengths = vdupq_n_f32(tableLength);
+            int32_t indices[4];
+            float lower[4];
+            float upper[4];
+            // NEON has no gather: four voices at a time, the table reads are scalar
+            for (int32_t voice = 0; voice < voiceCount; voice += 4) {
+                float32x4_t phase = vld1q_f32(phases + voice);
+                const float32x4_t increment = vld1q_f32(increments + voice);
+                const float32x4_t amplitude = vld1q_f32(amplitudes + voice);
+                const int32x4_t offsets = vld1q_s32(tableOffsets + voice);
+                float* lane = accumulator + voice % wavetableVoiceGroup;
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    const int32x4_t whole = vcvtq_s32_f32(phase);
+                    const float32x4_t fraction = vsubq_f32(phase, vcvtq_f32_s32(whole));
+                    vst1q_s32(indices, vaddq_s32(offsets, whole));
+                    for (int32_t i = 0; i < 4; i++) {
+                        lower[i] = tables[indices[i]];
+                        upper[i] = tables[indices[i] + 1];
+                    }
+                    const float32x4_t a = vld1q_f32(lower);
+                    const float32x4_t sample = vmlaq_f32(a, fraction, vsubq_f32(vld1q_f32(upper), a));
+                    float* destination = lane + frame * wavetableVoiceGroup;
+                    vst1q_f32(destination, vmlaq_f32(vld1q_f32(destination), amplitude, sample));
+                    phase = vaddq_f32(phase, increment);
+                    const uint32x4_t wrap = vandq_u32(vcgeq_f32(phase, lengths), vreinterpretq_u32_f32(lengths));
+                    phase = vsubq_f32(phase, vreinterpretq_f32_u32(wrap));
+                }
+                vst1q_f32(phases + voice, phase);
+            }
+        }
+#endif
+
+        // ---------------------------------------------------------------- dispatch
+
+        struct KernelTable {
+            InstructionSet instructionSet;
+            void (*mixAccumulate)(float*, const float*, float, int32_t);
+            void (*mixAccumulateRamp)(float*, const float*, float, float, int32_t);
+            void (*linearRamp)(float*, float, float, int32_t);
+            void (*exponentialRamp)(float*, float, float, float, int32_t);
+            void (*multiply)(float*, const float*, int32_t);
+            void (*scale)(float*, float, int32_t);
+            void (*interleave)(float*, const float*, int32_t, int32_t, int32_t);
+            void (*deinterleave)(float*, int32_t, const float*, int32_t, int32_t);
+            void (*floatToInt16)(int16_t*, const float*, const float*, int32_t);
+            void (*floatToInt24)(uint8_t*, const float*, const float*, int32_t);
+            void (*floatToInt32)(int32_t*, const float*, const float*, int32_t);
+            float (*dotProduct)(const float*, const float*, int32_t);
+            float (*interpolatedDotProduct)(const float*, const float*, const float*, float, int32_t);
+            void (*complexMultiplyAccumulate)(float*, float*, const float*, const float*, const float*, const float*,
+                                              int32_t);
+            void (*triangularDither)(float*, uint32_t*, int32_t);
+            void (*wavetableVoices)(const float*, float*, const float*, const float*, const int32_t*, int32_t, float,
+                                    float*, int32_t);
+        };
+
+        const KernelTable scalarKernels = {
+                InstructionSet::Scalar,
+                mixAccumulateScalar,
+                mixAccumulateRampScalar,
+                linearRampScalar,
+                exponentialRampScalar,
+                multiplyScalar,
+                scaleScalar,
+                interleaveScalar,
+                deinterleaveScalar,
+                floatToInt16Scalar,
+                floatToInt24Scalar,
+                floatToInt32Scalar,
+                dotProductScalar,
+                interpolatedDotProductScalar,
+                complexMultiplyAccumulateScalar,
+                triangularDitherScalar,
+                wavetableVoicesScalar,
+        };
+
+#ifdef SYNTHESIZERBASE_X86
+        const KernelTable sse2Kernels = {
+                InstructionSet::Sse2,
+                mixAccumulateSse2,
+                mixAccumulateRampSse2,
+                linearRampSse2,
+                exponentialRampSse2,
+                multiplySse2,
+                scaleSse2,
+                interleaveSse2,
+                deinterleaveSse2,
+                floatToInt16Sse2,
+                floatToInt24Sse2,
+                floatToInt32Sse2,
+                dotProductSse2,
+                interpolatedDotProductSse2,
+                complexMultiplyAccumulateSse2,
+                triangularDitherSse2,
+                wavetableVoicesSse2,
+        };
+
+        const KernelTable avx2Kernels = {
+                InstructionSet::Avx2,
+                mixAccumulateAvx2,
+                mixAccumulateRampAvx2,
+                linearRampAvx2,
+                exponentialRampAvx2,
+                multiplyAvx2,
+                scaleAvx2,
+                interleaveAvx2,
+                deinterleaveAvx2,
+                floatToInt16Avx2,
+                floatToInt24Avx2,
+                floatToInt32Avx2,
+                dotProductAvx2,
+                interpolatedDotProductAvx2,
+                complexMultiplyAccumulateAvx2,
+                triangularDitherAvx2,
+                wavetableVoicesAvx2,
+        };
+#endif
+
+#ifdef SYNTHESIZERBASE_NEON
+        const KernelTable neonKernels = {
+                InstructionSet::Neon,
+                mixAccumulateNeon,
+                mixAccumulateRampNeon,
+                linearRampNeon,
+                exponentialRampNeon,
+                multiplyNeon,
+                scaleNeon,
+                interleaveNeon,
+                deinterleaveNeon,
+                floatToInt16Neon,
+                floatToInt24Neon,
+                floatToInt32Neon,
+                dotProductNeon,
+                interpolatedDotProductNeon,
+                complexMultiplyAccumulateNeon,
+                triangularDitherNeon,
+                wavetableVoicesNeon,
+        };
+#endif
+
+        const KernelTable* kernelsFor(InstructionSet instructionSet) {
+            switch (instructionSet) {
+#ifdef SYNTHESIZERBASE_X86
+                case InstructionSet::Avx2:
+                    __builtin_cpu_init();
+                    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                        return &avx2Kernels;
+                    }
+                    return nullptr;
+                case InstructionSet::Sse2:
+                    __builtin_cpu_init();
+                    return __builtin_cpu_supports("sse2") ? &sse2Kernels : nullptr;
+#endif
+#ifdef SYNTHESIZERBASE_NEON
+                case InstructionSet::Neon:
+                    return &neonKernels;
+#endif
+                case InstructionSet::Scalar:
+                    return &scalarKernels;
+                default:
+                    return nullptr;
+            }
+        }
+
+        const KernelTable* bestKernels() {
+            for (InstructionSet instructionSet : {InstructionSet::Avx2, InstructionSet::Neon, InstructionSet::Sse2}) {
+                const KernelTable* kernels = kernelsFor(instructionSet);
+                if (kernels != nullptr) {
+                    return kernels;
+                }
+            }
+            return &scalarKernels;
+        }
+
+        // Selected on first use; concurrent first uses select the same table, so no lock is needed
+        std::atomic<const KernelTable*> activeKernels{nullptr};
+
+        inline const KernelTable* kernels() {
+            const KernelTable* table = activeKernels.load(std::memory_order_acquire);
+            if (table == nullptr) {
+                table = bestKernels();
+                activeKernels.store(table, std::memory_order_release);
+            }
+            return table;
+        }
+
+    }  // namespace
+
+    InstructionSet activeInstructionSet() {
+        return kernels()->instructionSet;
+    }
+
+    const char* instructionSetName(InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case InstructionSet::Sse2:
+                return "sse2";
+            case InstructionSet::Avx2:
+                return "avx2";
+            case InstructionSet::Neon:
+                return "neon";
+            case InstructionSet::Scalar:
+            default:
+                return "scalar";
+        }
+    }
+
+    bool selectInstructionSet(InstructionSet instructionSet) {
+        const KernelTable* table = kernelsFor(instructionSet);
+        if (table == nullptr) {
+            return false;
+        }
+        activeKernels.store(table, std::memory_order_release);
+        return true;
+    }
+
+    void mixAccumulate(float* destination, const float* source, float gain, int32_t count) {
+        kernels()->mixAccumulate(destination, source, gain, count);
+    }
+
+    void mixAccumulateRamp(float* destination, const float* source, float startGain, float gainStep, int32_t count) {
+        kernels()->mixAccumulateRamp(destination, source, startGain, gainStep, count);
+    }
+
+    void linearRamp(float* destination, float start, float step, int32_t count) {
+        kernels()->linearRamp(destination, start, step, count);
+    }
+
+    void exponentialRamp(float* destination, float offset, float scale, float factor, int32_t count) {
+        kernels()->exponentialRamp(destination, offset, scale, factor, count);
+    }
+
+    void multiply(float* destination, const float* gains, int32_t count) {
+        kernels()->multiply(destination, gains, count);
+    }
+
+    void scale(float* destination, float gain, int32_t count) {
+        kernels()->scale(destination, gain, count);
+    }
+
+    void interleave(float* interleaved, const float* planar, int32_t planarStride, int32_t framesCount,
+                    int32_t channelCount) {
+        kernels()->interleave(interleaved, planar, planarStride, framesCount, channelCount);
+    }
+
+    void deinterleave(float* planar, int32_t planarStride, const float* interleaved, int32_t framesCount,
+                      int32_t channelCount) {
+        kernels()->deinterleave(planar, planarStride, interleaved, framesCount, channelCount);
+    }
+
+    void floatToInt16(int16_t* destination, const float* source, const float* dither, int32_t count) {
+        kernels()->floatToInt16(destination, source, dither, count);
+    }
+
+    void floatToInt24(uint8_t* destination, const float* source, const float* dither, int32_t count) {
+        kernels()->floatToInt24(destination, source, dither, count);
+    }
+
+    void floatToInt32(int32_t* destination, const float* source, const float* dither, int32_t count) {
+        kernels()->floatToInt32(destination, source, dither, count);
+    }
+
+    float dotProduct(const float* a, const float* b, int32_t count) {
+        return kernels()->dotProduct(a, b, count);
+    }
+
+    float interpolatedDotProduct(const float* input, const float* below, const float* above, float weight,
+                                 int32_t count) {
+        return kernels()->interpolatedDotProduct(input, below, above, weight, count);
+    }
+
+    void complexMultiplyAccumulate(float* accumulatorReal, float* accumulatorImaginary, const float* aReal,
+                                   const float* aImaginary, const float* bReal, const float* bImaginary,
+                                   int32_t count) {
+        kernels()->complexMultiplyAccumulate(accumulatorReal, accumulatorImaginary, aReal, aImaginary, bReal,
+                                             bImaginary, count);
+    }
+
+    void triangularDither(float* destination, uint32_t* states, int32_t count) {
+        kernels()->triangularDither(destination, states, count);
+    }
+
+    void wavetableVoices(const float* tables, float* phases, const float* increments, const float* amplitudes,
+                         const int32_t* tableOffsets, int32_t voiceCount, float tableLength, float* accumulator,
+                         int32_t framesCount) {
+        kernels()->wavetableVoices(tables, phases, increments, amplitudes, tableOffsets, voiceCount, tableLength,
+                                   accumulator, framesCount);
+    }
+
+}  // namespace simd
+}  // namespace synthesizerBase
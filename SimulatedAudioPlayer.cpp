@@ -0,0 +1,235 @@
+#include "include/SimulatedAudioPlayer.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+namespace synthesizerBase {
+
+    using Clock = std::chrono::steady_clock;
+
+    SimulatedAudioPlayer::SimulatedAudioPlayer(AudioSource* source, int samplingRate,
+                                               int32_t channelCount, int32_t framesPerDataCallback)
+            : _samplingRate(samplingRate),
+              _channelCount(channelCount),
+              _framesPerDataCallback(framesPerDataCallback),
+              _maxBlockSize(framesPerDataCallback) {
+        setAudioSource(source);
+        setAudioThreadFeatures(AudioThreadFlushDenormals);
+    }
+
+    SimulatedAudioPlayer::~SimulatedAudioPlayer() {
+        SimulatedAudioPlayer::stop();
+    }
+
+    void SimulatedAudioPlayer::setBlockSizeMode(BlockSizeMode mode) {
+        _blockSizeMode = mode;
+    }
+
+    void SimulatedAudioPlayer::setBlockSizeRange(int32_t minFrames, int32_t maxFrames) {
+        _minBlockSize = std::max(1, minFrames);
+        _maxBlockSize = std::max(_minBlockSize, maxFrames);
+    }
+
+    void SimulatedAudioPlayer::setBlockSizeSequence(const int32_t* framesCounts, int32_t count) {
+        _blockSizeSequence.clear();
+        for (int32_t i = 0; i < count; i++) {
+            _blockSizeSequence.push_back(std::max(1, framesCounts[i]));
+        }
+        _sequencePosition = 0;
+    }
+
+    void SimulatedAudioPlayer::setJitter(int32_t maxJitterMicroseconds) {
+        _maxJitterMicroseconds = std::max(0, maxJitterMicroseconds);
+    }
+
+    void SimulatedAudioPlayer::setPeriodScale(double scale) {
+        if (scale > 0.0) {
+            _periodScale = scale;
+        }
+    }
+
+    void SimulatedAudioPlayer::setRandomSeed(uint32_t seed) {
+        _randomState = seed != 0 ? seed : 0x9E3779B9u;
+    }
+
+    void SimulatedAudioPlayer::setSink(AudioSink* sink) {
+        _sink = sink;
+    }
+
+    int32_t SimulatedAudioPlayer::play() {
+        if (getAudioSource() == nullptr || _channelCount <= 0 || _framesPerDataCallback <= 0 || _samplingRate <= 0) {
+            return ResultErrorInvalidArgument;
+        }
+        if (_blockSizeMode == BlockSizeMode::Sequence && _blockSizeSequence.empty()) {
+            return ResultErrorInvalidArgument;
+        }
+        if (_running) {
+            return ResultErrorInvalidState;
+        }
+        if (_thread.joinable()) {
+            // Thread that ended itself through a stop() from within the callback
+            _thread.join();
+        }
+
+        _buffer.assign(static_cast<size_t>(maximumBlockSize()) * _channelCount, 0.0f);
+        _sequencePosition = 0;
+        resetStatistics();
+        configureTelemetry(_samplingRate);
+
+        if (_sink != nullptr) {
+            const int32_t openResult = _sink->open(_samplingRate, _channelCount);
+            if (openResult != ResultOk) {
+                return openResult;
+            }
+        }
+
+        _running = true;
+        _thread = std::thread(&SimulatedAudioPlayer::runCallbackThread, this);
+        return ResultOk;
+    }
+
+    void SimulatedAudioPlayer::stop() {
+        const bool wasRunning = _running.exchange(false);
+        if (_thread.joinable() && _thread.get_id() != std::this_thread::get_id()) {
+            _thread.join();
+        }
+        if (wasRunning) {
+            notifyPlaybackStopped();
+        }
+    }
+
+    int32_t SimulatedAudioPlayer::getChannelCount() {
+        return _channelCount;
+    }
+
+    int32_t SimulatedAudioPlayer::getFramesPerDataCallback() {
+        return _framesPerDataCallback;
+    }
+
+    int64_t SimulatedAudioPlayer::getCallbackCount() const {
+        return _callbackCount.load(std::memory_order_relaxed);
+    }
+
+    int64_t SimulatedAudioPlayer::getMissedDeadlineCount() const {
+        return _missedDeadlineCount.load(std::memory_order_relaxed);
+    }
+
+    int64_t SimulatedAudioPlayer::getMinimumHeadroomNanos() const {
+        return _minimumHeadroomNanos.load(std::memory_order_relaxed);
+    }
+
+    int64_t SimulatedAudioPlayer::getMaximumCallbackNanos() const {
+        return _maximumCallbackNanos.load(std::memory_order_relaxed);
+    }
+
+    void SimulatedAudioPlayer::resetStatistics() {
+        _callbackCount = 0;
+        _missedDeadlineCount = 0;
+        _minimumHeadroomNanos = INT64_MAX;
+        _maximumCallbackNanos = 0;
+    }
+
+    void SimulatedAudioPlayer::runCallbackThread() {
+        const auto channelCount = static_cast<ChannelCount>(_channelCount);
+        // Blocks go to the sink in the layout it stores, without a conversion in between
+        const SampleLayout layout = _sink != nullptr ? _sink->getLayout() : SampleLayout::Planar;
+        const double nanosPerFrame = 1e9 * _periodScale / _samplingRate;
+
+        // Nominal start of the next callback on the simulated audio clock
+        Clock::time_point scheduled = Clock::now();
+        bool stoppedBySink = false;
+
+        while (_running.load(std::memory_order_relaxed)) {
+            const int32_t framesCount = nextBlockSize();
+            const auto period = std::chrono::nanoseconds(static_cast<int64_t>(framesCount * nanosPerFrame));
+            const Clock::time_point deadline = scheduled + period;
+
+            Clock::time_point wakeUp = scheduled;
+            if (_maxJitterMicroseconds > 0) {
+                wakeUp += std::chrono::microseconds(nextRandom() % (_maxJitterMicroseconds + 1));
+            }
+            std::this_thread::sleep_until(wakeUp);
+
+            const Clock::time_point callbackStart = Clock::now();
+            renderAudio(_buffer.data(), framesCount, channelCount, layout);
+            const Clock::time_point callbackEnd = Clock::now();
+
+            const int64_t callbackNanos =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(callbackEnd - callbackStart).count();
+            const int64_t headroomNanos =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - callbackEnd).count();
+
+            _callbackCount.fetch_add(1, std::memory_order_relaxed);
+            if (callbackNanos > _maximumCallbackNanos.load(std::memory_order_relaxed)) {
+                _maximumCallbackNanos.store(callbackNanos, std::memory_order_relaxed);
+            }
+            if (headroomNanos < _minimumHeadroomNanos.load(std::memory_order_relaxed)) {
+                _minimumHeadroomNanos.store(headroomNanos, std::memory_order_relaxed);
+            }
+
+            if (headroomNanos < 0) {
+                // Underrun: the device restarts from the moment data is available again
+                _missedDeadlineCount.fetch_add(1, std::memory_order_relaxed);
+                reportXRunCount(static_cast<int32_t>(_missedDeadlineCount.load(std::memory_order_relaxed)));
+                scheduled = callbackEnd;
+            } else {
+                scheduled = deadline;
+            }
+
+            if (_sink != nullptr && _sink->write(_buffer.data(), framesCount, _channelCount) != ResultOk) {
+                // Stopped here rather than by stop(), which then finds the player stopped and does not notify
+                stoppedBySink = _running.exchange(false);
+            }
+        }
+
+        if (_sink != nullptr) {
+            _sink->close();
+        }
+        if (stoppedBySink) {
+            notifyPlaybackStopped();
+        }
+    }
+
+    int32_t SimulatedAudioPlayer::nextBlockSize() {
+        switch (_blockSizeMode) {
+            case BlockSizeMode::Random:
+                return _minBlockSize +
+                       static_cast<int32_t>(nextRandom() % static_cast<uint32_t>(_maxBlockSize - _minBlockSize + 1));
+            case BlockSizeMode::SingleFrame:
+                return 1;
+            case BlockSizeMode::Sequence: {
+                const int32_t framesCount = _blockSizeSequence[_sequencePosition];
+                _sequencePosition = (_sequencePosition + 1) % _blockSizeSequence.size();
+                return framesCount;
+            }
+            case BlockSizeMode::Fixed:
+            default:
+                return _framesPerDataCallback;
+        }
+    }
+
+    int32_t SimulatedAudioPlayer::maximumBlockSize() const {
+        switch (_blockSizeMode) {
+            case BlockSizeMode::Random:
+                return _maxBlockSize;
+            case BlockSizeMode::SingleFrame:
+                return 1;
+            case BlockSizeMode::Sequence:
+                return *std::max_element(_blockSizeSequence.begin(), _blockSizeSequence.end());
+            case BlockSizeMode::Fixed:
+            default:
+                return _framesPerDataCallback;
+        }
+    }
+
+    uint32_t SimulatedAudioPlayer::nextRandom() {
+        uint32_t x = _randomState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        _randomState = x;
+        return x;
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,505 @@
+
+#include "include/StreamingSampleAudioSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+
+namespace synthesizerBase {
+
+    namespace {
+        // Nice value of the prefetch thread: below the audio thread and the UI
+        constexpr int prefetcherNice = 10;
+
+        // Interval at which the prefetch thread follows the voices
+        constexpr auto prefetchInterval = std::chrono::milliseconds(5);
+
+        constexpr uint64_t readyFrameMask = (uint64_t(1) << 40) - 1;
+        constexpr uint32_t readyGenerationMask = (1u << 24) - 1;
+
+        uint32_t readUint32(const uint8_t* bytes) {
+            return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        }
+
+        uint16_t readUint16(const uint8_t* bytes) {
+            return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+        }
+
+        uint64_t packReady(uint32_t generation, int64_t frames) {
+            return (static_cast<uint64_t>(generation & readyGenerationMask) << 40) |
+                   (static_cast<uint64_t>(frames) & readyFrameMask);
+        }
+
+        /**
+         * Reading one sample of each encoding; little endian files on a little endian host
+         */
+        template<int Encoding>
+        struct Decoder;
+
+        template<>
+        struct Decoder<0> {
+            static constexpr int32_t bytes = 2;
+
+            static float read(const uint8_t* source) {
+                int16_t value;
+                memcpy(&value, source, sizeof(value));
+                return static_cast<float>(value) * (1.0f / 32768.0f);
+            }
+        };
+
+        template<>
+        struct Decoder<1> {
+            static constexpr int32_t bytes = 3;
+
+            static float read(const uint8_t* source) {
+                const auto value = static_cast<int32_t>(static_cast<uint32_t>(source[0]) << 8 |
+                                                        static_cast<uint32_t>(source[1]) << 16 |
+                                                        static_cast<uint32_t>(source[2]) << 24) >> 8;
+                return static_cast<float>(value) * (1.0f / 8388608.0f);
+            }
+        };
+
+        template<>
+        struct Decoder<2> {
+            static constexpr int32_t bytes = 4;
+
+            static float read(const uint8_t* source) {
+                float value;
+                memcpy(&value, source, sizeof(value));
+                return value;
+            }
+        };
+    }
+
+    StreamingSampleAudioSource::StreamingSampleAudioSource(int samplingRate, int32_t channelCount,
+                                                           int32_t voiceCount, int32_t residentFrames,
+                                                           int32_t prefetchFrames)
+            : _samplingRate(samplingRate),
+              _channelCount(std::max(1, channelCount)),
+              _residentFrames(std::max(0, residentFrames)),
+              _prefetchFrames(std::max(1, prefetchFrames)),
+              _releaseFrames(std::max(1, samplingRate / 100)),
+              _pageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE))),
+              _pool(std::max(1, voiceCount)),
+              _voices(static_cast<size_t>(std::max(1, voiceCount))),
+              _releasedVoices(static_cast<size_t>(std::max(1, voiceCount))),
+              _shared(new SharedVoice[std::max(1, voiceCount)]),
+              _windows(static_cast<size_t>(std::max(1, voiceCount))) {
+        std::fill(_noteSamples, _noteSamples + VoicePool::noteCount, -1);
+    }
+
+    StreamingSampleAudioSource::~StreamingSampleAudioSource() {
+        stop();
+        for (const auto& sample : _samples) {
+            munmap(const_cast<uint8_t*>(sample->map), sample->mapBytes);
+        }
+    }
+
+    int32_t StreamingSampleAudioSource::addSample(const char* path, int32_t note) {
+        if (_running.load()) {
+            return ResultErrorInvalidState;
+        }
+        if (note < 0 || note >= VoicePool::noteCount) {
+            return ResultErrorInvalidArgument;
+        }
+        const int file = open(path, O_RDONLY);
+        if (file < 0) {
+            return ResultErrorIO;
+        }
+        struct stat status{};
+        void* map = MAP_FAILED;
+        if (fstat(file, &status) == 0 && status.st_size >= 12) {
+            map = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        close(file); // the mapping keeps the file
+        if (map == MAP_FAILED) {
+            return ResultErrorIO;
+        }
+        std::unique_ptr<Sample> sample(new Sample());
+        sample->map = static_cast<const uint8_t*>(map);
+        sample->mapBytes = static_cast<size_t>(status.st_size);
+
+        // RIFF chunks: the format, then the data
+        const uint8_t* bytes = sample->map;
+        const size_t size = sample->mapBytes;
+        int32_t formatTag = 0;
+        int32_t bits = 0;
+        uint32_t rate = 0;
+        bool valid = memcmp(bytes, "RIFF", 4) == 0 && memcmp(bytes + 8, "WAVE", 4) == 0;
+        for (size_t chunk = 12; valid && chunk + 8 <= size;) {
+            const uint32_t chunkBytes = readUint32(bytes + chunk + 4);
+            const uint8_t* body = bytes + chunk + 8;
+            if (memcmp(bytes + chunk, "fmt ", 4) == 0 && chunkBytes >= 16 && chunk + 8 + 16 <= size) {
+                formatTag = readUint16(body);
+                sample->channels = readUint16(body + 2);
+                rate = readUint32(body + 4);
+                bits = readUint16(body + 14);
+                if (formatTag == 0xFFFE && chunkBytes >= 26 && chunk + 8 + 26 <= size) {
+                    formatTag = readUint16(body + 24); // extensible format: the subformat GUID starts with the tag
+                }
+            } else if (memcmp(bytes + chunk, "data", 4) == 0) {
+                sample->data = body;
+                const size_t dataBytes = std::min<size_t>(chunkBytes, size - (chunk + 8));
+                sample->frameBytes = sample->channels * (bits / 8);
+                sample->frames = sample->frameBytes > 0 ? static_cast<int64_t>(dataBytes / sample->frameBytes) : 0;
+                break;
+            }
+            chunk += 8 + chunkBytes + (chunkBytes & 1);
+        }
+        if (formatTag == 1 && bits == 16) {
+            sample->encoding = Encoding::Int16;
+        } else if (formatTag == 1 && bits == 24) {
+            sample->encoding = Encoding::Int24;
+        } else if (formatTag == 3 && bits == 32) {
+            sample->encoding = Encoding::Float;
+        } else {
+            valid = false;
+        }
+        if (!valid || sample->data == nullptr || sample->channels <= 0 || static_cast<int>(rate) != _samplingRate) {
+            munmap(map, size);
+            return ResultErrorInvalidArgument;
+        }
+
+        // Decode the resident part, then let the kernel drop its pages, which the voices will not read
+        sample->residentFrames = std::min<int64_t>(sample->frames, _residentFrames);
+        sample->resident.resize(static_cast<size_t>(sample->residentFrames * sample->channels));
+        const int64_t residentSamples = sample->residentFrames * sample->channels;
+        const int32_t sampleBytes = sample->frameBytes / sample->channels;
+        for (int64_t i = 0; i < residentSamples; i++) {
+            const uint8_t* source = sample->data + i * sampleBytes;
+            switch (sample->encoding) {
+                case Encoding::Int16:
+                    sample->resident[i] = Decoder<0>::read(source);
+                    break;
+                case Encoding::Int24:
+                    sample->resident[i] = Decoder<1>::read(source);
+                    break;
+                case Encoding::Float:
+                    sample->resident[i] = Decoder<2>::read(source);
+                    break;
+            }
+        }
+        const size_t residentEnd = static_cast<size_t>(sample->data - sample->map) +
+                                   static_cast<size_t>(sample->residentFrames) * sample->frameBytes;
+        const size_t droppable = residentEnd / _pageSize * _pageSize;
+        if (droppable > 0) {
+            madvise(map, droppable, MADV_DONTNEED);
+        }
+
+        _samples.push_back(std::move(sample));
+        _noteSamples[note] = static_cast<int32_t>(_samples.size()) - 1;
+        return _noteSamples[note];
+    }
+
+    void StreamingSampleAudioSource::setPageLocking(bool enabled) {
+        _pageLocking = enabled;
+    }
+
+    int32_t StreamingSampleAudioSource::start() {
+        if (_running.exchange(true)) {
+            return ResultErrorInvalidState;
+        }
+        _prefetcher = std::thread(&StreamingSampleAudioSource::runPrefetcher, this);
+        return ResultOk;
+    }
+
+    void StreamingSampleAudioSource::stop() {
+        _running.store(false);
+        if (_prefetcher.joinable()) {
+            _prefetcher.join();
+        }
+    }
+
+    void StreamingSampleAudioSource::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+        if (static_cast<int32_t>(channelCount) != _channelCount) {
+            return;
+        }
+        // From the end: freeing a voice moves the last active voice into its place
+        for (int32_t i = _pool.activeCount() - 1; i >= 0; i--) {
+            const int32_t voice = _pool.activeVoices()[i];
+            if (!renderVoice(voice, audioData, framesCount)) {
+                _voices[voice].sample = -1;
+                _shared[voice].request.store(0, std::memory_order_release);
+                _pool.freeVoice(voice);
+            }
+        }
+        _pool.endBlock();
+    }
+
+    void StreamingSampleAudioSource::onPlaybackStopped() {
+        for (int32_t voice = 0; voice < static_cast<int32_t>(_voices.size()); voice++) {
+            _voices[voice].sample = -1;
+            _shared[voice].request.store(0, std::memory_order_release);
+        }
+        _pool.reset();
+    }
+
+    void StreamingSampleAudioSource::onAudioEvent(const AudioEvent& event) {
+        if (event.index < 0 || event.index >= VoicePool::noteCount) {
+            return;
+        }
+        if (event.type == AudioEventNoteOn) {
+            const int32_t sample = _noteSamples[event.index];
+            if (sample < 0) {
+                return;
+            }
+            const int32_t voice = _pool.noteOn(event.index, event.value);
+            if (voice < 0) {
+                return;
+            }
+            Voice& state = _voices[voice];
+            state.sample = sample;
+            state.generation++;
+            state.position = 0;
+            state.gain = event.value;
+            state.release = 1.0f;
+            state.releaseStep = 0.0f;
+            // The position first: the prefetcher reads it after the request
+            _shared[voice].position.store(0, std::memory_order_relaxed);
+            _shared[voice].request.store(static_cast<uint64_t>(state.generation) << 32 |
+                                         static_cast<uint32_t>(sample + 1), std::memory_order_release);
+        } else if (event.type == AudioEventNoteOff) {
+            const int32_t released = _pool.noteOff(event.index, _releasedVoices.data());
+            for (int32_t i = 0; i < released; i++) {
+                _voices[_releasedVoices[i]].releaseStep = 1.0f / static_cast<float>(_releaseFrames);
+            }
+        }
+    }
+
+    bool StreamingSampleAudioSource::isIdle() const {
+        return _pool.activeCount() == 0;
+    }
+
+    int64_t StreamingSampleAudioSource::getMissCount() const {
+        return _missCount.load(std::memory_order_relaxed);
+    }
+
+    int64_t StreamingSampleAudioSource::getMissedFrames() const {
+        return _missedFrames.load(std::memory_order_relaxed);
+    }
+
+    int64_t StreamingSampleAudioSource::getResidentBytes() const {
+        int64_t bytes = 0;
+        for (const auto& sample : _samples) {
+            bytes += static_cast<int64_t>(sample->resident.size() * sizeof(float));
+        }
+        return bytes;
+    }
+
+    int64_t StreamingSampleAudioSource::getMappedBytes() const {
+        int64_t bytes = 0;
+        for (const auto& sample : _samples) {
+            bytes += static_cast<int64_t>(sample->mapBytes);
+        }
+        return bytes;
+    }
+
+    int32_t StreamingSampleAudioSource::getSampleCount() const {
+        return static_cast<int32_t>(_samples.size());
+    }
+
+    template<StreamingSampleAudioSource::Encoding SourceEncoding>
+    void StreamingSampleAudioSource::mixFrames(Voice& voice, const Sample& sample, float* output,
+                                               int32_t framesCount, int32_t offset, const uint8_t* source,
+                                               int32_t count) {
+        using Decode = Decoder<static_cast<int>(SourceEncoding)>;
+        const int32_t sourceChannels = sample.channels;
+        const int32_t sourceStride = sourceChannels * Decode::bytes;
+        // One channel after the other, such that held notes mix with a constant gain
+        for (int32_t channel = 0; channel < _channelCount; channel++) {
+            const uint8_t* input = source + (sourceChannels == 1 ? 0 : channel % sourceChannels) * Decode::bytes;
+            float* destination = output + static_cast<int64_t>(channel) * framesCount + offset;
+            if (voice.releaseStep == 0.0f) {
+                const float gain = voice.gain * voice.release;
+                for (int32_t frame = 0; frame < count; frame++) {
+                    destination[frame] += gain * Decode::read(input + static_cast<int64_t>(frame) * sourceStride);
+                }
+            } else {
+                float release = voice.release;
+                for (int32_t frame = 0; frame < count; frame++) {
+                    destination[frame] += voice.gain * release *
+                                          Decode::read(input + static_cast<int64_t>(frame) * sourceStride);
+                    release = std::max(0.0f, release - voice.releaseStep);
+                }
+            }
+        }
+        voice.release = std::max(0.0f, voice.release - voice.releaseStep * static_cast<float>(count));
+    }
+
+    bool StreamingSampleAudioSource::renderVoice(int32_t voice, float* output, int32_t framesCount) {
+        Voice& state = _voices[voice];
+        const Sample& sample = *_samples[state.sample];
+        const int64_t end = std::min<int64_t>(state.position + framesCount, sample.frames);
+        int32_t offset = 0;
+
+        // Resident part
+        if (state.position < sample.residentFrames) {
+            const auto count = static_cast<int32_t>(std::min(end, sample.residentFrames) - state.position);
+            mixFrames<Encoding::Float>(state, sample, output, framesCount, offset,
+                                       reinterpret_cast<const uint8_t*>(sample.resident.data() +
+                                                                        state.position * sample.channels), count);
+            state.position += count;
+            offset += count;
+        }
+
+        // Streamed part, up to the frames the prefetcher has brought into memory for this note
+        if (state.position < end) {
+            const uint64_t ready = _shared[voice].ready.load(std::memory_order_acquire);
+            const int64_t readyEnd = (ready >> 40) == (state.generation & readyGenerationMask) ?
+                                     static_cast<int64_t>(ready & readyFrameMask) : 0;
+            const auto count = static_cast<int32_t>(std::max<int64_t>(0, std::min(end, readyEnd) - state.position));
+            if (count > 0) {
+                const uint8_t* source = sample.data + state.position * sample.frameBytes;
+                switch (sample.encoding) {
+                    case Encoding::Int16:
+                        mixFrames<Encoding::Int16>(state, sample, output, framesCount, offset, source, count);
+                        break;
+                    case Encoding::Int24:
+                        mixFrames<Encoding::Int24>(state, sample, output, framesCount, offset, source, count);
+                        break;
+                    case Encoding::Float:
+                        mixFrames<Encoding::Float>(state, sample, output, framesCount, offset, source, count);
+                        break;
+                }
+                state.position += count;
+            }
+            if (state.position < end) {
+                // Late: keep time with silence
+                const int64_t missed = end - state.position;
+                _missCount.fetch_add(1, std::memory_order_relaxed);
+                _missedFrames.fetch_add(missed, std::memory_order_relaxed);
+                state.release = std::max(0.0f, state.release - state.releaseStep * static_cast<float>(missed));
+                state.position = end;
+            }
+        }
+
+        _shared[voice].position.store(state.position, std::memory_order_relaxed);
+        _pool.setLevel(voice, state.gain * state.release);
+        return state.position < sample.frames && state.release > 0.0f;
+    }
+
+    void StreamingSampleAudioSource::runPrefetcher() {
+#if defined(__linux__)
+        // Per thread on Linux and Android
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), prefetcherNice);
+#endif
+        while (_running.load(std::memory_order_acquire)) {
+            for (int32_t voice = 0; voice < static_cast<int32_t>(_windows.size()); voice++) {
+                prefetchVoice(voice);
+            }
+            std::this_thread::sleep_for(prefetchInterval);
+        }
+        // Release what is still locked
+        for (int32_t voice = 0; voice < static_cast<int32_t>(_windows.size()); voice++) {
+            PrefetchWindow& window = _windows[voice];
+            if (window.sample >= 0) {
+                unlockExcept(voice, window.sample, window.begin, window.end);
+            }
+            window = PrefetchWindow();
+        }
+    }
+
+    void StreamingSampleAudioSource::prefetchVoice(int32_t voice) {
+        PrefetchWindow& window = _windows[voice];
+        const uint64_t request = _shared[voice].request.load(std::memory_order_acquire);
+        const auto generation = static_cast<uint32_t>(request >> 32);
+        const int32_t sampleIndex = static_cast<int32_t>(request & 0xFFFFFFFFu) - 1;
+        if (window.sample != sampleIndex || window.generation != generation) {
+            // Another note: release the pages of the previous one
+            if (window.sample >= 0) {
+                unlockExcept(voice, window.sample, window.begin, window.end);
+            }
+            window = PrefetchWindow();
+            window.sample = sampleIndex;
+            window.generation = generation;
+        }
+        if (sampleIndex < 0) {
+            return;
+        }
+        const Sample& sample = *_samples[sampleIndex];
+        const int64_t position = _shared[voice].position.load(std::memory_order_relaxed);
+        const int64_t firstFrame = std::max(position, sample.residentFrames);
+        const int64_t endFrame = std::min(firstFrame + _prefetchFrames, sample.frames);
+        if (firstFrame >= endFrame) {
+            _shared[voice].ready.store(packReady(generation, sample.frames), std::memory_order_release);
+            return;
+        }
+        const auto dataOffset = static_cast<size_t>(sample.data - sample.map);
+        const size_t begin = (dataOffset + static_cast<size_t>(firstFrame) * sample.frameBytes) / _pageSize *
+                             _pageSize;
+        const size_t end = std::min(sample.mapBytes, (dataOffset + static_cast<size_t>(endFrame) * sample.frameBytes +
+                                                      _pageSize - 1) / _pageSize * _pageSize);
+        if (window.end <= window.begin) {
+            window.begin = begin;
+            window.end = begin;
+        }
+        if (end > window.end) {
+            const size_t fetchBegin = std::max(window.end, begin);
+            auto* pages = const_cast<uint8_t*>(sample.map) + fetchBegin;
+            madvise(pages, end - fetchBegin, MADV_WILLNEED);
+            // Fault the pages in here, not on the audio thread
+            uint8_t sum = 0;
+            for (size_t offset = fetchBegin; offset < end; offset += _pageSize) {
+                sum += *static_cast<volatile const uint8_t*>(sample.map + offset);
+            }
+            (void) sum;
+            // Pages that could not be locked may be evicted again before they are played: retried next time
+            if (!_pageLocking || mlock(pages, end - fetchBegin) == 0) {
+                window.end = end;
+            }
+        }
+        if (begin > window.begin) {
+            unlockExcept(voice, sampleIndex, window.begin, std::min(begin, window.end));
+            window.begin = std::min(begin, window.end);
+        }
+        int64_t readyFrame = endFrame;
+        if (window.end < end) {
+            // Ready up to the last frame entirely within the locked pages
+            const int64_t lockedBytes = static_cast<int64_t>(window.end) - static_cast<int64_t>(dataOffset);
+            readyFrame = std::min(endFrame, std::max(firstFrame, lockedBytes / sample.frameBytes));
+        }
+        _shared[voice].ready.store(packReady(generation, readyFrame), std::memory_order_release);
+    }
+
+    void StreamingSampleAudioSource::unlockExcept(int32_t voice, int32_t sample, size_t begin, size_t end) {
+        if (!_pageLocking) {
+            return;
+        }
+        size_t cursor = begin;
+        while (cursor < end) {
+            // Skip the parts covered by the window of another voice of the same sample
+            size_t next = end;
+            bool covered = false;
+            for (int32_t other = 0; other < static_cast<int32_t>(_windows.size()); other++) {
+                const PrefetchWindow& window = _windows[other];
+                if (other == voice || window.sample != sample || window.end <= window.begin) {
+                    continue;
+                }
+                if (window.begin <= cursor && cursor < window.end) {
+                    cursor = window.end;
+                    covered = true;
+                    break;
+                }
+                if (window.begin > cursor) {
+                    next = std::min(next, window.begin);
+                }
+            }
+            if (covered) {
+                continue;
+            }
+            munlock(_samples[sample]->map + cursor, next - cursor);
+            cursor = next;
+        }
+    }
+
+}  // namespace synthesizerBase
@@ -1,5 +1,4 @@
 
-#include "include/OboeAudioPlayer.h"
 #include "include/Synthesizer.h"
 
 
@@ -10,11 +9,28 @@ namespace synthesizerBase {
         return _isPlaying;
     }
 
-   void Synthesizer::setAudioSource(AudioSource* source){
+   int32_t Synthesizer::setAudioSource(AudioSource* source){
         if(_audioPlayer != nullptr)
         {
-            _audioPlayer->setAudioSource(source);
+            return(_audioPlayer->setAudioSource(source));
         }
+        return ResultErrorInvalidState;
+    }
+
+   int32_t Synthesizer::setAudioSource(AudioSource* source, int32_t crossfadeFrames){
+        if(_audioPlayer != nullptr)
+        {
+            return(_audioPlayer->setAudioSource(source, crossfadeFrames));
+        }
+        return ResultErrorInvalidState;
+    }
+
+    AudioSource* Synthesizer::collectRetiredAudioSource(){
+        if(_audioPlayer != nullptr)
+        {
+            return(_audioPlayer->collectRetiredAudioSource());
+        }
+        return nullptr;
     }
 
     AudioSource* Synthesizer::getAudioSource(){
@@ -25,6 +41,29 @@ namespace synthesizerBase {
         return nullptr;
     };
 
+    int32_t Synthesizer::postEvent(const AudioEvent& event){
+        if(_audioPlayer != nullptr)
+        {
+            return(_audioPlayer->postEvent(event));
+        }
+        return ResultErrorInvalidState;
+    }
+
+    int64_t Synthesizer::getFrameTime() const{
+        if(_audioPlayer != nullptr)
+        {
+            return(_audioPlayer->getFrameTime());
+        }
+        return 0;
+    }
+
+    void Synthesizer::setThreadPool(RealtimeThreadPool* pool){
+        if(_audioPlayer != nullptr)
+        {
+            _audioPlayer->setThreadPool(pool);
+        }
+    }
+
 
 
 
@@ -0,0 +1,241 @@
+
+#include "include/VoicePool.h"
+
+#include <algorithm>
+
+
+namespace synthesizerBase {
+
+    VoicePool::VoicePool(int32_t capacity, StealMode stealMode)
+            : _capacity(std::max(1, capacity)),
+              _stealMode(stealMode),
+              _notes(static_cast<size_t>(_capacity)),
+              _velocities(static_cast<size_t>(_capacity)),
+              _levels(static_cast<size_t>(_capacity)),
+              _states(static_cast<size_t>(_capacity)),
+              _startSerials(static_cast<size_t>(_capacity)),
+              _olderVoices(static_cast<size_t>(_capacity)),
+              _newerVoices(static_cast<size_t>(_capacity)),
+              _activePositions(static_cast<size_t>(_capacity)),
+              _olderNoteVoices(static_cast<size_t>(_capacity)),
+              _newerNoteVoices(static_cast<size_t>(_capacity)),
+              _active(static_cast<size_t>(_capacity)),
+              _activeCount(0),
+              _freeVoices(static_cast<size_t>(_capacity)),
+              _freeCount(0),
+              _oldestVoice(noVoice),
+              _newestVoice(noVoice),
+              _noteVoices(static_cast<size_t>(noteCount)),
+              _quietOrder(static_cast<size_t>(_capacity)),
+              _quietCount(0),
+              _quietCursor(0),
+              _quietSerial(0),
+              _serial(0),
+              _stolenCount(0) {
+        reset();
+    }
+
+    void VoicePool::reset() {
+        for (int32_t voice = 0; voice < _capacity; voice++) {
+            _states[voice] = VoiceFree;
+            _notes[voice] = noVoice;
+            _levels[voice] = 0.0f;
+            _olderVoices[voice] = noVoice;
+            _newerVoices[voice] = noVoice;
+            _activePositions[voice] = noVoice;
+            _olderNoteVoices[voice] = noVoice;
+            _newerNoteVoices[voice] = noVoice;
+            // Popped from the end: voice 0 is used first
+            _freeVoices[voice] = _capacity - 1 - voice;
+        }
+        _freeCount = _capacity;
+        _activeCount = 0;
+        _oldestVoice = noVoice;
+        _newestVoice = noVoice;
+        for (int32_t note = 0; note < noteCount; note++) {
+            _noteVoices[note] = noVoice;
+        }
+        _quietCount = 0;
+        _quietCursor = 0;
+        _stolenCount = 0;
+    }
+
+    int32_t VoicePool::noteOn(int32_t note, float velocity, int32_t* stolenNote) {
+        if (stolenNote != nullptr) {
+            *stolenNote = noVoice;
+        }
+        if (note < 0 || note >= noteCount) {
+            return ResultErrorInvalidArgument;
+        }
+
+        int32_t voice = noVoice;
+        if (_stealMode == StealMode::SameNote && _noteVoices[note] != noVoice) {
+            voice = _noteVoices[note];
+        } else if (_freeCount > 0) {
+            voice = _freeVoices[--_freeCount];
+        } else {
+            voice = selectVoiceToSteal();
+            if (voice == noVoice) {
+                return ResultErrorInvalidState;
+            }
+        }
+
+        if (_states[voice] == VoiceFree) {
+            _activePositions[voice] = _activeCount;
+            _active[_activeCount++] = voice;
+        } else {
+            // Retriggered or stolen
+            if (stolenNote != nullptr) {
+                *stolenNote = _notes[voice];
+            }
+            if (_notes[voice] != note) {
+                _stolenCount++;
+            }
+            removeFromNoteList(voice);
+            removeFromAgeList(voice);
+        }
+
+        _notes[voice] = note;
+        _velocities[voice] = velocity;
+        _levels[voice] = velocity;
+        _states[voice] = VoicePlaying;
+        _startSerials[voice] = ++_serial;
+        appendToNoteList(voice, note);
+        appendToAgeList(voice);
+        return voice;
+    }
+
+    int32_t VoicePool::noteOff(int32_t note, int32_t* releasedVoices) {
+        if (note < 0 || note >= noteCount) {
+            return 0;
+        }
+        int32_t released = 0;
+        for (int32_t voice = _noteVoices[note]; voice != noVoice; voice = _olderNoteVoices[voice]) {
+            if (_states[voice] == VoicePlaying) {
+                _states[voice] = VoiceReleasing;
+                if (releasedVoices != nullptr) {
+                    releasedVoices[released] = voice;
+                }
+                released++;
+            }
+        }
+        return released;
+    }
+
+    void VoicePool::allNotesOff() {
+        for (int32_t i = 0; i < _activeCount; i++) {
+            _states[_active[i]] = VoiceReleasing;
+        }
+    }
+
+    void VoicePool::freeVoice(int32_t voice) {
+        if (voice < 0 || voice >= _capacity || _states[voice] == VoiceFree) {
+            return;
+        }
+        removeFromAgeList(voice);
+
+        const int32_t position = _activePositions[voice];
+        const int32_t last = _active[--_activeCount];
+        _active[position] = last;
+        _activePositions[last] = position;
+        _activePositions[voice] = noVoice;
+
+        removeFromNoteList(voice);
+        _states[voice] = VoiceFree;
+        _levels[voice] = 0.0f;
+        _freeVoices[_freeCount++] = voice;
+    }
+
+    void VoicePool::setLevel(int32_t voice, float level) {
+        _levels[voice] = level;
+    }
+
+    void VoicePool::endBlock() {
+        if (_stealMode != StealMode::Quietest) {
+            return;
+        }
+        int32_t* order = _quietOrder.data();
+        std::copy(_active.data(), _active.data() + _activeCount, order);
+        const float* levels = _levels.data();
+        std::sort(order, order + _activeCount, [levels](int32_t a, int32_t b) {
+            return levels[a] < levels[b];
+        });
+        _quietCount = _activeCount;
+        _quietCursor = 0;
+        _quietSerial = _serial;
+    }
+
+    int32_t VoicePool::selectVoiceToSteal() {
+        switch (_stealMode) {
+            case StealMode::None:
+                return noVoice;
+            case StealMode::Quietest:
+                // Skip the voices freed or restarted since the ranking, whose level is not known yet
+                while (_quietCursor < _quietCount) {
+                    const int32_t voice = _quietOrder[_quietCursor++];
+                    if (_states[voice] != VoiceFree && _startSerials[voice] <= _quietSerial) {
+                        return voice;
+                    }
+                }
+                return _oldestVoice;
+            case StealMode::SameNote:
+            case StealMode::Oldest:
+            default:
+                return _oldestVoice;
+        }
+    }
+
+    void VoicePool::appendToAgeList(int32_t voice) {
+        _olderVoices[voice] = _newestVoice;
+        _newerVoices[voice] = noVoice;
+        if (_newestVoice != noVoice) {
+            _newerVoices[_newestVoice] = voice;
+        } else {
+            _oldestVoice = voice;
+        }
+        _newestVoice = voice;
+    }
+
+    void VoicePool::removeFromAgeList(int32_t voice) {
+        const int32_t older = _olderVoices[voice];
+        const int32_t newer = _newerVoices[voice];
+        if (older != noVoice) {
+            _newerVoices[older] = newer;
+        } else {
+            _oldestVoice = newer;
+        }
+        if (newer != noVoice) {
+            _olderVoices[newer] = older;
+        } else {
+            _newestVoice = older;
+        }
+        _olderVoices[voice] = noVoice;
+        _newerVoices[voice] = noVoice;
+    }
+
+    void VoicePool::appendToNoteList(int32_t voice, int32_t note) {
+        const int32_t newest = _noteVoices[note];
+        _olderNoteVoices[voice] = newest;
+        _newerNoteVoices[voice] = noVoice;
+        if (newest != noVoice) {
+            _newerNoteVoices[newest] = voice;
+        }
+        _noteVoices[note] = voice;
+    }
+
+    void VoicePool::removeFromNoteList(int32_t voice) {
+        const int32_t older = _olderNoteVoices[voice];
+        const int32_t newer = _newerNoteVoices[voice];
+        if (newer != noVoice) {
+            _olderNoteVoices[newer] = older;
+        } else {
+            _noteVoices[_notes[voice]] = older;
+        }
+        if (older != noVoice) {
+            _newerNoteVoices[older] = newer;
+        }
+        _olderNoteVoices[voice] = noVoice;
+        _newerNoteVoices[voice] = noVoice;
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,106 @@
+
+#include "include/WavetableMipmaps.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+
+namespace synthesizerBase {
+
+    WavetableMipmaps::WavetableMipmaps(Waveform waveform) : _tables(nullptr) {
+        std::vector<float> amplitudes(tableSize / 2, 0.0f);
+        for (int32_t harmonic = 1; harmonic <= tableSize / 2; harmonic++) {
+            float amplitude = 0.0f;
+            switch (waveform) {
+                case Waveform::Sine:
+                    amplitude = harmonic == 1 ? 1.0f : 0.0f;
+                    break;
+                case Waveform::Sawtooth:
+                    amplitude = 1.0f / static_cast<float>(harmonic);
+                    break;
+                case Waveform::Square:
+                    amplitude = harmonic % 2 == 1 ? 1.0f / static_cast<float>(harmonic) : 0.0f;
+                    break;
+                case Waveform::Triangle:
+                    // Odd harmonics with alternating sign, falling with the square of the harmonic number
+                    amplitude = harmonic % 2 == 1
+                                ? ((harmonic / 2) % 2 == 0 ? 1.0f : -1.0f) /
+                                  static_cast<float>(harmonic * harmonic) : 0.0f;
+                    break;
+            }
+            amplitudes[harmonic - 1] = amplitude;
+        }
+        generate(amplitudes.data(), tableSize / 2);
+    }
+
+    WavetableMipmaps::WavetableMipmaps(const float* amplitudes, int32_t count) : _tables(nullptr) {
+        generate(amplitudes, count);
+    }
+
+    WavetableMipmaps::WavetableMipmaps(const float* tables) : _tables(tables) {
+    }
+
+    int32_t WavetableMipmaps::levelForFrequency(float frequency, int samplingRate) {
+        if (frequency <= 0.0f) {
+            return 0;
+        }
+        const float maxHarmonics = 0.5f * static_cast<float>(samplingRate) / frequency;
+        if (maxHarmonics < 1.0f) {
+            return -1;
+        }
+        int32_t level = 0;
+        while (level < levelCount - 1 && static_cast<float>((tableSize / 2) >> level) > maxHarmonics) {
+            level++;
+        }
+        return level;
+    }
+
+    const float* WavetableMipmaps::getTables() const {
+        return _tables;
+    }
+
+    const float* WavetableMipmaps::getLevel(int32_t level) const {
+        return _tables + static_cast<int64_t>(level) * levelStride;
+    }
+
+    void WavetableMipmaps::generate(const float* amplitudes, int32_t count) {
+        _storage.resize(static_cast<size_t>(levelCount) * levelStride);
+        _tables = _storage.data();
+
+        // sin(2 pi h n / N) is read from a single sine table at index (h*n) mod N, which is exact and fast
+        std::vector<double> sine(tableSize);
+        for (int32_t n = 0; n < tableSize; n++) {
+            sine[n] = sin(2.0 * M_PI * n / tableSize);
+        }
+
+        std::vector<double> level(tableSize);
+        double normalization = 1.0;
+        for (int32_t levelIndex = 0; levelIndex < levelCount; levelIndex++) {
+            const int32_t harmonics = std::min(count, (tableSize / 2) >> levelIndex);
+            for (int32_t n = 0; n < tableSize; n++) {
+                double sample = 0.0;
+                for (int32_t harmonic = 1; harmonic <= harmonics; harmonic++) {
+                    if (amplitudes[harmonic - 1] != 0.0f) {
+                        sample += amplitudes[harmonic - 1] * sine[(static_cast<int64_t>(harmonic) * n) % tableSize];
+                    }
+                }
+                level[n] = sample;
+            }
+            if (levelIndex == 0) {
+                // The same factor for all levels keeps the loudness constant across octaves
+                double peak = 0.0;
+                for (double sample : level) {
+                    peak = fmax(peak, fabs(sample));
+                }
+                normalization = peak > 0.0 ? 1.0 / peak : 1.0;
+            }
+            float* table = _storage.data() + static_cast<int64_t>(levelIndex) * levelStride;
+            for (int32_t n = 0; n < tableSize; n++) {
+                table[n] = static_cast<float>(level[n] * normalization);
+            }
+            table[tableSize] = table[0];
+        }
+    }
+
+}  // namespace synthesizerBase
@@ -0,0 +1,150 @@
+
+#include "include/WavetableOscillatorBank.h"
+
+#include <algorithm>
+#include <string.h>
+#include "include/SimdKernels.h"
+
+
+namespace synthesizerBase {
+
+    namespace {
+        // The oscillators are rendered in chunks of this many frames, to keep the accumulator in the L1 cache
+        constexpr int32_t wavetableChunkFrames = defaultAudioFrameSize;
+    }
+
+    WavetableOscillatorBank::WavetableOscillatorBank(const WavetableMipmaps* mipmaps, int32_t maxOscillators,
+                                                     int samplingRate)
+            : _mipmaps(mipmaps),
+              _maxOscillators(std::max(1, maxOscillators)),
+              _samplingRate(samplingRate),
+              _activeGroups(0) {
+        // Whole groups, such that the kernel never needs a partial group
+        const size_t capacity = static_cast<size_t>(
+                (_maxOscillators + simd::wavetableVoiceGroup - 1) / simd::wavetableVoiceGroup *
+                simd::wavetableVoiceGroup);
+        _phases.resize(capacity);
+        _increments.resize(capacity);
+        _amplitudes.resize(capacity);
+        _tableOffsets.resize(capacity);
+        _requestedAmplitudes.resize(capacity);
+        _muted.resize(capacity);
+        _accumulator.resize(static_cast<size_t>(wavetableChunkFrames) * simd::wavetableVoiceGroup);
+    }
+
+    void WavetableOscillatorBank::setOscillator(int32_t index, float frequency, float amplitude) {
+        if (index < 0 || index >= _maxOscillators) {
+            return;
+        }
+        _requestedAmplitudes[index] = amplitude;
+        setFrequency(index, frequency);
+    }
+
+    void WavetableOscillatorBank::setFrequency(int32_t index, float frequency) {
+        if (index < 0 || index >= _maxOscillators) {
+            return;
+        }
+        const int32_t level = WavetableMipmaps::levelForFrequency(frequency, _samplingRate);
+        _muted[index] = level < 0;
+        if (level < 0) {
+            _increments[index] = 0.0f;
+            _tableOffsets[index] = 0;
+        } else {
+            _increments[index] = std::max(0.0f, frequency) * WavetableMipmaps::tableSize / _samplingRate;
+            _tableOffsets[index] = level * WavetableMipmaps::levelStride;
+        }
+        updateAmplitude(index);
+    }
+
+    void WavetableOscillatorBank::setAmplitude(int32_t index, float amplitude) {
+        if (index < 0 || index >= _maxOscillators) {
+            return;
+        }
+        _requestedAmplitudes[index] = amplitude;
+        updateAmplitude(index);
+    }
+
+    void WavetableOscillatorBank::stopOscillator(int32_t index) {
+        if (index < 0 || index >= _maxOscillators) {
+            return;
+        }
+        _requestedAmplitudes[index] = 0.0f;
+        _phases[index] = 0.0f;
+        _increments[index] = 0.0f;
+        updateAmplitude(index);
+    }
+
+    int32_t WavetableOscillatorBank::getMaxOscillators() const {
+        return _maxOscillators;
+    }
+
+    void WavetableOscillatorBank::updateAmplitude(int32_t index) {
+        _amplitudes[index] = _muted[index] ? 0.0f : _requestedAmplitudes[index];
+
+        const int32_t group = index / simd::wavetableVoiceGroup;
+        if (_amplitudes[index] != 0.0f) {
+            _activeGroups = std::max(_activeGroups, group + 1);
+            return;
+        }
+        if (group + 1 < _activeGroups) {
+            return;
+        }
+        // The last audible oscillator may have been silenced: search backwards for the new last group
+        int32_t last = _activeGroups * simd::wavetableVoiceGroup - 1;
+        while (last >= 0 && _amplitudes[last] == 0.0f) {
+            last--;
+        }
+        _activeGroups = (last + simd::wavetableVoiceGroup) / simd::wavetableVoiceGroup;
+    }
+
+    void WavetableOscillatorBank::onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+        const int32_t voiceCount = _activeGroups * simd::wavetableVoiceGroup;
+        _silentBlock = voiceCount == 0;
+        if (_silentBlock) {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            return;
+        }
+        for (int32_t offset = 0; offset < framesCount; offset += wavetableChunkFrames) {
+            const int32_t chunk = std::min(wavetableChunkFrames, framesCount - offset);
+            float* accumulator = _accumulator.data();
+            memset(accumulator, 0, sizeof(float) * chunk * simd::wavetableVoiceGroup);
+            simd::wavetableVoices(_mipmaps->getTables(), _phases.data(), _increments.data(), _amplitudes.data(),
+                                  _tableOffsets.data(), voiceCount, static_cast<float>(WavetableMipmaps::tableSize),
+                                  accumulator, chunk);
+            float* output = audioData + offset;
+            for (int32_t frame = 0; frame < chunk; frame++) {
+                const float* lanes = accumulator + frame * simd::wavetableVoiceGroup;
+                output[frame] = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                                ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+            }
+        }
+        for (int32_t channel = 1; channel < static_cast<int32_t>(channelCount); channel++) {
+            memcpy(audioData + channel * framesCount, audioData, sizeof(float) * framesCount);
+        }
+    }
+
+    void WavetableOscillatorBank::onPlaybackStopped() {
+    }
+
+    bool WavetableOscillatorBank::isIdle() const {
+        return _activeGroups == 0;
+    }
+
+    BlockState WavetableOscillatorBank::getBlockState() const {
+        return _silentBlock ? BlockState::Silent : BlockState::Active;
+    }
+
+    void WavetableOscillatorBank::onAudioEvent(const AudioEvent& event) {
+        switch (event.type) {
+            case AudioEventFrequency:
+                setFrequency(event.index, event.value);
+                break;
+            case AudioEventAmplitude:
+                setAmplitude(event.index, event.value);
+                break;
+            default:
+                break;
+        }
+    }
+
+}  // namespace synthesizerBase
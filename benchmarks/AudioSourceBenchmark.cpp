@@ -0,0 +1,190 @@
+
+/* Callback-deadline benchmark for audio sources
+ *
+ * Runs every registered AudioSource (see BenchmarkRegistry.h) through onAudioReady for a grid of
+ * frame counts, channel counts and sampling rates, and reports per-callback timing percentiles,
+ * the CPU load relative to the callback deadline (framesCount/samplingRate) and the number of voices
+ * that fit on one core. Output is CSV (default) or JSON lines, one record per source and configuration,
+ * in a stable order such that results of different releases can be compared with diff.
+ *
+ * Usage: AudioSourceBenchmark [--source NAME]... [--callbacks N] [--format csv|json] [--output FILE] [--quick]
+ */
+
+#include "BenchmarkRegistry.h"
+#include "BenchmarkStatistics.h"
+#include "RealtimeSafety.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    struct Configuration {
+        int samplingRate;
+        int32_t channelCount;
+        int32_t framesCount;
+    };
+
+    struct Options {
+        std::vector<std::string> sources; // empty: all registered sources
+        int32_t callbacks = 2000;
+        bool json = false;
+        bool quick = false;
+        const char* outputPath = nullptr;
+    };
+
+    void printUsage() {
+        fprintf(stderr, "Usage: AudioSourceBenchmark [--source NAME]... [--callbacks N] "
+                        "[--format csv|json] [--output FILE] [--quick]\n");
+        fprintf(stderr, "Registered sources:");
+        for (const auto& source : registeredAudioSources()) {
+            fprintf(stderr, " %s", source.name.c_str());
+        }
+        fprintf(stderr, "\n");
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--source") == 0 && hasValue) {
+                options.sources.emplace_back(argv[++i]);
+            } else if (strcmp(argv[i], "--callbacks") == 0 && hasValue) {
+                options.callbacks = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--format") == 0 && hasValue) {
+                options.json = strcmp(argv[++i], "json") == 0;
+            } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+                options.outputPath = argv[++i];
+            } else if (strcmp(argv[i], "--quick") == 0) {
+                options.quick = true;
+            } else {
+                return false;
+            }
+        }
+        return options.callbacks > 0;
+    }
+
+    bool isSelected(const Options& options, const std::string& name) {
+        if (options.sources.empty()) {
+            return true;
+        }
+        for (const auto& selected : options.sources) {
+            if (selected == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Configuration> configurationGrid(bool quick) {
+        const std::vector<int> samplingRates = quick ? std::vector<int>{48000} : std::vector<int>{44100, 48000, 96000};
+        const std::vector<int32_t> channelCounts = {1, 2};
+        const std::vector<int32_t> framesCounts = quick ? std::vector<int32_t>{64, 256}
+                                                        : std::vector<int32_t>{32, 64, 128, 256, 512, 1024};
+        std::vector<Configuration> grid;
+        for (int samplingRate : samplingRates) {
+            for (int32_t channelCount : channelCounts) {
+                for (int32_t framesCount : framesCounts) {
+                    grid.push_back({samplingRate, channelCount, framesCount});
+                }
+            }
+        }
+        return grid;
+    }
+
+    void writeRecord(FILE* output, bool json, const RegisteredAudioSource& source, const Configuration& configuration,
+                     int32_t callbacks, const TimingSummary& summary) {
+        const double deadlineNanos = 1e9 * configuration.framesCount / configuration.samplingRate;
+        const double loadMean = 100.0 * summary.mean / deadlineNanos;
+        const double loadP99 = 100.0 * summary.p99 / deadlineNanos;
+        const double voicesPerCore = summary.mean > 0 ? source.voices * deadlineNanos / summary.mean : 0.0;
+
+        if (json) {
+            fprintf(output, "{\"source\":\"%s\",\"sample_rate\":%d,\"channels\":%d,\"frames\":%d,\"callbacks\":%d,"
+                            "\"deadline_us\":%.3f,\"mean_us\":%.3f,\"p50_us\":%.3f,\"p99_us\":%.3f,\"p999_us\":%.3f,"
+                            "\"max_us\":%.3f,\"load_mean_pct\":%.3f,\"load_p99_pct\":%.3f,\"voices_per_core\":%.1f}\n",
+                    source.name.c_str(), configuration.samplingRate, configuration.channelCount,
+                    configuration.framesCount, callbacks, deadlineNanos / 1000, summary.mean / 1000,
+                    summary.p50 / 1000, summary.p99 / 1000, summary.p999 / 1000, summary.max / 1000,
+                    loadMean, loadP99, voicesPerCore);
+        } else {
+            fprintf(output, "%s,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f\n",
+                    source.name.c_str(), configuration.samplingRate, configuration.channelCount,
+                    configuration.framesCount, callbacks, deadlineNanos / 1000, summary.mean / 1000,
+                    summary.p50 / 1000, summary.p99 / 1000, summary.p999 / 1000, summary.max / 1000,
+                    loadMean, loadP99, voicesPerCore);
+        }
+        fflush(output);
+    }
+
+    TimingSummary measure(const RegisteredAudioSource& source, const Configuration& configuration, int32_t callbacks) {
+        std::unique_ptr<AudioSource> audioSource = source.factory(configuration.samplingRate,
+                                                                  configuration.channelCount);
+        std::vector<float> buffer(static_cast<size_t>(configuration.framesCount) * configuration.channelCount);
+        const auto channelCount = static_cast<ChannelCount>(configuration.channelCount);
+
+        std::vector<int64_t> nanos(static_cast<size_t>(callbacks));
+        {
+            // Callbacks as on the audio thread: with SYNTHESIZERBASE_REALTIME_CHECKS, violations are reported
+            RealtimeScope realtimeScope;
+            // Warm up caches, branch predictors and lazily initialized state
+            const int32_t warmUpCallbacks = std::max(10, callbacks / 10);
+            for (int32_t i = 0; i < warmUpCallbacks; i++) {
+                audioSource->onAudioReady(buffer.data(), configuration.framesCount, channelCount);
+            }
+
+            for (int32_t i = 0; i < callbacks; i++) {
+                const int64_t start = nowNanos();
+                audioSource->onAudioReady(buffer.data(), configuration.framesCount, channelCount);
+                nanos[i] = nowNanos() - start;
+                doNotOptimize(buffer[0]);
+            }
+        }
+        audioSource->onPlaybackStopped();
+        return summarize(nanos);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    FILE* output = stdout;
+    if (options.outputPath != nullptr) {
+        output = fopen(options.outputPath, "w");
+        if (output == nullptr) {
+            fprintf(stderr, "Cannot open %s\n", options.outputPath);
+            return 1;
+        }
+    }
+
+    if (!options.json) {
+        fprintf(output, "source,sample_rate,channels,frames,callbacks,deadline_us,mean_us,p50_us,p99_us,p999_us,"
+                        "max_us,load_mean_pct,load_p99_pct,voices_per_core\n");
+    }
+
+    const std::vector<Configuration> grid = configurationGrid(options.quick);
+    for (const auto& source : registeredAudioSources()) {
+        if (!isSelected(options, source.name)) {
+            continue;
+        }
+        for (const auto& configuration : grid) {
+            const TimingSummary summary = measure(source, configuration, options.callbacks);
+            writeRecord(output, options.json, source, configuration, options.callbacks, summary);
+        }
+    }
+
+    if (output != stdout) {
+        fclose(output);
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+
+/* Throughput of the BatchRenderer for 1 to N workers: a batch of preview jobs, each a chord on a
+ * WavetableOscillatorBank with a note-off event, rendered into a sink that discards the audio (or, with --memory,
+ * kept in memory). Reports the seconds of audio rendered per wall-clock second, the speedup over one worker and
+ * the parallel efficiency. Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "BatchRenderer.h"
+#include "WavetableOscillatorBank.h"
+
+using namespace synthesizerBase;
+
+namespace {
+
+    constexpr int samplingRate = 48000;
+    constexpr int32_t oscillatorCount = 32;
+
+    /**
+     * Chord of detuned oscillators
+     */
+    class PreviewAudioSource : public AudioSource {
+    public:
+        PreviewAudioSource(const WavetableMipmaps* mipmaps, float root)
+                : _bank(mipmaps, oscillatorCount, samplingRate) {
+            const float intervals[] = {1.0f, 1.25f, 1.5f, 2.0f};
+            for (int32_t index = 0; index < oscillatorCount; index++) {
+                const float detune = 1.0f + 0.002f * static_cast<float>(index / 4 - 4);
+                _bank.setOscillator(index, root * intervals[index % 4] * detune, 0.5f / oscillatorCount);
+            }
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _bank.onAudioReady(audioData, framesCount, channelCount);
+        }
+
+        void onPlaybackStopped() override {
+            _bank.onPlaybackStopped();
+        }
+
+        void onAudioEvent(const AudioEvent& event) override {
+            _bank.onAudioEvent(event);
+        }
+
+    protected:
+        WavetableOscillatorBank _bank;
+    };
+
+    /**
+     * Sink discarding the audio, such that the benchmark measures rendering only
+     */
+    class DiscardingAudioSink : public AudioSink {
+    public:
+        int32_t open(int samplingRate, int32_t channelCount) override {
+            return ResultOk;
+        }
+
+        int32_t write(const float* audioData, int32_t framesCount, int32_t channelCount) override {
+            return ResultOk;
+        }
+
+        void close() override {
+        }
+    };
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t jobCount = 64;
+    double jobSeconds = 2.0;
+    int32_t maxWorkers = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+    bool memory = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobCount = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            jobSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-workers") == 0 && i + 1 < argc) {
+            maxWorkers = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            memory = true;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            jobCount = std::min(jobCount, 16);
+            jobSeconds = std::min(jobSeconds, 0.5);
+        } else {
+            fprintf(stderr, "Usage: BatchRenderBenchmark [--jobs N] [--seconds S] [--max-workers N] [--memory] "
+                            "[--quick]\n");
+            return 1;
+        }
+    }
+
+    const WavetableMipmaps mipmaps(WavetableMipmaps::Waveform::Sawtooth);
+    std::vector<int32_t> workerCounts;
+    for (int32_t workers = 1; workers < maxWorkers; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    printf("workers,jobs,audio_seconds,busy_seconds,realtime_factor,speedup,efficiency_pct\n");
+    double singleWorkerFactor = 0.0;
+    for (int32_t workers : workerCounts) {
+        BatchRenderer renderer(workers);
+        for (int32_t index = 0; index < jobCount; index++) {
+            RenderJob job;
+            job.frames = static_cast<int64_t>(jobSeconds * samplingRate);
+            job.samplingRate = samplingRate;
+            job.channelCount = 2;
+            const float root = 110.0f * (1.0f + static_cast<float>(index % 12) / 12.0f);
+            job.createSource = [&mipmaps, root] {
+                return std::unique_ptr<AudioSource>(new PreviewAudioSource(&mipmaps, root));
+            };
+            AudioEvent noteOff;
+            noteOff.frame = job.frames / 2;
+            noteOff.type = AudioEventAmplitude;
+            noteOff.index = 0;
+            noteOff.value = 0.0f;
+            job.events.push_back(noteOff);
+            if (!memory) {
+                job.createSink = [] { return std::unique_ptr<AudioSink>(new DiscardingAudioSink()); };
+            }
+            renderer.submit(std::move(job));
+        }
+        renderer.wait();
+        const BatchStatistics statistics = renderer.getStatistics();
+        if (statistics.jobsFailed > 0) {
+            fprintf(stderr, "%lld jobs failed\n", static_cast<long long>(statistics.jobsFailed));
+            return 1;
+        }
+        if (workers == 1) {
+            singleWorkerFactor = statistics.realtimeFactor;
+        }
+        const double speedup = singleWorkerFactor > 0.0 ? statistics.realtimeFactor / singleWorkerFactor : 0.0;
+        printf("%d,%d,%.1f,%.3f,%.1f,%.2f,%.1f\n", workers, jobCount, statistics.audioSeconds,
+               statistics.busySeconds, statistics.realtimeFactor, speedup, 100.0 * speedup / workers);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+
+#include "BenchmarkRegistry.h"
+
+#include <utility>
+
+
+namespace synthesizerBase {
+namespace benchmark {
+
+    std::vector<RegisteredAudioSource>& registeredAudioSources() {
+        // Function-local so that registration from static initializers in other translation units is safe
+        static std::vector<RegisteredAudioSource> sources;
+        return sources;
+    }
+
+    bool registerAudioSource(const std::string& name, int32_t voices, AudioSourceFactory factory) {
+        registeredAudioSources().push_back({name, voices, std::move(factory)});
+        return true;
+    }
+
+}  // namespace benchmark
+}  // namespace synthesizerBase
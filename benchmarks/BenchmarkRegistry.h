@@ -0,0 +1,81 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Registry of the audio sources measured by the AudioSourceBenchmark. Sources register themselves
+ * with REGISTER_BENCHMARK_SOURCE in any translation unit linked into the benchmark executable.
+ */
+
+#ifndef BenchmarkRegistry_H
+#define BenchmarkRegistry_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AudioSource.h"
+
+namespace synthesizerBase {
+namespace benchmark {
+
+    /**
+     * Factory for a benchmarked audio source, configured for the given sampling rate and channel count
+     */
+    using AudioSourceFactory = std::function<std::unique_ptr<AudioSource>(int samplingRate, int32_t channelCount)>;
+
+    /**
+     * Description of a registered audio source
+     */
+    struct RegisteredAudioSource {
+        std::string name; // name used in the output and for selecting sources on the command line
+        int32_t voices; // number of voices rendered by one instance, for the voices per core figure
+        AudioSourceFactory factory; // creates a fresh instance for each configuration
+    };
+
+    /**
+     * All registered audio sources, in registration order
+     * @return The registered audio sources
+     */
+    std::vector<RegisteredAudioSource>& registeredAudioSources();
+
+    /**
+     * Register an audio source for benchmarking
+     * @param name Name of the source
+     * @param voices Number of voices rendered by one instance
+     * @param factory Factory for the source
+     * @return true, such that the function can be used for static initialization
+     */
+    bool registerAudioSource(const std::string& name, int32_t voices, AudioSourceFactory factory);
+
+}  // namespace benchmark
+}  // namespace synthesizerBase
+
+#define BENCHMARK_CONCAT_INNER(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_INNER(a, b)
+
+/**
+ * Register an audio source at static initialization time
+ * @param name Name of the source (string)
+ * @param voices Number of voices rendered by one instance
+ * @param factory Callable with signature std::unique_ptr<AudioSource>(int samplingRate, int32_t channelCount)
+ */
+#define REGISTER_BENCHMARK_SOURCE(name, voices, factory) \
+    static const bool BENCHMARK_CONCAT(benchmarkSourceRegistered, __LINE__) = \
+            synthesizerBase::benchmark::registerAudioSource(name, voices, factory)
+
+#endif
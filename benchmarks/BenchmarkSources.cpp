@@ -0,0 +1,267 @@
+
+/* Reference audio sources for the AudioSourceBenchmark, giving a baseline for the cost of the
+ * benchmark loop itself and of a simple oscillator.
+ */
+
+#include "BenchmarkRegistry.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "AudioGraph.h"
+#include "MixerAudioSource.h"
+#include "ParameterBank.h"
+#include "WavetableOscillatorBank.h"
+
+
+namespace synthesizerBase {
+namespace benchmark {
+
+    /**
+     * Writes zeros: measures the overhead of the callback and of the benchmark itself
+     */
+    class SilenceAudioSource : public AudioSource {
+    public:
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+        }
+
+        void onPlaybackStopped() override {
+        }
+    };
+
+    /**
+     * Sine oscillator computed with sinf for each sample, identical in all channels
+     */
+    class SineAudioSource : public AudioSource {
+    public:
+        SineAudioSource(int samplingRate, float frequency)
+                : _phaseIncrement(2.0f * static_cast<float>(M_PI) * frequency / samplingRate) {
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                audioData[frame] = 0.5f * sinf(_phase);
+                _phase += _phaseIncrement;
+                if (_phase > 2.0f * static_cast<float>(M_PI)) {
+                    _phase -= 2.0f * static_cast<float>(M_PI);
+                }
+            }
+            for (int32_t channel = 1; channel < static_cast<int32_t>(channelCount); channel++) {
+                memcpy(audioData + channel * framesCount, audioData, sizeof(float) * framesCount);
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        float _phase = 0.0f;
+        float _phaseIncrement;
+    };
+
+    /**
+     * Mixer with a given number of inputs writing a constant: measures the mixing itself
+     */
+    class MixerBenchmarkSource : public AudioSource {
+    public:
+        MixerBenchmarkSource(int32_t inputs, int32_t channelCount)
+                : _mixer(inputs, channelCount), _inputs(inputs) {
+            for (int32_t i = 0; i < inputs; i++) {
+                _mixer.attachInput(&_inputs[i], 1.0f / inputs, -1.0f + 2.0f * i / inputs);
+            }
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _mixer.onAudioReady(audioData, framesCount, channelCount);
+        }
+
+        void onPlaybackStopped() override {
+            _mixer.onPlaybackStopped();
+        }
+
+    protected:
+        class ConstantAudioSource : public AudioSource {
+        public:
+            void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+                for (int32_t i = 0; i < framesCount * static_cast<int32_t>(channelCount); i++) {
+                    audioData[i] = 0.25f;
+                }
+            }
+
+            void onPlaybackStopped() override {
+            }
+        };
+
+        MixerAudioSource _mixer;
+        std::vector<ConstantAudioSource> _inputs;
+    };
+
+    /**
+     * Wavetable oscillator bank with a given number of sawtooth oscillators spread over six octaves,
+     * so that all mipmap levels in that range are used
+     */
+    class WavetableBenchmarkSource : public AudioSource {
+    public:
+        WavetableBenchmarkSource(int32_t oscillators, int samplingRate)
+                : _bank(&sawtoothMipmaps(), oscillators, samplingRate) {
+            for (int32_t i = 0; i < oscillators; i++) {
+                const float frequency = 55.0f * powf(2.0f, 6.0f * static_cast<float>(i) / oscillators);
+                _bank.setOscillator(i, frequency, 1.0f / oscillators);
+            }
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _bank.onAudioReady(audioData, framesCount, channelCount);
+        }
+
+        void onPlaybackStopped() override {
+            _bank.onPlaybackStopped();
+        }
+
+    protected:
+        static const WavetableMipmaps& sawtoothMipmaps() {
+            static const WavetableMipmaps mipmaps(WavetableMipmaps::Waveform::Sawtooth);
+            return mipmaps;
+        }
+
+        WavetableOscillatorBank _bank;
+    };
+
+    /**
+     * A given number of smoothed gains, each applied to its own copy of a constant signal and summed. Every
+     * 16th callback, one in four gains gets a new target; the others stay steady.
+     */
+    class SmoothingBenchmarkSource : public AudioSource {
+    public:
+        SmoothingBenchmarkSource(int32_t parameters, int samplingRate)
+                : _parameters(parameters, samplingRate),
+                  _scratch(static_cast<size_t>(_parameters.getMaxBlockFrames())) {
+            for (int32_t i = 0; i < parameters; i++) {
+                _parameters.setRamp(i, i % 2 == 0 ? RampShape::OnePole : RampShape::Linear, 20.0f);
+                _parameters.setValue(i, 1.0f / parameters);
+            }
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            if (_callbacks++ % 16 == 0) {
+                for (int32_t i = _callbacks % 4; i < _parameters.getParameterCount(); i += 4) {
+                    _parameters.setTarget(i, (_callbacks % 32 == 1 ? 0.5f : 1.5f) / _parameters.getParameterCount());
+                }
+            }
+            const int32_t chunkFrames = _parameters.getMaxBlockFrames();
+            for (int32_t offset = 0; offset < framesCount; offset += chunkFrames) {
+                const int32_t frames = std::min(chunkFrames, framesCount - offset);
+                _parameters.advance(frames);
+                float* output = audioData + offset;
+                memset(output, 0, sizeof(float) * frames);
+                for (int32_t i = 0; i < _parameters.getParameterCount(); i++) {
+                    for (int32_t frame = 0; frame < frames; frame++) {
+                        _scratch[frame] = 0.25f;
+                    }
+                    _parameters.apply(i, _scratch.data(), frames);
+                    for (int32_t frame = 0; frame < frames; frame++) {
+                        output[frame] += _scratch[frame];
+                    }
+                }
+            }
+            for (int32_t channel = 1; channel < static_cast<int32_t>(channelCount); channel++) {
+                memcpy(audioData + channel * framesCount, audioData, sizeof(float) * framesCount);
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        ParameterBank _parameters;
+        AlignedBuffer<float> _scratch;
+        int64_t _callbacks = 0;
+    };
+
+    /**
+     * Audio graph where one wavetable oscillator bank feeds a given number of gain nodes, summed by a mix node:
+     * the shared bank is rendered once per block, whatever the number of its consumers
+     */
+    class GraphBenchmarkSource : public AudioSource {
+    public:
+        GraphBenchmarkSource(int32_t consumers, int samplingRate, int32_t channelCount)
+                : _bankSource(64, samplingRate),
+                  _bankNode(&_bankSource),
+                  _graph(consumers + 2, channelCount) {
+            const int32_t bank = _graph.addNode(&_bankNode);
+            const int32_t mix = _graph.addNode(&_mix);
+            _gains.reserve(static_cast<size_t>(consumers));
+            for (int32_t i = 0; i < consumers; i++) {
+                _gains.emplace_back(1.0f / static_cast<float>(consumers * (i + 1)));
+                const int32_t gain = _graph.addNode(&_gains.back());
+                _graph.connect(bank, gain);
+                _graph.connect(gain, mix);
+            }
+            _graph.setOutputNode(mix);
+            _graph.commit();
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _graph.onAudioReady(audioData, framesCount, channelCount);
+        }
+
+        void onPlaybackStopped() override {
+            _graph.onPlaybackStopped();
+        }
+
+    protected:
+        class GainNode : public AudioGraphNode {
+        public:
+            explicit GainNode(float gain) : _gain(gain) {}
+
+            void process(const float* const* inputs, int32_t inputCount, float* output, int32_t framesCount,
+                         ChannelCount channelCount) override {
+                const int32_t samples = framesCount * static_cast<int32_t>(channelCount);
+                for (int32_t i = 0; i < samples; i++) {
+                    output[i] = inputCount > 0 ? _gain * inputs[0][i] : 0.0f;
+                }
+            }
+
+        protected:
+            float _gain;
+        };
+
+        WavetableBenchmarkSource _bankSource;
+        AudioSourceNode _bankNode;
+        MixNode _mix;
+        std::vector<GainNode> _gains; // reserved: the graph keeps pointers
+        AudioGraph _graph;
+    };
+
+    REGISTER_BENCHMARK_SOURCE("silence", 0, [](int, int32_t) {
+        return std::unique_ptr<AudioSource>(new SilenceAudioSource());
+    });
+
+    REGISTER_BENCHMARK_SOURCE("sine", 1, [](int samplingRate, int32_t) {
+        return std::unique_ptr<AudioSource>(new SineAudioSource(samplingRate, 440.0f));
+    });
+
+    REGISTER_BENCHMARK_SOURCE("mixer-32", 32, [](int, int32_t channelCount) {
+        return std::unique_ptr<AudioSource>(new MixerBenchmarkSource(32, channelCount));
+    });
+
+    REGISTER_BENCHMARK_SOURCE("mixer-128", 128, [](int, int32_t channelCount) {
+        return std::unique_ptr<AudioSource>(new MixerBenchmarkSource(128, channelCount));
+    });
+
+    REGISTER_BENCHMARK_SOURCE("wavetable-256", 256, [](int samplingRate, int32_t) {
+        return std::unique_ptr<AudioSource>(new WavetableBenchmarkSource(256, samplingRate));
+    });
+
+    REGISTER_BENCHMARK_SOURCE("smoothing-256", 256, [](int samplingRate, int32_t) {
+        return std::unique_ptr<AudioSource>(new SmoothingBenchmarkSource(256, samplingRate));
+    });
+
+    REGISTER_BENCHMARK_SOURCE("graph-shared-8", 64, [](int samplingRate, int32_t channelCount) {
+        return std::unique_ptr<AudioSource>(new GraphBenchmarkSource(8, samplingRate, channelCount));
+    });
+
+}  // namespace benchmark
+}  // namespace synthesizerBase
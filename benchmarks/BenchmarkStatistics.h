@@ -0,0 +1,93 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Timing helpers shared by the benchmark executables
+ */
+
+#ifndef BenchmarkStatistics_H
+#define BenchmarkStatistics_H
+
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <vector>
+
+namespace synthesizerBase {
+namespace benchmark {
+
+    /**
+     * Current time of a monotonic clock
+     * @return Time in nanoseconds
+     */
+    inline int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Summary of a series of timings
+     */
+    struct TimingSummary {
+        double mean = 0; // all values in nanoseconds
+        double p50 = 0;
+        double p99 = 0;
+        double p999 = 0;
+        double max = 0;
+    };
+
+    /**
+     * Summarize a series of timings. The series is sorted in place.
+     * @param nanos Timings, in nanoseconds
+     * @return Mean, percentiles and maximum
+     */
+    inline TimingSummary summarize(std::vector<int64_t>& nanos) {
+        TimingSummary summary;
+        if (nanos.empty()) {
+            return summary;
+        }
+        std::sort(nanos.begin(), nanos.end());
+        double sum = 0;
+        for (int64_t value : nanos) {
+            sum += static_cast<double>(value);
+        }
+        auto percentile = [&nanos](double fraction) {
+            auto index = static_cast<size_t>(fraction * static_cast<double>(nanos.size()));
+            return static_cast<double>(nanos[std::min(index, nanos.size() - 1)]);
+        };
+        summary.mean = sum / static_cast<double>(nanos.size());
+        summary.p50 = percentile(0.5);
+        summary.p99 = percentile(0.99);
+        summary.p999 = percentile(0.999);
+        summary.max = static_cast<double>(nanos.back());
+        return summary;
+    }
+
+    /**
+     * Keep the compiler from optimizing away a computed value
+     * @param value Value that should be considered used
+     */
+    template<typename T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+}  // namespace benchmark
+}  // namespace synthesizerBase
+
+#endif
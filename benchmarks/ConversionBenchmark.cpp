@@ -0,0 +1,171 @@
+
+/* Throughput of the conversion of float samples to the integer formats of audio devices and files: a plain scalar
+ * reference loop (clamp, then lrintf per sample), the conversion kernels of each instruction set supported by the
+ * CPU, and the SampleFormatConverter with each dither mode on the best kernels. Blocks of 256 stereo frames, as
+ * a callback would convert. Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "BenchmarkStatistics.h"
+#include "SampleFormatConverter.h"
+#include "SimdKernels.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t channelCount = 2;
+    constexpr int32_t samplesCount = framesCount * channelCount;
+
+    const char* formatName(SampleFormat format) {
+        switch (format) {
+            case SampleFormat::Int16:
+                return "int16";
+            case SampleFormat::Int24Packed:
+                return "int24";
+            case SampleFormat::Int32:
+                return "int32";
+            case SampleFormat::Float:
+            default:
+                return "float";
+        }
+    }
+
+    const char* ditherName(DitherMode dither) {
+        switch (dither) {
+            case DitherMode::Triangular:
+                return "triangular";
+            case DitherMode::NoiseShaped:
+                return "noise-shaped";
+            case DitherMode::None:
+            default:
+                return "none";
+        }
+    }
+
+    /**
+     * Straightforward conversion, as written without kernels
+     */
+    void convertReference(SampleFormat format, uint8_t* destination, const float* source, int32_t count) {
+        for (int32_t i = 0; i < count; i++) {
+            const float sample = std::min(1.0f, std::max(-1.0f, source[i]));
+            switch (format) {
+                case SampleFormat::Int16: {
+                    const long value = std::min(32767L, lrintf(sample * 32768.0f));
+                    reinterpret_cast<int16_t*>(destination)[i] = static_cast<int16_t>(value);
+                    break;
+                }
+                case SampleFormat::Int24Packed: {
+                    const long value = std::min(8388607L, lrintf(sample * 8388608.0f));
+                    destination[3 * i] = static_cast<uint8_t>(value);
+                    destination[3 * i + 1] = static_cast<uint8_t>(value >> 8);
+                    destination[3 * i + 2] = static_cast<uint8_t>(value >> 16);
+                    break;
+                }
+                case SampleFormat::Int32:
+                default:
+                    reinterpret_cast<int32_t*>(destination)[i] = static_cast<int32_t>(
+                            llrintf(std::min(2147483520.0f, sample * 2147483648.0f)));
+                    break;
+            }
+        }
+    }
+
+    void convertKernels(SampleFormat format, uint8_t* destination, const float* source, int32_t count) {
+        switch (format) {
+            case SampleFormat::Int16:
+                simd::floatToInt16(reinterpret_cast<int16_t*>(destination), source, nullptr, count);
+                break;
+            case SampleFormat::Int24Packed:
+                simd::floatToInt24(destination, source, nullptr, count);
+                break;
+            case SampleFormat::Int32:
+            default:
+                simd::floatToInt32(reinterpret_cast<int32_t*>(destination), source, nullptr, count);
+                break;
+        }
+    }
+
+    void printRow(const char* implementation, SampleFormat format, DitherMode dither, TimingSummary summary,
+                  double referenceMean) {
+        printf("%s,%s,%s,%.1f,%.1f,%.3f,%.1f,%.2f\n", implementation, formatName(format), ditherName(dither),
+               summary.mean, summary.p99, summary.mean / samplesCount, 1e3 * samplesCount / summary.mean,
+               referenceMean / summary.mean);
+        fflush(stdout);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t blocks = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--blocks") == 0 && i + 1 < argc) {
+            blocks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            blocks = std::min(blocks, 2000);
+        } else {
+            fprintf(stderr, "Usage: ConversionBenchmark [--blocks N] [--quick]\n");
+            return 1;
+        }
+    }
+
+    // A loud signal, clipping now and then
+    std::vector<float> source(samplesCount);
+    for (int32_t i = 0; i < samplesCount; i++) {
+        source[i] = 1.1f * sinf(0.05f * static_cast<float>(i));
+    }
+    std::vector<uint8_t> destination(static_cast<size_t>(samplesCount) * 4);
+    std::vector<int64_t> nanos;
+    nanos.reserve(static_cast<size_t>(blocks));
+    const simd::InstructionSet best = simd::activeInstructionSet();
+
+    printf("implementation,format,dither,mean_ns,p99_ns,ns_per_sample,msamples_per_s,speedup\n");
+    for (SampleFormat format : {SampleFormat::Int16, SampleFormat::Int24Packed, SampleFormat::Int32}) {
+        nanos.clear();
+        for (int32_t block = 0; block < blocks; block++) {
+            const int64_t start = nowNanos();
+            convertReference(format, destination.data(), source.data(), samplesCount);
+            nanos.push_back(nowNanos() - start);
+            doNotOptimize(destination[0]);
+        }
+        const TimingSummary reference = summarize(nanos);
+        printRow("reference", format, DitherMode::None, reference, reference.mean);
+
+        for (simd::InstructionSet instructionSet : {simd::InstructionSet::Scalar, simd::InstructionSet::Sse2,
+                                                    simd::InstructionSet::Avx2, simd::InstructionSet::Neon}) {
+            if (!simd::selectInstructionSet(instructionSet)) {
+                continue;
+            }
+            nanos.clear();
+            for (int32_t block = 0; block < blocks; block++) {
+                const int64_t start = nowNanos();
+                convertKernels(format, destination.data(), source.data(), samplesCount);
+                nanos.push_back(nowNanos() - start);
+                doNotOptimize(destination[0]);
+            }
+            printRow(simd::instructionSetName(instructionSet), format, DitherMode::None, summarize(nanos),
+                     reference.mean);
+        }
+        simd::selectInstructionSet(best);
+
+        for (DitherMode dither : {DitherMode::None, DitherMode::Triangular, DitherMode::NoiseShaped}) {
+            SampleFormatConverter converter(format, channelCount, dither, framesCount);
+            nanos.clear();
+            for (int32_t block = 0; block < blocks; block++) {
+                const int64_t start = nowNanos();
+                converter.convert(destination.data(), source.data(), framesCount);
+                nanos.push_back(nowNanos() - start);
+                doNotOptimize(destination[0]);
+            }
+            printRow("converter", format, dither, summarize(nanos), reference.mean);
+        }
+    }
+    return 0;
+}
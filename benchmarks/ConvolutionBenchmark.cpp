@@ -0,0 +1,163 @@
+
+/* Cost of the ConvolutionAudioSource against a direct-form FIR filter (one simd::dotProduct over the whole impulse
+ * response per output frame), for impulse responses of 0.1 to 4 seconds and several partition lengths. Reports the
+ * time of a 256-frame stereo callback at 48 kHz and its load relative to the deadline. The direct form is only run
+ * up to a maximum response length, as it cannot keep up beyond. Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "AlignedBuffer.h"
+#include "BenchmarkStatistics.h"
+#include "ConvolutionAudioSource.h"
+#include "SimdKernels.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int samplingRate = 48000;
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t channelCount = 2;
+
+    /**
+     * White noise, different in each channel
+     */
+    class NoiseAudioSource : public AudioSource {
+    public:
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            for (int32_t index = 0; index < framesCount * static_cast<int32_t>(channelCount); index++) {
+                _state = _state * 1664525u + 1013904223u;
+                audioData[index] = static_cast<float>(static_cast<int32_t>(_state)) * (0.25f / 2147483648.0f);
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        uint32_t _state = 1;
+    };
+
+    /**
+     * Reference: the whole impulse response in direct form
+     */
+    class DirectFirAudioSource : public AudioSource {
+    public:
+        DirectFirAudioSource(AudioSource* source, const float* impulseResponse, int32_t impulseFrames)
+                : _source(source),
+                  _taps(impulseFrames),
+                  _historyStride(impulseFrames + framesCount),
+                  _reversed(static_cast<size_t>(impulseFrames)),
+                  _history(static_cast<size_t>(channelCount) * (impulseFrames + framesCount)) {
+            for (int32_t tap = 0; tap < _taps; tap++) {
+                _reversed[_taps - 1 - tap] = impulseResponse[tap];
+            }
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _source->onAudioReady(audioData, framesCount, channelCount);
+            for (int32_t channel = 0; channel < static_cast<int32_t>(channelCount); channel++) {
+                float* samples = audioData + static_cast<int64_t>(channel) * framesCount;
+                float* history = _history.data() + static_cast<int64_t>(channel) * _historyStride;
+                // The last _taps - 1 input frames, then the new ones
+                memcpy(history + _taps - 1, samples, sizeof(float) * framesCount);
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    samples[frame] = simd::dotProduct(_reversed.data(), history + frame, _taps);
+                }
+                memmove(history, history + framesCount, sizeof(float) * (_taps - 1));
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        AudioSource* _source;
+        int32_t _taps;
+        int32_t _historyStride;
+        AlignedBuffer<float> _reversed;
+        AlignedBuffer<float> _history;
+    };
+
+    /**
+     * Exponentially decaying noise, as the tail of a room
+     */
+    std::vector<float> impulseResponse(int32_t frames) {
+        std::vector<float> response(static_cast<size_t>(frames));
+        uint32_t state = 12345;
+        for (int32_t frame = 0; frame < frames; frame++) {
+            state = state * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(static_cast<int32_t>(state)) / 2147483648.0f;
+            response[frame] = 0.05f * noise * expf(-6.9f * static_cast<float>(frame) / static_cast<float>(frames));
+        }
+        return response;
+    }
+
+    TimingSummary measureCallbacks(AudioSource* source, int32_t callbacks) {
+        std::vector<float> buffer(static_cast<size_t>(framesCount) * channelCount);
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(callbacks));
+        for (int32_t callback = 0; callback < callbacks; callback++) {
+            const int64_t start = nowNanos();
+            source->onAudioReady(buffer.data(), framesCount, static_cast<ChannelCount>(channelCount));
+            nanos.push_back(nowNanos() - start);
+            doNotOptimize(buffer[0]);
+        }
+        return summarize(nanos);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 2000;
+    double directMaximumSeconds = 0.5;
+    std::vector<double> lengths = {0.1, 0.5, 1.0, 2.0, 4.0};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--direct-max-seconds") == 0 && i + 1 < argc) {
+            directMaximumSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            callbacks = std::min(callbacks, 200);
+            directMaximumSeconds = std::min(directMaximumSeconds, 0.1);
+            lengths = {0.1, 1.0, 4.0};
+        } else {
+            fprintf(stderr, "Usage: ConvolutionBenchmark [--callbacks N] [--direct-max-seconds S] [--quick]\n");
+            return 1;
+        }
+    }
+
+    const double deadlineNanos = 1e9 * framesCount / samplingRate;
+    printf("method,ir_seconds,ir_frames,partition_frames,partitions,mean_us,p99_us,max_us,load_mean_pct,"
+           "load_p99_pct\n");
+    for (double seconds : lengths) {
+        const auto frames = static_cast<int32_t>(seconds * samplingRate);
+        const std::vector<float> response = impulseResponse(frames);
+        if (seconds <= directMaximumSeconds) {
+            NoiseAudioSource noise;
+            DirectFirAudioSource direct(&noise, response.data(), frames);
+            const TimingSummary timing = measureCallbacks(&direct, callbacks);
+            printf("direct,%.1f,%d,0,0,%.1f,%.1f,%.1f,%.2f,%.2f\n", seconds, frames, timing.mean * 1e-3,
+                   timing.p99 * 1e-3, timing.max * 1e-3, 100.0 * timing.mean / deadlineNanos,
+                   100.0 * timing.p99 / deadlineNanos);
+            fflush(stdout);
+        }
+        for (int32_t partitionFrames : {64, 128, 256, 512}) {
+            NoiseAudioSource noise;
+            ConvolutionAudioSource convolution(&noise, response.data(), frames, 1, channelCount, partitionFrames);
+            const TimingSummary timing = measureCallbacks(&convolution, callbacks);
+            printf("partitioned,%.1f,%d,%d,%d,%.1f,%.1f,%.1f,%.2f,%.2f\n", seconds, frames,
+                   convolution.getPartitionFrames(), convolution.getPartitionCount(), timing.mean * 1e-3,
+                   timing.p99 * 1e-3, timing.max * 1e-3, 100.0 * timing.mean / deadlineNanos,
+                   100.0 * timing.p99 / deadlineNanos);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+
+/* Effect of flushing denormals on a decaying filter tail. A bank of two-pole resonators, as in reverbs and
+ * filters ringing out, renders 256-frame stereo callbacks through an OfflineAudioPlayer on a fresh thread, with
+ * the filter states reset at every callback to a level in the normal range or in the denormal range. The
+ * player either leaves the thread as it is or flushes denormals with AudioThreadSetup
+ * (setAudioThreadFeatures(AudioThreadFlushDenormals)). Without flushing, the denormal tail is typically many times
+ * slower than the normal one; with flushing, both cost the same. Results as CSV on stdout; exits with 2 if the
+ * denormal tail with flushing is slower than the normal one by more than the allowed slowdown (--max-slowdown).
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "BenchmarkStatistics.h"
+#include "OfflineAudioPlayer.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t channelCount = 2;
+    constexpr int samplingRate = 48000;
+    constexpr int32_t resonatorCount = 64;
+
+    /**
+     * Resonators decaying from a fixed level at the start of each callback, summed into all channels;
+     * times its own callbacks
+     */
+    class DecayingResonators : public AudioSource {
+    public:
+        DecayingResonators(float level, int32_t callbacks) : _level(level) {
+            for (int32_t i = 0; i < resonatorCount; i++) {
+                const double frequency = 200.0 + 100.0 * i;
+                const double radius = 0.9999;
+                _feedback[i] = static_cast<float>(2.0 * radius * cos(2.0 * M_PI * frequency / samplingRate));
+                _damping[i] = static_cast<float>(radius * radius);
+            }
+            _nanos.reserve(static_cast<size_t>(callbacks));
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            const int64_t start = nowNanos();
+            for (int32_t i = 0; i < resonatorCount; i++) {
+                _previous[i] = _level;
+                _beforePrevious[i] = 0.0f;
+            }
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                float sum = 0.0f;
+                for (int32_t i = 0; i < resonatorCount; i++) {
+                    const float value = _feedback[i] * _previous[i] - _damping[i] * _beforePrevious[i];
+                    _beforePrevious[i] = _previous[i];
+                    _previous[i] = value;
+                    sum += value;
+                }
+                audioData[frame] = sum;
+            }
+            for (int32_t channel = 1; channel < static_cast<int32_t>(channelCount); channel++) {
+                memcpy(audioData + channel * framesCount, audioData, sizeof(float) * framesCount);
+            }
+            _nanos.push_back(nowNanos() - start);
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+        std::vector<int64_t>& getNanos() {
+            return _nanos;
+        }
+
+    protected:
+        float _level; // state of the resonators at the start of each callback
+        float _feedback[resonatorCount];
+        float _damping[resonatorCount];
+        float _previous[resonatorCount] = {};
+        float _beforePrevious[resonatorCount] = {};
+        std::vector<int64_t> _nanos; // duration of each callback
+    };
+
+    /**
+     * Render on a new thread, such that the floating point settings of other rows do not carry over
+     */
+    TimingSummary measure(float level, bool flush, int32_t callbacks, int32_t& appliedFeatures) {
+        DecayingResonators source(level, callbacks);
+        std::thread thread([&]() {
+            OfflineAudioPlayer player(&source, samplingRate, channelCount, framesCount);
+            player.setAudioThreadFeatures(flush ? AudioThreadFlushDenormals : 0);
+            player.setRenderLength(static_cast<int64_t>(callbacks) * framesCount);
+            player.play();
+            appliedFeatures = player.getAudioThreadSetup().getAppliedFeatures();
+        });
+        thread.join();
+        return summarize(source.getNanos());
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 2000;
+    double maxSlowdown = 2.0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-slowdown") == 0 && i + 1 < argc) {
+            maxSlowdown = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            callbacks = std::min(callbacks, 200);
+        } else {
+            fprintf(stderr, "Usage: DenormalBenchmark [--callbacks N] [--max-slowdown X] [--quick]\n");
+            return 1;
+        }
+    }
+
+    const double deadlineNanos = 1e9 * framesCount / samplingRate;
+    double flushedSlowdown = 0.0;
+    printf("flush,tail,mean_ns,p99_ns,load_mean_pct,slowdown,flushed\n");
+    for (bool flush : {false, true}) {
+        int32_t applied = 0;
+        const TimingSummary normal = measure(1e-3f, flush, callbacks, applied);
+        const TimingSummary denormal = measure(1e-40f, flush, callbacks, applied);
+        const int flushed = (applied & AudioThreadFlushDenormals) != 0 ? 1 : 0;
+        printf("%d,normal,%.1f,%.1f,%.3f,1.00,%d\n", flush ? 1 : 0, normal.mean, normal.p99,
+               100.0 * normal.mean / deadlineNanos, flushed);
+        printf("%d,denormal,%.1f,%.1f,%.3f,%.2f,%d\n", flush ? 1 : 0, denormal.mean, denormal.p99,
+               100.0 * denormal.mean / deadlineNanos, denormal.mean / normal.mean, flushed);
+        fflush(stdout);
+        if (flush) {
+            flushedSlowdown = denormal.mean / normal.mean;
+        }
+    }
+    if (flushedSlowdown > maxSlowdown) {
+        fprintf(stderr, "Denormal tail %.2f times slower than the normal one with flushing, allowed %.2f\n",
+                flushedSlowdown, maxSlowdown);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,209 @@
+
+/* Overhead of the timestamped event queue: cost of AudioPlayer::postEvent on the producer side, and cost of the
+ * audio callback when events arrive at rates of up to 100000 per second, each splitting the block it falls into.
+ * The audio source is a wavetable oscillator bank receiving amplitude events, or a silent source to isolate
+ * the queue and the block splitting. Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "AudioPlayer.h"
+#include "BenchmarkStatistics.h"
+#include "WavetableOscillatorBank.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int samplingRate = 48000;
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t channelCount = 2;
+
+    /**
+     * Player whose callback is driven by the benchmark loop
+     */
+    class ManualAudioPlayer : public AudioPlayer {
+    public:
+        int32_t play() override {
+            return ResultOk;
+        }
+
+        void stop() override {
+            notifyPlaybackStopped();
+        }
+
+        int32_t getChannelCount() override {
+            return channelCount;
+        }
+
+        int32_t getFramesPerDataCallback() override {
+            return framesCount;
+        }
+
+        void callback(float* audioData) {
+            renderAudio(audioData, framesCount, static_cast<ChannelCount>(channelCount));
+        }
+    };
+
+    class SilentAudioSource : public AudioSource {
+    public:
+        void onAudioReady(float* audioData, int32_t frames, ChannelCount channels) override {
+            memset(audioData, 0, sizeof(float) * frames * static_cast<int32_t>(channels));
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+        void onAudioEvent(const AudioEvent& event) override {
+            _sum += event.value;
+        }
+
+    protected:
+        float _sum = 0.0f;
+    };
+
+    /**
+     * Callback times with a given event rate; the events of each block are posted before its callback,
+     * at evenly spread frames
+     */
+    void measureCallbacks(const char* sourceName, AudioSource* source, int32_t eventsPerSecond, int32_t callbacks,
+                          int32_t oscillators) {
+        ManualAudioPlayer player;
+        player.setAudioSource(source);
+        std::vector<float> buffer(static_cast<size_t>(framesCount) * channelCount);
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(callbacks));
+
+        const double eventsPerBlock = static_cast<double>(eventsPerSecond) * framesCount / samplingRate;
+        double eventDebt = 0.0;
+        int64_t posted = 0;
+        int64_t rejected = 0;
+        for (int32_t callback = 0; callback < callbacks; callback++) {
+            eventDebt += eventsPerBlock;
+            const auto events = static_cast<int32_t>(eventDebt);
+            eventDebt -= events;
+            const int64_t blockStart = player.getFrameTime();
+            for (int32_t i = 0; i < events; i++) {
+                AudioEvent event;
+                event.frame = blockStart + static_cast<int64_t>(i) * framesCount / std::max(1, events);
+                event.type = AudioEventAmplitude;
+                event.index = static_cast<int32_t>(posted % std::max(1, oscillators));
+                event.value = 0.5f / std::max(1, oscillators);
+                if (player.postEvent(event) == ResultOk) {
+                    posted++;
+                } else {
+                    rejected++;
+                }
+            }
+            const int64_t start = nowNanos();
+            player.callback(buffer.data());
+            nanos.push_back(nowNanos() - start);
+            doNotOptimize(buffer[0]);
+        }
+        player.stop();
+
+        const TimingSummary summary = summarize(nanos);
+        const double deadlineNanos = 1e9 * framesCount / samplingRate;
+        printf("callback,%s,%d,1,%lld,%.1f,%.1f,%.1f,%.3f,%lld\n", sourceName, eventsPerSecond,
+               static_cast<long long>(posted), summary.mean, summary.p99, summary.max,
+               100.0 * summary.mean / deadlineNanos, static_cast<long long>(rejected));
+        fflush(stdout);
+    }
+
+    /**
+     * Cost of postEvent from several producer threads, while the calling thread drains the queue by rendering
+     */
+    void measurePosting(int32_t producers, int32_t eventsPerProducer) {
+        ManualAudioPlayer player;
+        SilentAudioSource source;
+        player.setAudioSource(&source);
+        std::vector<float> buffer(static_cast<size_t>(framesCount) * channelCount);
+        std::vector<std::vector<int64_t>> nanos(static_cast<size_t>(producers));
+        std::vector<int64_t> rejected(static_cast<size_t>(producers), 0);
+        std::atomic<int32_t> running{producers};
+
+        std::vector<std::thread> threads;
+        for (int32_t producer = 0; producer < producers; producer++) {
+            threads.emplace_back([&, producer]() {
+                std::vector<int64_t>& timings = nanos[producer];
+                timings.reserve(static_cast<size_t>(eventsPerProducer));
+                AudioEvent event;
+                event.type = AudioEventParameter;
+                event.index = producer;
+                for (int32_t i = 0; i < eventsPerProducer; i++) {
+                    event.value = static_cast<float>(i);
+                    const int64_t start = nowNanos();
+                    const int32_t result = player.postEvent(event);
+                    timings.push_back(nowNanos() - start);
+                    if (result != ResultOk) {
+                        rejected[producer]++;
+                        std::this_thread::yield();
+                    }
+                }
+                running.fetch_sub(1);
+            });
+        }
+        while (running.load() > 0) {
+            player.callback(buffer.data());
+            std::this_thread::yield();
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        player.stop();
+
+        std::vector<int64_t> all;
+        int64_t totalRejected = 0;
+        for (int32_t producer = 0; producer < producers; producer++) {
+            all.insert(all.end(), nanos[producer].begin(), nanos[producer].end());
+            totalRejected += rejected[producer];
+        }
+        const TimingSummary summary = summarize(all);
+        printf("post,silent,0,%d,%lld,%.1f,%.1f,%.1f,0,%lld\n", producers, static_cast<long long>(all.size()),
+               summary.mean, summary.p99, summary.max, static_cast<long long>(totalRejected));
+        fflush(stdout);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 5000;
+    bool quick = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else {
+            fprintf(stderr, "Usage: EventQueueBenchmark [--callbacks N] [--quick]\n");
+            return 1;
+        }
+    }
+    if (quick) {
+        callbacks = std::min(callbacks, 500);
+    }
+
+    // For "callback" rows the times are per callback, for "post" rows per postEvent call
+    printf("measurement,source,events_per_second,producers,events,mean_ns,p99_ns,max_ns,load_mean_pct,rejected\n");
+    constexpr int32_t oscillators = 64;
+    const WavetableMipmaps mipmaps(WavetableMipmaps::Waveform::Sawtooth);
+    for (int32_t eventsPerSecond : {0, 1000, 10000, 100000}) {
+        SilentAudioSource silent;
+        measureCallbacks("silent", &silent, eventsPerSecond, callbacks, 0);
+
+        WavetableOscillatorBank bank(&mipmaps, oscillators, samplingRate);
+        for (int32_t i = 0; i < oscillators; i++) {
+            bank.setOscillator(i, 110.0f + 7.0f * i, 0.5f / oscillators);
+        }
+        measureCallbacks("wavetable-64", &bank, eventsPerSecond, callbacks, oscillators);
+    }
+    for (int32_t producers : {1, 2, 4}) {
+        measurePosting(producers, quick ? 20000 : 200000);
+    }
+    return 0;
+}
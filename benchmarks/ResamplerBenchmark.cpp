@@ -0,0 +1,148 @@
+
+/* Cost and accuracy of the ResamplingAudioSource: for each quality preset and a set of rate conversions, the time
+ * of a 256-frame stereo callback (the wrapped source renders a sine with sinf; the "direct" rows give its cost
+ * without resampling), the load relative to the deadline, and the error of the converted sine relative to the
+ * ideal one, in dB. Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "BenchmarkStatistics.h"
+#include "ResamplingAudioSource.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t channelCount = 2;
+    constexpr float sineAmplitude = 0.5f;
+
+    /**
+     * Sine, identical in all channels
+     */
+    class SineAudioSource : public AudioSource {
+    public:
+        SineAudioSource(int samplingRate, double frequency)
+                : _phaseIncrement(2.0 * M_PI * frequency / samplingRate) {
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                audioData[frame] = sineAmplitude * sinf(static_cast<float>(_phase));
+                _phase += _phaseIncrement;
+                if (_phase > 2.0 * M_PI) {
+                    _phase -= 2.0 * M_PI;
+                }
+            }
+            for (int32_t channel = 1; channel < static_cast<int32_t>(channelCount); channel++) {
+                memcpy(audioData + channel * framesCount, audioData, sizeof(float) * framesCount);
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        double _phase = 0.0;
+        double _phaseIncrement;
+    };
+
+    const char* qualityName(ResamplerQuality quality) {
+        switch (quality) {
+            case ResamplerQuality::Fast:
+                return "fast";
+            case ResamplerQuality::Medium:
+                return "medium";
+            case ResamplerQuality::Best:
+                return "best";
+            case ResamplerQuality::High:
+            default:
+                return "high";
+        }
+    }
+
+    /**
+     * Error of a sine converted from sourceRate to outputRate, relative to the ideal sine at the output rate, in dB
+     */
+    double sineErrorDb(int sourceRate, int outputRate, ResamplerQuality quality, double frequency) {
+        SineAudioSource sine(sourceRate, frequency);
+        ResamplingAudioSource resampler(&sine, sourceRate, outputRate, 1, quality);
+        std::vector<float> output(static_cast<size_t>(outputRate) / 4);
+        resampler.onAudioReady(output.data(), static_cast<int32_t>(output.size()), ChannelCount::Mono);
+        double error = 0.0;
+        double power = 0.0;
+        // Past the start, where the filters still see the zeros before the first input frame
+        for (size_t frame = 1024; frame < output.size(); frame++) {
+            const double ideal = sineAmplitude * sin(2.0 * M_PI * frequency * frame / outputRate);
+            error += (output[frame] - ideal) * (output[frame] - ideal);
+            power += ideal * ideal;
+        }
+        return 10.0 * log10(error / power + 1e-30);
+    }
+
+    TimingSummary measureCallbacks(AudioSource* source, int32_t callbacks) {
+        std::vector<float> buffer(static_cast<size_t>(framesCount) * channelCount);
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(callbacks));
+        for (int32_t callback = 0; callback < callbacks; callback++) {
+            const int64_t start = nowNanos();
+            source->onAudioReady(buffer.data(), framesCount, static_cast<ChannelCount>(channelCount));
+            nanos.push_back(nowNanos() - start);
+            doNotOptimize(buffer[0]);
+        }
+        return summarize(nanos);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 5000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            callbacks = std::min(callbacks, 500);
+        } else {
+            fprintf(stderr, "Usage: ResamplerBenchmark [--callbacks N] [--quick]\n");
+            return 1;
+        }
+    }
+
+    struct Conversion {
+        int sourceRate;
+        int outputRate;
+    };
+    const Conversion conversions[] = {{44100, 48000}, {48000, 44100}, {48000, 96000}, {96000, 48000}};
+
+    printf("quality,source_rate,output_rate,taps,mean_ns,p99_ns,ns_per_frame,load_mean_pct,error_1k_db,"
+           "error_10k_db\n");
+    for (const Conversion& conversion : conversions) {
+        const double deadlineNanos = 1e9 * framesCount / conversion.outputRate;
+        SineAudioSource direct(conversion.outputRate, 1000.0);
+        const TimingSummary summary = measureCallbacks(&direct, callbacks);
+        printf("direct,%d,%d,0,%.1f,%.1f,%.2f,%.3f,0,0\n", conversion.sourceRate, conversion.outputRate, summary.mean,
+               summary.p99, summary.mean / framesCount, 100.0 * summary.mean / deadlineNanos);
+        fflush(stdout);
+
+        for (ResamplerQuality quality : {ResamplerQuality::Fast, ResamplerQuality::Medium, ResamplerQuality::High,
+                                         ResamplerQuality::Best}) {
+            SineAudioSource sine(conversion.sourceRate, 1000.0);
+            ResamplingAudioSource resampler(&sine, conversion.sourceRate, conversion.outputRate, channelCount,
+                                            quality);
+            const TimingSummary timing = measureCallbacks(&resampler, callbacks);
+            printf("%s,%d,%d,%d,%.1f,%.1f,%.2f,%.3f,%.1f,%.1f\n", qualityName(quality), conversion.sourceRate,
+                   conversion.outputRate, resampler.getFilterTaps(), timing.mean, timing.p99,
+                   timing.mean / framesCount, 100.0 * timing.mean / deadlineNanos,
+                   sineErrorDb(conversion.sourceRate, conversion.outputRate, quality, 1000.0),
+                   sineErrorDb(conversion.sourceRate, conversion.outputRate, quality, 10000.0));
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,219 @@
+
+/* Startup time with and without the AssetCache. An application needing a set of wavetables (the predefined
+ * waveforms and custom spectra) and of patches (parameter values parsed from text) either generates and parses
+ * them at startup, or maps a cache built beforehand and uses the assets in place. Reports, per method, the time
+ * until the first wavetable can play and until all assets are ready (the cache checks each asset on first use),
+ * with the cache file dropped from the page cache (cold) or not (warm). Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <fcntl.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "AssetCache.h"
+#include "BenchmarkStatistics.h"
+#include "WavetableMipmaps.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int32_t wavetableCount = 32;
+    constexpr int32_t harmonicCount = 256;
+    constexpr int32_t patchCount = 128;
+    constexpr int32_t parametersPerPatch = 64;
+
+    /**
+     * Harmonic amplitudes of the custom spectra
+     */
+    std::vector<float> spectrum(int32_t index) {
+        std::vector<float> amplitudes(harmonicCount);
+        for (int32_t harmonic = 1; harmonic <= harmonicCount; harmonic++) {
+            amplitudes[harmonic - 1] = (harmonic % (index % 5 + 1) == 0 ? 1.0f : 0.3f) /
+                                       static_cast<float>(harmonic + index % 3);
+        }
+        return amplitudes;
+    }
+
+    /**
+     * Patch as stored by an application, as text
+     */
+    std::string patchText(int32_t index) {
+        std::string text;
+        char value[32];
+        for (int32_t parameter = 0; parameter < parametersPerPatch; parameter++) {
+            snprintf(value, sizeof(value), "%.6f ", static_cast<double>((index * 7 + parameter * 13) % 1000) / 1000.0);
+            text += value;
+        }
+        return text;
+    }
+
+    std::string assetName(const char* prefix, int32_t index) {
+        return std::string(prefix) + std::to_string(index);
+    }
+
+    /**
+     * Assets in use, either owned or pointing into the cache
+     */
+    struct Assets {
+        std::vector<std::unique_ptr<WavetableMipmaps>> wavetables;
+        std::vector<std::vector<float>> ownedPatches;
+        std::vector<const float*> patches;
+    };
+
+    void dropFromPageCache(const char* path) {
+        const int file = open(path, O_RDONLY);
+        if (file >= 0) {
+#if defined(__linux__)
+            posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+            close(file);
+        }
+    }
+
+    /**
+     * Touch the table a note at 440 Hz plays, as the first callback would
+     */
+    float firstSound(const WavetableMipmaps& mipmaps) {
+        const float* table = mipmaps.getTables() +
+                             WavetableMipmaps::levelForFrequency(440.0f, 48000) * WavetableMipmaps::levelStride;
+        float sum = 0.0f;
+        for (int32_t index = 0; index < WavetableMipmaps::tableSize; index += 16) {
+            sum += table[index];
+        }
+        return sum;
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t repetitions = 10;
+    const char* directory = "/tmp";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--directory") == 0 && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            repetitions = std::min(repetitions, 3);
+        } else {
+            fprintf(stderr, "Usage: StartupBenchmark [--repetitions N] [--directory path] [--quick]\n");
+            return 1;
+        }
+    }
+
+    // Inputs of the generating application, prepared outside of the measurement
+    std::vector<std::vector<float>> spectra;
+    std::vector<std::string> patches;
+    for (int32_t index = 0; index < wavetableCount; index++) {
+        spectra.push_back(spectrum(index));
+    }
+    for (int32_t index = 0; index < patchCount; index++) {
+        patches.push_back(patchText(index));
+    }
+
+    // The cache, built as BuildAssetCache would
+    const std::string path = std::string(directory) + "/StartupBenchmark.sbcache";
+    {
+        AssetCacheBuilder builder;
+        for (int32_t index = 0; index < wavetableCount; index++) {
+            builder.addWavetable(assetName("wavetable", index).c_str(),
+                                 WavetableMipmaps(spectra[index].data(), harmonicCount));
+        }
+        for (int32_t index = 0; index < patchCount; index++) {
+            std::vector<float> values;
+            const char* text = patches[index].c_str();
+            char* end = nullptr;
+            for (float value = strtof(text, &end); end != text; value = strtof(text, &end)) {
+                values.push_back(value);
+                text = end;
+            }
+            builder.addParameters(assetName("patch", index).c_str(), values.data(),
+                                  static_cast<int32_t>(values.size()));
+        }
+        if (builder.write(path.c_str(), 1) != ResultOk) {
+            fprintf(stderr, "Cannot write %s\n", path.c_str());
+            return 1;
+        }
+    }
+    FILE* file = fopen(path.c_str(), "rb");
+    long fileBytes = 0;
+    if (file != nullptr) {
+        fseek(file, 0, SEEK_END);
+        fileBytes = ftell(file);
+        fclose(file);
+    }
+
+    printf("method,wavetables,patches,cache_bytes,first_wavetable_mean_ms,first_wavetable_max_ms,all_ready_mean_ms,"
+           "all_ready_max_ms\n");
+    for (const char* method : {"generate", "cache_cold", "cache_warm"}) {
+        std::vector<int64_t> firstNanos;
+        std::vector<int64_t> readyNanos;
+        for (int32_t repetition = 0; repetition < repetitions; repetition++) {
+            const bool generate = strcmp(method, "generate") == 0;
+            if (strcmp(method, "cache_cold") == 0) {
+                dropFromPageCache(path.c_str());
+            }
+            Assets assets;
+            AssetCache cache;
+            const int64_t start = nowNanos();
+            if (generate) {
+                for (int32_t index = 0; index < wavetableCount; index++) {
+                    assets.wavetables.emplace_back(new WavetableMipmaps(spectra[index].data(), harmonicCount));
+                    if (index == 0) {
+                        doNotOptimize(firstSound(*assets.wavetables[0]));
+                        firstNanos.push_back(nowNanos() - start);
+                    }
+                }
+                for (int32_t index = 0; index < patchCount; index++) {
+                    std::vector<float> values;
+                    values.reserve(parametersPerPatch);
+                    const char* text = patches[index].c_str();
+                    char* end = nullptr;
+                    for (float value = strtof(text, &end); end != text; value = strtof(text, &end)) {
+                        values.push_back(value);
+                        text = end;
+                    }
+                    assets.ownedPatches.push_back(std::move(values));
+                    assets.patches.push_back(assets.ownedPatches.back().data());
+                }
+            } else {
+                if (cache.open(path.c_str(), 1) != ResultOk) {
+                    fprintf(stderr, "Cannot open %s\n", path.c_str());
+                    return 1;
+                }
+                for (int32_t index = 0; index < wavetableCount; index++) {
+                    const float* tables = cache.findWavetable(assetName("wavetable", index).c_str());
+                    if (tables == nullptr) {
+                        fprintf(stderr, "Corrupt cache %s\n", path.c_str());
+                        return 1;
+                    }
+                    assets.wavetables.emplace_back(new WavetableMipmaps(tables));
+                    if (index == 0) {
+                        doNotOptimize(firstSound(*assets.wavetables[0]));
+                        firstNanos.push_back(nowNanos() - start);
+                    }
+                }
+                for (int32_t index = 0; index < patchCount; index++) {
+                    int32_t count = 0;
+                    assets.patches.push_back(cache.findParameters(assetName("patch", index).c_str(), &count));
+                }
+            }
+            readyNanos.push_back(nowNanos() - start);
+            doNotOptimize(assets.patches.back()[parametersPerPatch - 1]);
+        }
+        const TimingSummary first = summarize(firstNanos);
+        const TimingSummary ready = summarize(readyNanos);
+        printf("%s,%d,%d,%ld,%.3f,%.3f,%.3f,%.3f\n", method, wavetableCount, patchCount, fileBytes, first.mean * 1e-6,
+               first.max * 1e-6, ready.mean * 1e-6, ready.max * 1e-6);
+        fflush(stdout);
+    }
+    unlink(path.c_str());
+    return 0;
+}
@@ -0,0 +1,197 @@
+
+/* Cost of a StaticChain (sine oscillator, gain and one-pole lowpass fused into one loop) compared with the same
+ * processing done by three AudioSources calling each other through virtual functions, one pass over the buffer
+ * per stage. Stereo, for a range of callback sizes, through onAudioReady (planar) and renderInterleaved for the
+ * chain. Results as CSV on stdout, with the largest difference between the outputs as a check.
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "BenchmarkStatistics.h"
+#include "StaticChain.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int32_t channelCount = 2;
+    constexpr int samplingRate = 48000;
+    constexpr float frequency = 440.0f;
+    constexpr float gain = 0.5f;
+    constexpr float cutoff = 2000.0f;
+
+    using FusedVoice = StaticChain<StaticSineOscillator<channelCount>, StaticGain<channelCount>,
+            StaticOnePoleLowpass<channelCount>>;
+
+    /**
+     * Sine computed with the same phasor as StaticSineOscillator, written to the first channel and copied
+     */
+    class VirtualSine : public AudioSource {
+    public:
+        VirtualSine() {
+            const double angle = 2.0 * M_PI * frequency / samplingRate;
+            _rotationCosine = static_cast<float>(cos(angle));
+            _rotationSine = static_cast<float>(sin(angle));
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                if (frame % 64 == 0) {
+                    const float norm = 1.0f / sqrtf(_cosine * _cosine + _sine * _sine);
+                    _cosine *= norm;
+                    _sine *= norm;
+                }
+                audioData[frame] = _sine;
+                const float cosine = _cosine * _rotationCosine - _sine * _rotationSine;
+                _sine = _sine * _rotationCosine + _cosine * _rotationSine;
+                _cosine = cosine;
+            }
+            for (int32_t channel = 1; channel < static_cast<int32_t>(channelCount); channel++) {
+                memcpy(audioData + channel * framesCount, audioData, sizeof(float) * framesCount);
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        float _cosine = 1.0f;
+        float _sine = 0.0f;
+        float _rotationCosine;
+        float _rotationSine;
+    };
+
+    /**
+     * Constant gain applied to the output of another source
+     */
+    class VirtualGain : public AudioSource {
+    public:
+        explicit VirtualGain(AudioSource* input) : _input(input) {
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _input->onAudioReady(audioData, framesCount, channelCount);
+            for (int32_t i = 0; i < framesCount * static_cast<int32_t>(channelCount); i++) {
+                audioData[i] *= gain;
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        AudioSource* _input;
+    };
+
+    /**
+     * One-pole lowpass applied to the output of another source
+     */
+    class VirtualLowpass : public AudioSource {
+    public:
+        explicit VirtualLowpass(AudioSource* input)
+                : _input(input),
+                  _coefficient(static_cast<float>(1.0 - exp(-2.0 * M_PI * cutoff / samplingRate))) {
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _input->onAudioReady(audioData, framesCount, channelCount);
+            for (int32_t channel = 0; channel < static_cast<int32_t>(channelCount); channel++) {
+                float* samples = audioData + channel * framesCount;
+                for (int32_t frame = 0; frame < framesCount; frame++) {
+                    _state[channel] += _coefficient * (samples[frame] - _state[channel]);
+                    samples[frame] = _state[channel];
+                }
+            }
+        }
+
+        void onPlaybackStopped() override {
+        }
+
+    protected:
+        AudioSource* _input;
+        float _coefficient;
+        float _state[channelCount] = {};
+    };
+
+    /**
+     * Time the callbacks of a source, after a warm-up
+     * @param interleaved Call renderInterleaved instead of onAudioReady
+     */
+    TimingSummary measureCallbacks(AudioSource* source, int32_t framesCount, int32_t callbacks, bool interleaved,
+                                   std::vector<float>& buffer) {
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(callbacks));
+        for (int32_t callback = -callbacks / 10; callback < callbacks; callback++) {
+            const int64_t start = nowNanos();
+            if (interleaved) {
+                source->renderInterleaved(buffer.data(), framesCount, static_cast<ChannelCount>(channelCount));
+            } else {
+                source->onAudioReady(buffer.data(), framesCount, static_cast<ChannelCount>(channelCount));
+            }
+            const int64_t elapsed = nowNanos() - start;
+            if (callback >= 0) {
+                nanos.push_back(elapsed);
+            }
+            doNotOptimize(buffer[0]);
+        }
+        return summarize(nanos);
+    }
+
+    FusedVoice makeFusedVoice() {
+        return FusedVoice(StaticSineOscillator<channelCount>(samplingRate, frequency),
+                          StaticGain<channelCount>(0, gain),
+                          StaticOnePoleLowpass<channelCount>(samplingRate, cutoff, 1));
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            callbacks = std::min(callbacks, 1000);
+        } else {
+            fprintf(stderr, "Usage: StaticChainBenchmark [--callbacks N] [--quick]\n");
+            return 1;
+        }
+    }
+
+    printf("frames,variant,mean_ns,p99_ns,ns_per_frame,speedup,max_difference\n");
+    for (int32_t framesCount : {16, 32, 64, 128, 256}) {
+        const auto samples = static_cast<size_t>(framesCount) * channelCount;
+        std::vector<float> reference(samples);
+        std::vector<float> buffer(samples);
+
+        VirtualSine sine;
+        VirtualGain gainStage(&sine);
+        VirtualLowpass lowpass(&gainStage);
+        const TimingSummary virtualTiming = measureCallbacks(&lowpass, framesCount, callbacks, false, reference);
+        printf("%d,virtual,%.1f,%.1f,%.2f,1.00,0\n", framesCount, virtualTiming.mean, virtualTiming.p99,
+               virtualTiming.mean / framesCount);
+
+        for (bool interleaved : {false, true}) {
+            StaticChainAudioSource<FusedVoice> fused(makeFusedVoice());
+            const TimingSummary timing = measureCallbacks(&fused, framesCount, callbacks, interleaved, buffer);
+            // Same number of callbacks as the virtual chain: compare the last blocks
+            float difference = 0.0f;
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                for (int32_t channel = 0; channel < channelCount; channel++) {
+                    const float value = interleaved ? buffer[frame * channelCount + channel]
+                                                    : buffer[channel * framesCount + frame];
+                    difference = std::max(difference, fabsf(value - reference[channel * framesCount + frame]));
+                }
+            }
+            printf("%d,%s,%.1f,%.1f,%.2f,%.2f,%.2g\n", framesCount, interleaved ? "fused-interleaved" : "fused-planar",
+                   timing.mean, timing.p99, timing.mean / framesCount, virtualTiming.mean / timing.mean, difference);
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
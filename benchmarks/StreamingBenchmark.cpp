@@ -0,0 +1,173 @@
+
+/* Memory and callback cost of the StreamingSampleAudioSource. Writes a set of long 16-bit stereo WAV files,
+ * evicts them from the page cache, and plays a given number of voices spread over the samples in real time
+ * (the callbacks are paced at the sampling rate, such that the prefetch thread runs as it would on a device).
+ * Reports the memory taken by the resident parts against decoding the whole samples, the load time, the
+ * resident set size of the process before and after playing, the callback timings and the misses. Results as
+ * CSV on stdout.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "AudioSink.h"
+#include "BenchmarkStatistics.h"
+#include "StreamingSampleAudioSource.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int samplingRate = 48000;
+    constexpr int32_t channelCount = 2;
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t sampleCount = 8;
+
+    /**
+     * Resident set size of the process
+     * @return Size in kB, or 0 if unknown
+     */
+    long residentKilobytes() {
+        FILE* file = fopen("/proc/self/statm", "r");
+        if (file == nullptr) {
+            return 0;
+        }
+        long pages = 0;
+        long resident = 0;
+        if (fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file);
+        return resident * sysconf(_SC_PAGESIZE) / 1024;
+    }
+
+    /**
+     * Write a stereo 16-bit WAV file with a decaying tone, and drop it from the page cache
+     */
+    bool writeSample(const std::string& path, int32_t frames, float frequency) {
+        FileAudioSink sink(path.c_str(), FileAudioSink::FileFormat::Wav, SampleFormat::Int16, DitherMode::None);
+        if (sink.open(samplingRate, channelCount) != ResultOk) {
+            return false;
+        }
+        std::vector<float> block(static_cast<size_t>(samplingRate) * channelCount);
+        for (int32_t offset = 0; offset < frames; offset += samplingRate) {
+            const int32_t count = std::min(samplingRate, frames - offset);
+            for (int32_t frame = 0; frame < count; frame++) {
+                const float time = static_cast<float>(offset + frame) / samplingRate;
+                const float value = 0.5f * expf(-0.1f * time) *
+                                    sinf(2.0f * static_cast<float>(M_PI) * frequency * time);
+                block[frame * channelCount] = value;
+                block[frame * channelCount + 1] = value;
+            }
+            if (sink.write(block.data(), count, channelCount) != ResultOk) {
+                return false;
+            }
+        }
+        sink.close();
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file >= 0) {
+#if defined(__linux__)
+            fdatasync(file);
+            posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+            close(file);
+        }
+        return true;
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double seconds = 10.0;
+    int32_t sampleSeconds = 60;
+    const char* directory = "/tmp";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--sample-seconds") == 0 && i + 1 < argc) {
+            sampleSeconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--directory") == 0 && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            seconds = 2.0;
+            sampleSeconds = 10;
+        } else {
+            fprintf(stderr, "Usage: StreamingBenchmark [--seconds S] [--sample-seconds S] [--directory D] "
+                            "[--quick]\n");
+            return 1;
+        }
+    }
+
+    std::vector<std::string> paths;
+    for (int32_t i = 0; i < sampleCount; i++) {
+        paths.push_back(std::string(directory) + "/StreamingBenchmark" + std::to_string(i) + ".wav");
+        if (!writeSample(paths.back(), sampleSeconds * samplingRate, 110.0f * static_cast<float>(i + 1))) {
+            fprintf(stderr, "Cannot write %s\n", paths.back().c_str());
+            return 1;
+        }
+    }
+
+    printf("voices,samples,resident_kb,full_decode_kb,load_ms,rss_before_kb,rss_after_kb,mean_ns,p99_ns,max_ns,"
+           "misses,missed_frames\n");
+    for (int32_t voices : {8, 32}) {
+        const int64_t loadStart = nowNanos();
+        StreamingSampleAudioSource source(samplingRate, channelCount, voices);
+        for (int32_t i = 0; i < sampleCount; i++) {
+            source.addSample(paths[i].c_str(), 60 + i);
+        }
+        const double loadMillis = 1e-6 * static_cast<double>(nowNanos() - loadStart);
+        source.start();
+        const long rssBefore = residentKilobytes();
+
+        std::vector<float> buffer(static_cast<size_t>(framesCount) * channelCount);
+        const auto callbacks = static_cast<int32_t>(seconds * samplingRate / framesCount);
+        // Start a voice at regular intervals, such that all voices play after the first seconds
+        const int32_t noteInterval = std::max(1, callbacks / (2 * voices));
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(callbacks));
+        const auto period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 * framesCount / samplingRate));
+        auto wakeUp = std::chrono::steady_clock::now();
+        int32_t started = 0;
+        for (int32_t callback = 0; callback < callbacks; callback++) {
+            const int64_t start = nowNanos();
+            if (callback % noteInterval == 0) {
+                AudioEvent event;
+                event.type = AudioEventNoteOn;
+                event.index = 60 + started % sampleCount;
+                event.value = 1.0f / static_cast<float>(voices);
+                source.onAudioEvent(event);
+                started++;
+            }
+            source.onAudioReady(buffer.data(), framesCount, static_cast<ChannelCount>(channelCount));
+            nanos.push_back(nowNanos() - start);
+            doNotOptimize(buffer[0]);
+            wakeUp += period;
+            std::this_thread::sleep_until(wakeUp);
+        }
+        const long rssAfter = residentKilobytes();
+        source.stop();
+        const TimingSummary summary = summarize(nanos);
+        const int64_t fullDecodeBytes = static_cast<int64_t>(sampleCount) * sampleSeconds * samplingRate *
+                                        channelCount * static_cast<int64_t>(sizeof(float));
+        printf("%d,%d,%lld,%lld,%.1f,%ld,%ld,%.1f,%.1f,%.1f,%lld,%lld\n", voices, sampleCount,
+               static_cast<long long>(source.getResidentBytes() / 1024),
+               static_cast<long long>(fullDecodeBytes / 1024), loadMillis, rssBefore, rssAfter, summary.mean,
+               summary.p99, summary.max, static_cast<long long>(source.getMissCount()),
+               static_cast<long long>(source.getMissedFrames()));
+        fflush(stdout);
+    }
+
+    for (const std::string& path : paths) {
+        unlink(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+
+/* Scaling of parallel rendering with the RealtimeThreadPool: a mixer of wavetable oscillator banks (voice groups)
+ * renders with 0 to N worker threads, the player's beginBlock called before each callback as the player would.
+ * Reports callback times, the load relative to the deadline, the speedup over rendering without the pool, and
+ * the number of voices one callback period can hold; plus the overhead of an empty batch. Results as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "BenchmarkStatistics.h"
+#include "MixerAudioSource.h"
+#include "RealtimeThreadPool.h"
+#include "WavetableOscillatorBank.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    constexpr int samplingRate = 48000;
+    constexpr int32_t framesCount = 256;
+    constexpr int32_t channelCount = 2;
+
+    /**
+     * Callback times of a mixer of voice groups, each a wavetable bank
+     */
+    TimingSummary measureMixer(const WavetableMipmaps& mipmaps, int32_t groups, int32_t voicesPerGroup,
+                               int32_t workers, int32_t callbacks, int64_t* missedDeadlines) {
+        std::vector<std::unique_ptr<WavetableOscillatorBank>> banks;
+        MixerAudioSource mixer(groups, channelCount);
+        for (int32_t group = 0; group < groups; group++) {
+            banks.emplace_back(new WavetableOscillatorBank(&mipmaps, voicesPerGroup, samplingRate));
+            for (int32_t voice = 0; voice < voicesPerGroup; voice++) {
+                banks.back()->setOscillator(voice, 55.0f + 3.0f * (group * voicesPerGroup + voice),
+                                            0.5f / (groups * voicesPerGroup));
+            }
+            mixer.attachInput(banks.back().get());
+        }
+        std::unique_ptr<RealtimeThreadPool> pool;
+        if (workers > 0) {
+            pool.reset(new RealtimeThreadPool(workers, samplingRate));
+            mixer.setThreadPool(pool.get());
+        }
+
+        std::vector<float> buffer(static_cast<size_t>(framesCount) * channelCount);
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(callbacks));
+        for (int32_t callback = 0; callback < callbacks; callback++) {
+            const int64_t start = nowNanos();
+            if (pool) {
+                pool->beginBlock(framesCount);
+            }
+            mixer.onAudioReady(buffer.data(), framesCount, static_cast<ChannelCount>(channelCount));
+            nanos.push_back(nowNanos() - start);
+            doNotOptimize(buffer[0]);
+        }
+        *missedDeadlines = pool ? pool->getMissedDeadlineCount() : 0;
+        return summarize(nanos);
+    }
+
+    /**
+     * Time of parallelFor with tasks doing nothing: cost of waking, distributing and joining
+     */
+    TimingSummary measureEmptyBatch(int32_t workers, int32_t batches) {
+        RealtimeThreadPool pool(workers, samplingRate);
+        std::vector<int64_t> nanos;
+        nanos.reserve(static_cast<size_t>(batches));
+        int32_t sink = 0;
+        for (int32_t batch = 0; batch < batches; batch++) {
+            pool.beginBlock(framesCount);
+            const int64_t start = nowNanos();
+            pool.parallelFor([](void* context, int32_t index) {
+                doNotOptimize(*static_cast<int32_t*>(context));
+            }, &sink, 64);
+            nanos.push_back(nowNanos() - start);
+        }
+        return summarize(nanos);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 2000;
+    int32_t maxWorkers = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()) - 1);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            maxWorkers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            callbacks = std::min(callbacks, 200);
+        } else {
+            fprintf(stderr, "Usage: ThreadPoolBenchmark [--callbacks N] [--workers N] [--quick]\n");
+            return 1;
+        }
+    }
+
+    const double deadlineNanos = 1e9 * framesCount / samplingRate;
+    constexpr int32_t groups = 16;
+    constexpr int32_t voicesPerGroup = 64;
+    const WavetableMipmaps mipmaps(WavetableMipmaps::Waveform::Sawtooth);
+
+    printf("measurement,workers,tasks,mean_ns,p99_ns,max_ns,load_mean_pct,speedup,voices_per_period,missed\n");
+    double sequentialMean = 0.0;
+    for (int32_t workers = 0; workers <= maxWorkers; workers++) {
+        int64_t missed = 0;
+        const TimingSummary summary = measureMixer(mipmaps, groups, voicesPerGroup, workers, callbacks, &missed);
+        if (workers == 0) {
+            sequentialMean = summary.mean;
+        }
+        printf("mixer,%d,%d,%.1f,%.1f,%.1f,%.3f,%.2f,%.0f,%lld\n", workers, groups, summary.mean, summary.p99,
+               summary.max, 100.0 * summary.mean / deadlineNanos, sequentialMean / summary.mean,
+               deadlineNanos / summary.p99 * groups * voicesPerGroup, static_cast<long long>(missed));
+        fflush(stdout);
+    }
+    for (int32_t workers = 1; workers <= maxWorkers; workers++) {
+        const TimingSummary summary = measureEmptyBatch(workers, callbacks * 10);
+        printf("empty-batch,%d,64,%.1f,%.1f,%.1f,0,0,0,0\n", workers, summary.mean, summary.p99, summary.max);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+
+/* Note storm benchmark of the VoicePool: a polyphonic wavetable source receives bursts of note-on and note-off
+ * events at every callback, far more than it has voices, so that nearly every note-on steals a voice.
+ * Reports the cost of single noteOn calls and of whole callbacks (events, voice management and rendering),
+ * as CSV on stdout.
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "BenchmarkStatistics.h"
+#include "VoicePool.h"
+#include "WavetableOscillatorBank.h"
+
+using namespace synthesizerBase;
+using namespace synthesizerBase::benchmark;
+
+namespace {
+
+    /**
+     * Polyphonic source: one wavetable oscillator per voice, with a linear release
+     */
+    class PolyphonicWavetableSource : public AudioSource {
+    public:
+        PolyphonicWavetableSource(const WavetableMipmaps* mipmaps, int32_t voices, VoicePool::StealMode stealMode,
+                                  int samplingRate)
+                : _pool(voices, stealMode),
+                  _bank(mipmaps, voices, samplingRate),
+                  _envelopes(static_cast<size_t>(voices)) {
+        }
+
+        /**
+         * @return Voice index, or a negative value if the note was dropped
+         */
+        int32_t noteOn(int32_t note, float velocity) {
+            const int32_t voice = _pool.noteOn(note, velocity);
+            if (voice >= 0) {
+                _envelopes[voice] = velocity;
+                _bank.setOscillator(voice, 440.0f * powf(2.0f, (note - 69) / 12.0f), velocity);
+            }
+            return voice;
+        }
+
+        void noteOff(int32_t note) {
+            _pool.noteOff(note);
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            _bank.onAudioReady(audioData, framesCount, channelCount);
+            // Iterate from the end, as freeVoice reorders the active voices behind the current position
+            const int32_t* active = _pool.activeVoices();
+            for (int32_t i = _pool.activeCount() - 1; i >= 0; i--) {
+                const int32_t voice = active[i];
+                if (_pool.getState(voice) == VoicePool::VoiceReleasing) {
+                    _envelopes[voice] -= releaseStep;
+                    if (_envelopes[voice] <= 0.0f) {
+                        _bank.stopOscillator(voice);
+                        _pool.freeVoice(voice);
+                        continue;
+                    }
+                    _bank.setAmplitude(voice, _envelopes[voice]);
+                }
+                _pool.setLevel(voice, _envelopes[voice]);
+            }
+            _pool.endBlock();
+        }
+
+        void onPlaybackStopped() override {
+            _pool.reset();
+        }
+
+        const VoicePool& getPool() const {
+            return _pool;
+        }
+
+    protected:
+        static constexpr float releaseStep = 0.1f; // per callback
+
+        VoicePool _pool;
+        WavetableOscillatorBank _bank;
+        AlignedBuffer<float> _envelopes;
+    };
+
+    struct Scenario {
+        VoicePool::StealMode stealMode;
+        int32_t voices;
+        int32_t eventsPerCallback; // note-ons, each followed by the note-off of a random note
+    };
+
+    const char* stealModeName(VoicePool::StealMode stealMode) {
+        switch (stealMode) {
+            case VoicePool::StealMode::None:
+                return "none";
+            case VoicePool::StealMode::Oldest:
+                return "oldest";
+            case VoicePool::StealMode::Quietest:
+                return "quietest";
+            case VoicePool::StealMode::SameNote:
+            default:
+                return "same-note";
+        }
+    }
+
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    void runScenario(const WavetableMipmaps& mipmaps, const Scenario& scenario, int32_t callbacks) {
+        constexpr int samplingRate = 48000;
+        constexpr int32_t framesCount = 128;
+        PolyphonicWavetableSource source(&mipmaps, scenario.voices, scenario.stealMode, samplingRate);
+        std::vector<float> buffer(framesCount);
+        std::vector<int64_t> noteOnNanos;
+        std::vector<int64_t> callbackNanos;
+        noteOnNanos.reserve(static_cast<size_t>(callbacks) * scenario.eventsPerCallback);
+        callbackNanos.reserve(static_cast<size_t>(callbacks));
+
+        uint32_t random = 0x9e3779b9u;
+        int64_t dropped = 0;
+        for (int32_t callback = 0; callback < callbacks; callback++) {
+            const int64_t callbackStart = nowNanos();
+            for (int32_t event = 0; event < scenario.eventsPerCallback; event++) {
+                const auto note = static_cast<int32_t>(24 + nextRandom(random) % 72);
+                const float velocity = 0.2f + 0.8f * static_cast<float>(nextRandom(random) % 1000) / 1000.0f;
+                const int64_t start = nowNanos();
+                const int32_t voice = source.noteOn(note, velocity);
+                noteOnNanos.push_back(nowNanos() - start);
+                if (voice < 0) {
+                    dropped++;
+                }
+                source.noteOff(static_cast<int32_t>(24 + nextRandom(random) % 72));
+            }
+            source.onAudioReady(buffer.data(), framesCount, ChannelCount::Mono);
+            callbackNanos.push_back(nowNanos() - callbackStart);
+            doNotOptimize(buffer[0]);
+        }
+
+        const int64_t stolen = source.getPool().getStolenCount();
+        const TimingSummary noteOn = summarize(noteOnNanos);
+        const TimingSummary callback = summarize(callbackNanos);
+        printf("%s,%d,%d,%d,%.1f,%.1f,%.1f,%.3f,%.3f,%.3f,%lld,%lld\n",
+               stealModeName(scenario.stealMode), scenario.voices, scenario.eventsPerCallback, callbacks,
+               noteOn.mean, noteOn.p99, noteOn.max, callback.mean / 1000, callback.p99 / 1000, callback.max / 1000,
+               static_cast<long long>(stolen), static_cast<long long>(dropped));
+        fflush(stdout);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int32_t callbacks = 5000;
+    bool quick = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--callbacks") == 0 && i + 1 < argc) {
+            callbacks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else {
+            fprintf(stderr, "Usage: VoicePoolBenchmark [--callbacks N] [--quick]\n");
+            return 1;
+        }
+    }
+    if (quick) {
+        callbacks = std::min(callbacks, 500);
+    }
+
+    const WavetableMipmaps mipmaps(WavetableMipmaps::Waveform::Sawtooth);
+    printf("steal_mode,voices,events_per_callback,callbacks,note_on_mean_ns,note_on_p99_ns,note_on_max_ns,"
+           "callback_mean_us,callback_p99_us,callback_max_us,stolen,dropped\n");
+    const std::vector<int32_t> voiceCounts = quick ? std::vector<int32_t>{64} : std::vector<int32_t>{16, 64, 256};
+    const std::vector<int32_t> eventCounts = quick ? std::vector<int32_t>{32} : std::vector<int32_t>{8, 32, 128};
+    for (VoicePool::StealMode stealMode : {VoicePool::StealMode::None, VoicePool::StealMode::Oldest,
+                                           VoicePool::StealMode::Quietest, VoicePool::StealMode::SameNote}) {
+        for (int32_t voices : voiceCounts) {
+            for (int32_t events : eventCounts) {
+                runScenario(mipmaps, {stealMode, voices, events}, callbacks);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef AlignedBuffer_H
+#define AlignedBuffer_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace synthesizerBase {
+
+    /**
+     * Alignment of AlignedBuffer storage, in bytes: a cache line, and enough for AVX and NEON loads
+     */
+    constexpr size_t audioBufferAlignment = 64;
+
+    /**
+     * @brief Zero-initialized array of trivially copyable elements with cache-line alignment
+     *
+     * Allocated once at construction or by resize, from a non-real-time thread; element access is
+     * allocation-free. Not copyable.
+     * @tparam T Element type
+     */
+    template<typename T>
+    class AlignedBuffer {
+    public:
+        AlignedBuffer() = default;
+
+        /**
+         * Constructor
+         * @param size Number of elements
+         */
+        explicit AlignedBuffer(size_t size) {
+            resize(size);
+        }
+
+        ~AlignedBuffer() {
+            free(_data);
+        }
+
+        AlignedBuffer(const AlignedBuffer&) = delete;
+        AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+        /**
+         * Reallocate the buffer; the previous contents are discarded and the new elements are zero
+         * @param size Number of elements
+         */
+        void resize(size_t size) {
+            free(_data);
+            _data = nullptr;
+            _size = 0;
+            if (size == 0) {
+                return;
+            }
+            // Round up to whole cache lines, such that vector loops may run over the end of the last element
+            const size_t bytes = (size * sizeof(T) + audioBufferAlignment - 1) / audioBufferAlignment *
+                                 audioBufferAlignment;
+            void* memory = nullptr;
+            if (posix_memalign(&memory, audioBufferAlignment, bytes) != 0) {
+                return;
+            }
+            memset(memory, 0, bytes);
+            _data = static_cast<T*>(memory);
+            _size = size;
+        }
+
+        T* data() { return _data; }
+        const T* data() const { return _data; }
+        size_t size() const { return _size; }
+        T& operator[](size_t index) { return _data[index]; }
+        const T& operator[](size_t index) const { return _data[index]; }
+
+    protected:
+        T* _data = nullptr;
+        size_t _size = 0;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
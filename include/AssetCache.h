@@ -0,0 +1,213 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Binary cache of precomputed assets (wavetables, patch parameters, other data), memory-mapped and used in place.
+ *
+ * File layout, little endian: a 64-byte header (magic "SBCACHE", format version, entry count, content version,
+ * file size, checksum of the directory), the directory (one 64-byte entry per asset: name, type, element count,
+ * offset, size, checksum), then the payloads, each starting at a multiple of 64 bytes, such that float arrays
+ * can be handed to vector code and to WavetableMipmaps(const float*) without a copy.
+ */
+
+#ifndef AssetCache_H
+#define AssetCache_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "AudioDefinitions.h"
+#include "WavetableMipmaps.h"
+
+namespace synthesizerBase {
+
+    /**
+     * Kind of an asset, checked when it is looked up
+     */
+    enum class AssetType : uint32_t {
+        Data = 0, // any bytes
+        Wavetable, // WavetableMipmaps tables, levelCount*levelStride floats
+        Parameters, // float values, e.g. the parameters of a patch
+    };
+
+    /**
+     * @brief Read-only view of an asset cache file
+     *
+     * open() maps the file and checks the header and the directory, which takes a few microseconds whatever the
+     * size of the assets. The payload of an asset is checked against its checksum the first time it is looked up
+     * (lazy validation), so that assets that are not used are never read from storage. Lookups return pointers
+     * into the mapping, valid until close() or destruction. Applications open the cache at startup, and rebuild
+     * it with AssetCacheBuilder if open() or a lookup fails, e.g. after an update changing the content version.
+     */
+    class AssetCache {
+    public:
+        /**
+         * Version of the file layout; files of other versions are rejected
+         */
+        static constexpr uint32_t formatVersion = 1;
+
+        /**
+         * Longest asset name, in characters
+         */
+        static constexpr int32_t maxNameLength = 31;
+
+        /**
+         * Alignment of the payloads in the file, in bytes
+         */
+        static constexpr size_t payloadAlignment = 64;
+
+        AssetCache() = default;
+
+        ~AssetCache();
+
+        AssetCache(const AssetCache&) = delete;
+
+        AssetCache& operator=(const AssetCache&) = delete;
+
+        /**
+         * Map a cache file and check its header and directory
+         * @param path Path of the file
+         * @param contentVersion Version of the content expected by the application; 0 accepts any
+         * @return ResultOk, ResultErrorIO if the file cannot be mapped, ResultErrorInvalidState if it is not a
+         *         valid cache of this format version and content version
+         */
+        int32_t open(const char* path, uint64_t contentVersion = 0);
+
+        /**
+         * Unmap the file; pointers returned by the lookups become invalid
+         */
+        void close();
+
+        bool isOpen() const;
+
+        /**
+         * Number of assets in the cache
+         */
+        int32_t getAssetCount() const;
+
+        /**
+         * Content version stored in the file
+         */
+        uint64_t getContentVersion() const;
+
+        /**
+         * @brief Look up an asset, checking its payload on first use
+         * @param name Name of the asset
+         * @param type Expected type
+         * @param bytes Optional; receives the size of the payload in bytes
+         * @param count Optional; receives the number of elements given when the asset was added
+         * @return Start of the payload, 64-byte aligned, or nullptr if missing, of another type or corrupt
+         */
+        const void* find(const char* name, AssetType type, size_t* bytes = nullptr, uint32_t* count = nullptr);
+
+        /**
+         * Look up wavetables, to be passed to WavetableMipmaps(const float*)
+         * @param name Name of the asset
+         * @return WavetableMipmaps::levelCount*WavetableMipmaps::levelStride floats, or nullptr
+         */
+        const float* findWavetable(const char* name);
+
+        /**
+         * Look up parameter values
+         * @param name Name of the asset
+         * @param count Receives the number of values
+         * @return Values, or nullptr
+         */
+        const float* findParameters(const char* name, int32_t* count);
+
+        /**
+         * Check the payloads of all assets now, e.g. from a background thread after startup
+         * @return ResultOk, or ResultErrorInvalidState if an asset is corrupt
+         */
+        int32_t validateAll();
+
+    protected:
+        /**
+         * Check the payload of an asset against its checksum, once
+         * @param index Index of the asset in the directory
+         * @return true if valid
+         */
+        bool validate(int32_t index);
+
+        const uint8_t* _map = nullptr; // the whole file
+        size_t _mapBytes = 0;
+        int32_t _assetCount = 0;
+        uint64_t _contentVersion = 0;
+        std::unique_ptr<std::atomic<int32_t>[]> _validation; // per asset: 0 unchecked, 1 valid, -1 corrupt
+    };
+
+    /**
+     * @brief Writer of asset cache files, e.g. in a build tool or in a background thread of the application
+     */
+    class AssetCacheBuilder {
+    public:
+        /**
+         * Add an asset; the data is copied
+         * @param name Name, at most AssetCache::maxNameLength characters
+         * @param type Type
+         * @param data Payload
+         * @param bytes Size of the payload
+         * @param count Number of elements, returned by AssetCache::find
+         * @return ResultOk, or ResultErrorInvalidArgument if the name is empty, too long or already used
+         */
+        int32_t addData(const char* name, AssetType type, const void* data, size_t bytes, uint32_t count);
+
+        /**
+         * Add the tables of a wavetable mipmap
+         * @param name Name
+         * @param mipmaps Wavetables
+         * @return As addData
+         */
+        int32_t addWavetable(const char* name, const WavetableMipmaps& mipmaps);
+
+        /**
+         * Add parameter values
+         * @param name Name
+         * @param values Values
+         * @param count Number of values
+         * @return As addData
+         */
+        int32_t addParameters(const char* name, const float* values, int32_t count);
+
+        /**
+         * Write the cache; the file is written under a temporary name and renamed, such that readers never see
+         * a partial file
+         * @param path Path of the file
+         * @param contentVersion Version of the content, checked by AssetCache::open
+         * @return ResultOk, or ResultErrorIO
+         */
+        int32_t write(const char* path, uint64_t contentVersion = 0) const;
+
+    protected:
+        struct Asset {
+            std::string name;
+            AssetType type;
+            uint32_t count;
+            std::vector<uint8_t> data;
+        };
+
+        std::vector<Asset> _assets;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,90 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Definitions shared by all parts of the library, independent of the audio driver system.
+ *
+ * On Android, the library is built against oboe and the channel count type is oboe's own,
+ * such that AudioSource implementations can be written against oboe::ChannelCount as before.
+ * When built without oboe (SYNTHESIZERBASE_NO_OBOE, e.g. for offline rendering on Linux),
+ * an equivalent type is provided here.
+ */
+
+#ifndef AudioDefinitions_H
+#define AudioDefinitions_H
+
+#include <stdint.h>
+
+#ifndef SYNTHESIZERBASE_NO_OBOE
+#include <oboe/Oboe.h>
+#endif
+
+#define defaultAudioFrameSize 256
+#define defaultAudioChannelNumber 1
+
+namespace synthesizerBase {
+
+#ifndef SYNTHESIZERBASE_NO_OBOE
+    /**
+     * Number of audio channels, 1=mono, 2=stereo. Identical to oboe::ChannelCount when built with oboe.
+     */
+    using ChannelCount = oboe::ChannelCount;
+#else
+    /**
+     * Number of audio channels, 1=mono, 2=stereo. Replacement for oboe::ChannelCount when
+     * building without oboe; other channel numbers can be obtained by static_cast.
+     */
+    enum ChannelCount : int32_t {
+        Unspecified = 0,
+        Mono = 1,
+        Stereo = 2,
+    };
+#endif
+
+    /**
+     * Arrangement of the samples of several channels in a buffer
+     */
+    enum class SampleLayout : int32_t {
+        Planar = 0, // one block per channel, float[channelCount][framesCount], as in AudioSource::onAudioReady
+        Interleaved, // one frame after the other, float[framesCount][channelCount], as oboe and audio files use
+    };
+
+    /**
+     * Encoding of the samples handed to an audio device or written to a file
+     */
+    enum class SampleFormat : int32_t {
+        Float = 0, // 32-bit float in [-1, 1], as rendered by the audio sources
+        Int16, // 16-bit signed integer
+        Int24Packed, // 24-bit signed integer, 3 bytes little endian
+        Int32, // 32-bit signed integer
+    };
+
+    /**
+     * Result codes for the functions of this library that do not relay oboe results. 0 means success,
+     * negative values are errors.
+     */
+    enum ResultCode : int32_t {
+        ResultOk = 0,
+        ResultErrorInvalidArgument = -1,
+        ResultErrorInvalidState = -2,
+        ResultErrorIO = -3,
+    };
+
+}  // namespace synthesizerBase
+
+#endif
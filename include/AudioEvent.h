@@ -0,0 +1,61 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Timestamped events sent from control threads (MIDI, UI, sequencers) to the audio source.
+ *
+ * The audio player keeps a frame clock, the number of frames rendered so far (AudioPlayer::getFrameTime). An event
+ * carries the frame time at which it takes effect: the player splits its block at that frame and calls
+ * AudioSource::onAudioEvent between the two parts, so that the change is sample-accurate. Events whose frame time
+ * has already passed take effect at the start of the next block.
+ */
+
+#ifndef AudioEvent_H
+#define AudioEvent_H
+
+#include <stdint.h>
+
+namespace synthesizerBase {
+
+    /**
+     * Event types known to the library; audio sources ignore the types they do not handle. Application-specific
+     * types start at AudioEventUser.
+     */
+    enum AudioEventType : int32_t {
+        AudioEventNoteOn = 0, // index: note number, value: velocity
+        AudioEventNoteOff, // index: note number
+        AudioEventParameter, // index: parameter identifier, value: parameter value
+        AudioEventFrequency, // index: oscillator or voice, value: frequency in Hz
+        AudioEventAmplitude, // index: oscillator or voice, value: linear amplitude
+        AudioEventUser = 1024,
+    };
+
+    /**
+     * @brief Event to be applied by the audio source at a given frame
+     */
+    struct AudioEvent {
+        int64_t frame = 0; // frame time at which the event takes effect; 0 for as soon as possible
+        int32_t type = AudioEventParameter; // AudioEventType or application-specific type
+        int32_t index = 0; // e.g. note number, parameter identifier or voice, depending on the type
+        float value = 0.0f; // e.g. velocity or parameter value, depending on the type
+    };
+
+}  // namespace synthesizerBase
+
+#endif
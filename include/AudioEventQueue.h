@@ -0,0 +1,128 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef AudioEventQueue_H
+#define AudioEventQueue_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include "AudioEvent.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Bounded lock-free queue of audio events, for any number of producer threads and one consumer thread
+     *
+     * This is D. Vyukov's bounded queue: each cell carries a sequence number telling whether it is ready for
+     * writing or for reading at the current lap, so that producers only contend on one atomic index and the
+     * consumer does not need atomic read-modify-write operations at all. The cells are allocated once in the
+     * constructor; push and pop neither allocate nor block, and run in constant time except for retries
+     * of producers racing each other. The capacity is rounded up to a power of two.
+     */
+    class AudioEventQueue {
+    public:
+        /**
+         * Constructor
+         * @param capacity Minimum number of events the queue can hold
+         */
+        explicit AudioEventQueue(int32_t capacity) {
+            uint64_t size = 2;
+            while (size < static_cast<uint64_t>(capacity)) {
+                size <<= 1;
+            }
+            _cells.reset(new Cell[size]);
+            _mask = size - 1;
+            for (uint64_t i = 0; i < size; i++) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        AudioEventQueue(const AudioEventQueue&) = delete;
+        AudioEventQueue& operator=(const AudioEventQueue&) = delete;
+
+        /**
+         * Add an event (any thread)
+         * @param event Event to add
+         * @return true on success, false if the queue is full
+         */
+        bool push(const AudioEvent& event) {
+            uint64_t position = _enqueuePosition.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &_cells[position & _mask];
+                const uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<int64_t>(sequence - position);
+                if (difference == 0) {
+                    // The cell is free at this lap: claim it
+                    if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false; // the consumer has not read this cell of the previous lap yet
+                } else {
+                    position = _enqueuePosition.load(std::memory_order_relaxed); // another producer was faster
+                }
+            }
+            cell->event = event;
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Remove the oldest event (consumer thread only)
+         * @param event Receives the event
+         * @return true on success, false if the queue is empty
+         */
+        bool pop(AudioEvent& event) {
+            const uint64_t position = _dequeuePosition.load(std::memory_order_relaxed);
+            Cell& cell = _cells[position & _mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+                return false;
+            }
+            event = cell.event;
+            // Ready for writing at the next lap
+            cell.sequence.store(position + _mask + 1, std::memory_order_release);
+            _dequeuePosition.store(position + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * Number of events the queue can hold
+         */
+        int32_t capacity() const {
+            return static_cast<int32_t>(_mask + 1);
+        }
+
+    protected:
+        struct Cell {
+            std::atomic<uint64_t> sequence;
+            AudioEvent event;
+        };
+
+        std::unique_ptr<Cell[]> _cells;
+        uint64_t _mask;
+        alignas(64) std::atomic<uint64_t> _enqueuePosition{0}; // written by the producers
+        alignas(64) std::atomic<uint64_t> _dequeuePosition{0}; // written by the consumer
+    };
+
+}  // namespace synthesizerBase
+
+#endif
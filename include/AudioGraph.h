@@ -0,0 +1,265 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef AudioGraph_H
+#define AudioGraph_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+#include "AlignedBuffer.h"
+#include "AudioSource.h"
+#include "RealtimeThreadPool.h"
+#include "SpscRingBuffer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Processing node of an AudioGraph
+     *
+     * A node renders one block from the blocks of its inputs, all with the planar layout of AudioSource,
+     * float[channelCount][framesCount]. process is called exactly once per block, however many nodes use the output.
+     */
+    class AudioGraphNode {
+    public:
+        virtual ~AudioGraphNode() = default;
+
+        /**
+         * Render one block (audio thread)
+         * @param inputs Output blocks of the input nodes, in the order they were connected
+         * @param inputCount Number of inputs
+         * @param output Block to be filled
+         * @param framesCount Number of frames
+         * @param channelCount Number of channels
+         */
+        virtual void process(const float* const* inputs, int32_t inputCount, float* output, int32_t framesCount,
+                             ChannelCount channelCount) = 0;
+
+        /**
+         * Notify the node that playing stopped
+         */
+        virtual void onPlaybackStopped() {}
+
+        /**
+         * Apply an event, see AudioSource::onAudioEvent; the default implementation ignores all events
+         */
+        virtual void onAudioEvent(const AudioEvent& event) {}
+    };
+
+    /**
+     * @brief Graph node rendering an audio source, without inputs; writes zeros while the source is idle
+     */
+    class AudioSourceNode : public AudioGraphNode {
+    public:
+        /**
+         * Constructor
+         * @param source Audio source, owned by the caller
+         */
+        explicit AudioSourceNode(AudioSource* source) : _source(source) {}
+
+        void process(const float* const* inputs, int32_t inputCount, float* output, int32_t framesCount,
+                     ChannelCount channelCount) override;
+
+        void onPlaybackStopped() override;
+
+        void onAudioEvent(const AudioEvent& event) override;
+
+    protected:
+        AudioSource* _source;
+    };
+
+    /**
+     * @brief Graph node summing its inputs
+     */
+    class MixNode : public AudioGraphNode {
+    public:
+        void process(const float* const* inputs, int32_t inputCount, float* output, int32_t framesCount,
+                     ChannelCount channelCount) override;
+    };
+
+    /**
+     * @brief Audio source rendering a graph of processing nodes
+     *
+     * Nodes are added and connected from a control thread, then commit compiles the graph: the nodes the output
+     * depends on are sorted topologically into waves, each wave holding nodes whose inputs are all computed by
+     * earlier waves, and each node gets a buffer of a preallocated arena for its output. Buffers are reused as soon
+     * as the wave of their last consumer has run (liveness analysis), so a chain of any length needs only two
+     * buffers. With a thread pool (setThreadPool), the nodes of a wave render in parallel. The compiled schedule is
+     * handed to the audio thread lock-free and adopted at the start of its next block; rendering a block then only
+     * calls the nodes in order, each once, with precomputed buffer pointers.
+     * A node feeding several consumers (an LFO, a noise generator, a shared effect send) is thus rendered once.
+     * <br />
+     * Nodes are owned by the caller. A node removed from the graph may still be used by the audio thread until the
+     * schedule without it is adopted: delete it only once isCommitPending returns false, or while not playing.
+     * Blocks longer than the block size given at construction are rendered in several parts.
+     */
+    class AudioGraph : public AudioSource {
+    public:
+        /**
+         * Constructor
+         * @param maxNodes Maximum number of nodes
+         * @param channelCount Number of channels; onAudioReady must be called with this channel count
+         * @param blockFrames Frames per buffer of the arena; longer requests are rendered in several parts
+         */
+        AudioGraph(int32_t maxNodes, int32_t channelCount, int32_t blockFrames = defaultAudioFrameSize);
+
+        ~AudioGraph() override;
+
+        /**
+         * Add a node (control thread); it is rendered after the next commit if the output depends on it
+         * @param node Node, owned by the caller
+         * @return Node identifier, or ResultErrorInvalidState if maxNodes nodes are in the graph
+         */
+        int32_t addNode(AudioGraphNode* node);
+
+        /**
+         * Remove a node and all its connections (control thread)
+         * @param node Node identifier
+         * @return ResultOk, or ResultErrorInvalidArgument if there is no such node
+         */
+        int32_t removeNode(int32_t node);
+
+        /**
+         * Add an input to a node (control thread); inputs are passed to process in the order they were connected
+         * @param source Node identifier of the input
+         * @param destination Node identifier of the node using it
+         * @return ResultOk, or ResultErrorInvalidArgument if a node does not exist
+         */
+        int32_t connect(int32_t source, int32_t destination);
+
+        /**
+         * Remove an input from a node (control thread)
+         * @param source Node identifier of the input
+         * @param destination Node identifier of the node using it
+         * @return ResultOk, or ResultErrorInvalidArgument if there is no such connection
+         */
+        int32_t disconnect(int32_t source, int32_t destination);
+
+        /**
+         * Set the node whose output is the output of the graph (control thread)
+         * @param node Node identifier
+         * @return ResultOk, or ResultErrorInvalidArgument if there is no such node
+         */
+        int32_t setOutputNode(int32_t node);
+
+        /**
+         * @brief Compile the graph and hand the schedule to the audio thread (control thread)
+         *
+         * Allocates on the calling thread only. Also releases the schedules the audio thread no longer uses.
+         * @return ResultOk, or ResultErrorInvalidArgument if the nodes the output depends on form a cycle
+         */
+        int32_t commit();
+
+        /**
+         * Whether the audio thread has not adopted the last committed schedule yet (control thread)
+         * @return true if the last commit is pending
+         */
+        bool isCommitPending() const;
+
+        /**
+         * Number of nodes rendered per block with the last committed schedule (control thread)
+         */
+        int32_t getScheduledNodeCount() const;
+
+        /**
+         * Number of arena buffers used by the last committed schedule (control thread)
+         */
+        int32_t getBufferCount() const;
+
+        /**
+         * Render the independent nodes of each wave in parallel on a thread pool. Call while not playing. Nodes
+         * must then support being rendered on any thread of the pool.
+         * @param pool Thread pool, owned by the caller, or nullptr to render all nodes on the audio thread
+         */
+        void setThreadPool(RealtimeThreadPool* pool);
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Relay to the scheduled nodes
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Relay to the scheduled nodes
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+    protected:
+        struct NodeEntry {
+            AudioGraphNode* node = nullptr; // nullptr if the entry is unused
+            std::vector<int32_t> inputs;
+        };
+
+        struct Step {
+            AudioGraphNode* node;
+            const float* const* inputs; // into Schedule::inputPointers
+            int32_t inputCount;
+            float* output; // into Schedule::arena
+        };
+
+        /**
+         * Compiled graph, immutable once published
+         */
+        struct Schedule {
+            std::vector<Step> steps; // ordered by wave
+            std::vector<int32_t> waveEnds; // index of the step after the last one of each wave
+            std::vector<const float*> inputPointers;
+            AlignedBuffer<float> arena; // bufferCount blocks of float[channelCount][blockFrames]
+            int32_t bufferCount = 0;
+            const float* output = nullptr; // nullptr for silence
+        };
+
+        /**
+         * Adopt a newly committed schedule, if any (audio thread)
+         */
+        void adoptPendingSchedule();
+
+        /**
+         * Delete the schedules handed back by the audio thread (control thread)
+         */
+        void releaseRetiredSchedules();
+
+        /**
+         * Task of the thread pool: render one step of the current wave
+         */
+        static void processStepTask(void* context, int32_t index);
+
+        int32_t _channelCount;
+        int32_t _blockFrames;
+        std::vector<NodeEntry> _nodes; // control thread
+        int32_t _outputNode = -1;
+        int32_t _scheduledNodeCount = 0;
+        int32_t _bufferCount = 0;
+
+        std::atomic<Schedule*> _pending{nullptr}; // committed, not yet adopted
+        Schedule* _current = nullptr; // audio thread
+        SpscRingBuffer<Schedule*> _retired{16}; // handed back by the audio thread
+
+        RealtimeThreadPool* _threadPool = nullptr;
+        const Step* _waveSteps = nullptr; // audio thread: wave the pool tasks render
+        int32_t _waveFrames = 0;
+        ChannelCount _waveChannelCount = ChannelCount::Mono;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
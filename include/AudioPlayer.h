@@ -29,7 +29,7 @@
  * implementations of the Audio system such as Oboe and others.
  * The details of implementation are left to daughter classes of this abstract base class
  *
- * Of note, the AudioSource member "_source" is solely defined through the interface AudioSource
+ * Of note, the AudioSource (held by the member "_sourceExchange") is solely defined through the interface AudioSource
  * and so whatever else it does (e.g. simulations, midi messaging, really, whatever) does not direclty
  * matter for the purpose of the Audioplayer
  */
@@ -38,9 +38,16 @@
 #ifndef AudioPlayer_H
 #define AudioPlayer_H
 
+#include <atomic>
 #include <stdint.h>
+#include <vector>
+#include "AudioEventQueue.h"
 #include "AudioSource.h"
 #include "AudioSourceConsumer.h"
+#include "AudioSourceExchange.h"
+#include "AudioThreadSetup.h"
+#include "CallbackTelemetry.h"
+#include "RealtimeThreadPool.h"
 
 namespace synthesizerBase {
     /** @brief Virtual base class for an audio player.
@@ -54,7 +61,9 @@ namespace synthesizerBase {
      */
 class AudioPlayer: public AudioSourceConsumer{
  public:
-  virtual ~AudioPlayer() = default;
+  AudioPlayer();
+
+  virtual ~AudioPlayer();
 
   /**
    * @brief Start playing, by starting to transmit data from the audio source to the audio driver
@@ -82,9 +91,25 @@ class AudioPlayer: public AudioSourceConsumer{
    * oboe::AudioStreamDataCallback such that it can respond to the callback from the oboe framework when data is needed
    * When the audioPlayer is called back from the oboe framework, it onovkes the onAudioReady method on the
    * AudioSource object it posses. The AudioSource object is then responsible for filling the data for the oboe
+   * <br />
+   * The source can be changed while playing: the audio thread switches to the new source at the start of its
+   * next block. The previous source must not be deleted before it is returned by collectRetiredAudioSource.
+   * @param source Audio source
+   * @return ResultOk, or ResultErrorInvalidState if AudioSourceExchange::referenceCapacity sources are in use or
+   *         wait for collectRetiredAudioSource: the source was not set, collect them first
+   */
+  int32_t setAudioSource(AudioSource* source) override;
+
+  /**
+   * @brief Set the audio source, crossfading from the previous one
+   *
+   * As setAudioSource(AudioSource*), but the audio thread renders both sources during crossfadeFrames frames
+   * and fades linearly from the previous source to the new one. Neither thread locks or waits.
    * @param source Audio source
+   * @param crossfadeFrames Length of the crossfade, in frames. 0 switches directly.
+   * @return ResultOk, or ResultErrorInvalidState if the source was not set, as for setAudioSource(AudioSource*)
    */
-  void setAudioSource(AudioSource* source) override;
+  int32_t setAudioSource(AudioSource* source, int32_t crossfadeFrames);
 
   /**
    * Get the audio source
@@ -93,6 +118,23 @@ class AudioPlayer: public AudioSourceConsumer{
 
   AudioSource* getAudioSource() override;
 
+  /**
+   * @brief Take back an audio source that was replaced and is no longer used by the audio thread
+   *
+   * Call this from the thread that sets the audio source, repeatedly until it returns nullptr, for example
+   * before deleting replaced sources. While the player is stopped, the current source is not used either.
+   * @return A replaced audio source that can be deleted, or nullptr
+   */
+  AudioSource* collectRetiredAudioSource();
+
+  /**
+   * @brief Switch to the audio source set last at once (while not playing)
+   *
+   * Without a running audio thread, a new source is only adopted when playback starts again, and the source it
+   * replaces is not returned by collectRetiredAudioSource before. This adopts it now, without crossfade.
+   */
+  void adoptAudioSource();
+
   /**
    * Get the number of audio channels currently configured
    * @return The number of audio channels currently configured. 1=mono, 2=stereo, more
@@ -109,8 +151,151 @@ class AudioPlayer: public AudioSourceConsumer{
    */
   virtual int32_t getFramesPerDataCallback()=0;
 
+  /**
+   * @brief Get the instrumentation of the audio callback
+   *
+   * Only available if the library is built with SYNTHESIZERBASE_TELEMETRY (CMake option
+   * SYNTHESIZERBASE_ENABLE_TELEMETRY). Call CallbackTelemetry::poll regularly from a non-real-time thread
+   * to collect the measurements.
+   * @return Callback telemetry, or nullptr if built without telemetry
+   */
+  CallbackTelemetry* getTelemetry();
+
+  /**
+   * Number of events that can be posted ahead of the audio thread
+   */
+  static constexpr int32_t eventQueueCapacity = 1024;
+
+  /**
+   * @brief Send a timestamped event to the audio source (any thread)
+   *
+   * The audio thread collects the events at the start of each block and calls AudioSource::onAudioEvent at the
+   * frame given by the event, splitting the rendering of the block at that frame. Events for the same frame are
+   * applied in the order they were posted by one thread. Neither this function nor the audio thread allocate
+   * or lock.
+   * @param event Event; event.frame is a frame time as given by getFrameTime, or 0 to apply it at the next block
+   * @return ResultOk, or ResultErrorInvalidState if too many events are pending
+   */
+  int32_t postEvent(const AudioEvent& event);
+
+  /**
+   * @brief Drop the events posted or staged but not delivered yet (while not playing)
+   *
+   * E.g. events scheduled after the end of an offline rendering, before the player renders something else.
+   */
+  void discardEvents();
+
+  /**
+   * @brief Current frame time (any thread)
+   *
+   * Number of frames rendered since the player was created, updated at the end of each block. Add the desired
+   * delay to schedule events, e.g. getFrameTime() + getFramesPerDataCallback() to keep the timing of events
+   * produced at irregular intervals.
+   * @return Frame time
+   */
+  int64_t getFrameTime() const;
+
+  /**
+   * @brief Set the thread pool woken at the start of each callback
+   *
+   * The player calls RealtimeThreadPool::beginBlock before rendering each block, so that the workers are spinning
+   * when the audio source hands them work. Audio sources use the pool themselves, e.g. with
+   * MixerAudioSource::setThreadPool. Call while not playing.
+   * @param pool Thread pool, owned by the caller, or nullptr
+   */
+  void setThreadPool(RealtimeThreadPool* pool);
+
+  /**
+   * Get the thread pool woken at the start of each callback
+   * @return Thread pool, or nullptr
+   */
+  RealtimeThreadPool* getThreadPool();
+
+  /**
+   * @brief Set how the threads rendering audio are configured (control thread, while not playing)
+   *
+   * The callback thread applies the settings at the start of its first block, the workers of the thread pool
+   * (setThreadPool) when they are first woken. OboeAudioPlayer and SimulatedAudioPlayer default to
+   * AudioThreadFlushDenormals, OfflineAudioPlayer, which renders on the caller's thread, to none. Real-time
+   * priority and core affinity are opt-in.
+   * @param features Combination of AudioThreadFeature flags
+   * @param priority SCHED_FIFO priority, for AudioThreadRealtimePriority
+   */
+  void setAudioThreadFeatures(int32_t features, int32_t priority = AudioThreadSetup::defaultPriority);
+
+  /**
+   * Get the settings of the threads rendering audio, e.g. for RenderAheadAudioSource::setThreadSetup or to check
+   * which features took effect
+   * @return Thread settings
+   */
+  AudioThreadSetup& getAudioThreadSetup();
+
 protected:
-    AudioSource * _source; // The audio data source
+    /**
+     * @brief Fill a block of audio data from the audio source; to be called by daughter classes on their audio thread
+     *
+     * Takes over a newly set audio source at the block boundary, and fills the block with zeros if there is
+     * no source. Interleaved buffers are handed to sources rendering interleaved frames natively; for other sources,
+     * the block is rendered in parts into a scratch buffer and interleaved with vectorized kernels.
+     * @param audioData Buffer to be filled, with the given layout
+     * @param framesCount Number of samples to be supplied in each channel
+     * @param channelCount Number of channels
+     * @param layout Layout of audioData
+     */
+    void renderAudio(float* audioData, int32_t framesCount, ChannelCount channelCount,
+                     SampleLayout layout = SampleLayout::Planar);
+
+    /**
+     * Take the posted events from the queue into the sorted staging array (audio thread)
+     */
+    void stageEvents();
+
+    /**
+     * Render a part of a block, with the layout of the whole block (audio thread)
+     * @param audioData Whole block, float[channelCount][framesCount] or float[framesCount][channelCount]
+     * @param offset First frame of the part
+     * @param length Number of frames of the part
+     * @param layout Layout of audioData
+     */
+    void renderSubBlock(float* audioData, int32_t framesCount, ChannelCount channelCount, int32_t offset,
+                        int32_t length, SampleLayout layout);
+
+    /**
+     * Relay onPlaybackStopped to the audio source; to be called by daughter classes once their audio thread stopped
+     */
+    void notifyPlaybackStopped();
+
+    /**
+     * Set the sampling rate used by the telemetry to detect late callbacks; no-op without telemetry
+     * @param samplingRate Sampling rate, in samples per second
+     */
+    void configureTelemetry(int samplingRate) {
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        _telemetry.setSamplingRate(samplingRate);
+#endif
+    }
+
+    /**
+     * Report the cumulative underrun count of the audio driver from the audio thread; no-op without telemetry
+     * @param xRunCount Number of underruns since the start of playing
+     */
+    void reportXRunCount(int32_t xRunCount) {
+#ifdef SYNTHESIZERBASE_TELEMETRY
+        _telemetry.reportXRunCount(xRunCount);
+#endif
+    }
+
+    AudioSourceExchange _sourceExchange; // The audio data source, handed over lock-free to the audio thread
+    AudioEventQueue _eventQueue{eventQueueCapacity}; // events posted by control threads
+    std::vector<AudioEvent> _stagedEvents; // audio thread: events taken from the queue, sorted by frame
+    int32_t _stagedCount = 0;
+    std::vector<float> _subBlockScratch; // audio thread: parts of blocks with several channels, and conversions
+    std::atomic<int64_t> _frameTime{0}; // frames rendered so far
+    RealtimeThreadPool* _threadPool = nullptr; // woken at the start of each block
+    AudioThreadSetup _threadSetup; // applied by the callback thread and the workers of _threadPool
+#ifdef SYNTHESIZERBASE_TELEMETRY
+    CallbackTelemetry _telemetry; // timings of the audio callback
+#endif
 };
 }  // namespace synthesizerBase
 
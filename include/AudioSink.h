@@ -0,0 +1,177 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Audio sinks are the counterpart of the loudspeaker driver for players that do not output
+ * to an audio device, such as the OfflineAudioPlayer. The player obtains the audio data from its
+ * AudioSource and hands each block to the sink, which stores it in a file or in memory.
+ */
+
+#ifndef AudioSink_H
+#define AudioSink_H
+
+#include <memory>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "AudioDefinitions.h"
+#include "SampleFormatConverter.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Abstract destination for rendered audio data
+     *
+     * The blocks handed to write have the layout given by getLayout: by default, the layout of
+     * AudioSource::onAudioReady, that is, channelCount consecutive blocks of framesCount floats each. Sinks storing
+     * interleaved frames take interleaved blocks instead, which players render without an intermediate copy.
+     * Implementations decide how they store them.
+     */
+    class AudioSink {
+    public:
+        virtual ~AudioSink() = default;
+
+        /**
+         * @brief Prepare the sink for receiving data
+         * @param samplingRate Sampling rate of the data that will be written, in samples per second
+         * @param channelCount Number of channels of the data that will be written
+         * @return 0 for success, error code otherwise
+         */
+        virtual int32_t open(int samplingRate, int32_t channelCount) = 0;
+
+        /**
+         * @brief Store a block of audio data
+         * @param audioData Block of audio data, float[channelCount][framesCount] or, if getLayout returns
+         *                  SampleLayout::Interleaved, float[framesCount][channelCount]
+         * @param framesCount Number of samples per channel
+         * @param channelCount Number of channels, must match the number given to open
+         * @return 0 for success, error code otherwise. On error, the player stops rendering.
+         */
+        virtual int32_t write(const float* audioData, int32_t framesCount, int32_t channelCount) = 0;
+
+        /**
+         * @brief Finish writing; no more data follows until the next call to open
+         */
+        virtual void close() = 0;
+
+        /**
+         * Layout of the blocks handed to write; the default implementation returns SampleLayout::Planar
+         * @return Sample layout
+         */
+        virtual SampleLayout getLayout() const { return SampleLayout::Planar; }
+    };
+
+    /**
+     * @brief Audio sink writing interleaved float samples into a caller-supplied buffer
+     *
+     * Takes interleaved blocks, copied as they are.
+     * The buffer has to hold capacityFrames*channelCount floats. Once it is full, write
+     * stores what still fits and reports ResultErrorInvalidState, which ends rendering.
+     */
+    class BufferAudioSink : public AudioSink {
+    public:
+        /**
+         * Constructor
+         * @param buffer Destination buffer, owned by the caller
+         * @param capacityFrames Number of frames (samples per channel) the buffer can hold
+         */
+        BufferAudioSink(float* buffer, int64_t capacityFrames);
+
+        int32_t open(int samplingRate, int32_t channelCount) override;
+
+        int32_t write(const float* audioData, int32_t framesCount, int32_t channelCount) override;
+
+        void close() override;
+
+        SampleLayout getLayout() const override;
+
+        /**
+         * Number of frames written into the buffer since the last call to open
+         * @return Number of frames stored
+         */
+        int64_t getFramesWritten() const;
+
+    protected:
+        float* _buffer; // caller-owned destination, interleaved
+        int64_t _capacityFrames; // capacity of _buffer in frames
+        int64_t _framesWritten = 0; // frames written since open
+        int32_t _channelCount = 0; // channel count set at open
+    };
+
+    /**
+     * @brief Audio sink streaming samples to a file, either as WAV or as headerless raw PCM
+     *
+     * In both formats, the samples are stored interleaved and in the native (little endian) byte order. Takes
+     * interleaved blocks; float samples are written as they are, integer samples are converted with a
+     * SampleFormatConverter.
+     */
+    class FileAudioSink : public AudioSink {
+    public:
+        /**
+         * Output file format
+         */
+        enum class FileFormat {
+            Wav, // RIFF/WAVE file, IEEE float or integer PCM format
+            RawPcm, // headerless interleaved samples
+        };
+
+        /**
+         * Constructor
+         * @param path Path of the file to be written. It is created or truncated by open.
+         * @param format File format
+         * @param sampleFormat Format of the samples stored
+         * @param dither Dither applied when converting to an integer sample format
+         */
+        FileAudioSink(const char* path, FileFormat format = FileFormat::Wav,
+                      SampleFormat sampleFormat = SampleFormat::Float, DitherMode dither = DitherMode::Triangular);
+
+        /**
+         * Destructor, closes the file if still open
+         */
+        ~FileAudioSink();
+
+        int32_t open(int samplingRate, int32_t channelCount) override;
+
+        int32_t write(const float* audioData, int32_t framesCount, int32_t channelCount) override;
+
+        void close() override;
+
+        SampleLayout getLayout() const override;
+
+    protected:
+        /**
+         * Write the WAV header for the current number of frames, at the start of the file
+         * @return 0 for success, error code otherwise
+         */
+        int32_t writeWavHeader();
+
+        std::vector<char> _path; // file path, zero terminated
+        FileFormat _format; // output file format
+        SampleFormat _sampleFormat; // format of the samples stored
+        DitherMode _dither; // dither of integer samples
+        std::unique_ptr<SampleFormatConverter> _converter; // created by open for integer formats
+        std::vector<uint8_t> _converted; // one chunk of converted samples
+        FILE* _file = nullptr; // open file, nullptr when closed
+        int _samplingRate = 0; // sampling rate set at open
+        int32_t _channelCount = 0; // channel count set at open
+        int64_t _framesWritten = 0; // frames written since open
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -24,10 +24,20 @@
 #ifndef AudioSource_H
 #define AudioSource_H
 
-#include <oboe/Oboe.h>
+#include <string.h>
+#include "AudioDefinitions.h"
+#include "AudioEvent.h"
 
 namespace synthesizerBase {
 
+/**
+ * @brief Content of the block last rendered by an audio source, see AudioSource::getBlockState
+ */
+enum class BlockState : int32_t {
+    Active = 0, // any content
+    Silent, // all samples are zero
+};
+
 /**
  * @brief Generic base class for an audio source
  *
@@ -50,20 +60,82 @@ class AudioSource {
        *
        * audioData represents a pre-reserved float array of length framesCount*channelCount, with a block
        * structure with channelCount blocks of each block consisting of framesCount consecutive floats. I.e.
-       * This can for example be achieved with an array of the structure float[channelCount][framesCount]. Oboe
-       * expects that the values provided be in the interval -1.0 to +1.0
+       * This can for example be achieved with an array of the structure float[channelCount][framesCount] (planar
+       * layout). Oboe expects interleaved frames: the player converts, unless the source renders interleaved frames
+       * natively, see getNativeLayout. Oboe expects that the values provided be in the interval -1.0 to +1.0
        * @param audioData Pointer to the start of the audio data buffer, preallocated by oboe, of length
        *                  framesCount*channelCount and with an intended blockwise structure float[channelCount][framesCount]
        * @param framesCount Number of samples to be supplied in each channel
        * @param channelCount Number of channels, e.g., number of blocks. Mono=1, Stereo=2
        */
-  virtual void onAudioReady(float* audioData, int32_t framesCount, oboe::ChannelCount channelCount)=0;
+  virtual void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount)=0;
 
   /**
    * Notify the audio source that the audio playing via the audio driver system has stopped
    */
 
   virtual void onPlaybackStopped() = 0;
+
+  /**
+   * @brief Apply a timestamped event (audio thread)
+   *
+   * Called by the audio player between two calls of onAudioReady, at the frame given by the event, see
+   * AudioPlayer::postEvent. The default implementation ignores all events.
+   * @param event Event
+   */
+  virtual void onAudioEvent(const AudioEvent& event) {}
+
+  /**
+   * @brief Whether the source renders silence, and will until it receives an event (audio thread)
+   *
+   * Consumers may then skip onAudioReady and treat the block as silent, but still deliver events with onAudioEvent,
+   * which may wake the source up. The default implementation returns false.
+   * @return true if the source is idle
+   */
+  virtual bool isIdle() const { return false; }
+
+  /**
+   * @brief Content of the block filled by the last call of onAudioReady (audio thread)
+   *
+   * Lets consumers skip summing or processing silent blocks. The default implementation returns BlockState::Active,
+   * which is always correct.
+   * @return Block state
+   */
+  virtual BlockState getBlockState() const { return BlockState::Active; }
+
+  /**
+   * @brief Number of frames the source may keep sounding once its own inputs fell silent, e.g. a reverb decay
+   *
+   * For sources processing other sources: after that many frames of silent input, the source can report itself
+   * idle, and consumers can size buffers and fades to it. The default implementation returns 0, as for sources
+   * without memory.
+   * @return Tail length, in frames
+   */
+  virtual int32_t getTailFrames() const { return 0; }
+
+  /**
+   * @brief Sample layout the source renders natively
+   *
+   * A source returning SampleLayout::Interleaved implements renderInterleaved, which players call instead of
+   * onAudioReady when the audio driver or sink takes interleaved frames, handing over the driver buffer without
+   * conversion. onAudioReady still has to render the planar layout, for consumers such as mixers. The default
+   * implementation returns SampleLayout::Planar.
+   * @return Native layout
+   */
+  virtual SampleLayout getNativeLayout() const { return SampleLayout::Planar; }
+
+  /**
+   * @brief Fill an interleaved buffer, float[framesCount][channelCount] (audio thread)
+   *
+   * Only called if getNativeLayout returns SampleLayout::Interleaved, in place of onAudioReady; the default
+   * implementation fills zeros.
+   * @param audioData Buffer of framesCount*channelCount floats
+   * @param framesCount Number of frames
+   * @param channelCount Number of channels
+   */
+  virtual void renderInterleaved(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+      memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+  }
 };
 
 
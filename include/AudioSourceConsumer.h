@@ -32,8 +32,9 @@ namespace synthesizerBase {
         /**
          * Set the audio data source
          * @param source The audio data source that will provide audio data on callback
+         * @return ResultOk, or a negative ResultCode if the source was not set
          */
-        virtual void setAudioSource(AudioSource* source)=0;
+        virtual int32_t setAudioSource(AudioSource* source)=0;
 
         /**
          * Get the currently set audio data source
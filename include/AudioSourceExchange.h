@@ -0,0 +1,198 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Hand-over of the AudioSource between a control thread (typically the UI thread) and the audio thread.
+ *
+ * The control thread publishes a new source; the audio thread adopts it at the start of its next block,
+ * optionally crossfading from the previous source, and hands the previous source back through a lock-free
+ * queue once it no longer uses it. The control thread then collects it and can delete it. This is a simple
+ * form of read-copy-update where the audio thread itself declares the end of the grace period.
+ */
+
+#ifndef AudioSourceExchange_H
+#define AudioSourceExchange_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+#include "AudioSource.h"
+#include "SpscRingBuffer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Lock-free exchange of the audio source used by the audio thread
+     *
+     * setSource, getSource and collectRetired are meant for a single control thread, render and
+     * notifyPlaybackStopped for the audio thread (or for the control thread while the audio thread is not running).
+     * No function allocates, locks or waits.
+     */
+    class AudioSourceExchange {
+    public:
+        /**
+         * Number of sources the audio thread can hand back before the control thread collects them. If the
+         * queue is full, the audio thread postpones adopting new sources.
+         */
+        static constexpr int32_t retiredCapacity = 16;
+
+        /**
+         * Number of distinct sources the exchange keeps track of, in use or waiting for collectRetired
+         */
+        static constexpr int32_t referenceCapacity = retiredCapacity + 4;
+
+        /**
+         * Maximum number of channels for which crossfades are rendered in blocks of defaultAudioFrameSize frames;
+         * with more channels, the crossfade is rendered in smaller chunks.
+         */
+        static constexpr int32_t crossfadeChannels = 8;
+
+        AudioSourceExchange();
+
+        /**
+         * @brief Publish a new audio source (control thread)
+         *
+         * The audio thread adopts the source at the start of its next block. If the previous source published
+         * has not been adopted yet, it is superseded and directly becomes collectable. A source published
+         * several times is collectable once no publication of it is in use any more.
+         * @param source New audio source, may be nullptr for silence
+         * @param crossfadeFrames Length of the linear crossfade from the current source to the new one, in frames;
+         *                        0 switches at the block boundary
+         * @return ResultOk, or ResultErrorInvalidState if referenceCapacity sources are in use or wait for
+         *         collectRetired: the source was not published, collect the retired sources first
+         */
+        int32_t setSource(AudioSource* source, int32_t crossfadeFrames = 0);
+
+        /**
+         * Most recently published audio source (control thread)
+         * @return Audio source, may be nullptr
+         */
+        AudioSource* getSource() const;
+
+        /**
+         * @brief Take back a source that the audio thread no longer uses (control thread)
+         *
+         * Call repeatedly until it returns nullptr. The returned sources can be deleted. While the audio thread is
+         * not running, the current source is not in use either.
+         * @return A replaced audio source, or nullptr if there is none
+         */
+        AudioSource* collectRetired();
+
+        /**
+         * @brief Fill a block of audio data from the current source, adopting a newly published one first (audio thread)
+         *
+         * Without any source, or while the source is idle (AudioSource::isIdle), the block is filled with zeros.
+         * @param audioData Buffer to be filled, as for AudioSource::onAudioReady
+         * @param framesCount Number of samples to be supplied in each channel
+         * @param channelCount Number of channels
+         */
+        void render(float* audioData, int32_t framesCount, ChannelCount channelCount);
+
+        /**
+         * @brief Fill a block of interleaved frames directly, if the current source renders them natively (audio thread)
+         *
+         * Adopts a newly published source first. Writes zeros without any source or with an idle one.
+         * @param audioData Buffer to be filled, float[framesCount][channelCount]
+         * @param framesCount Number of frames
+         * @param channelCount Number of channels
+         * @return true if the block was filled, false if the current source renders planar blocks or a crossfade is
+         *         running: render into a planar buffer then, and interleave
+         */
+        bool renderInterleaved(float* audioData, int32_t framesCount, ChannelCount channelCount);
+
+        /**
+         * Relay onPlaybackStopped to the source(s) in use by the audio thread. Call once the audio thread has stopped.
+         */
+        void notifyPlaybackStopped();
+
+        /**
+         * @brief Adopt the source published last at once, without crossfade (while the audio thread is not running)
+         *
+         * Ends a crossfade still running. Without it, a source published while stopped is only adopted at the
+         * start of the next block, and the one it replaces is not collectable before.
+         */
+        void adoptWhileStopped();
+
+        /**
+         * Deliver an event to the current source, adopting a newly published one first (audio thread)
+         * @param event Event
+         */
+        void dispatchEvent(const AudioEvent& event);
+
+        /**
+         * Audio source in use by the audio thread (audio thread)
+         * @return Audio source, may be nullptr
+         */
+        AudioSource* getCurrentSource() const;
+
+    protected:
+        /**
+         * Adopt a newly published source, if any and if possible (audio thread)
+         * @param crossfade false to switch at once, ignoring the crossfade length published with the source
+         */
+        void adoptPendingSource(bool crossfade = true);
+
+        /**
+         * Mix the outgoing source into a block already rendered by the current source (audio thread)
+         */
+        void renderCrossfade(float* audioData, int32_t framesCount, ChannelCount channelCount);
+
+        /**
+         * Hand a source back to the control thread (audio thread)
+         */
+        void retire(AudioSource* source);
+
+        /**
+         * Count a publication of a source (control thread)
+         * @return false if referenceCapacity other sources are tracked
+         */
+        bool addReference(AudioSource* source);
+
+        /**
+         * End a publication of a source: retired by the audio thread or superseded (control thread)
+         */
+        void releaseReference(AudioSource* source);
+
+        // Published source, tagged with bit 0 set such that nullptr can be published; 0 means nothing pending
+        std::atomic<uintptr_t> _pending{0};
+        std::atomic<int32_t> _pendingCrossfadeFrames{0};
+        std::atomic<AudioSource*> _published{nullptr}; // most recently published source, for getSource
+
+        // Audio thread state
+        std::atomic<AudioSource*> _current{nullptr}; // source rendering the output
+        AudioSource* _fadingOut = nullptr; // source faded out during a crossfade, nullptr otherwise
+        int32_t _fadeLength = 0; // crossfade length, in frames
+        int32_t _fadePosition = 0; // frames of the crossfade already rendered
+        std::vector<float> _scratch; // buffer for rendering the outgoing source during crossfades
+
+        SpscRingBuffer<AudioSource*> _retired{retiredCapacity}; // publications ended by the audio thread
+
+        /**
+         * Publications of a source not ended yet (control thread only)
+         */
+        struct Reference {
+            AudioSource* source = nullptr; // nullptr for an unused entry
+            int32_t count = 0; // 0: no longer in use, to be returned by collectRetired
+        };
+
+        Reference _references[referenceCapacity];
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,150 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Configuration of the threads rendering audio: denormal flushing, real-time scheduling and core affinity,
+ * applied once per thread from within the thread itself, as the audio driver creates the callback thread.
+ */
+
+#ifndef AudioThreadSetup_H
+#define AudioThreadSetup_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace synthesizerBase {
+
+    /**
+     * Settings applied by AudioThreadSetup, combined as bit flags
+     */
+    enum AudioThreadFeature : int32_t {
+        AudioThreadFlushDenormals = 1, // flush denormal results and inputs to zero (FTZ/DAZ on x86, FZ on ARM)
+        AudioThreadRealtimePriority = 2, // SCHED_FIFO, where the process is permitted to
+        AudioThreadPerformanceCores = 4, // keep the thread off the efficiency cores (lowest maximum frequency)
+        AudioThreadAllFeatures = 7,
+    };
+
+    /**
+     * @brief Settings for the threads rendering audio, applied once per thread
+     *
+     * configure() is called from a control thread while no audio thread runs; it looks up the performance cores
+     * (on Linux and Android, all but the cores with the lowest maximum frequency in sysfs; devices whose cores all
+     * have the same maximum frequency are left unrestricted). applyToCurrentThread() is then called by each thread
+     * rendering audio, at the start of every block: the first call on a thread applies the settings, the following
+     * ones only compare a thread_local value. The audio players call it for their callback thread,
+     * RealtimeThreadPool and RenderAheadAudioSource for their workers.
+     * <br />
+     * Settings that are not permitted or not supported are skipped; getAppliedFeatures tells which ones took effect.
+     */
+    class AudioThreadSetup {
+    public:
+        /**
+         * Default SCHED_FIFO priority: low among real-time priorities, above all normal threads
+         */
+        static constexpr int32_t defaultPriority = 2;
+
+        /**
+         * Constructor
+         * @param features Combination of AudioThreadFeature flags
+         * @param priority SCHED_FIFO priority, for AudioThreadRealtimePriority
+         */
+        explicit AudioThreadSetup(int32_t features = 0, int32_t priority = defaultPriority);
+
+        AudioThreadSetup(const AudioThreadSetup&) = delete;
+
+        AudioThreadSetup& operator=(const AudioThreadSetup&) = delete;
+
+        /**
+         * @brief Change the settings (control thread, while no audio thread runs)
+         *
+         * Threads apply the new settings at their next call of applyToCurrentThread. Settings dropped from the
+         * features are not undone on threads that applied them before.
+         * @param features Combination of AudioThreadFeature flags
+         * @param priority SCHED_FIFO priority, for AudioThreadRealtimePriority
+         */
+        void configure(int32_t features, int32_t priority = defaultPriority);
+
+        /**
+         * @brief Apply the settings to the calling thread, unless already done (audio thread)
+         *
+         * Neither allocates nor locks. Calls with another AudioThreadSetup on the same thread apply that one.
+         */
+        void applyToCurrentThread();
+
+        /**
+         * Features requested
+         * @return Combination of AudioThreadFeature flags
+         */
+        int32_t getFeatures() const;
+
+        /**
+         * Features that took effect on the thread set up last
+         * @return Combination of AudioThreadFeature flags
+         */
+        int32_t getAppliedFeatures() const;
+
+        /**
+         * Performance cores found by configure
+         * @return Core numbers; empty if AudioThreadPerformanceCores is not requested or if all cores are alike
+         */
+        const std::vector<int32_t>& getPerformanceCores() const;
+
+        /**
+         * Flush denormal numbers to zero on the calling thread
+         * @return true on success, false if not supported on this architecture
+         */
+        static bool flushDenormals();
+
+        /**
+         * Whether denormal numbers are flushed to zero on the calling thread
+         * @return true if flushed
+         */
+        static bool areDenormalsFlushed();
+
+        /**
+         * Set the SCHED_FIFO policy for the calling thread
+         * @param priority SCHED_FIFO priority
+         * @return ResultOk, or ResultErrorInvalidState if not permitted or not supported
+         */
+        static int32_t setRealtimePriority(int32_t priority);
+
+        /**
+         * Find the cores faster than the efficiency cores (Linux and Android; reads sysfs, not for audio threads)
+         * @return Core numbers; empty if all cores have the same maximum frequency or the frequencies are unknown
+         */
+        static std::vector<int32_t> findPerformanceCores();
+
+    protected:
+        /**
+         * Restrict the calling thread to the performance cores
+         * @return true on success
+         */
+        bool setAffinity() const;
+
+        int32_t _features;
+        int32_t _priority;
+        std::vector<int32_t> _performanceCores; // found by configure
+        uint64_t _configuration = 0; // unique among all setups and their configurations, compared per thread
+        std::atomic<int32_t> _appliedFeatures{0}; // features that took effect on the thread set up last
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,185 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Rendering of many independent jobs (previews, test material) across the cores of a build host or server,
+ * faster than real time, with one OfflineAudioPlayer per worker thread.
+ */
+
+#ifndef BatchRenderer_H
+#define BatchRenderer_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioDefinitions.h"
+#include "AudioEvent.h"
+#include "AudioSink.h"
+#include "AudioSource.h"
+#include "OfflineAudioPlayer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Description of a rendering job of the BatchRenderer
+     */
+    struct RenderJob {
+        /**
+         * Creates the audio source of the job; called on the worker thread, the source is deleted once rendered.
+         * Sources processing other sources are returned as one object owning the chain.
+         */
+        std::function<std::unique_ptr<AudioSource>()> createSource;
+
+        int64_t frames = 0; // length of the rendering, in frames
+        int samplingRate = 48000; // sampling rate, in samples per second
+        int32_t channelCount = defaultAudioChannelNumber; // number of channels
+
+        /**
+         * Events delivered to the source, with event.frame counted from the start of the job; at most
+         * AudioPlayer::eventQueueCapacity
+         */
+        std::vector<AudioEvent> events;
+
+        /**
+         * Path of a WAV file to write; if empty, and without createSink, the audio is kept in RenderResult::audio
+         */
+        std::string outputPath;
+
+        SampleFormat sampleFormat = SampleFormat::Float; // format of the samples of the WAV file
+
+        /**
+         * Optional; creates the sink of the job on the worker thread, instead of the file or memory output. The job
+         * fails with ResultErrorInvalidArgument if it returns nullptr.
+         */
+        std::function<std::unique_ptr<AudioSink>()> createSink;
+    };
+
+    /**
+     * @brief Outcome of a rendering job
+     */
+    struct RenderResult {
+        int32_t result = ResultErrorInvalidState; // ResultOk or an error; ResultErrorInvalidState until finished
+        int64_t framesRendered = 0; // frames rendered
+        double renderSeconds = 0.0; // time the worker spent on the job
+        std::vector<float> audio; // interleaved frames, for jobs kept in memory
+    };
+
+    /**
+     * @brief Aggregate statistics of a BatchRenderer
+     */
+    struct BatchStatistics {
+        int64_t jobsCompleted = 0; // jobs finished, with or without error
+        int64_t jobsFailed = 0; // jobs finished with an error
+        double audioSeconds = 0.0; // duration of the audio rendered
+        double busySeconds = 0.0; // wall-clock time during which jobs were pending or running
+        double realtimeFactor = 0.0; // audioSeconds / busySeconds: seconds of audio rendered per second
+    };
+
+    /**
+     * @brief Fixed-size pool of threads rendering jobs from a queue
+     *
+     * Jobs are submitted from any thread and rendered in submission order by the first free worker. Each worker
+     * owns an OfflineAudioPlayer, reused for all its jobs, such that the block buffer and the event queue are
+     * allocated once per worker; denormals are flushed on the workers. The audio goes to a WAV file, to memory or
+     * to a sink created for the job. The queue uses a mutex and is not meant for audio threads.
+     */
+    class BatchRenderer {
+    public:
+        /**
+         * Constructor, starting the workers
+         * @param workerCount Number of worker threads; 0 for one per core
+         * @param framesPerDataCallback Number of frames requested from the audio sources per call to onAudioReady
+         */
+        explicit BatchRenderer(int32_t workerCount = 0, int32_t framesPerDataCallback = defaultAudioFrameSize);
+
+        /**
+         * Destructor; waits for the submitted jobs, then stops the workers
+         */
+        ~BatchRenderer();
+
+        BatchRenderer(const BatchRenderer&) = delete;
+
+        BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+        /**
+         * Queue a job (any thread)
+         * @param job Job
+         * @return Identifier of the job, for takeResult; identifiers count from 0 in submission order
+         */
+        int64_t submit(RenderJob job);
+
+        /**
+         * Block until all jobs submitted so far have finished
+         */
+        void wait();
+
+        /**
+         * Move the result of a finished job out of the renderer
+         * @param job Identifier returned by submit
+         * @return Result; RenderResult::result is ResultErrorInvalidState if the job has not finished or its result
+         *         was taken already
+         */
+        RenderResult takeResult(int64_t job);
+
+        /**
+         * Statistics since construction
+         * @return Statistics
+         */
+        BatchStatistics getStatistics() const;
+
+        /**
+         * Number of worker threads
+         * @return Number of workers
+         */
+        int32_t getWorkerCount() const;
+
+    protected:
+        /**
+         * Main loop of a worker thread
+         * @param player Player of the worker
+         */
+        void work(OfflineAudioPlayer* player);
+
+        /**
+         * Render one job on a worker
+         */
+        static RenderResult render(OfflineAudioPlayer* player, RenderJob& job);
+
+        std::vector<std::unique_ptr<OfflineAudioPlayer>> _players; // one per worker
+        std::vector<std::thread> _workers;
+        mutable std::mutex _mutex; // protects all members below
+        std::condition_variable _jobAvailable; // signaled on submit and on shutdown
+        std::condition_variable _jobsFinished; // signaled when no job is pending or running
+        std::deque<std::pair<int64_t, RenderJob>> _queue; // jobs not started, with their identifiers
+        std::vector<RenderResult> _results; // by identifier
+        int64_t _running = 0; // jobs being rendered
+        bool _stopping = false; // set by the destructor
+        BatchStatistics _statistics;
+        int64_t _busySince = 0; // steady clock time at which the renderer last became busy, in nanoseconds
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,198 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Instrumentation of the audio callback. The audio players own a CallbackTelemetry object only if the
+ * library is built with SYNTHESIZERBASE_TELEMETRY (CMake option SYNTHESIZERBASE_ENABLE_TELEMETRY); otherwise,
+ * the instrumentation is compiled out of the players entirely.
+ */
+
+#ifndef CallbackTelemetry_H
+#define CallbackTelemetry_H
+
+#include <atomic>
+#include <stdint.h>
+#include "SpscRingBuffer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * Measurements of one audio callback, as written by the audio thread
+     */
+    struct CallbackRecord {
+        int64_t startNanos; // start of the callback, monotonic clock
+        int32_t durationNanos; // time spent rendering the block
+        int32_t intervalNanos; // time since the start of the previous callback, 0 for the first one
+        int32_t framesCount; // number of frames requested by the driver
+        int32_t xRunCount; // cumulative underrun count reported by the driver
+    };
+
+    /**
+     * @brief Histogram with logarithmic buckets of durations
+     *
+     * Bucket 0 counts durations below 1 microsecond, bucket i durations from 2^(i-1) to 2^i microseconds,
+     * and the last bucket everything longer.
+     */
+    struct DurationHistogram {
+        static constexpr int32_t bucketCount = 24;
+
+        int64_t counts[bucketCount] = {};
+
+        /**
+         * Index of the bucket for a duration
+         * @param nanos Duration, in nanoseconds
+         * @return Bucket index
+         */
+        static int32_t bucketIndex(int64_t nanos);
+
+        /**
+         * Upper limit of a bucket
+         * @param bucket Bucket index
+         * @return Upper limit, in microseconds
+         */
+        static int64_t bucketUpperMicros(int32_t bucket);
+
+        /**
+         * Total number of counted durations
+         * @return Sum over all buckets
+         */
+        int64_t total() const;
+
+        /**
+         * Approximate percentile, as the upper limit of the bucket containing it
+         * @param fraction Percentile as a fraction, e.g. 0.99
+         * @return Upper limit of the bucket, in microseconds
+         */
+        int64_t percentileMicros(double fraction) const;
+    };
+
+    /**
+     * @brief Lock-free recorder of audio callback timings with a non-real-time reader
+     *
+     * The audio thread calls beginCallback and endCallback around the rendering of each block; each call
+     * pair writes one fixed-size CallbackRecord into a ring buffer, without allocating or locking. If the ring is
+     * full, the record is dropped and counted. A reader thread calls poll regularly (e.g. every 100 ms) to drain
+     * the records into rolling histograms, worst-case values and counters.
+     */
+    class CallbackTelemetry {
+    public:
+        /**
+         * Constructor
+         * @param capacity Number of records the ring buffer holds between two polls
+         * @param windowCallbacks Rolling window of the histograms: they cover the last windowCallbacks
+         *                        to 2*windowCallbacks callbacks
+         */
+        explicit CallbackTelemetry(int32_t capacity = 4096, int32_t windowCallbacks = 10000);
+
+        /**
+         * Set the sampling rate, for detecting late callbacks. Call while not playing.
+         * @param samplingRate Sampling rate, in samples per second; 0 disables the detection
+         */
+        void setSamplingRate(int samplingRate);
+
+        /**
+         * Mark the start of a callback (audio thread)
+         */
+        void beginCallback();
+
+        /**
+         * Mark the end of a callback and write its record (audio thread)
+         * @param framesCount Number of frames rendered
+         */
+        void endCallback(int32_t framesCount);
+
+        /**
+         * Mark the end of playback (audio thread, or once it has stopped): the first callback of the next playback
+         * is recorded without interval, instead of with the time the player was stopped
+         */
+        void endPlayback();
+
+        /**
+         * Report the cumulative underrun count of the audio driver (audio thread), included in the next record
+         * @param xRunCount Number of underruns since the stream started
+         */
+        void reportXRunCount(int32_t xRunCount);
+
+        /**
+         * @brief Drain the records written by the audio thread into the statistics (reader thread)
+         * @param records Optional array receiving copies of the drained records, e.g. for logging
+         * @param maxRecords Size of records; further drained records are only accounted in the statistics
+         * @return Number of records drained
+         */
+        int32_t poll(CallbackRecord* records = nullptr, int32_t maxRecords = 0);
+
+        /**
+         * Histogram of the callback durations over the rolling window (reader thread)
+         * @return Histogram
+         */
+        DurationHistogram getDurationHistogram() const;
+
+        /**
+         * Histogram of the intervals between callback starts over the rolling window (reader thread)
+         * @return Histogram
+         */
+        DurationHistogram getIntervalHistogram() const;
+
+        int64_t getCallbackCount() const; // callbacks drained since the last reset (reader thread)
+        int64_t getWorstDurationNanos() const; // longest callback since the last reset (reader thread)
+        int64_t getWorstIntervalNanos() const; // longest interval since the last reset (reader thread)
+        int32_t getXRunCount() const; // latest underrun count reported by the driver (reader thread)
+        int64_t getLateCallbackCount() const; // callbacks starting later than 1.5 periods after the previous one
+        int32_t getMinFramesCount() const; // smallest framesCount seen since the last reset (reader thread)
+        int32_t getMaxFramesCount() const; // largest framesCount seen since the last reset (reader thread)
+        int64_t getDroppedRecordCount() const; // records lost because the ring was full (any thread)
+
+        /**
+         * Reset the statistics (reader thread)
+         */
+        void reset();
+
+    protected:
+        /**
+         * Account one record in the statistics
+         * @param record Record drained from the ring
+         */
+        void accumulate(const CallbackRecord& record);
+
+        SpscRingBuffer<CallbackRecord> _records;
+
+        // Audio thread state
+        int64_t _callbackStartNanos = 0;
+        int64_t _previousStartNanos = 0;
+        int32_t _xRunCount = 0;
+        std::atomic<int64_t> _droppedRecords{0};
+
+        // Reader state
+        int _samplingRate = 0;
+        int32_t _windowCallbacks;
+        int32_t _windowFill = 0; // callbacks in the current window
+        DurationHistogram _durations[2]; // current and previous window
+        DurationHistogram _intervals[2];
+        int32_t _currentWindow = 0;
+        int64_t _callbackCount = 0;
+        int64_t _worstDurationNanos = 0;
+        int64_t _worstIntervalNanos = 0;
+        int32_t _latestXRunCount = 0;
+        int64_t _lateCallbackCount = 0;
+        int32_t _minFramesCount = 0;
+        int32_t _maxFramesCount = 0;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
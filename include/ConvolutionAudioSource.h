@@ -0,0 +1,140 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef ConvolutionAudioSource_H
+#define ConvolutionAudioSource_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+#include "AudioSource.h"
+#include "RealFft.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Adapter convolving a wrapped audio source with an impulse response, e.g. a reverb or a cabinet
+     *
+     * Uniformly partitioned convolution without latency. The first partition of the impulse response is applied
+     * in direct form, one dot product per output frame (simd::dotProduct). The rest is split into partitions of
+     * the same length, whose spectra are computed at construction. At the end of every partition of input, the
+     * spectrum of the last two partitions of input (overlap-save) is computed and kept in a frequency-domain delay
+     * line. The spectra of the delay line are multiplied with those of the impulse response and summed
+     * (simd::complexMultiplyAccumulate), and one inverse transform gives the output of all partitions but the first
+     * for the next partition of frames.
+     * <br />
+     * The cost per frame is about the partition length (direct form) plus the impulse response length divided by
+     * the partition length (delay line), so longer partitions suit longer responses; partitions of at most the
+     * callback size spread the transforms evenly over the callbacks. No memory is allocated after construction.
+     * Renders planar frames.
+     */
+    class ConvolutionAudioSource : public AudioSource {
+    public:
+        /**
+         * Default partition length, in frames
+         */
+        static constexpr int32_t defaultPartitionFrames = 256;
+
+        /**
+         * Constructor
+         * @param source Wrapped audio source, owned by the caller
+         * @param impulseResponse Impulse response, float[impulseChannels][impulseFrames]; copied
+         * @param impulseFrames Length of the impulse response, in frames
+         * @param impulseChannels 1, for the same response in all channels, or channelCount
+         * @param channelCount Number of channels; rendering must be requested with this channel count
+         * @param partitionFrames Partition length, rounded up to a power of two between 16 and 8192
+         */
+        ConvolutionAudioSource(AudioSource* source, const float* impulseResponse, int32_t impulseFrames,
+                               int32_t impulseChannels, int32_t channelCount,
+                               int32_t partitionFrames = defaultPartitionFrames);
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Relay to the wrapped source, and clear the input kept for the convolution
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Idle once the wrapped source is idle and the convolution of its last input has been played out
+         */
+        bool isIdle() const override;
+
+        BlockState getBlockState() const override;
+
+        /**
+         * Relay to the wrapped source, see AudioSource::onAudioEvent
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Tail of the wrapped source plus the length of the impulse response
+         */
+        int32_t getTailFrames() const override;
+
+        /**
+         * Partition length in use
+         * @return Frames per partition
+         */
+        int32_t getPartitionFrames() const;
+
+        /**
+         * Number of partitions processed in the frequency domain
+         * @return Partitions after the first one
+         */
+        int32_t getPartitionCount() const;
+
+    protected:
+        /**
+         * At the end of a partition of input: transform it, add it to the delay line and compute the output of
+         * the frequency-domain partitions for the next partition of frames
+         */
+        void processPartition();
+
+        /**
+         * Clear the input, the delay line and the pending output
+         */
+        void clear();
+
+        AudioSource* _source; // wrapped audio source
+        int32_t _channelCount; // number of channels
+        int32_t _impulseChannels; // channels of the impulse response
+        int32_t _impulseFrames; // length of the impulse response
+        int32_t _partitionFrames; // partition length
+        int32_t _partitionCount; // partitions in the frequency domain, after the direct-form one
+        int32_t _binCount; // bins of a spectrum, _partitionFrames + 1
+        int32_t _binStride; // distance between two spectra, in floats, a multiple of 16
+        int32_t _macCount; // bins passed to the kernels, _binCount rounded up to a multiple of 8
+        RealFft _fft; // transform of two partitions
+        AlignedBuffer<float> _head; // first partition of each response channel, reversed, float[channels][frames]
+        AlignedBuffer<float> _filterSpectra; // float[impulseChannels][partitions][2][binStride], real then imaginary
+        AlignedBuffer<float> _inputSpectra; // delay line, float[channels][partitions][2][binStride]
+        AlignedBuffer<float> _input; // last two partitions of input, float[channels][2*partitionFrames]
+        AlignedBuffer<float> _pending; // output of the frequency-domain partitions, float[channels][partitionFrames]
+        AlignedBuffer<float> _accumulator; // sum of the products of the spectra, float[2][binStride]
+        AlignedBuffer<float> _transformed; // output of the inverse transform, float[2*partitionFrames]
+        int32_t _position = 0; // frames of the current partition already processed
+        int32_t _newestSpectrum = 0; // slot of the delay line holding the newest spectrum
+        int64_t _silentFrames; // number of silent input frames, up to the last one
+        BlockState _blockState = BlockState::Silent; // content of the last block
+    };
+
+}  // namespace synthesizerBase
+
+#endif
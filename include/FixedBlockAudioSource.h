@@ -0,0 +1,97 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef FixedBlockAudioSource_H
+#define FixedBlockAudioSource_H
+
+#include "AlignedBuffer.h"
+#include "AudioSource.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Adapter presenting a fixed internal block size to a wrapped audio source
+     *
+     * The audio driver may request any number of frames per callback, and that number can change between
+     * callbacks. This adapter calls the wrapped source always with exactly getBlockFrames() frames, a power of two,
+     * into a buffer where each channel block starts on a 64-byte boundary. The wrapped source can therefore rely on
+     * aligned, fixed-length loops (e.g. dispatch once to kernels templated on the block size, or run FFTs of
+     * matching length).
+     * <br />
+     * Blocks are rendered on demand when a request reaches beyond the frames left from the previous block, and the
+     * rest of the block is kept for the next request; this adds no latency. No memory is allocated after
+     * construction.
+     */
+    class FixedBlockAudioSource : public AudioSource {
+    public:
+        /**
+         * Constructor
+         * @param source Wrapped audio source, owned by the caller
+         * @param blockFrames Internal block size, rounded up to a power of two of at least 16 (e.g. 32, 64, 128, 256)
+         * @param channelCount Number of channels; onAudioReady must be called with this channel count
+         */
+        FixedBlockAudioSource(AudioSource* source, int32_t blockFrames, int32_t channelCount);
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Relay to the wrapped source, and discard the frames left from the last block
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Internal block size, as used for calling the wrapped source
+         * @return Number of frames per block
+         */
+        int32_t getBlockFrames() const;
+
+        /**
+         * Idle once the frames left from the last block are delivered and the wrapped source is idle
+         */
+        bool isIdle() const override;
+
+        /**
+         * Silent if all delivered frames came from silent blocks of the wrapped source
+         */
+        BlockState getBlockState() const override;
+
+        /**
+         * Relay to the wrapped source, see AudioSource::onAudioEvent; applies at the next internal block
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Tail of the wrapped source
+         */
+        int32_t getTailFrames() const override;
+
+    protected:
+        AudioSource* _source; // wrapped audio source
+        int32_t _blockFrames; // internal block size, power of two
+        int32_t _channelCount; // number of channels
+        AlignedBuffer<float> _block; // last rendered block, float[channelCount][blockFrames]
+        int32_t _readPosition; // first frame of _block not yet delivered
+        bool _silentBlock = false; // whether _block is silent
+        bool _silentOutput = false; // whether all frames delivered by the last call were silent
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,204 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef MixerAudioSource_H
+#define MixerAudioSource_H
+
+#include <atomic>
+#include <memory>
+#include "AlignedBuffer.h"
+#include "AudioSource.h"
+#include "RealtimeThreadPool.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Audio source summing several input audio sources, each with its own gain and pan
+     *
+     * The mixer has a fixed number of input slots, allocated at construction. Inputs are attached and detached
+     * from a control thread while playing, without locks or allocation: attachInput takes a free slot, and
+     * detachInput asks the audio thread to stop using the source. Once isInputReleased confirms the release,
+     * the source can be deleted and the slot is free again.
+     * <br />
+     * Each input renders into a scratch buffer that is then accumulated into the output with vectorized kernels
+     * (see SimdKernels.h). Gain changes are ramped over one block to avoid zipper noise; likewise, attached inputs
+     * fade in and detached inputs fade out over one block.
+     * Pan only applies with two or more output channels, and affects the first two: it uses a constant power law,
+     * from -1 (left) to +1 (right).
+     * <br />
+     * Idle inputs (AudioSource::isIdle) are not rendered, and chunks an input reports as silent are not summed;
+     * the mixer itself is idle when all its inputs are.
+     * <br />
+     * With a thread pool (setThreadPool), the inputs of each chunk render in parallel, each into its own scratch
+     * buffer, and are then accumulated on the audio thread in slot order, with the same result as without the pool.
+     */
+    class MixerAudioSource : public AudioSource {
+    public:
+        /**
+         * Constructor
+         * @param maxInputs Number of input slots
+         * @param channelCount Number of channels; onAudioReady must be called with this channel count
+         * @param chunkFrames Number of frames rendered by each input per call; larger requests are split
+         */
+        MixerAudioSource(int32_t maxInputs, int32_t channelCount, int32_t chunkFrames = defaultAudioFrameSize);
+
+        /**
+         * Attach an input (control thread)
+         * @param source Audio source, owned by the caller
+         * @param gain Linear gain
+         * @param pan Pan position, from -1 (left) to +1 (right)
+         * @return Slot index of the input, or ResultErrorInvalidState if all slots are in use
+         */
+        int32_t attachInput(AudioSource* source, float gain = 1.0f, float pan = 0.0f);
+
+        /**
+         * Ask the audio thread to stop using an input (control thread). Without a running audio thread, the
+         * release happens at the next callback or at onPlaybackStopped.
+         * @param slot Slot index returned by attachInput
+         */
+        void detachInput(int32_t slot);
+
+        /**
+         * Check whether a detached input is no longer used by the audio thread (control thread). Once this
+         * returns true, the source can be deleted and the slot can be reused by attachInput.
+         * @param slot Slot index
+         * @return true if the slot is not in use
+         */
+        bool isInputReleased(int32_t slot);
+
+        /**
+         * Set the gain of an input (control thread)
+         * @param slot Slot index
+         * @param gain Linear gain
+         */
+        void setInputGain(int32_t slot, float gain);
+
+        /**
+         * Set the pan position of an input (control thread)
+         * @param slot Slot index
+         * @param pan Pan position, from -1 (left) to +1 (right)
+         */
+        void setInputPan(int32_t slot, float pan);
+
+        /**
+         * Number of input slots
+         * @return Maximum number of inputs
+         */
+        int32_t getMaxInputs() const;
+
+        /**
+         * @brief Render the inputs in parallel on a thread pool
+         *
+         * Allocates one scratch buffer per input slot. Call while not playing. Inputs must then support being
+         * rendered on any thread of the pool.
+         * @param pool Thread pool, owned by the caller, or nullptr to render all inputs on the audio thread
+         */
+        void setThreadPool(RealtimeThreadPool* pool);
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Relay to all attached inputs, including idle ones and those fading out, such that events can wake them up
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Relay to all attached inputs, and release detached ones
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Idle if no input is fading in or out and all attached inputs are idle
+         */
+        bool isIdle() const override;
+
+        /**
+         * Silent if no input contributed to the last block
+         */
+        BlockState getBlockState() const override;
+
+    protected:
+        enum SlotState : int32_t {
+            SlotFree = 0,
+            SlotAttaching, // claimed by attachInput, not yet visible to the audio thread
+            SlotActive,
+            SlotDetaching, // detachInput called, the audio thread may still use the source
+            SlotReleased, // the audio thread no longer uses the source
+        };
+
+        struct InputSlot {
+            std::atomic<int32_t> state{SlotFree};
+            AudioSource* source = nullptr; // written before the slot becomes active
+            float gain = 1.0f; // control thread copies of the parameters, for recomputing the channel gains
+            float pan = 0.0f;
+            // Target gains of channel 0, channel 1 and further channels, pan law applied
+            std::atomic<float> channelGains[3];
+            float appliedGains[3] = {}; // audio thread: gains reached at the end of the last block
+            float startGains[3] = {}; // audio thread: gain ramp of the current block
+            float gainSteps[3] = {};
+            bool fadingOut = false; // audio thread: detached, fading out in the current block
+        };
+
+        /**
+         * Recompute the channel gains of a slot from its gain and pan (control thread)
+         */
+        void updateChannelGains(InputSlot& slot);
+
+        /**
+         * Set the gain ramps of an input for the current block, from the applied to the target gains (audio thread)
+         * @param slot Input slot
+         * @param fadeOut true to ramp to silence instead of the target gains
+         * @param framesCount Frames of the block
+         */
+        void beginInput(InputSlot& slot, bool fadeOut, int32_t framesCount);
+
+        /**
+         * Accumulate one rendered chunk of an input into the output, with its gain ramps (audio thread)
+         * @param slot Input slot
+         * @param input Chunk rendered by the input, float[channelCount][frames]
+         * @param offset First frame of the chunk in the block
+         * @param frames Frames of the chunk
+         */
+        void accumulateInput(const InputSlot& slot, const float* input, float* audioData, int32_t framesCount,
+                             int32_t offset, int32_t frames);
+
+        /**
+         * Task of the thread pool: render one input of the current chunk into its scratch buffer
+         */
+        static void renderInputTask(void* context, int32_t index);
+
+        int32_t _maxInputs;
+        int32_t _channelCount;
+        int32_t _chunkFrames;
+        std::unique_ptr<InputSlot[]> _slots;
+        AlignedBuffer<float> _scratch; // one input chunk, float[channelCount][chunkFrames]
+
+        RealtimeThreadPool* _threadPool = nullptr;
+        AlignedBuffer<float> _inputScratch; // with a thread pool: one chunk per input slot
+        std::unique_ptr<int32_t[]> _renderedSlots; // audio thread: slots rendered in the current block
+        int32_t _renderedCount = 0;
+        bool _silentBlock = true; // audio thread: no input contributed to the last block
+        int32_t _chunkRenderFrames = 0; // audio thread: chunk the pool tasks render
+        ChannelCount _chunkChannelCount = ChannelCount::Mono;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
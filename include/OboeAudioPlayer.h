@@ -27,14 +27,14 @@
 #ifndef OboeAudioPlayer_H
 #define OboeAudioPlayer_H
 
+#include <memory>
 #include <oboe/Oboe.h>
+#include "AlignedBuffer.h"
 #include "AudioPlayer.h"
 #include "AudioSource.h"
-
-
-
-#define defaultAudioFrameSize 256
-#define defaultAudioChannelNumber 1
+#include "AudioDefinitions.h"
+#include "ResamplingAudioSource.h"
+#include "SampleFormatConverter.h"
 
 
 
@@ -51,18 +51,17 @@ namespace synthesizerBase {
     class OboeAudioPlayer : public oboe::AudioStreamDataCallback,
                             public synthesizerBase::AudioPlayer {
     public:
-        /**
-         * Number of audio channels to be synthesized (1=mono for now)
-         */
-        static constexpr auto channelCount = oboe::ChannelCount::Mono;
-
         /** Constructor with audio source
          *
          * @param source The audio source
          * @param samplingRate The required sampling rate, in samples per seconds
+         * @param channelCount The number of channels requested from the stream (1=mono, 2=stereo, ...). The
+         * stream's data is interleaved; sources declaring SampleLayout::Interleaved as their native layout
+         * render into it directly, others are rendered planar and interleaved by the player.
          */
 
-        OboeAudioPlayer(synthesizerBase::AudioSource * source, int samplingRate);
+        OboeAudioPlayer(synthesizerBase::AudioSource * source, int samplingRate,
+                        int32_t channelCount = defaultAudioChannelNumber);
         /**
          * Destructor
          */
@@ -102,6 +101,42 @@ namespace synthesizerBase {
 
         virtual void stop() override;
 
+        /**
+         * @brief Choose between the native sample format of the device and float
+         *
+         * With the native format (default), the stream is opened without a requested format, so that the device
+         * does not convert on its side; if it gives 16, 24 or 32-bit integers, the float frames of the audio source
+         * are converted with SampleFormatConverter. Otherwise, the stream is opened with float samples. Call while
+         * not playing.
+         * @param enabled true for the native format, false for float
+         */
+        void setNativeFormatEnabled(bool enabled);
+
+        /**
+         * Set the dither applied when converting to an integer native format; Triangular by default. Call while
+         * not playing.
+         * @param dither Dither mode
+         */
+        void setDitherMode(DitherMode dither);
+
+        /**
+         * @brief Open the stream at the device's native sampling rate, and resample with ResamplingAudioSource
+         *
+         * By default, the stream is opened at the sampling rate given to the constructor and oboe converts to the
+         * device rate if needed. With the native rate, the audio source still renders at the rate given to the
+         * constructor, and the player resamples with the given quality preset when the device rate differs. Event
+         * frames and getFrameTime then count frames at the rate of the source. Call while not playing.
+         * @param enabled true for the native rate
+         * @param quality Quality preset of the resampler
+         */
+        void setNativeRateEnabled(bool enabled, ResamplerQuality quality = ResamplerQuality::High);
+
+        /**
+         * Sample format of the open stream
+         * @return Sample format, SampleFormat::Float when not playing
+         */
+        SampleFormat getSampleFormat() const;
+
         /**
        * @brief Callback method following oboe::AudioStreamDataCallback, indicating that audio data should
        * be generated and written to the audio buffer provided.
@@ -137,11 +172,51 @@ namespace synthesizerBase {
 
 
     protected:
+        /**
+         * The player's audio source, as rendered by renderAudio, presented to the resampler
+         */
+        class PlayerAudioSource : public AudioSource {
+        public:
+            explicit PlayerAudioSource(OboeAudioPlayer* player) : _player(player) {}
+
+            void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+                _player->renderAudio(audioData, framesCount, channelCount);
+            }
+
+            void onPlaybackStopped() override {
+            }
+
+        protected:
+            OboeAudioPlayer* _player; // enclosing player
+        };
+
+        /**
+         * Fill interleaved float frames at the stream's rate, through the resampler if there is one
+         */
+        void renderStream(float* audioData, int32_t framesCount, int32_t channelCount);
 
         std::shared_ptr<oboe::AudioStream> _stream; // oboe audio stream, acquired during oboe audio startup
         // and serving to obtain parameters such as the number of frames per callback.
 
         int _samplingRate; // the audio sampling rate, in samples / second
+
+        int32_t _channelCount; // the number of channels requested when opening the stream
+
+        bool _nativeFormatEnabled = true; // open the stream with the device's sample format rather than float
+
+        DitherMode _dither = DitherMode::Triangular; // dither when converting to integer samples
+
+        std::unique_ptr<SampleFormatConverter> _converter; // for integer stream formats, created by play
+
+        AlignedBuffer<float> _floatData; // float frames rendered before conversion, the capacity of the stream
+
+        bool _nativeRateEnabled = false; // open the stream at the device's rate and resample here
+
+        ResamplerQuality _resamplerQuality = ResamplerQuality::High; // quality of _resampler
+
+        PlayerAudioSource _playerSource{this}; // source of _resampler
+
+        std::unique_ptr<ResamplingAudioSource> _resampler; // if the stream's rate differs from _samplingRate
     };
 }  // namespace synthesizerBase
 
@@ -0,0 +1,132 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef OfflineAudioPlayer_H
+#define OfflineAudioPlayer_H
+
+#include <atomic>
+#include <vector>
+#include "AudioPlayer.h"
+#include "AudioSink.h"
+#include "AudioSource.h"
+#include "AudioDefinitions.h"
+
+
+namespace synthesizerBase {
+    /**
+     * @brief Audio player rendering faster than real time, without an audio device
+     *
+     * The OfflineAudioPlayer implements the same contract as the other audio players, but instead of
+     * waiting for an audio driver to request data, play() invokes onAudioReady on the AudioSource in
+     * a tight loop, as fast as the CPU allows, and hands each block to an AudioSink (a WAV or raw PCM file,
+     * a caller-supplied buffer, or a custom implementation). This serves for rendering previews
+     * and test material, for example on a server, and does not depend on oboe.
+     * <br />
+     * play() renders synchronously, in the calling thread, and returns once the configured number of
+     * frames has been rendered, the sink reported an error, or stop() was called (from another thread
+     * or from within the AudioSource).
+     */
+    class OfflineAudioPlayer : public AudioPlayer {
+    public:
+        /**
+         * Constructor
+         * @param source The audio source
+         * @param samplingRate The sampling rate, in samples per second
+         * @param channelCount Number of channels requested from the audio source
+         * @param framesPerDataCallback Number of frames requested from the audio source per call to onAudioReady
+         */
+        OfflineAudioPlayer(AudioSource* source, int samplingRate,
+                           int32_t channelCount = defaultAudioChannelNumber,
+                           int32_t framesPerDataCallback = defaultAudioFrameSize);
+
+        /**
+         * Destructor
+         */
+        ~OfflineAudioPlayer() override;
+
+        /**
+         * Set the destination of the rendered data. If no sink is set, the data is rendered and discarded,
+         * which can be useful for benchmarking.
+         * @param sink Audio sink, owned by the caller; it must remain valid while playing
+         */
+        void setSink(AudioSink* sink);
+
+        /**
+         * Set the number of frames to be rendered by play()
+         * @param framesToRender Number of frames (samples per channel). 0 or negative values mean that
+         *                       rendering continues until stop() is called.
+         */
+        void setRenderLength(int64_t framesToRender);
+
+        /**
+         * Change the sampling rate and the channel count (while not playing), e.g. for rendering jobs of different
+         * formats with one player; the block buffer keeps its memory if it is large enough
+         * @param samplingRate The sampling rate, in samples per second
+         * @param channelCount Number of channels requested from the audio source
+         */
+        void setFormat(int samplingRate, int32_t channelCount);
+
+        /**
+         * @brief Render the configured number of frames from the audio source to the sink
+         *
+         * Blocks until rendering is finished. The audio source is notified by onPlaybackStopped once
+         * rendering ends.
+         * @return 0 for success, error code otherwise (including errors reported by the sink)
+         */
+        int32_t play() override;
+
+        /**
+         * @brief Request rendering to stop
+         *
+         * Can be called from any thread, including from within the AudioSource callback. play() returns
+         * after the block being rendered is complete; if it is not rendering yet, the next play() returns without
+         * rendering.
+         */
+        void stop() override;
+
+        int32_t getChannelCount() override;
+
+        int32_t getFramesPerDataCallback() override;
+
+        /**
+         * Number of frames rendered by the last or current call to play()
+         * @return Number of frames rendered
+         */
+        int64_t getFramesRendered() const;
+
+        /**
+         * Sampling rate of the rendered data
+         * @return Sampling rate, in samples per second
+         */
+        int getSamplingRate() const;
+
+    protected:
+        AudioSink* _sink = nullptr; // destination of the rendered data, may be nullptr
+        int _samplingRate; // the audio sampling rate, in samples / second
+        int32_t _channelCount; // number of channels requested from the source
+        int32_t _framesPerDataCallback; // block size requested from the source
+        int64_t _framesToRender = 0; // length of the rendering, 0 for rendering until stop()
+        std::atomic<int64_t> _framesRendered{0}; // progress of the current rendering
+        std::atomic<bool> _stopRequested{false}; // set by stop() to end play()
+        std::vector<float> _buffer; // block buffer handed to the audio source
+    };
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,193 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef ParameterBank_H
+#define ParameterBank_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+#include "AudioDefinitions.h"
+#include "AudioEvent.h"
+
+namespace synthesizerBase {
+
+    /**
+     * Shape of the transition of a parameter to a new target value
+     */
+    enum class RampShape : uint8_t {
+        Linear, // constant slope, reaching the target after the ramp time
+        Exponential, // constant ratio, reaching the target after the ramp time; suited to gains and frequencies.
+                     // Falls back to Linear if the values are not both of the same sign and non-zero
+        OnePole, // first order low-pass, the ramp time being the time constant (63% of the change)
+    };
+
+    /**
+     * @brief Smoothed parameters of an audio source, e.g. gains, pans or cutoff frequencies
+     *
+     * Each parameter has a current value, a target and a ramp shape and time. When a target changes, the values of
+     * the following blocks are generated as a per-sample vector by vectorized kernels (see SimdKernels.h), ready to
+     * be applied as a gain or read by the synthesis code. Steady parameters cost nothing per sample: only the
+     * parameters that are ramping are visited in advance, and apply uses a scalar gain for the others.
+     * <br />
+     * The state is kept as separate aligned arrays, one entry per parameter. The bank is not synchronized: change
+     * targets from the audio thread, typically by forwarding AudioEventParameter events to handleEvent, or while
+     * the source is not playing.
+     * <br />
+     * Usage per block of at most getMaxBlockFrames() frames: advance(framesCount), then for each parameter either
+     * isSteady(p) and getValue(p), or getRamp(p) for the per-sample values; apply(p, ...) does this for gains.
+     */
+    class ParameterBank {
+    public:
+        /**
+         * Constructor; all parameters start at 0 with a linear 10 ms ramp
+         * @param parameterCount Number of parameters
+         * @param samplingRate Sampling rate, in samples per second
+         * @param maxBlockFrames Maximum number of frames per advance
+         */
+        ParameterBank(int32_t parameterCount, int samplingRate, int32_t maxBlockFrames = defaultAudioFrameSize);
+
+        /**
+         * Set the ramp used by setTarget
+         * @param parameter Parameter index
+         * @param shape Ramp shape
+         * @param rampMillis Ramp time, or time constant for OnePole, in milliseconds; 0 for immediate changes
+         */
+        void setRamp(int32_t parameter, RampShape shape, float rampMillis);
+
+        /**
+         * Start a ramp from the current value to a new target, with the ramp set by setRamp
+         * @param parameter Parameter index
+         * @param target Target value
+         */
+        void setTarget(int32_t parameter, float target);
+
+        /**
+         * Set a value immediately, without ramp
+         * @param parameter Parameter index
+         * @param value Value
+         */
+        void setValue(int32_t parameter, float value);
+
+        /**
+         * Apply an AudioEventParameter event, whose index is the parameter and value the target
+         * @param event Event
+         * @return true if the event was a parameter event for this bank
+         */
+        bool handleEvent(const AudioEvent& event);
+
+        /**
+         * Generate the values of the ramping parameters for the next block; split longer blocks into parts of at
+         * most getMaxBlockFrames() frames
+         * @param framesCount Number of frames, at most getMaxBlockFrames()
+         * @return ResultOk, or ResultErrorInvalidArgument if framesCount exceeds getMaxBlockFrames(), leaving the
+         *         bank unchanged
+         */
+        int32_t advance(int32_t framesCount);
+
+        /**
+         * Whether a parameter was constant during the last block
+         * @param parameter Parameter index
+         * @return true if getValue is valid for all frames of the block, false if getRamp must be used
+         */
+        bool isSteady(int32_t parameter) const {
+            return _rampBlocks[parameter] != _blockCount;
+        }
+
+        /**
+         * Value at the end of the last block, or current value if steady
+         * @param parameter Parameter index
+         * @return Value
+         */
+        float getValue(int32_t parameter) const {
+            return _values[parameter];
+        }
+
+        /**
+         * Target value
+         * @param parameter Parameter index
+         * @return Target value
+         */
+        float getTarget(int32_t parameter) const {
+            return _targets[parameter];
+        }
+
+        /**
+         * Per-sample values during the last block
+         * @param parameter Parameter index
+         * @return framesCount values of the last advance, or nullptr if the parameter is steady
+         */
+        const float* getRamp(int32_t parameter) const;
+
+        /**
+         * Multiply samples by a parameter: with the per-sample ramp if ramping, with the scalar value otherwise
+         * @param parameter Parameter index
+         * @param samples Samples, modified in place, framesCount of the last advance or fewer
+         * @param count Number of samples
+         * @return ResultOk, or ResultErrorInvalidArgument if the parameter is ramping and count exceeds the
+         *         framesCount of the last advance, leaving the samples unchanged
+         */
+        int32_t apply(int32_t parameter, float* samples, int32_t count) const;
+
+        int32_t getParameterCount() const {
+            return _parameterCount;
+        }
+
+        int32_t getMaxBlockFrames() const {
+            return _maxBlockFrames;
+        }
+
+        /**
+         * Number of parameters currently ramping
+         */
+        int32_t getRampingCount() const {
+            return _rampingCount;
+        }
+
+    protected:
+        void startRamping(int32_t parameter);
+        void stopRamping(int32_t parameter);
+
+        int32_t _parameterCount;
+        int _samplingRate;
+        int32_t _maxBlockFrames;
+        int32_t _rowStride; // floats between the ramps of two parameters, a multiple of 16
+
+        // Per parameter
+        AlignedBuffer<float> _values;
+        AlignedBuffer<float> _targets;
+        AlignedBuffer<float> _steps; // Linear: increment per sample; Exponential, OnePole: factor per sample
+        AlignedBuffer<int32_t> _remainingFrames; // Linear, Exponential: frames to the end of the ramp
+        AlignedBuffer<uint8_t> _shapes; // shape set by setRamp
+        AlignedBuffer<uint8_t> _rampShapes; // shape of the current ramp, Linear if Exponential is not possible
+        AlignedBuffer<float> _rampFrames; // ramp time or time constant, in frames
+        AlignedBuffer<float> _settledDistances; // OnePole: distance to the target at which the ramp ends
+        AlignedBuffer<int64_t> _rampBlocks; // _blockCount of the last block with a ramp
+        AlignedBuffer<int32_t> _rampingPositions; // index in _ramping, or -1
+
+        AlignedBuffer<int32_t> _ramping; // dense array of the ramping parameters
+        int32_t _rampingCount;
+        AlignedBuffer<float> _ramps; // float[parameterCount][_rowStride], values of the last block
+        int64_t _blockCount;
+        int32_t _blockFrames; // framesCount of the last advance
+    };
+
+}  // namespace synthesizerBase
+
+#endif
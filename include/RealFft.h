@@ -0,0 +1,99 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Fast Fourier transform of real signals, for the block convolution of ConvolutionAudioSource.
+ */
+
+#ifndef RealFft_H
+#define RealFft_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Fourier transform of real signals of a power-of-two length
+     *
+     * Computed as a complex transform of half the length on the even and odd samples, by iterative radix-2
+     * butterflies with the twiddle factors of each stage stored contiguously, followed by the split into the
+     * spectrum of the real signal. Spectra are kept in split layout (real and imaginary parts in separate arrays),
+     * as taken by simd::complexMultiplyAccumulate. The tables are computed at construction; the transforms neither
+     * allocate nor lock, but use a work buffer of the object, so one object serves one thread at a time.
+     */
+    class RealFft {
+    public:
+        /**
+         * Constructor
+         * @param size Transform length, a power of two, at least 4; other values are rounded up
+         */
+        explicit RealFft(int32_t size);
+
+        RealFft(const RealFft&) = delete;
+
+        RealFft& operator=(const RealFft&) = delete;
+
+        /**
+         * Transform length
+         * @return Number of real samples
+         */
+        int32_t getSize() const;
+
+        /**
+         * Number of frequency bins of a spectrum, from 0 Hz to the Nyquist frequency
+         * @return size/2 + 1
+         */
+        int32_t getBinCount() const;
+
+        /**
+         * Forward transform, without scaling
+         * @param input size samples
+         * @param real Receives getBinCount() real parts
+         * @param imaginary Receives getBinCount() imaginary parts
+         */
+        void forward(const float* input, float* real, float* imaginary);
+
+        /**
+         * Inverse transform, without scaling: the inverse of the forward transform of x is size*x
+         * @param real getBinCount() real parts
+         * @param imaginary getBinCount() imaginary parts; those at 0 Hz and the Nyquist frequency are ignored
+         * @param output Receives size samples
+         */
+        void inverse(const float* real, const float* imaginary, float* output);
+
+    protected:
+        /**
+         * In-place complex transform of the half length, on _work, input in bit-reversed order
+         * @param real Real parts
+         * @param imaginary Imaginary parts
+         */
+        void transform(float* real, float* imaginary) const;
+
+        int32_t _size; // transform length
+        int32_t _half; // length of the complex transform
+        AlignedBuffer<int32_t> _bitReversal; // bit-reversed index of each of the _half positions
+        AlignedBuffer<float> _stageTwiddles; // cosine and sine parts, _half - 1 each, stage by stage
+        AlignedBuffer<float> _splitTwiddles; // cosine and sine of the split into the real spectrum, _half/2 + 1 each
+        AlignedBuffer<float> _work; // complex signal of the half length, real then imaginary parts
+    };
+
+}  // namespace synthesizerBase
+
+#endif
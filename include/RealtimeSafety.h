@@ -0,0 +1,180 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Checking that audio callbacks are real-time safe. With the CMake option SYNTHESIZERBASE_REALTIME_CHECKS (Linux
+ * with glibc, for debug and test builds), the library interposes the memory allocation functions, the blocking
+ * lock functions and blocking calls such as file I/O and sleeping, and reports each call made by a thread inside
+ * a RealtimeScope: the audio players mark their callbacks, RealtimeThreadPool and RenderAheadAudioSource the
+ * blocks rendered by their workers.
+ */
+
+#ifndef RealtimeSafety_H
+#define RealtimeSafety_H
+
+#include <stdint.h>
+
+namespace synthesizerBase {
+
+    /**
+     * Kind of call that is not real-time safe
+     */
+    enum class RealtimeViolationType : int32_t {
+        Allocation = 0, // malloc, calloc, realloc, aligned allocation, and operator new, which calls malloc
+        Deallocation, // free, and operator delete
+        Lock, // blocking mutex, read-write lock, condition variable and semaphore waits, thread joins
+        BlockingCall, // file and stream I/O, sleeping, polling, memory mapping
+    };
+
+    /**
+     * What the checker does on a violation
+     */
+    enum class RealtimeCheckMode : int32_t {
+        Off = 0, // nothing
+        Report, // count it and print it with a backtrace on stderr, up to the report limit
+        Abort, // print it with a backtrace and abort the process, e.g. for continuous integration
+    };
+
+    /**
+     * @brief A call that is not real-time safe, made inside a RealtimeScope
+     */
+    struct RealtimeViolation {
+        RealtimeViolationType type;
+        const char* function; // name of the interposed function, e.g. "malloc"
+    };
+
+    /**
+     * Function called on each violation, with checks suspended on the calling thread, such that it may allocate
+     */
+    typedef void (*RealtimeViolationHandler)(const RealtimeViolation& violation, void* context);
+
+    /**
+     * @brief Configuration and state of the real-time safety checks
+     *
+     * The mode defaults to Report, or to the value of the environment variable SYNTHESIZERBASE_REALTIME_CHECKS
+     * ("off", "report" or "abort") when the library is loaded. Without the CMake option, the functions exist but
+     * nothing is checked. The interposition replaces the allocator functions of glibc; it cannot be combined with
+     * sanitizers that replace them as well.
+     */
+    class RealtimeSafety {
+    public:
+        /**
+         * Default number of violations printed; further ones are only counted
+         */
+        static constexpr int32_t defaultReportLimit = 32;
+
+        /**
+         * Whether the checks are compiled into the library
+         * @return true with SYNTHESIZERBASE_REALTIME_CHECKS on Linux with glibc
+         */
+        static bool isAvailable();
+
+        static void setMode(RealtimeCheckMode mode);
+
+        static RealtimeCheckMode getMode();
+
+        /**
+         * Set how many violations are printed in Report mode
+         * @param reports Number of reports; further violations are counted and passed to the handler only
+         */
+        static void setReportLimit(int32_t reports);
+
+        /**
+         * Set a function called on each violation, e.g. to collect them in a test (while no audio thread runs)
+         * @param handler Handler, or nullptr
+         * @param context Passed to the handler
+         */
+        static void setViolationHandler(RealtimeViolationHandler handler, void* context);
+
+        /**
+         * Number of violations since the library was loaded or the count was reset
+         * @return Number of violations
+         */
+        static int64_t getViolationCount();
+
+        static void resetViolationCount();
+
+        /**
+         * Whether the calling thread is inside a RealtimeScope, with checks not suspended
+         * @return true if calls on this thread are checked
+         */
+        static bool isChecking();
+
+        /**
+         * Enter a real-time section on the calling thread; sections nest. Use RealtimeScope.
+         */
+        static void enterRealtimeScope();
+
+        static void leaveRealtimeScope();
+
+        /**
+         * Suspend the checks on the calling thread, e.g. around a deliberate exception; suspensions nest.
+         * Use NonRealtimeScope.
+         */
+        static void suspendChecks();
+
+        static void resumeChecks();
+    };
+
+    /**
+     * @brief Marks the lifetime of the object as a real-time section of the calling thread
+     *
+     * Compiles to nothing without SYNTHESIZERBASE_REALTIME_CHECKS.
+     */
+    class RealtimeScope {
+    public:
+#ifdef SYNTHESIZERBASE_REALTIME_CHECKS
+        RealtimeScope() { RealtimeSafety::enterRealtimeScope(); }
+
+        ~RealtimeScope() { RealtimeSafety::leaveRealtimeScope(); }
+#else
+        RealtimeScope() {}
+
+        ~RealtimeScope() {} // user-provided, such that scope variables do not count as unused
+#endif
+
+        RealtimeScope(const RealtimeScope&) = delete;
+
+        RealtimeScope& operator=(const RealtimeScope&) = delete;
+    };
+
+    /**
+     * @brief Suspends the checks on the calling thread for the lifetime of the object, for calls that are known
+     * and accepted; compiles to nothing without SYNTHESIZERBASE_REALTIME_CHECKS
+     */
+    class NonRealtimeScope {
+    public:
+#ifdef SYNTHESIZERBASE_REALTIME_CHECKS
+        NonRealtimeScope() { RealtimeSafety::suspendChecks(); }
+
+        ~NonRealtimeScope() { RealtimeSafety::resumeChecks(); }
+#else
+        NonRealtimeScope() {}
+
+        ~NonRealtimeScope() {} // user-provided, such that scope variables do not count as unused
+#endif
+
+        NonRealtimeScope(const NonRealtimeScope&) = delete;
+
+        NonRealtimeScope& operator=(const NonRealtimeScope&) = delete;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,209 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef RealtimeThreadPool_H
+#define RealtimeThreadPool_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+#include "AudioThreadSetup.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Worker threads that render parts of an audio block in parallel with the audio thread
+     *
+     * The audio thread hands a batch of independent tasks to parallelFor, which splits them into one contiguous
+     * range per thread, itself included. Each thread runs its own range, then steals the remaining tasks of the
+     * other ranges; claiming a task is one atomic increment of the range's cursor. The audio thread always takes
+     * part, so a batch completes even if no worker gets scheduled in time.
+     * <br />
+     * Workers spin for a while after each batch, then sleep (on a futex on Linux and Android, polling elsewhere).
+     * The player calls beginBlock at the start of each callback, which wakes sleeping workers early enough for them
+     * to spin when the first batch arrives. parallelFor neither allocates nor locks.
+     * <br />
+     * If the audio thread is still waiting for the workers at the deadline of its block (a fraction of the block
+     * period), the pool falls back at once to running batches on the audio thread alone, for the duration of
+     * fallbackBlocks blocks, then tries again: a device with busy or throttled cores then behaves as without the pool,
+     * instead of glitching at every block. Past the deadline, the audio thread yields while it waits for the tasks
+     * the workers are running, so that a worker preempted on its core can complete them.
+     * <br />
+     * The pool serves one audio thread. Calls of parallelFor from within a task, or from any other thread while a
+     * batch runs, execute inline.
+     */
+    class RealtimeThreadPool {
+    public:
+        /**
+         * Task of a batch, called with the context given to parallelFor and the index of the task
+         */
+        using Task = void (*)(void* context, int32_t index);
+
+        /**
+         * Duration, in blocks, of running without the workers after a missed deadline
+         */
+        static constexpr int32_t fallbackBlocks = 256;
+
+        /**
+         * Constructor, starts the worker threads
+         * @param workerCount Number of worker threads, in addition to the audio thread
+         * @param samplingRate Sampling rate, in samples per second, for the deadline of each block; 0 for none
+         * @param deadlineFraction Part of the block period within which parallel work must complete
+         * @param spinMicros Time workers spin waiting for a batch before they sleep, in microseconds
+         */
+        RealtimeThreadPool(int32_t workerCount, int samplingRate, float deadlineFraction = 0.75f,
+                           int32_t spinMicros = 500);
+
+        /**
+         * Destructor, stops the worker threads
+         */
+        ~RealtimeThreadPool();
+
+        RealtimeThreadPool(const RealtimeThreadPool&) = delete;
+
+        RealtimeThreadPool& operator=(const RealtimeThreadPool&) = delete;
+
+        /**
+         * @brief Start a block (audio thread)
+         *
+         * Wakes sleeping workers and sets the deadline for the batches of this block. Called by AudioPlayer when
+         * the pool is set with AudioPlayer::setThreadPool.
+         * @param framesCount Number of frames of the block
+         */
+        void beginBlock(int32_t framesCount);
+
+        /**
+         * @brief Run a batch of tasks, on the workers and the calling thread (audio thread)
+         *
+         * Returns once all tasks completed. Tasks may run in any order and concurrently.
+         * @param task Task function
+         * @param context Passed to the task function
+         * @param count Number of tasks
+         * @return true if the workers took part, false if the batch ran on the calling thread only
+         */
+        bool parallelFor(Task task, void* context, int32_t count);
+
+        /**
+         * @brief Set the settings applied to the worker threads
+         *
+         * Each worker applies them when woken for a block or a batch, once per configuration.
+         * AudioPlayer::setThreadPool sets the player's settings.
+         * @param setup Thread settings, owned by the caller, or nullptr
+         */
+        void setThreadSetup(AudioThreadSetup* setup);
+
+        /**
+         * Number of worker threads
+         */
+        int32_t getWorkerCount() const;
+
+        /**
+         * Whether batches currently run on the audio thread alone after a missed deadline
+         */
+        bool isFallbackActive() const;
+
+        /**
+         * Number of batches that completed after the deadline of their block
+         */
+        int64_t getMissedDeadlineCount() const;
+
+        /**
+         * Number of batches the workers took part in
+         */
+        int64_t getParallelBatchCount() const;
+
+    protected:
+        /**
+         * Tasks of one thread, claimed by incrementing next
+         */
+        struct alignas(64) TaskRange {
+            std::atomic<int32_t> next{0};
+            int32_t end = 0;
+        };
+
+        /**
+         * Wait until a counter of the current batch drops to 0 (audio thread); falls back once past the deadline
+         * @param counter Counter to wait for
+         * @param late Whether the deadline was missed; set when missed while waiting
+         */
+        void waitForZero(const std::atomic<int32_t>& counter, bool& late);
+
+        /**
+         * Count a missed deadline and start the fallback (audio thread)
+         * @param now Current steady clock time, in nanoseconds
+         */
+        void missDeadline(int64_t now);
+
+        /**
+         * Run the tasks of the own range, then steal from the others
+         * @param participant Index of the own range, 0 for the audio thread
+         * @return Number of tasks run by the calling thread
+         */
+        int32_t runBatch(int32_t participant);
+
+        /**
+         * Main function of a worker thread
+         * @param participant Index of the worker's range, from 1
+         */
+        void runWorker(int32_t participant);
+
+        /**
+         * Wake the sleeping workers, if any
+         */
+        void wakeWorkers();
+
+        /**
+         * Apply the thread settings to the calling worker, unless already done
+         */
+        void setUpWorker();
+
+        int32_t _workerCount;
+        int _samplingRate;
+        float _deadlineFraction;
+        int64_t _spinNanos;
+        std::unique_ptr<TaskRange[]> _ranges; // workerCount + 1
+
+        // Batch: generation in the upper bits, 1 in the lowest bit while workers may join
+        alignas(64) std::atomic<uint32_t> _batch{0};
+        Task _task = nullptr;
+        void* _context = nullptr;
+        std::atomic<int32_t> _remaining{0}; // tasks not completed yet
+        std::atomic<int32_t> _activeWorkers{0}; // workers inside the current batch
+        std::atomic<bool> _busy{false}; // a batch runs
+        uint32_t _generation = 0; // audio thread
+
+        alignas(64) std::atomic<uint32_t> _wakeSequence{0}; // futex word, incremented to wake the workers
+        std::atomic<int32_t> _sleepingWorkers{0};
+        std::atomic<bool> _running{true};
+
+        int64_t _deadlineNanos = 0; // audio thread: steady clock time, 0 for none
+        int64_t _blockNanos = 0; // audio thread: period of the last block
+        std::atomic<int64_t> _fallbackEndNanos{0}; // steady clock time until which batches run without the workers
+        std::atomic<int64_t> _missedDeadlineCount{0};
+        std::atomic<int64_t> _parallelBatchCount{0};
+        std::atomic<AudioThreadSetup*> _threadSetup{nullptr}; // applied by the workers
+
+        std::vector<std::thread> _workers;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,208 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef RenderAheadAudioSource_H
+#define RenderAheadAudioSource_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "AudioSource.h"
+#include "AudioThreadSetup.h"
+#include "SpscRingBuffer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Audio source decoupling a heavy audio source from the audio callback through a worker thread
+     *
+     * A dedicated worker thread renders the wrapped source in blocks of blockFrames frames into a lock-free ring
+     * buffer, up to blocksAhead blocks ahead of playback. onAudioReady, called on the audio thread, only copies
+     * out of the ring. A wrapped source whose cost occasionally exceeds one callback period, but stays well
+     * inside the budget on average, then plays without glitches, at the price of blocksAhead*blockFrames
+     * frames of additional latency. If the ring runs empty, the missing frames are played as silence and
+     * counted as an underrun.
+     * <br />
+     * Events passed to onAudioEvent are queued to the worker thread together with the frame they fall on, delayed by
+     * (blocksAhead+1)*blockFrames frames, and applied to the wrapped source right before it renders that frame.
+     * <br />
+     * The wrapped source is only ever called from the worker thread. start() has to be called before playing;
+     * onPlaybackStopped stops the worker thread and relays the notification to the wrapped source.
+     */
+    class RenderAheadAudioSource : public AudioSource {
+    public:
+        /**
+         * Number of events that can wait for the worker thread; further events are dropped and counted
+         */
+        static constexpr int32_t eventQueueCapacity = 1024;
+
+        /**
+         * Constructor
+         * @param source Wrapped audio source, owned by the caller
+         * @param samplingRate Sampling rate, in samples per second, for pacing the worker thread
+         * @param channelCount Number of channels; onAudioReady must be called with this channel count
+         * @param blockFrames Number of frames the wrapped source renders per call
+         * @param blocksAhead Number of blocks rendered ahead of playback
+         */
+        RenderAheadAudioSource(AudioSource* source, int samplingRate, int32_t channelCount,
+                               int32_t blockFrames = defaultAudioFrameSize, int32_t blocksAhead = 4);
+
+        /**
+         * Destructor, stops the worker thread
+         */
+        ~RenderAheadAudioSource() override;
+
+        /**
+         * @brief Fill the ring buffer and start the worker thread
+         *
+         * Call from a non-real-time thread before the player starts.
+         */
+        void start();
+
+        /**
+         * Stop the worker thread. Call from a non-real-time thread.
+         */
+        void stop();
+
+        /**
+         * Copy the frames rendered ahead into the audio buffer (audio thread)
+         */
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Queue an event for the wrapped source, applied by the worker thread (blocksAhead+1)*blockFrames frames
+         * after the frame being played (audio thread)
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Stop the worker thread and notify the wrapped source
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Number of frames currently rendered ahead
+         * @return Fill level of the ring buffer, in frames
+         */
+        int32_t getFillLevelFrames() const;
+
+        /**
+         * Lowest fill level seen by the audio thread at the start of a callback, since start() or the last reset
+         * @return Fill level, in frames
+         */
+        int32_t getMinimumFillLevelFrames() const;
+
+        /**
+         * Number of callbacks that found fewer frames than requested
+         * @return Underrun count
+         */
+        int64_t getUnderrunCount() const;
+
+        /**
+         * Number of frames played as silence because of underruns
+         * @return Frames count
+         */
+        int64_t getUnderrunFrames() const;
+
+        /**
+         * Number of events dropped because the event queue was full
+         * @return Dropped event count
+         */
+        int64_t getDroppedEventCount() const;
+
+        /**
+         * Added latency
+         * @return Capacity of the render-ahead buffer, in frames
+         */
+        int32_t getLatencyFrames() const;
+
+        /**
+         * Reset the underrun statistics and the minimum fill level
+         */
+        void resetStatistics();
+
+        /**
+         * Set the settings applied to the worker thread when it starts, e.g. the player's
+         * (AudioPlayer::getAudioThreadSetup). Call before start().
+         * @param setup Thread settings, owned by the caller, or nullptr
+         */
+        void setThreadSetup(AudioThreadSetup* setup);
+
+    protected:
+        /**
+         * Event waiting for the worker thread
+         */
+        struct ScheduledEvent {
+            AudioEvent event;
+            int64_t renderFrame = 0; // ring frame before which the event is applied
+        };
+
+        /**
+         * Render one block of the wrapped source into the ring buffer (worker thread), split at the frames of the
+         * events due in the block
+         */
+        void renderBlock();
+
+        /**
+         * Render part of a block into the interleaved block buffer (worker thread); silence if the source is idle
+         * @param offset First frame of the part in the block
+         * @param framesCount Number of frames of the part
+         */
+        void renderPart(int32_t offset, int32_t framesCount);
+
+        /**
+         * Make the oldest queued event available in _nextEvent (worker thread)
+         * @return true if there is an event
+         */
+        bool peekEvent();
+
+        /**
+         * Main function of the worker thread
+         */
+        void runWorker();
+
+        AudioSource* _source; // wrapped audio source
+        int _samplingRate;
+        int32_t _channelCount;
+        int32_t _blockFrames;
+        int32_t _blocksAhead;
+        SpscRingBuffer<float> _ring; // interleaved frames rendered ahead
+        std::vector<float> _blockBuffer; // worker: block in the layout of onAudioReady
+        std::vector<float> _interleavedBuffer; // worker: block interleaved for the ring
+        std::vector<float> _readBuffer; // audio thread: interleaved frames taken from the ring
+        AudioThreadSetup* _threadSetup = nullptr; // applied by the worker thread
+        SpscRingBuffer<ScheduledEvent> _events{eventQueueCapacity}; // from the audio thread to the worker
+        ScheduledEvent _nextEvent; // worker: oldest event taken from the queue, not applied yet
+        bool _hasNextEvent = false; // worker: whether _nextEvent is valid
+        int64_t _renderedFrames = 0; // worker: frames written to the ring so far
+        int64_t _readFrames = 0; // audio thread: frames read from the ring so far
+
+        std::thread _worker;
+        std::atomic<bool> _running{false};
+
+        std::atomic<int32_t> _minimumFillLevel{0};
+        std::atomic<int64_t> _underrunCount{0};
+        std::atomic<int64_t> _underrunFrames{0};
+        std::atomic<int64_t> _droppedEventCount{0};
+    };
+
+}  // namespace synthesizerBase
+
+#endif
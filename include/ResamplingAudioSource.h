@@ -0,0 +1,144 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef ResamplingAudioSource_H
+#define ResamplingAudioSource_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+#include "AudioSource.h"
+
+namespace synthesizerBase {
+
+    /**
+     * Quality presets of the ResamplingAudioSource: filter length, number of phases, Kaiser window and cutoff
+     */
+    enum class ResamplerQuality : int32_t {
+        Fast = 0, // 8 taps, 64 phases, about 50 dB stopband attenuation; for previews and many voices
+        Medium, // 16 taps, 128 phases, about 55 dB
+        High, // 32 taps, 256 phases, about 85 dB
+        Best, // 64 taps, 512 phases, above 100 dB and a narrow transition band
+    };
+
+    /**
+     * @brief Adapter rendering a wrapped audio source at its own sampling rate, converted to the output rate
+     *
+     * Sample rate conversion by any ratio of two integer rates, with a polyphase bank of Kaiser-windowed sinc
+     * filters computed at construction. Each output frame is the interpolation between the two filter phases
+     * nearest to its position between input frames; the dot products between filters and input run in the vectorized
+     * kernels of SimdKernels.h. The position advances by exact integer arithmetic, without drift. When downsampling,
+     * the cutoff follows the output rate, such that the filters also act as anti-aliasing filters.
+     * <br />
+     * The wrapped source is called with blocks of the block size given at construction, as far ahead as the filters
+     * need; events relayed by onAudioEvent apply at the next of these blocks. The delay of the filters is compensated
+     * for: output frame 0 corresponds to input frame 0. If both rates are equal, the wrapped source renders directly
+     * into the output. No memory is allocated after construction. Renders planar or, for players with interleaved
+     * buffers, interleaved frames natively.
+     */
+    class ResamplingAudioSource : public AudioSource {
+    public:
+        /**
+         * Constructor
+         * @param source Wrapped audio source, owned by the caller
+         * @param sourceRate Sampling rate at which the wrapped source renders, in samples per second
+         * @param outputRate Sampling rate of the output, in samples per second
+         * @param channelCount Number of channels; rendering must be requested with this channel count
+         * @param quality Quality preset
+         * @param sourceBlockFrames Number of frames per call to the wrapped source
+         */
+        ResamplingAudioSource(AudioSource* source, int sourceRate, int outputRate, int32_t channelCount,
+                              ResamplerQuality quality = ResamplerQuality::High,
+                              int32_t sourceBlockFrames = defaultAudioFrameSize);
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Both layouts are rendered directly; Interleaved such that players do not interleave
+         */
+        SampleLayout getNativeLayout() const override;
+
+        void renderInterleaved(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Relay to the wrapped source, and clear the input kept for the filters
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Idle once the wrapped source is idle and the input kept for the filters is silent
+         */
+        bool isIdle() const override;
+
+        /**
+         * Relay to the wrapped source, see AudioSource::onAudioEvent; applies at the next block of the wrapped source
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Tail of the wrapped source, converted to output frames, plus the length of the filters
+         */
+        int32_t getTailFrames() const override;
+
+        /**
+         * Number of taps of the filters of the quality preset
+         * @return Number of taps
+         */
+        int32_t getFilterTaps() const;
+
+    protected:
+        /**
+         * Render output frames, with the given distance between the samples of a channel and between frames
+         */
+        void render(float* audioData, int32_t framesCount, int32_t channelStride, int32_t frameStride);
+
+        /**
+         * Drop the input frames no longer needed and append a block of the wrapped source
+         */
+        void refill();
+
+        /**
+         * Compute the filter bank
+         */
+        void designFilters(float cutoff, double kaiserBeta);
+
+        AudioSource* _source; // wrapped audio source
+        int _sourceRate; // sampling rate of the wrapped source
+        int _outputRate; // sampling rate of the output
+        int32_t _channelCount; // number of channels
+        int32_t _sourceBlockFrames; // frames per call to the wrapped source
+        int32_t _taps; // filter length
+        int32_t _phases; // number of filter phases per input frame
+        int32_t _tapStride; // distance between two phases in _filters, a multiple of 16
+        AlignedBuffer<float> _filters; // (_phases + 1) filters of _taps coefficients, the last one for interpolation
+        int32_t _historyStride; // distance between two channels in _history
+        AlignedBuffer<float> _history; // input kept for the filters, float[channelCount][historyStride]
+        AlignedBuffer<float> _sourceBlock; // block of the wrapped source, float[channelCount][sourceBlockFrames]
+        int32_t _available = 0; // number of frames in _history
+        int32_t _index = 0; // first frame of _history under the filter for the next output frame
+        int64_t _remainder = 0; // fractional position of the next output frame, in units of 1/_denominator
+        int32_t _step; // integer part of the input frames per output frame
+        int64_t _stepRemainder; // fractional part of the input frames per output frame, in units of 1/_denominator
+        int64_t _denominator; // output rate divided by the greatest common divisor of both rates
+        int64_t _silentFrames = 0; // number of silent frames at the end of _history
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,121 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Conversion of the float samples rendered by the audio sources to the sample formats of audio devices and files,
+ * for the players and sinks that do not hand floats to their destination.
+ */
+
+#ifndef SampleFormatConverter_H
+#define SampleFormatConverter_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+#include "AudioDefinitions.h"
+#include "SimdKernels.h"
+
+namespace synthesizerBase {
+
+    /**
+     * Noise added before rounding float samples to integers
+     */
+    enum class DitherMode : int32_t {
+        None = 0, // rounding to nearest; the rounding error follows the signal and is heard as distortion at low levels
+        Triangular, // TPDF dither of +-1 least significant bit: white noise, independent of the signal
+        NoiseShaped, // TPDF dither with second order error feedback, moving the noise towards high frequencies
+    };
+
+    /**
+     * @brief Converter of interleaved float frames to a given sample format, with optional dither
+     *
+     * The conversion uses the vectorized kernels of SimdKernels.h (clamp to full scale, round to nearest). Dither is
+     * generated per chunk, also by a kernel, into a preallocated buffer handed to the conversion; with noise
+     * shaping, the error feedback of each channel is computed sample by sample into that buffer, the conversion
+     * itself remaining vectorized. convert neither allocates nor locks, so it can run on the audio thread. The
+     * state (random generators, shaping errors) carries over from one call to the next, so one converter serves
+     * one stream.
+     */
+    class SampleFormatConverter {
+    public:
+        /**
+         * Size of one sample of a format
+         * @param format Sample format
+         * @return Number of bytes
+         */
+        static int32_t bytesPerSample(SampleFormat format);
+
+        /**
+         * Constructor
+         * @param format Output sample format; Float copies the samples as they are
+         * @param channelCount Number of interleaved channels
+         * @param dither Dither applied to the integer formats
+         * @param chunkFrames Number of frames for which dither is generated at once
+         */
+        SampleFormatConverter(SampleFormat format, int32_t channelCount, DitherMode dither = DitherMode::None,
+                              int32_t chunkFrames = defaultAudioFrameSize);
+
+        /**
+         * @brief Convert interleaved frames
+         * @param destination Output, framesCount*channelCount samples of the output format
+         * @param source Input, framesCount*channelCount floats, interleaved
+         * @param framesCount Number of frames; any number, converted in chunks
+         */
+        void convert(void* destination, const float* source, int32_t framesCount);
+
+        /**
+         * Clear the noise shaping state, e.g. at the start of a new stream
+         */
+        void reset();
+
+        /**
+         * Output sample format
+         * @return Sample format
+         */
+        SampleFormat getFormat() const;
+
+        /**
+         * Dither mode
+         * @return Dither mode
+         */
+        DitherMode getDitherMode() const;
+
+        /**
+         * Number of interleaved channels
+         * @return Number of channels
+         */
+        int32_t getChannelCount() const;
+
+    protected:
+        /**
+         * Fill the dither buffer for the given number of frames, with or without noise shaping
+         */
+        void generateDither(const float* source, int32_t framesCount);
+
+        SampleFormat _format; // output sample format
+        int32_t _channelCount; // number of interleaved channels
+        DitherMode _dither; // dither mode, None for Float
+        int32_t _chunkFrames; // frames per dither chunk
+        AlignedBuffer<float> _ditherValues; // dither of one chunk, in least significant bits, interleaved
+        AlignedBuffer<float> _errors; // last two shaping errors of each channel: [channel*2], [channel*2 + 1]
+        uint32_t _randomStates[simd::ditherGenerators]; // states of the dither generators, never 0
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,253 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+/* Vectorized inner loops shared by the audio sources of the library.
+ *
+ * Each kernel exists in a scalar version and in versions for SSE2 and AVX2 (x86) or NEON (ARM). The best version
+ * supported by the CPU is selected at runtime, the first time a kernel is called; there is no need to build the
+ * library for a specific instruction set. None of the kernels allocate; pointers need not be aligned.
+ */
+
+#ifndef SimdKernels_H
+#define SimdKernels_H
+
+#include <stdint.h>
+
+namespace synthesizerBase {
+namespace simd {
+
+    /**
+     * Instruction sets for which kernels exist
+     */
+    enum class InstructionSet {
+        Scalar,
+        Sse2,
+        Avx2, // AVX2 with FMA
+        Neon,
+    };
+
+    /**
+     * Instruction set of the kernels in use
+     * @return Instruction set
+     */
+    InstructionSet activeInstructionSet();
+
+    /**
+     * Human readable name of an instruction set
+     * @param instructionSet Instruction set
+     * @return Name, e.g. "avx2"
+     */
+    const char* instructionSetName(InstructionSet instructionSet);
+
+    /**
+     * @brief Select the kernels of a given instruction set, e.g. for comparing them in benchmarks
+     *
+     * Not meant to be called while audio is being rendered.
+     * @param instructionSet Instruction set
+     * @return true if the instruction set is supported and now in use, false otherwise (selection unchanged)
+     */
+    bool selectInstructionSet(InstructionSet instructionSet);
+
+    /**
+     * destination[i] += gain * source[i]
+     * @param destination Accumulation buffer
+     * @param source Input samples
+     * @param gain Gain applied to the input
+     * @param count Number of samples
+     */
+    void mixAccumulate(float* destination, const float* source, float gain, int32_t count);
+
+    /**
+     * destination[i] += (startGain + i * gainStep) * source[i], for gain changes without zipper noise
+     * @param destination Accumulation buffer
+     * @param source Input samples
+     * @param startGain Gain applied to the first sample
+     * @param gainStep Gain increment per sample
+     * @param count Number of samples
+     */
+    void mixAccumulateRamp(float* destination, const float* source, float startGain, float gainStep, int32_t count);
+
+    /**
+     * destination[i] = start + i * step
+     * @param destination Output samples
+     * @param start First value
+     * @param step Increment per sample
+     * @param count Number of samples
+     */
+    void linearRamp(float* destination, float start, float step, int32_t count);
+
+    /**
+     * destination[i] = offset + scale * factor^i, for exponential and one-pole (exponential approach) ramps
+     * @param destination Output samples
+     * @param offset Value approached by the ramp if factor < 1
+     * @param scale Difference between the first value and offset
+     * @param factor Ratio between successive differences to offset
+     * @param count Number of samples
+     */
+    void exponentialRamp(float* destination, float offset, float scale, float factor, int32_t count);
+
+    /**
+     * destination[i] *= gains[i]
+     * @param destination Samples, modified in place
+     * @param gains Gain of each sample
+     * @param count Number of samples
+     */
+    void multiply(float* destination, const float* gains, int32_t count);
+
+    /**
+     * destination[i] *= gain
+     * @param destination Samples, modified in place
+     * @param gain Gain
+     * @param count Number of samples
+     */
+    void scale(float* destination, float gain, int32_t count);
+
+    /**
+     * interleaved[f*channelCount + c] = planar[c*planarStride + f]; vectorized for stereo
+     * @param interleaved Output frames, framesCount*channelCount floats
+     * @param planar Input channel blocks
+     * @param planarStride Distance between the starts of two channel blocks, in floats
+     * @param framesCount Number of frames
+     * @param channelCount Number of channels
+     */
+    void interleave(float* interleaved, const float* planar, int32_t planarStride, int32_t framesCount,
+                    int32_t channelCount);
+
+    /**
+     * planar[c*planarStride + f] = interleaved[f*channelCount + c]; vectorized for stereo
+     * @param planar Output channel blocks
+     * @param planarStride Distance between the starts of two channel blocks, in floats
+     * @param interleaved Input frames, framesCount*channelCount floats
+     * @param framesCount Number of frames
+     * @param channelCount Number of channels
+     */
+    void deinterleave(float* planar, int32_t planarStride, const float* interleaved, int32_t framesCount,
+                      int32_t channelCount);
+
+    /**
+     * @brief Convert float samples to 16-bit integers: scale by 32768, add the dither, clamp and round to nearest
+     * @param destination Output samples
+     * @param source Input samples, nominally in [-1, 1]
+     * @param dither Value added to each scaled sample, in least significant bits, or nullptr for none
+     * @param count Number of samples
+     */
+    void floatToInt16(int16_t* destination, const float* source, const float* dither, int32_t count);
+
+    /**
+     * @brief Convert float samples to packed 24-bit integers (3 bytes little endian), as floatToInt16
+     * @param destination Output bytes, 3*count
+     * @param source Input samples, nominally in [-1, 1]
+     * @param dither Value added to each scaled sample, in least significant bits, or nullptr for none
+     * @param count Number of samples
+     */
+    void floatToInt24(uint8_t* destination, const float* source, const float* dither, int32_t count);
+
+    /**
+     * @brief Convert float samples to 32-bit integers, as floatToInt16; the largest value is that of the largest
+     * float below 2^31
+     * @param destination Output samples
+     * @param source Input samples, nominally in [-1, 1]
+     * @param dither Value added to each scaled sample, in least significant bits, or nullptr for none
+     * @param count Number of samples
+     */
+    void floatToInt32(int32_t* destination, const float* source, const float* dither, int32_t count);
+
+    /**
+     * Sum of a[i] * b[i], e.g. one output sample of a FIR filter; the order of the additions depends on the
+     * instruction set
+     * @param a First vector
+     * @param b Second vector
+     * @param count Number of elements
+     * @return Dot product
+     */
+    float dotProduct(const float* a, const float* b, int32_t count);
+
+    /**
+     * Sum of input[i] * (below[i] + weight * (above[i] - below[i])): a FIR filter interpolated between two filters,
+     * e.g. two phases of a polyphase filter bank, in one pass over the input
+     * @param input Input samples
+     * @param below First filter
+     * @param above Second filter
+     * @param weight Weight of the second filter, in [0, 1]
+     * @param count Number of taps
+     * @return Filter output
+     */
+    float interpolatedDotProduct(const float* input, const float* below, const float* above, float weight,
+                                 int32_t count);
+
+    /**
+     * accumulator[i] += a[i] * b[i] for complex numbers in split layout (real and imaginary parts in separate arrays),
+     * e.g. the product of a spectrum with a filter response summed over the partitions of a convolution
+     * @param accumulatorReal Real parts of the accumulator
+     * @param accumulatorImaginary Imaginary parts of the accumulator
+     * @param aReal Real parts of the first factor
+     * @param aImaginary Imaginary parts of the first factor
+     * @param bReal Real parts of the second factor
+     * @param bImaginary Imaginary parts of the second factor
+     * @param count Number of complex numbers
+     */
+    void complexMultiplyAccumulate(float* accumulatorReal, float* accumulatorImaginary, const float* aReal,
+                                   const float* aImaginary, const float* bReal, const float* bImaginary,
+                                   int32_t count);
+
+    /**
+     * Number of random generators used by triangularDither
+     */
+    constexpr int32_t ditherGenerators = 8;
+
+    /**
+     * @brief Triangular (TPDF) random values over (-1, 1), for dithering the integer conversions
+     *
+     * destination[i] is the difference of the two 16-bit halves of the next value of the xorshift32 generator
+     * states[i % 8]; the result is the same with all instruction sets.
+     * @param destination Output values
+     * @param states States of the ditherGenerators generators, non-zero; updated
+     * @param count Number of values
+     */
+    void triangularDither(float* destination, uint32_t* states, int32_t count);
+
+    /**
+     * Number of oscillators processed together by wavetableVoices
+     */
+    constexpr int32_t wavetableVoiceGroup = 8;
+
+    /**
+     * @brief Render groups of wavetable oscillators with linear interpolation, into one accumulator lane per voice
+     *
+     * For voice v and frame f: accumulator[f*8 + v%8] += amplitudes[v] * table(tableOffsets[v] + phases[v]),
+     * then phases[v] += increments[v], wrapped to [0, tableLength). The AVX2 version reads the tables of
+     * 8 voices with one gather instruction.
+     * @param tables Table array; each table has tableLength+1 samples, the last one repeating the first
+     * @param phases Phase of each voice, in samples, in [0, tableLength); updated
+     * @param increments Phase increment of each voice, in samples per frame, in [0, tableLength)
+     * @param amplitudes Amplitude of each voice
+     * @param tableOffsets Start of the table of each voice in the table array
+     * @param voiceCount Number of voices, a multiple of wavetableVoiceGroup
+     * @param tableLength Samples per cycle
+     * @param accumulator Accumulation buffer of framesCount*wavetableVoiceGroup floats
+     * @param framesCount Number of frames
+     */
+    void wavetableVoices(const float* tables, float* phases, const float* increments, const float* amplitudes,
+                         const int32_t* tableOffsets, int32_t voiceCount, float tableLength, float* accumulator,
+                         int32_t framesCount);
+
+}  // namespace simd
+}  // namespace synthesizerBase
+
+#endif
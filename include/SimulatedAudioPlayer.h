@@ -0,0 +1,222 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef SimulatedAudioPlayer_H
+#define SimulatedAudioPlayer_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "AudioPlayer.h"
+#include "AudioSink.h"
+#include "AudioSource.h"
+#include "AudioDefinitions.h"
+
+
+namespace synthesizerBase {
+    /**
+     * @brief Audio player simulating a real-time audio driver, without an audio device
+     *
+     * The SimulatedAudioPlayer runs its own callback thread that invokes onAudioReady on the AudioSource
+     * on a clock, the way an audio driver such as oboe does. The audio clock advances by framesCount/samplingRate
+     * for every callback (optionally scaled, see setPeriodScale); the data for a callback has to be delivered
+     * before the audio clock reaches the end of that block, otherwise the callback counts as a missed deadline.
+     * After a missed deadline, the schedule restarts from the time the late callback completed, as a device does
+     * after an underrun.
+     * <br />
+     * To reproduce what real devices do to audio sources, the block size can vary between callbacks
+     * (fixed, random, adversarial single-frame blocks, or a programmed sequence), and the wake-up of the callback
+     * thread can be delayed by a random scheduling jitter.
+     * <br />
+     * The configuration functions have to be called while not playing.
+     */
+    class SimulatedAudioPlayer : public AudioPlayer {
+    public:
+        /**
+         * How the number of frames requested per callback is chosen
+         */
+        enum class BlockSizeMode {
+            Fixed, // always framesPerDataCallback
+            Random, // uniformly distributed in the range set by setBlockSizeRange
+            SingleFrame, // adversarial: one frame per callback
+            Sequence, // cycling through the sequence set by setBlockSizeSequence
+        };
+
+        /**
+         * Constructor
+         * @param source The audio source
+         * @param samplingRate The sampling rate, in samples per second
+         * @param channelCount Number of channels requested from the audio source
+         * @param framesPerDataCallback Nominal number of frames per callback, used in BlockSizeMode::Fixed
+         */
+        SimulatedAudioPlayer(AudioSource* source, int samplingRate,
+                             int32_t channelCount = defaultAudioChannelNumber,
+                             int32_t framesPerDataCallback = defaultAudioFrameSize);
+
+        /**
+         * Destructor, stops the callback thread
+         */
+        ~SimulatedAudioPlayer() override;
+
+        /**
+         * Set how the block size is chosen for each callback
+         * @param mode Block size mode
+         */
+        void setBlockSizeMode(BlockSizeMode mode);
+
+        /**
+         * Set the range for BlockSizeMode::Random
+         * @param minFrames Smallest block size, at least 1
+         * @param maxFrames Largest block size
+         */
+        void setBlockSizeRange(int32_t minFrames, int32_t maxFrames);
+
+        /**
+         * Set the block sizes for BlockSizeMode::Sequence, repeated cyclically
+         * @param framesCounts Block sizes, each at least 1
+         * @param count Number of entries in framesCounts
+         */
+        void setBlockSizeSequence(const int32_t* framesCounts, int32_t count);
+
+        /**
+         * Set the scheduling jitter. The wake-up of each callback is delayed by a uniformly distributed
+         * random time between 0 and maxJitterMicroseconds.
+         * @param maxJitterMicroseconds Maximum delay, in microseconds. 0 disables jitter.
+         */
+        void setJitter(int32_t maxJitterMicroseconds);
+
+        /**
+         * Scale the callback period relative to real time. With 1.0 (the default), callbacks arrive at the
+         * pace at which a device consumes the audio; with 0.5, they arrive twice as fast, which leaves half the
+         * time budget per callback and serves to measure the headroom of an audio source.
+         * @param scale Ratio of the simulated callback period to the real-time period, larger than 0
+         */
+        void setPeriodScale(double scale);
+
+        /**
+         * Seed for the random block sizes and jitter, for reproducible runs
+         * @param seed Random seed
+         */
+        void setRandomSeed(uint32_t seed);
+
+        /**
+         * Optionally forward the rendered data to a sink. The sink is invoked on the callback thread after the
+         * deadline check, so its cost does not count against the audio source.
+         * @param sink Audio sink, owned by the caller, or nullptr
+         */
+        void setSink(AudioSink* sink);
+
+        /**
+         * @brief Start the callback thread
+         * @return 0 for success, error code otherwise
+         */
+        int32_t play() override;
+
+        /**
+         * @brief Stop the callback thread
+         *
+         * Waits for the callback thread to finish, unless called from within the callback, in which case the
+         * thread ends after the current callback.
+         */
+        void stop() override;
+
+        int32_t getChannelCount() override;
+
+        int32_t getFramesPerDataCallback() override;
+
+        /**
+         * Number of callbacks since the start of playing or the last resetStatistics
+         * @return Number of callbacks
+         */
+        int64_t getCallbackCount() const;
+
+        /**
+         * Number of callbacks that completed after their deadline
+         * @return Number of missed deadlines
+         */
+        int64_t getMissedDeadlineCount() const;
+
+        /**
+         * Smallest time left between the completion of a callback and its deadline. Negative if a deadline
+         * was missed.
+         * @return Minimum headroom, in nanoseconds
+         */
+        int64_t getMinimumHeadroomNanos() const;
+
+        /**
+         * Longest time spent in the onAudioReady function of the audio source
+         * @return Maximum callback duration, in nanoseconds
+         */
+        int64_t getMaximumCallbackNanos() const;
+
+        /**
+         * Reset the callback statistics. Can be called while playing.
+         */
+        void resetStatistics();
+
+    protected:
+        /**
+         * Main function of the callback thread
+         */
+        void runCallbackThread();
+
+        /**
+         * Block size for the next callback, following the block size mode
+         * @return Number of frames
+         */
+        int32_t nextBlockSize();
+
+        /**
+         * Largest block size that can be requested in the current configuration
+         * @return Number of frames
+         */
+        int32_t maximumBlockSize() const;
+
+        /**
+         * Next value of the random number generator (xorshift32)
+         * @return Pseudo-random number
+         */
+        uint32_t nextRandom();
+
+        AudioSink* _sink = nullptr; // optional destination of the rendered data
+        int _samplingRate; // the audio sampling rate, in samples / second
+        int32_t _channelCount; // number of channels requested from the source
+        int32_t _framesPerDataCallback; // nominal block size
+        BlockSizeMode _blockSizeMode = BlockSizeMode::Fixed; // how block sizes are chosen
+        int32_t _minBlockSize = 1; // range for BlockSizeMode::Random
+        int32_t _maxBlockSize = defaultAudioFrameSize;
+        std::vector<int32_t> _blockSizeSequence; // block sizes for BlockSizeMode::Sequence
+        size_t _sequencePosition = 0; // position in _blockSizeSequence
+        int32_t _maxJitterMicroseconds = 0; // maximum random wake-up delay
+        double _periodScale = 1.0; // simulated period relative to real time
+        uint32_t _randomState = 0x9E3779B9u; // xorshift32 state, never 0
+
+        std::vector<float> _buffer; // block buffer handed to the audio source
+        std::thread _thread; // callback thread
+        std::atomic<bool> _running{false}; // cleared to end the callback thread
+
+        std::atomic<int64_t> _callbackCount{0};
+        std::atomic<int64_t> _missedDeadlineCount{0};
+        std::atomic<int64_t> _minimumHeadroomNanos{INT64_MAX};
+        std::atomic<int64_t> _maximumCallbackNanos{0};
+    };
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,151 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef SpscRingBuffer_H
+#define SpscRingBuffer_H
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Lock-free ring buffer for one producer thread and one consumer thread
+     *
+     * The storage is allocated once in the constructor; push, pop, write and read neither allocate
+     * nor block, such that either side can be the audio thread. The capacity is rounded up to a power of two.
+     * @tparam T Element type, copied by assignment
+     */
+    template<typename T>
+    class SpscRingBuffer {
+    public:
+        /**
+         * Constructor
+         * @param capacity Minimum number of elements the buffer can hold
+         */
+        explicit SpscRingBuffer(int32_t capacity) {
+            uint32_t size = 1;
+            while (size < static_cast<uint32_t>(capacity)) {
+                size <<= 1;
+            }
+            _data.resize(size);
+            _mask = size - 1;
+        }
+
+        /**
+         * Add an element (producer side)
+         * @param value Element to add
+         * @return true on success, false if the buffer is full
+         */
+        bool push(const T& value) {
+            const uint32_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+            if (writeIndex - _readIndex.load(std::memory_order_acquire) > _mask) {
+                return false;
+            }
+            _data[writeIndex & _mask] = value;
+            _writeIndex.store(writeIndex + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Remove the oldest element (consumer side)
+         * @param value Receives the element
+         * @return true on success, false if the buffer is empty
+         */
+        bool pop(T& value) {
+            const uint32_t readIndex = _readIndex.load(std::memory_order_relaxed);
+            if (readIndex == _writeIndex.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = _data[readIndex & _mask];
+            _readIndex.store(readIndex + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Add as many elements as fit (producer side)
+         * @param values Elements to add
+         * @param count Number of elements in values
+         * @return Number of elements added
+         */
+        int32_t write(const T* values, int32_t count) {
+            const uint32_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+            const uint32_t space = _mask + 1 - (writeIndex - _readIndex.load(std::memory_order_acquire));
+            const uint32_t n = static_cast<uint32_t>(count) < space ? static_cast<uint32_t>(count) : space;
+            for (uint32_t i = 0; i < n; i++) {
+                _data[(writeIndex + i) & _mask] = values[i];
+            }
+            _writeIndex.store(writeIndex + n, std::memory_order_release);
+            return static_cast<int32_t>(n);
+        }
+
+        /**
+         * Remove up to count of the oldest elements (consumer side)
+         * @param values Receives the elements
+         * @param count Maximum number of elements to remove
+         * @return Number of elements removed
+         */
+        int32_t read(T* values, int32_t count) {
+            const uint32_t readIndex = _readIndex.load(std::memory_order_relaxed);
+            const uint32_t available = _writeIndex.load(std::memory_order_acquire) - readIndex;
+            const uint32_t n = static_cast<uint32_t>(count) < available ? static_cast<uint32_t>(count) : available;
+            for (uint32_t i = 0; i < n; i++) {
+                values[i] = _data[(readIndex + i) & _mask];
+            }
+            _readIndex.store(readIndex + n, std::memory_order_release);
+            return static_cast<int32_t>(n);
+        }
+
+        /**
+         * Number of elements that can currently be read. Exact on the consumer side, a lower bound elsewhere.
+         * @return Number of elements
+         */
+        int32_t availableToRead() const {
+            return static_cast<int32_t>(_writeIndex.load(std::memory_order_acquire) -
+                                        _readIndex.load(std::memory_order_acquire));
+        }
+
+        /**
+         * Number of elements that can currently be written. Exact on the producer side, a lower bound elsewhere.
+         * @return Number of elements
+         */
+        int32_t availableToWrite() const {
+            return capacity() - availableToRead();
+        }
+
+        /**
+         * Number of elements the buffer can hold
+         * @return Capacity
+         */
+        int32_t capacity() const {
+            return static_cast<int32_t>(_mask + 1);
+        }
+
+    protected:
+        std::vector<T> _data; // element storage, size is a power of two
+        uint32_t _mask; // size of _data minus 1
+        alignas(64) std::atomic<uint32_t> _writeIndex{0}; // advanced by the producer
+        alignas(64) std::atomic<uint32_t> _readIndex{0}; // advanced by the consumer
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,503 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+/* Audio sources composed at compile time. A StaticChain joins a generator and processors (stages) into one type;
+ * StaticChainAudioSource exposes the chain as an ordinary AudioSource. The stages are called without virtual
+ * functions, one frame after the other, so that the compiler can inline the whole chain into a single loop over
+ * the block instead of one call and one pass over the buffer per stage. Channel count and block size are template
+ * parameters. Example:
+ *
+ *     using Voice = StaticChain<StaticSineOscillator<2>, StaticGain<2>, StaticOnePoleLowpass<2>>;
+ *     StaticChainAudioSource<Voice> source(StaticSineOscillator<2>(48000, 440.0f), StaticGain<2>(0, 0.5f),
+ *                                          StaticOnePoleLowpass<2>(48000, 2000.0f, 1));
+ */
+
+#ifndef StaticChain_H
+#define StaticChain_H
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <tuple>
+#include <utility>
+#include "AudioSource.h"
+#include "SimdKernels.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Base class of the stages of a StaticChain, for the curiously recurring template pattern
+     *
+     * A stage handles one frame of Channels samples at a time in processFrame(float* frame), which derived classes
+     * implement: generators overwrite the frame, processors modify it in place. The other member functions are
+     * optional; derived classes hide the defaults given here to change them. All are called on the audio thread.
+     * @tparam Derived Stage class deriving from this class
+     * @tparam Channels Number of samples of a frame
+     */
+    template<class Derived, int32_t Channels>
+    class StaticStage {
+    public:
+        static_assert(Channels > 0, "A stage needs at least one channel");
+
+        static constexpr int32_t channelCount = Channels; // samples per frame
+
+        /**
+         * Called before each part of a block, e.g. to update smoothed parameters
+         * @param framesCount Number of frames of the part, at most the block size of the StaticChainAudioSource
+         */
+        void beginBlock(int32_t framesCount) {}
+
+        /**
+         * Apply a timestamped event, as AudioSource::onAudioEvent; the default ignores all events
+         * @param event Event
+         */
+        void onAudioEvent(const AudioEvent& event) {}
+
+        /**
+         * Playback has stopped, e.g. to clear filter states
+         */
+        void onPlaybackStopped() {}
+
+        /**
+         * Whether a generator renders silence until an event wakes it up, as AudioSource::isIdle
+         * @return true if idle; false by default
+         */
+        bool isIdle() const { return false; }
+
+        /**
+         * Number of frames a processor keeps sounding once its input fell silent, as AudioSource::getTailFrames
+         * @return Tail length, in frames; 0 by default
+         */
+        int32_t getTailFrames() const { return 0; }
+
+        /**
+         * Process interleaved frames one after the other
+         * @param frames Buffer of framesCount*Channels floats, float[framesCount][Channels]
+         * @param framesCount Number of frames
+         */
+        void processFrames(float* frames, int32_t framesCount) {
+            for (int32_t frame = 0; frame < framesCount; frame++) {
+                static_cast<Derived*>(this)->processFrame(frames + frame * Channels);
+            }
+        }
+    };
+
+    /**
+     * @brief Stages applied one after the other to each frame
+     *
+     * The first stage is usually a generator, the others are processors. A chain is a stage itself, so that chains
+     * can be nested.
+     * @tparam First First stage
+     * @tparam Rest Following stages, with the same channel count
+     */
+    template<class First, class... Rest>
+    class StaticChain : public StaticStage<StaticChain<First, Rest...>, First::channelCount> {
+    public:
+        static_assert(((Rest::channelCount == First::channelCount) && ...),
+                      "All stages of a chain need the same channel count");
+
+        StaticChain() = default;
+
+        /**
+         * Constructor
+         * @param first First stage
+         * @param rest Following stages
+         */
+        explicit StaticChain(First first, Rest... rest) : _stages(std::move(first), std::move(rest)...) {
+        }
+
+        /**
+         * Access a stage, e.g. to set parameters while not playing
+         * @tparam Index Position of the stage in the chain
+         * @return Stage
+         */
+        template<size_t Index>
+        auto& stage() {
+            return std::get<Index>(_stages);
+        }
+
+        void processFrame(float* frame) {
+            std::apply([frame](auto&... stages) { (stages.processFrame(frame), ...); }, _stages);
+        }
+
+        void beginBlock(int32_t framesCount) {
+            std::apply([framesCount](auto&... stages) { (stages.beginBlock(framesCount), ...); }, _stages);
+        }
+
+        /**
+         * Hand an event to every stage, in chain order; each stage picks the events addressed to it
+         * @param event Event
+         */
+        void onAudioEvent(const AudioEvent& event) {
+            std::apply([&event](auto&... stages) { (stages.onAudioEvent(event), ...); }, _stages);
+        }
+
+        void onPlaybackStopped() {
+            std::apply([](auto&... stages) { (stages.onPlaybackStopped(), ...); }, _stages);
+        }
+
+        /**
+         * Whether the first stage is idle; the following stages may still have a tail, see getTailFrames
+         * @return true if the first stage is idle
+         */
+        bool isIdle() const {
+            return std::get<0>(_stages).isIdle();
+        }
+
+        /**
+         * Sum of the tails of the stages
+         * @return Tail length, in frames
+         */
+        int32_t getTailFrames() const {
+            return std::apply([](const auto&... stages) { return (stages.getTailFrames() + ...); }, _stages);
+        }
+
+    protected:
+        std::tuple<First, Rest...> _stages; // stored by value, such that all calls can be inlined
+    };
+
+    /**
+     * @brief AudioSource rendering a StaticChain
+     *
+     * The only virtual calls are those of the AudioSource interface at the edge. Blocks are rendered in parts of
+     * at most BlockFrames frames, with StaticStage::beginBlock before each part; whole parts have a trip count known
+     * at compile time. The native layout is interleaved, as the stages work on frames: renderInterleaved processes
+     * the driver buffer in place, onAudioReady deinterleaves each part from a scratch buffer. The source renders
+     * silence if the channel count does not match the one of the chain, and stops processing once the first stage
+     * is idle and the tails of the others have passed.
+     * @tparam Chain StaticChain or other stage
+     * @tparam BlockFrames Frames per part, e.g. the control rate of smoothed parameters
+     */
+    template<class Chain, int32_t BlockFrames = 64>
+    class StaticChainAudioSource final : public AudioSource {
+    public:
+        static_assert(BlockFrames > 0, "The block size must be positive");
+
+        static constexpr int32_t channels = Chain::channelCount; // channel count of the chain
+
+        /**
+         * Constructor
+         * @param arguments Arguments of the constructor of the chain, e.g. its stages
+         */
+        template<class... Arguments>
+        explicit StaticChainAudioSource(Arguments&&... arguments) : _chain(std::forward<Arguments>(arguments)...) {
+        }
+
+        /**
+         * Access the chain, e.g. to set parameters while not playing
+         * @return Chain
+         */
+        Chain& getChain() {
+            return _chain;
+        }
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            if (!beginRendering(audioData, framesCount, channelCount)) {
+                return;
+            }
+            if (channels == 1) {
+                // Planar and interleaved are the same
+                render(audioData, framesCount);
+                return;
+            }
+            for (int32_t offset = 0; offset < framesCount; offset += BlockFrames) {
+                const int32_t frames = std::min(BlockFrames, framesCount - offset);
+                renderPart(_block, frames);
+                simd::deinterleave(audioData + offset, framesCount, _block, frames, channels);
+            }
+        }
+
+        SampleLayout getNativeLayout() const override {
+            return SampleLayout::Interleaved;
+        }
+
+        void renderInterleaved(float* audioData, int32_t framesCount, ChannelCount channelCount) override {
+            if (beginRendering(audioData, framesCount, channelCount)) {
+                render(audioData, framesCount);
+            }
+        }
+
+        void onPlaybackStopped() override {
+            _chain.onPlaybackStopped();
+        }
+
+        void onAudioEvent(const AudioEvent& event) override {
+            _chain.onAudioEvent(event);
+            if (!_chain.isIdle()) {
+                _silentFrames = 0;
+            }
+        }
+
+        bool isIdle() const override {
+            return _chain.isIdle() && _silentFrames >= _chain.getTailFrames();
+        }
+
+        BlockState getBlockState() const override {
+            return _blockState;
+        }
+
+        int32_t getTailFrames() const override {
+            return _chain.getTailFrames();
+        }
+
+    protected:
+        /**
+         * Fill silence instead of rendering if the channel count does not match or the chain is idle
+         * @return true if the block is to be rendered
+         */
+        bool beginRendering(float* audioData, int32_t framesCount, ChannelCount channelCount) {
+            if (static_cast<int32_t>(channelCount) == channels && !isIdle()) {
+                _blockState = BlockState::Active;
+                return true;
+            }
+            memset(audioData, 0, sizeof(float) * framesCount * static_cast<int32_t>(channelCount));
+            _blockState = BlockState::Silent;
+            return false;
+        }
+
+        /**
+         * Render interleaved frames in parts of at most BlockFrames frames
+         */
+        void render(float* frames, int32_t framesCount) {
+            for (int32_t offset = 0; offset < framesCount; offset += BlockFrames) {
+                renderPart(frames + offset * channels, std::min(BlockFrames, framesCount - offset));
+            }
+        }
+
+        void renderPart(float* frames, int32_t framesCount) {
+            _chain.beginBlock(framesCount);
+            if (framesCount == BlockFrames) {
+                _chain.processFrames(frames, BlockFrames);
+            } else {
+                _chain.processFrames(frames, framesCount);
+            }
+            if (_chain.isIdle()) {
+                _silentFrames = std::min(_silentFrames + framesCount, INT32_MAX - BlockFrames);
+            } else {
+                _silentFrames = 0;
+            }
+        }
+
+        Chain _chain; // the stages
+        alignas(64) float _block[BlockFrames * channels] = {}; // interleaved part, for planar rendering
+        int32_t _silentFrames = 0; // frames rendered since the first stage became idle
+        BlockState _blockState = BlockState::Active; // content of the last block
+    };
+
+    /**
+     * @brief Sine generator, identical in all channels
+     *
+     * Rotates a phasor by a fixed angle per frame, renormalized at each part of a block. Listens to
+     * AudioEventFrequency and AudioEventAmplitude events with its index.
+     * @tparam Channels Number of channels
+     */
+    template<int32_t Channels>
+    class StaticSineOscillator : public StaticStage<StaticSineOscillator<Channels>, Channels> {
+    public:
+        /**
+         * Constructor
+         * @param samplingRate Sampling rate, in samples per second
+         * @param frequency Frequency, in Hz
+         * @param amplitude Linear amplitude; 0 makes the oscillator idle
+         * @param index Index matched by the events
+         */
+        StaticSineOscillator(int samplingRate, float frequency, float amplitude = 1.0f, int32_t index = 0)
+                : _samplingRate(samplingRate), _amplitude(amplitude), _index(index) {
+            setFrequency(frequency);
+        }
+
+        /**
+         * Set the frequency
+         * @param frequency Frequency, in Hz
+         */
+        void setFrequency(float frequency) {
+            const double angle = 2.0 * M_PI * frequency / _samplingRate;
+            _rotationCosine = static_cast<float>(cos(angle));
+            _rotationSine = static_cast<float>(sin(angle));
+        }
+
+        /**
+         * Set the amplitude
+         * @param amplitude Linear amplitude; 0 makes the oscillator idle
+         */
+        void setAmplitude(float amplitude) {
+            _amplitude = amplitude;
+        }
+
+        void beginBlock(int32_t framesCount) {
+            // Keep the phasor on the unit circle despite rounding
+            const float norm = 1.0f / sqrtf(_cosine * _cosine + _sine * _sine);
+            _cosine *= norm;
+            _sine *= norm;
+        }
+
+        void onAudioEvent(const AudioEvent& event) {
+            if (event.index != _index) {
+                return;
+            }
+            if (event.type == AudioEventFrequency) {
+                setFrequency(event.value);
+            } else if (event.type == AudioEventAmplitude) {
+                setAmplitude(event.value);
+            }
+        }
+
+        bool isIdle() const {
+            return _amplitude == 0.0f;
+        }
+
+        void processFrame(float* frame) {
+            const float value = _amplitude * _sine;
+            for (int32_t channel = 0; channel < Channels; channel++) {
+                frame[channel] = value;
+            }
+            const float cosine = _cosine * _rotationCosine - _sine * _rotationSine;
+            _sine = _sine * _rotationCosine + _cosine * _rotationSine;
+            _cosine = cosine;
+        }
+
+    protected:
+        int _samplingRate;
+        float _amplitude;
+        int32_t _index; // index matched by the events
+        float _cosine = 1.0f; // phasor
+        float _sine = 0.0f;
+        float _rotationCosine = 1.0f; // rotation per frame
+        float _rotationSine = 0.0f;
+    };
+
+    /**
+     * @brief Gain, ramped linearly to a new value over each part of a block
+     *
+     * Listens to AudioEventParameter events with its parameter identifier.
+     * @tparam Channels Number of channels
+     */
+    template<int32_t Channels>
+    class StaticGain : public StaticStage<StaticGain<Channels>, Channels> {
+    public:
+        /**
+         * Constructor
+         * @param parameter Parameter identifier matched by the events
+         * @param gain Initial linear gain
+         */
+        explicit StaticGain(int32_t parameter, float gain = 1.0f)
+                : _parameter(parameter), _gain(gain), _partTarget(gain), _target(gain) {
+        }
+
+        /**
+         * Set the gain, reached at the end of the next part of a block
+         * @param gain Linear gain
+         */
+        void setGain(float gain) {
+            _target = gain;
+        }
+
+        void beginBlock(int32_t framesCount) {
+            // Start exactly at the end value of the previous ramp
+            _gain = _partTarget;
+            _partTarget = _target;
+            _increment = (_partTarget - _gain) / static_cast<float>(framesCount);
+        }
+
+        void onAudioEvent(const AudioEvent& event) {
+            if (event.type == AudioEventParameter && event.index == _parameter) {
+                setGain(event.value);
+            }
+        }
+
+        void processFrame(float* frame) {
+            _gain += _increment;
+            for (int32_t channel = 0; channel < Channels; channel++) {
+                frame[channel] *= _gain;
+            }
+        }
+
+    protected:
+        int32_t _parameter; // parameter identifier matched by the events
+        float _gain; // current gain
+        float _partTarget; // gain at the end of the current part
+        float _target; // gain requested
+        float _increment = 0.0f; // per frame, within the current part
+    };
+
+    /**
+     * @brief One-pole lowpass filter, y[n] = y[n-1] + a * (x[n] - y[n-1]), for each channel
+     *
+     * Listens to AudioEventParameter events with its parameter identifier, whose value is the cutoff in Hz.
+     * @tparam Channels Number of channels
+     */
+    template<int32_t Channels>
+    class StaticOnePoleLowpass : public StaticStage<StaticOnePoleLowpass<Channels>, Channels> {
+    public:
+        /**
+         * Constructor
+         * @param samplingRate Sampling rate, in samples per second
+         * @param cutoff Cutoff frequency, in Hz
+         * @param parameter Parameter identifier matched by the events
+         */
+        StaticOnePoleLowpass(int samplingRate, float cutoff, int32_t parameter)
+                : _samplingRate(samplingRate), _parameter(parameter) {
+            setCutoff(cutoff);
+        }
+
+        /**
+         * Set the cutoff frequency
+         * @param cutoff Cutoff frequency, in Hz
+         */
+        void setCutoff(float cutoff) {
+            const double pole = exp(-2.0 * M_PI * std::max(cutoff, 1.0f) / _samplingRate);
+            _coefficient = static_cast<float>(1.0 - pole);
+            // Time for the state to decay by 120 dB
+            _tailFrames = static_cast<int32_t>(std::min(ceil(log(1e-6) / log(pole)), 1e9));
+        }
+
+        void onAudioEvent(const AudioEvent& event) {
+            if (event.type == AudioEventParameter && event.index == _parameter) {
+                setCutoff(event.value);
+            }
+        }
+
+        void onPlaybackStopped() {
+            memset(_state, 0, sizeof(_state));
+        }
+
+        int32_t getTailFrames() const {
+            return _tailFrames;
+        }
+
+        void processFrame(float* frame) {
+            for (int32_t channel = 0; channel < Channels; channel++) {
+                _state[channel] += _coefficient * (frame[channel] - _state[channel]);
+                frame[channel] = _state[channel];
+            }
+        }
+
+    protected:
+        int _samplingRate;
+        int32_t _parameter; // parameter identifier matched by the events
+        float _coefficient = 1.0f; // a
+        int32_t _tailFrames = 0; // decay time by 120 dB
+        float _state[Channels] = {}; // last output of each channel
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,280 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef StreamingSampleAudioSource_H
+#define StreamingSampleAudioSource_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+#include "AudioSource.h"
+#include "VoicePool.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Sample player streaming its samples from memory-mapped WAV files
+     *
+     * Each sample (16 or 24-bit PCM, or 32-bit float WAV, at the sampling rate of the source) is assigned to a
+     * note. Only its first residentFrames frames are decoded into memory when it is added; the rest of the file
+     * is memory-mapped and read in place by the audio thread, without a copy. A low-priority prefetch thread keeps
+     * the next prefetchFrames frames ahead of every playing voice in memory: it advises the kernel (madvise),
+     * touches the pages and locks them (mlock), unlocking the pages the voices have passed. The prefetcher
+     * publishes, for each voice, up to which frame the data is locked in memory; the audio thread never reads
+     * beyond, so that it does not wait for the disk. Data that is not ready in time, e.g. because RLIMIT_MEMLOCK
+     * does not permit locking it, is played as silence and counted as a miss. The resident part gives the
+     * prefetcher time to fetch the start of the streamed part after a note starts. Without page locking
+     * (setPageLocking(false)), the pages are only touched: the kernel may evict them again before they are
+     * played, and the audio thread then waits for the disk.
+     * <br />
+     * Notes are started and released with AudioEventNoteOn (velocity as linear gain) and AudioEventNoteOff,
+     * voices are assigned by a VoicePool. Samples with one channel play in all channels; otherwise output
+     * channel c plays sample channel c modulo the sample's channel count. Add the samples, then call start(),
+     * before playing.
+     */
+    class StreamingSampleAudioSource : public AudioSource {
+    public:
+        /**
+         * Frames decoded into memory at the start of each sample by default, about 0.7 s at 48 kHz
+         */
+        static constexpr int32_t defaultResidentFrames = 32768;
+
+        /**
+         * Frames kept in memory ahead of each voice by default
+         */
+        static constexpr int32_t defaultPrefetchFrames = 65536;
+
+        /**
+         * Constructor
+         * @param samplingRate Sampling rate, in samples per second; samples must have this rate
+         * @param channelCount Number of channels; onAudioReady must be called with this channel count
+         * @param voiceCount Number of voices
+         * @param residentFrames Frames decoded into memory at the start of each sample
+         * @param prefetchFrames Frames kept in memory ahead of each voice
+         */
+        StreamingSampleAudioSource(int samplingRate, int32_t channelCount, int32_t voiceCount = 32,
+                                   int32_t residentFrames = defaultResidentFrames,
+                                   int32_t prefetchFrames = defaultPrefetchFrames);
+
+        /**
+         * Destructor, stops the prefetch thread and unmaps the files
+         */
+        ~StreamingSampleAudioSource() override;
+
+        StreamingSampleAudioSource(const StreamingSampleAudioSource&) = delete;
+
+        StreamingSampleAudioSource& operator=(const StreamingSampleAudioSource&) = delete;
+
+        /**
+         * @brief Map a WAV file and assign it to a note (non-real-time thread, before start)
+         *
+         * Decodes the resident part; the rest of the file is only read when played.
+         * @param path Path of the WAV file
+         * @param note Note number, 0 to 127; replaces a sample previously assigned to the note
+         * @return Index of the sample, or ResultErrorIO if the file cannot be read, ResultErrorInvalidArgument if
+         *         its format or sampling rate is not supported or the note is out of range, ResultErrorInvalidState
+         *         if the prefetch thread runs
+         */
+        int32_t addSample(const char* path, int32_t note);
+
+        /**
+         * Lock the prefetched pages in memory, such that the kernel cannot evict them before they are played
+         * (call before start; enabled by default). Locking is limited by RLIMIT_MEMLOCK: pages that cannot be
+         * locked are not handed to the audio thread. Without locking, the pages are only touched, and the audio
+         * thread may take page faults on pages evicted in the meantime.
+         * @param enabled true to lock the prefetched pages
+         */
+        void setPageLocking(bool enabled);
+
+        /**
+         * Start the prefetch thread (non-real-time thread, before playing)
+         * @return ResultOk, or ResultErrorInvalidState if already started
+         */
+        int32_t start();
+
+        /**
+         * Stop the prefetch thread (non-real-time thread)
+         */
+        void stop();
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        /**
+         * Stop all voices
+         */
+        void onPlaybackStopped() override;
+
+        /**
+         * Start (AudioEventNoteOn) and release (AudioEventNoteOff) notes
+         * @param event Event
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Idle while no voice plays
+         * @return true if no voice plays
+         */
+        bool isIdle() const override;
+
+        /**
+         * Number of times a voice found its data not yet in memory
+         * @return Miss count, one per voice and callback at most
+         */
+        int64_t getMissCount() const;
+
+        /**
+         * Number of frames played as silence because their data was not yet in memory, summed over the voices
+         * @return Frames count
+         */
+        int64_t getMissedFrames() const;
+
+        /**
+         * Memory taken by the decoded resident parts of the samples
+         * @return Size in bytes
+         */
+        int64_t getResidentBytes() const;
+
+        /**
+         * Size of the mapped files
+         * @return Size in bytes
+         */
+        int64_t getMappedBytes() const;
+
+        /**
+         * Number of samples added
+         */
+        int32_t getSampleCount() const;
+
+    protected:
+        /**
+         * Sample encodings read from the mapped files
+         */
+        enum class Encoding : int32_t {
+            Int16 = 0,
+            Int24,
+            Float,
+        };
+
+        /**
+         * A mapped WAV file
+         */
+        struct Sample {
+            const uint8_t* map = nullptr; // the whole file
+            size_t mapBytes = 0;
+            const uint8_t* data = nullptr; // first frame, in the map
+            int64_t frames = 0;
+            int32_t channels = 0;
+            int32_t frameBytes = 0; // in the file
+            Encoding encoding = Encoding::Int16;
+            std::vector<float> resident; // first residentFrames frames, interleaved
+            int64_t residentFrames = 0;
+        };
+
+        /**
+         * State of a voice shared between the audio thread and the prefetch thread
+         */
+        struct alignas(64) SharedVoice {
+            std::atomic<uint64_t> request{0}; // generation in the upper 32 bits, sample index + 1 in the lower; 0: free
+            std::atomic<int64_t> position{0}; // frame the voice plays, published by the audio thread
+            std::atomic<uint64_t> ready{0}; // generation in the upper 24 bits, end of the prefetched frames below
+        };
+
+        /**
+         * Playing state of a voice (audio thread)
+         */
+        struct Voice {
+            int32_t sample = -1; // sample index, -1 if free
+            uint32_t generation = 0; // incremented at each note start, matches the prefetched frames to the note
+            int64_t position = 0; // next frame of the sample
+            float gain = 0.0f; // velocity
+            float release = 1.0f; // release envelope, from 1 to 0
+            float releaseStep = 0.0f; // per frame, 0 while the note is held
+        };
+
+        /**
+         * Pages prefetched for a voice (prefetch thread)
+         */
+        struct PrefetchWindow {
+            int32_t sample = -1;
+            uint32_t generation = 0;
+            size_t begin = 0; // byte offsets in the map, page-aligned
+            size_t end = 0;
+        };
+
+        /**
+         * Mix frames of a voice into the planar output, with the voice's gain and release envelope
+         * @tparam SourceEncoding Encoding of the source frames
+         * @param output Planar output block
+         * @param framesCount Frames of the output block
+         * @param offset First frame of the output block to mix into
+         * @param source First source frame
+         * @param count Number of frames
+         */
+        template<Encoding SourceEncoding>
+        void mixFrames(Voice& voice, const Sample& sample, float* output, int32_t framesCount, int32_t offset,
+                       const uint8_t* source, int32_t count);
+
+        /**
+         * Mix the frames of a voice into the planar output (audio thread)
+         * @return false if the voice ended
+         */
+        bool renderVoice(int32_t voice, float* output, int32_t framesCount);
+
+        /**
+         * Main function of the prefetch thread
+         */
+        void runPrefetcher();
+
+        /**
+         * Bring the pages ahead of a voice into memory and release those it has passed (prefetch thread)
+         */
+        void prefetchVoice(int32_t voice);
+
+        /**
+         * Unlock a byte range of a sample's map, except for the parts in the windows of other voices
+         * (prefetch thread)
+         */
+        void unlockExcept(int32_t voice, int32_t sample, size_t begin, size_t end);
+
+        int _samplingRate;
+        int32_t _channelCount;
+        int32_t _residentFrames;
+        int32_t _prefetchFrames;
+        int32_t _releaseFrames; // length of the release after a note off
+        size_t _pageSize;
+        bool _pageLocking = true;
+        std::vector<std::unique_ptr<Sample>> _samples;
+        int32_t _noteSamples[VoicePool::noteCount]; // sample index of each note, -1 for none
+        VoicePool _pool; // audio thread
+        std::vector<Voice> _voices; // audio thread
+        std::vector<int32_t> _releasedVoices; // audio thread: voices released by a note off
+        std::unique_ptr<SharedVoice[]> _shared;
+        std::vector<PrefetchWindow> _windows; // prefetch thread
+        std::thread _prefetcher;
+        std::atomic<bool> _running{false};
+        std::atomic<int64_t> _missCount{0};
+        std::atomic<int64_t> _missedFrames{0};
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -27,6 +27,7 @@
 #include "AudioPlayer.h"
 #include "AudioSourceConsumer.h"
 #include <memory>
+#include <atomic>
 
 
 
@@ -75,8 +76,26 @@ namespace synthesizerBase {
         /**
          * Set the audio data source
          * @param source Audio data source
+         * @return ResultOk, or ResultErrorInvalidState without audio player or if the player did not accept the
+         *         source (see AudioPlayer::setAudioSource)
          */
-        virtual void setAudioSource(AudioSource* source) override;
+        virtual int32_t setAudioSource(AudioSource* source) override;
+
+        /**
+         * Set the audio data source, crossfading from the previous one while playing
+         * @param source Audio data source
+         * @param crossfadeFrames Length of the crossfade, in frames
+         * @return ResultOk, or ResultErrorInvalidState without audio player or if the player did not accept the
+         *         source (see AudioPlayer::setAudioSource)
+         */
+        virtual int32_t setAudioSource(AudioSource* source, int32_t crossfadeFrames);
+
+        /**
+         * Take back a replaced audio data source once the audio thread no longer uses it,
+         * see AudioPlayer::collectRetiredAudioSource
+         * @return A replaced audio source that can be deleted, or nullptr
+         */
+        virtual AudioSource* collectRetiredAudioSource();
 
         /**
          * Get the currently configured audio data source
@@ -84,6 +103,25 @@ namespace synthesizerBase {
          */
         virtual AudioSource* getAudioSource() override;
 
+        /**
+         * Send a timestamped event to the audio source, see AudioPlayer::postEvent
+         * @param event Event
+         * @return ResultOk, or an error code if there is no audio player or too many events are pending
+         */
+        virtual int32_t postEvent(const AudioEvent& event);
+
+        /**
+         * Current frame time of the audio player, for scheduling events, see AudioPlayer::getFrameTime
+         * @return Frame time, 0 if there is no audio player
+         */
+        virtual int64_t getFrameTime() const;
+
+        /**
+         * Set the thread pool the audio player wakes at the start of each callback, see AudioPlayer::setThreadPool
+         * @param pool Thread pool, owned by the caller, or nullptr
+         */
+        virtual void setThreadPool(RealtimeThreadPool* pool);
+
 
 
 
@@ -0,0 +1,224 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef VoicePool_H
+#define VoicePool_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+#include "AudioDefinitions.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Polyphony manager: assigns notes to a fixed number of voices, without allocation
+     *
+     * The pool only keeps the bookkeeping of each voice (note, velocity, level, state); an audio source using it
+     * keeps its own per-voice synthesis state in arrays indexed by the voice index, e.g. the oscillators of a
+     * WavetableOscillatorBank. All arrays are allocated at construction, cache-line aligned, one per field.
+     * <br />
+     * noteOn takes a free voice or, when all voices are in use, steals one according to the steal mode. A note
+     * started again while it still sounds takes another voice (except with StealMode::SameNote), and noteOff
+     * releases all voices playing the note. noteOn and freeVoice run in constant time, noteOff in the number of
+     * voices of the note. The indices of the voices in use are kept in a dense
+     * array, for iterating over active voices only. The pool is not synchronized: use it from the audio thread,
+     * e.g. when handling note events in onAudioReady.
+     * <br />
+     * Typical use, per block: handle the note events with noteOn and noteOff, render the active voices, report
+     * the level of each with setLevel and free the voices whose release has ended with freeVoice, then call
+     * endBlock.
+     */
+    class VoicePool {
+    public:
+        /**
+         * Value returned instead of a voice index when no voice is concerned
+         */
+        static constexpr int32_t noVoice = -1;
+
+        /**
+         * Number of distinct notes (MIDI note numbers 0 to 127)
+         */
+        static constexpr int32_t noteCount = 128;
+
+        /**
+         * Voice to take when a note starts while all voices are in use
+         */
+        enum class StealMode {
+            None, // the note is not played
+            Oldest, // the voice started longest ago
+            Quietest, // the voice with the lowest level at the last endBlock
+            SameNote, // retrigger the voice already playing the note if any, otherwise the oldest voice
+        };
+
+        /**
+         * State of a voice
+         */
+        enum VoiceState : uint8_t {
+            VoiceFree = 0,
+            VoicePlaying, // note held
+            VoiceReleasing, // note released, the voice is still sounding until freeVoice is called
+        };
+
+        /**
+         * Constructor
+         * @param capacity Number of voices
+         * @param stealMode Voice stealing policy
+         */
+        explicit VoicePool(int32_t capacity, StealMode stealMode = StealMode::Oldest);
+
+        /**
+         * Start a note
+         * @param note Note number, 0 to 127
+         * @param velocity Velocity, used as initial level for quietest-voice stealing
+         * @param stolenNote Optional; set to the note previously played by the returned voice if it was stolen
+         *                   or retriggered, to noVoice otherwise
+         * @return Voice index, ResultErrorInvalidArgument if the note is out of range, or ResultErrorInvalidState
+         *         if all voices are in use and the steal mode is None
+         */
+        int32_t noteOn(int32_t note, float velocity, int32_t* stolenNote = nullptr);
+
+        /**
+         * Release a note: all voices playing it go to the releasing state
+         * @param note Note number
+         * @param releasedVoices Optional, room for getCapacity() entries; set to the indices of the voices released
+         * @return Number of voices released, 0 if the note is not held
+         */
+        int32_t noteOff(int32_t note, int32_t* releasedVoices = nullptr);
+
+        /**
+         * Release all held notes
+         */
+        void allNotesOff();
+
+        /**
+         * Return a voice to the pool, typically at the end of its release. Swaps the last active voice into the
+         * position of the freed one in the active voice array: when freeing voices while iterating over that
+         * array, iterate from the end.
+         * @param voice Voice index
+         */
+        void freeVoice(int32_t voice);
+
+        /**
+         * Free all voices
+         */
+        void reset();
+
+        /**
+         * Report the current level of a voice, e.g. its envelope value, for quietest-voice stealing
+         * @param voice Voice index
+         * @param level Level
+         */
+        void setLevel(int32_t voice, float level);
+
+        /**
+         * End of an audio block: with the Quietest steal mode, rank the active voices by the levels set
+         * since the last call. Voices started after this call are not stolen before the next one, if possible.
+         */
+        void endBlock();
+
+        /**
+         * Indices of the voices in use, playing or releasing, in no particular order
+         * @return activeCount() voice indices, contiguous
+         */
+        const int32_t* activeVoices() const {
+            return _active.data();
+        }
+
+        /**
+         * Number of voices in use
+         * @return Number of entries of activeVoices()
+         */
+        int32_t activeCount() const {
+            return _activeCount;
+        }
+
+        int32_t getCapacity() const {
+            return _capacity;
+        }
+
+        VoiceState getState(int32_t voice) const {
+            return static_cast<VoiceState>(_states[voice]);
+        }
+
+        int32_t getNote(int32_t voice) const {
+            return _notes[voice];
+        }
+
+        float getVelocity(int32_t voice) const {
+            return _velocities[voice];
+        }
+
+        float getLevel(int32_t voice) const {
+            return _levels[voice];
+        }
+
+        /**
+         * Number of voices stolen since construction or the last reset
+         */
+        int64_t getStolenCount() const {
+            return _stolenCount;
+        }
+
+    protected:
+        /**
+         * Voice to steal, or noVoice
+         */
+        int32_t selectVoiceToSteal();
+
+        void appendToAgeList(int32_t voice);
+        void removeFromAgeList(int32_t voice);
+        void appendToNoteList(int32_t voice, int32_t note);
+        void removeFromNoteList(int32_t voice);
+
+        int32_t _capacity;
+        StealMode _stealMode;
+
+        // Per voice
+        AlignedBuffer<int32_t> _notes;
+        AlignedBuffer<float> _velocities;
+        AlignedBuffer<float> _levels;
+        AlignedBuffer<uint8_t> _states;
+        AlignedBuffer<uint64_t> _startSerials; // noteOn count when the voice was last started
+        AlignedBuffer<int32_t> _olderVoices; // age list, doubly linked, oldest voice first
+        AlignedBuffer<int32_t> _newerVoices;
+        AlignedBuffer<int32_t> _activePositions; // index in _active, or noVoice
+        AlignedBuffer<int32_t> _olderNoteVoices; // list of the voices of each note, doubly linked, newest first
+        AlignedBuffer<int32_t> _newerNoteVoices;
+
+        AlignedBuffer<int32_t> _active; // dense array of the voices in use
+        int32_t _activeCount;
+        AlignedBuffer<int32_t> _freeVoices; // stack of free voices
+        int32_t _freeCount;
+        int32_t _oldestVoice; // head of the age list
+        int32_t _newestVoice; // tail of the age list
+        AlignedBuffer<int32_t> _noteVoices; // newest voice in use for each note (head of its list), or noVoice
+
+        AlignedBuffer<int32_t> _quietOrder; // active voices by increasing level, at the last endBlock
+        int32_t _quietCount;
+        int32_t _quietCursor; // next candidate in _quietOrder
+        uint64_t _quietSerial; // noteOn count at the last endBlock
+
+        uint64_t _serial; // number of noteOn calls
+        int64_t _stolenCount;
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,120 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef WavetableMipmaps_H
+#define WavetableMipmaps_H
+
+#include <stdint.h>
+#include "AlignedBuffer.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Band-limited versions of a single-cycle waveform, one per octave
+     *
+     * Level k of the mipmap contains the harmonics 1 to (tableSize/2)>>k of the waveform, so level 0 has the full
+     * bandwidth of the table and the last level is a pure sine. An oscillator picks the first level whose highest
+     * harmonic stays below the Nyquist frequency for its fundamental, which avoids aliasing without oversampling.
+     * <br />
+     * All levels are stored in one contiguous, aligned array; each level has tableSize samples followed by
+     * a copy of its first sample, for interpolation, and is padded to levelStride floats.
+     */
+    class WavetableMipmaps {
+    public:
+        /**
+         * Samples per cycle
+         */
+        static constexpr int32_t tableSize = 2048;
+
+        /**
+         * Number of levels: tableSize/2 harmonics at level 0 down to 1 harmonic
+         */
+        static constexpr int32_t levelCount = 11;
+
+        /**
+         * Distance between the starts of two levels in the table array, in floats (a multiple of 16)
+         */
+        static constexpr int32_t levelStride = tableSize + 16;
+
+        /**
+         * Predefined waveforms
+         */
+        enum class Waveform {
+            Sine,
+            Sawtooth,
+            Square,
+            Triangle,
+        };
+
+        /**
+         * Constructor, generating the tables of a predefined waveform
+         * @param waveform Waveform
+         */
+        explicit WavetableMipmaps(Waveform waveform = Waveform::Sawtooth);
+
+        /**
+         * Constructor, generating the tables from harmonic amplitudes (sine phase)
+         * @param amplitudes Amplitude of harmonic 1, 2, ...
+         * @param count Number of harmonics given; harmonics above tableSize/2 are ignored
+         */
+        WavetableMipmaps(const float* amplitudes, int32_t count);
+
+        /**
+         * @brief Constructor using tables generated beforehand, e.g. memory-mapped from a file
+         *
+         * The memory is not copied and must remain valid for the lifetime of this object.
+         * @param tables levelCount*levelStride floats, in the layout described above, 64-byte aligned
+         */
+        explicit WavetableMipmaps(const float* tables);
+
+        /**
+         * Mipmap level to use for a fundamental frequency
+         * @param frequency Fundamental frequency, in Hz
+         * @param samplingRate Sampling rate, in samples per second
+         * @return Level index, or -1 if the frequency is at or above the Nyquist frequency
+         */
+        static int32_t levelForFrequency(float frequency, int samplingRate);
+
+        /**
+         * Start of the table array
+         * @return levelCount*levelStride floats
+         */
+        const float* getTables() const;
+
+        /**
+         * Start of one level
+         * @param level Level index
+         * @return tableSize+1 floats
+         */
+        const float* getLevel(int32_t level) const;
+
+    protected:
+        /**
+         * Generate all levels from harmonic amplitudes, normalized to a peak of 1 at level 0
+         */
+        void generate(const float* amplitudes, int32_t count);
+
+        AlignedBuffer<float> _storage; // generated tables, empty if external tables are used
+        const float* _tables; // tables in use
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,124 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2025 Thomas and Mathis Braschler <thomas.braschler@gmail.com>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef WavetableOscillatorBank_H
+#define WavetableOscillatorBank_H
+
+#include "AlignedBuffer.h"
+#include "AudioSource.h"
+#include "WavetableMipmaps.h"
+
+namespace synthesizerBase {
+
+    /**
+     * @brief Audio source summing a large number of wavetable oscillators sharing one band-limited waveform
+     *
+     * The oscillator state is kept as separate aligned arrays (phase, phase increment, amplitude, table offset),
+     * so that the oscillators are rendered in groups of 8 by a vectorized kernel (see SimdKernels.h). The mipmap
+     * level of each oscillator is chosen when its frequency is set, not per sample; oscillators above the
+     * Nyquist frequency are muted.
+     * <br />
+     * The output is the same in all channels. The setters are not synchronized with onAudioReady: call them from
+     * the audio thread, or while the bank is not playing. While playing, post AudioEventFrequency and
+     * AudioEventAmplitude events (index: oscillator) to the audio player instead; they are applied sample-accurately.
+     */
+    class WavetableOscillatorBank : public AudioSource {
+    public:
+        /**
+         * Constructor; all oscillators are initially silent
+         * @param mipmaps Waveform, owned by the caller and possibly shared by several banks
+         * @param maxOscillators Number of oscillators
+         * @param samplingRate Sampling rate, in samples per second
+         */
+        WavetableOscillatorBank(const WavetableMipmaps* mipmaps, int32_t maxOscillators, int samplingRate);
+
+        /**
+         * Set the frequency and amplitude of an oscillator
+         * @param index Oscillator index
+         * @param frequency Frequency, in Hz
+         * @param amplitude Linear amplitude
+         */
+        void setOscillator(int32_t index, float frequency, float amplitude);
+
+        /**
+         * Set the frequency of an oscillator, keeping its phase and amplitude
+         * @param index Oscillator index
+         * @param frequency Frequency, in Hz
+         */
+        void setFrequency(int32_t index, float frequency);
+
+        /**
+         * Set the amplitude of an oscillator
+         * @param index Oscillator index
+         * @param amplitude Linear amplitude
+         */
+        void setAmplitude(int32_t index, float amplitude);
+
+        /**
+         * Silence an oscillator and reset its phase
+         * @param index Oscillator index
+         */
+        void stopOscillator(int32_t index);
+
+        /**
+         * Number of oscillators
+         * @return Maximum number of oscillators
+         */
+        int32_t getMaxOscillators() const;
+
+        void onAudioReady(float* audioData, int32_t framesCount, ChannelCount channelCount) override;
+
+        void onPlaybackStopped() override;
+
+        /**
+         * Apply AudioEventFrequency and AudioEventAmplitude events; the index is the oscillator
+         */
+        void onAudioEvent(const AudioEvent& event) override;
+
+        /**
+         * Idle while no oscillator is audible
+         */
+        bool isIdle() const override;
+
+        BlockState getBlockState() const override;
+
+    protected:
+        /**
+         * Recompute the rendered amplitude of an oscillator and the number of groups to render
+         */
+        void updateAmplitude(int32_t index);
+
+        const WavetableMipmaps* _mipmaps;
+        int32_t _maxOscillators;
+        int _samplingRate;
+        int32_t _activeGroups; // groups of 8 oscillators up to the last audible one
+        bool _silentBlock = false; // whether the last block was rendered without audible oscillators
+        AlignedBuffer<float> _phases; // in table samples
+        AlignedBuffer<float> _increments; // in table samples per frame
+        AlignedBuffer<float> _amplitudes; // rendered amplitude, 0 if muted
+        AlignedBuffer<int32_t> _tableOffsets; // start of the mipmap level in the table array
+        AlignedBuffer<float> _requestedAmplitudes; // amplitude set by the caller
+        AlignedBuffer<uint8_t> _muted; // 1 if the frequency is at or above the Nyquist frequency
+        AlignedBuffer<float> _accumulator; // one lane per oscillator of a group, float[frames][8]
+    };
+
+}  // namespace synthesizerBase
+
+#endif
@@ -0,0 +1,98 @@
+
+/* Builds an asset cache (see AssetCache.h) for shipping with an application or generating at packaging time:
+ * the wavetables of the predefined waveforms, plus wavetables from harmonic amplitudes and parameter sets
+ * (patches) read from text files of whitespace-separated numbers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "AssetCache.h"
+#include "WavetableMipmaps.h"
+
+using namespace synthesizerBase;
+
+namespace {
+
+    /**
+     * Read whitespace-separated numbers
+     * @return false if the file cannot be read or contains anything else
+     */
+    bool readNumbers(const char* path, std::vector<float>& values) {
+        FILE* file = fopen(path, "r");
+        if (file == nullptr) {
+            return false;
+        }
+        float value = 0.0f;
+        int read;
+        while ((read = fscanf(file, "%f", &value)) == 1) {
+            values.push_back(value);
+        }
+        fclose(file);
+        return read == EOF;
+    }
+
+    int usage() {
+        fprintf(stderr, "Usage: BuildAssetCache output [--content-version N] [--no-waveforms]\n"
+                        "       [--wavetable name harmonics.txt]... [--parameters name values.txt]...\n");
+        return 1;
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        return usage();
+    }
+    const char* output = argv[1];
+    uint64_t contentVersion = 0;
+    bool waveforms = true;
+    AssetCacheBuilder builder;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--content-version") == 0 && i + 1 < argc) {
+            contentVersion = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--no-waveforms") == 0) {
+            waveforms = false;
+        } else if ((strcmp(argv[i], "--wavetable") == 0 || strcmp(argv[i], "--parameters") == 0) && i + 2 < argc) {
+            const bool wavetable = strcmp(argv[i], "--wavetable") == 0;
+            const char* name = argv[++i];
+            const char* path = argv[++i];
+            std::vector<float> values;
+            if (!readNumbers(path, values)) {
+                fprintf(stderr, "Cannot read %s\n", path);
+                return 1;
+            }
+            const int32_t count = static_cast<int32_t>(values.size());
+            const int32_t result = wavetable
+                                   ? builder.addWavetable(name, WavetableMipmaps(values.data(), count))
+                                   : builder.addParameters(name, values.data(), count);
+            if (result != ResultOk) {
+                fprintf(stderr, "Invalid or duplicate name %s\n", name);
+                return 1;
+            }
+        } else {
+            return usage();
+        }
+    }
+    if (waveforms) {
+        const struct {
+            const char* name;
+            WavetableMipmaps::Waveform waveform;
+        } predefined[] = {{"sine", WavetableMipmaps::Waveform::Sine},
+                          {"sawtooth", WavetableMipmaps::Waveform::Sawtooth},
+                          {"square", WavetableMipmaps::Waveform::Square},
+                          {"triangle", WavetableMipmaps::Waveform::Triangle}};
+        for (const auto& entry : predefined) {
+            if (builder.addWavetable(entry.name, WavetableMipmaps(entry.waveform)) != ResultOk) {
+                fprintf(stderr, "Duplicate name %s\n", entry.name);
+                return 1;
+            }
+        }
+    }
+    if (builder.write(output, contentVersion) != ResultOk) {
+        fprintf(stderr, "Cannot write %s\n", output);
+        return 1;
+    }
+    return 0;
+}